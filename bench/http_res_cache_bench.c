@@ -0,0 +1,279 @@
+/**
+ * @file http_res_cache_bench.c
+ * @brief HTTP server resource metadata cache benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * BENCH_URI_COUNT small files are generated under BENCH_ROOT_DIR, every
+ * fourth one also having a gzip-compressed variant. The metadata of these
+ * resources is then looked up repeatedly, the same way the HTTP server does
+ * before sending a response. Most lookups target a small set of popular
+ * URIs while the remaining ones are spread over the whole document tree,
+ * which mimics the access pattern of a typical web site.
+ *
+ * Build the benchmark once with HTTP_SERVER_RES_CACHE_SUPPORT enabled and
+ * once with it disabled. HTTP_SERVER_RES_CACHE_SIZE and
+ * HTTP_SERVER_RES_CACHE_WAYS can be varied to observe the effect of
+ * conflict misses on the lookup rate
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "http/http_server.h"
+#include "http/http_server_misc.h"
+#include "fs_port.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (HTTP_SERVER_SUPPORT != ENABLED)
+   #error HTTP_SERVER_SUPPORT must be enabled
+#elif (HTTP_SERVER_FS_SUPPORT != ENABLED)
+   #error HTTP_SERVER_FS_SUPPORT must be enabled
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Directory holding the generated files
+#ifndef BENCH_ROOT_DIR
+   #define BENCH_ROOT_DIR "/bench_www"
+#endif
+
+//Number of distinct URIs
+#ifndef BENCH_URI_COUNT
+   #define BENCH_URI_COUNT 256
+#elif (BENCH_URI_COUNT < 1)
+   #error BENCH_URI_COUNT parameter is not valid
+#endif
+
+//Number of popular URIs
+#ifndef BENCH_HOT_COUNT
+   #define BENCH_HOT_COUNT 12
+#elif (BENCH_HOT_COUNT < 1 || BENCH_HOT_COUNT > BENCH_URI_COUNT)
+   #error BENCH_HOT_COUNT parameter is not valid
+#endif
+
+//Percentage of lookups targeting the popular URIs
+#ifndef BENCH_HOT_RATIO
+   #define BENCH_HOT_RATIO 90
+#elif (BENCH_HOT_RATIO < 0 || BENCH_HOT_RATIO > 100)
+   #error BENCH_HOT_RATIO parameter is not valid
+#endif
+
+//Size of the generated files
+#define BENCH_FILE_SIZE 64
+
+
+//HTTP server context
+static HttpServerContext httpServerContext;
+//Single connection slot used to perform the lookups
+static HttpConnection httpConnections[1];
+//URIs of the generated resources
+static char_t benchUri[BENCH_URI_COUNT][24];
+//Contents of the generated files
+static uint8_t benchData[BENCH_FILE_SIZE];
+
+
+/**
+ * @brief Create a file in the web root directory
+ * @param[in] uri Path to the resource
+ * @param[in] suffix Extension appended to the name of the file
+ * @return Error code
+ **/
+
+error_t benchCreateFile(const char_t *uri, const char_t *suffix)
+{
+   error_t error;
+   FsFile *file;
+   char_t path[64];
+
+   //Build the absolute path of the file
+   osSprintf(path, "%s%s%s", BENCH_ROOT_DIR, uri, suffix);
+
+   //Create the file
+   file = fsOpenFile(path, FS_FILE_MODE_WRITE | FS_FILE_MODE_CREATE |
+      FS_FILE_MODE_TRUNC);
+   //Failed to create the file?
+   if(file == NULL)
+      return ERROR_OPEN_FAILED;
+
+   //Write the contents of the file
+   error = fsWriteFile(file, benchData, BENCH_FILE_SIZE);
+   //Close the file
+   fsCloseFile(file);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Measure lookup rate
+ * @param[in] connection Handle referencing a client connection
+ * @return Error code
+ **/
+
+error_t benchLookup(HttpConnection *connection)
+{
+   error_t error;
+   uint_t i;
+   uint32_t count;
+   systime_t time;
+   HttpResourceInfo info;
+
+   //Initialize variables
+   error = NO_ERROR;
+   count = 0;
+
+   //Save current time
+   time = osGetSystemTime();
+
+   //Run for a fixed duration
+   while(!error && timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+   {
+      //Select either a popular URI or any URI of the document tree
+      if((uint_t) (rand() % 100) < BENCH_HOT_RATIO)
+      {
+         i = rand() % BENCH_HOT_COUNT;
+      }
+      else
+      {
+         i = rand() % BENCH_URI_COUNT;
+      }
+
+      //Retrieve the metadata of the resource
+      error = httpGetResourceInfo(connection, benchUri[i], &info);
+
+      //Both variants of a resource have the same length
+      if(!error && info.length != BENCH_FILE_SIZE)
+      {
+         error = ERROR_FAILURE;
+      }
+
+      //Next lookup
+      count++;
+   }
+
+   //Display results
+   printf("%" PRIu32 " lookups/s, %" PRIu32 " ns per lookup "
+      "(HTTP_SERVER_RES_CACHE_SUPPORT %s)%s\r\n",
+      count * 1000 / BENCH_DURATION,
+      (count > 0) ? (uint32_t) ((uint64_t) BENCH_DURATION * 1000000 / count) : 0,
+      (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED) ? "enabled" : "disabled",
+      error ? " (lookup failed)" : "");
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   //Display cache geometry
+   printf("%u entries, %u ways, %u popular URIs out of %u\r\n",
+      HTTP_SERVER_RES_CACHE_SIZE, HTTP_SERVER_RES_CACHE_WAYS,
+      BENCH_HOT_COUNT, BENCH_URI_COUNT);
+#endif
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t i;
+   HttpConnection *connection;
+   HttpServerSettings httpServerSettings;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Fill the contents of the files
+   osMemset(benchData, 'x', sizeof(benchData));
+
+   //Create the web root directory
+   fsCreateDir(BENCH_ROOT_DIR);
+
+   //Generate the document tree
+   for(i = 0; i < BENCH_URI_COUNT && !error; i++)
+   {
+      //Format the URI of the resource
+      osSprintf(benchUri[i], "/page%u.html", i);
+
+      //Create the file
+      error = benchCreateFile(benchUri[i], "");
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+      //Every fourth resource has a gzip-compressed variant
+      if(!error && (i % 4) == 0)
+      {
+         error = benchCreateFile(benchUri[i], ".gz");
+      }
+#endif
+   }
+
+   //Failed to generate the document tree?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Get default settings
+   httpServerGetDefaultSettings(&httpServerSettings);
+   //Serve the generated document tree
+   osStrcpy(httpServerSettings.rootDirectory, BENCH_ROOT_DIR);
+   //A single connection slot is needed
+   httpServerSettings.maxConnections = 1;
+   httpServerSettings.connections = httpConnections;
+
+   //HTTP server initialization
+   error = httpServerInit(&httpServerContext, &httpServerSettings);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Point to the connection slot
+   connection = &httpConnections[0];
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //The client accepts gzip-compressed representations
+   connection->request.acceptGzipEncoding = TRUE;
+#endif
+
+   //Measure lookup rate
+   error = benchLookup(connection);
+
+   //Return status code
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
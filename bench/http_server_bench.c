@@ -0,0 +1,432 @@
+/**
+ * @file http_server_bench.c
+ * @brief HTTP server load generator
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The HTTP server runs on the loopback interface with one connection slot
+ * per client. Each client task keeps a persistent connection open and
+ * issues GET requests back to back. The request callback answers each of
+ * them with a small fixed body. The number of requests served per second
+ * is reported for an increasing number of concurrent clients, together
+ * with the RAM needed per connection slot.
+ *
+ * Build the benchmark once with HTTP_SERVER_EVENT_DRIVEN_SUPPORT enabled
+ * and once with it disabled. In the task-per-connection mode, each slot
+ * also owns a task stack of HTTP_SERVER_STACK_SIZE words
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "drivers/loopback/loopback_driver.h"
+#include "http/http_server.h"
+#include "debug.h"
+
+//Maximum number of client tasks
+#ifndef BENCH_MAX_CLIENTS
+   #define BENCH_MAX_CLIENTS 32
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Size of the response body
+#ifndef BENCH_BODY_SIZE
+   #define BENCH_BODY_SIZE 64
+#endif
+
+//Size of the client receive buffer
+#define BENCH_BUFFER_SIZE 512
+
+
+/**
+ * @brief Client task context
+ **/
+
+typedef struct
+{
+   uint_t index;
+   volatile bool_t running;
+   volatile bool_t done;
+   uint32_t requests;
+   uint32_t errors;
+} BenchClient;
+
+
+//HTTP server context
+static HttpServerContext httpServerContext;
+//One connection slot per client
+static HttpConnection httpConnections[BENCH_MAX_CLIENTS];
+//Client contexts
+static BenchClient clients[BENCH_MAX_CLIENTS];
+//Response body
+static char_t benchBody[BENCH_BODY_SIZE];
+
+//Request issued by the clients
+static const char_t benchRequest[] =
+   "GET /bench HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+
+
+/**
+ * @brief HTTP request callback
+ * @param[in] connection Handle referencing a client connection
+ * @param[in] uri NULL-terminated string containing the path to the requested resource
+ * @return Error code
+ **/
+
+error_t benchRequestCallback(HttpConnection *connection, const char_t *uri)
+{
+   error_t error;
+
+   //Only the benchmark resource is served by the callback
+   if(osStrcmp(uri, "/bench"))
+      return ERROR_NOT_FOUND;
+
+   //Format HTTP response header
+   connection->response.statusCode = 200;
+   connection->response.contentType = "text/plain";
+   connection->response.chunkedEncoding = FALSE;
+   connection->response.contentLength = BENCH_BODY_SIZE;
+
+   //Send the header to the client
+   error = httpWriteHeader(connection);
+
+   //Check status code
+   if(!error)
+   {
+      //Send the response body
+      error = httpWriteStream(connection, benchBody, BENCH_BODY_SIZE);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Properly close the output stream
+      error = httpCloseStream(connection);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Perform a single GET request over a persistent connection
+ * @param[in] socket Handle to the connection
+ * @return Error code
+ **/
+
+error_t benchGetResource(Socket *socket)
+{
+   error_t error;
+   size_t n;
+   size_t length;
+   size_t bodyLength;
+   char_t *p;
+   char_t buffer[BENCH_BUFFER_SIZE + 1];
+
+   //Send the request
+   error = socketSend(socket, benchRequest, osStrlen(benchRequest), NULL,
+      SOCKET_FLAG_NO_DELAY);
+
+   //Initialize variables
+   length = 0;
+   p = NULL;
+
+   //Read the response header
+   while(!error && p == NULL)
+   {
+      //The header must fit in the buffer
+      if(length >= BENCH_BUFFER_SIZE)
+      {
+         error = ERROR_BUFFER_OVERFLOW;
+         break;
+      }
+
+      //Receive more data
+      error = socketReceive(socket, buffer + length, BENCH_BUFFER_SIZE - length,
+         &n, 0);
+
+      //Check status code
+      if(!error)
+      {
+         //Properly terminate the string
+         length += n;
+         buffer[length] = '\0';
+
+         //Search for the end of the header
+         p = osStrstr(buffer, "\r\n\r\n");
+      }
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Point to the beginning of the body
+      p += 4;
+      //Number of body bytes that have already been received
+      n = length - (p - buffer);
+
+      //Successful response?
+      if(osStrncmp(buffer, "HTTP/1.1 200", 12) ||
+         osStrstr(buffer, "Content-Length: ") == NULL)
+      {
+         error = ERROR_INVALID_RESPONSE;
+      }
+      else
+      {
+         //Retrieve the length of the body
+         bodyLength = osStrtoul(osStrstr(buffer, "Content-Length: ") + 16,
+            NULL, 10);
+
+         //Read the rest of the body
+         if(bodyLength > n)
+         {
+            error = socketReceive(socket, buffer, bodyLength - n, NULL,
+               SOCKET_FLAG_WAIT_ALL);
+         }
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Client task
+ * @param[in] client Pointer to the client context
+ **/
+
+void benchClientTask(BenchClient *client)
+{
+   error_t error;
+   IpAddr ipAddr;
+   Socket *socket;
+
+   //Loopback address
+   ipAddr.length = sizeof(Ipv4Addr);
+   ipAddr.ipv4Addr = IPV4_ADDR(127, 0, 0, 1);
+
+   //Open a TCP socket
+   socket = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
+
+   //Successful socket creation?
+   if(socket != NULL)
+   {
+      //Do not block forever if the server stalls
+      socketSetTimeout(socket, 5000);
+
+      //Establish the connection
+      error = socketConnect(socket, &ipAddr, HTTP_PORT);
+
+      //Run until the main task stops the benchmark
+      while(!error && client->running)
+      {
+         //Perform a GET request
+         error = benchGetResource(socket);
+
+         //Update statistics
+         if(!error)
+         {
+            client->requests++;
+         }
+         else
+         {
+            client->errors++;
+         }
+      }
+
+      //Gracefully close the connection
+      socketShutdown(socket, SOCKET_SD_BOTH);
+      socketClose(socket);
+   }
+   else
+   {
+      //The client could not run
+      client->errors++;
+   }
+
+   //The client has completed
+   client->done = TRUE;
+
+   //Kill ourselves
+   osDeleteTask(OS_SELF_TASK_ID);
+}
+
+
+/**
+ * @brief Run the benchmark with a given number of clients
+ * @param[in] count Number of client tasks
+ **/
+
+void benchRun(uint_t count)
+{
+   uint_t i;
+   uint32_t requests;
+   uint32_t errors;
+   OsTaskId taskId;
+
+   //Start the client tasks
+   for(i = 0; i < count; i++)
+   {
+      //Initialize client context
+      osMemset(&clients[i], 0, sizeof(BenchClient));
+      clients[i].index = i;
+      clients[i].running = TRUE;
+
+      //Create a task
+      taskId = osCreateTask("Client", (OsTaskCode) benchClientTask,
+         &clients[i], 1024, OS_TASK_PRIORITY_NORMAL);
+
+      //Failed to create task?
+      if(taskId == OS_INVALID_TASK_ID)
+      {
+         clients[i].done = TRUE;
+      }
+   }
+
+   //Let the clients run
+   osDelayTask(BENCH_DURATION);
+
+   //Stop the clients
+   for(i = 0; i < count; i++)
+   {
+      clients[i].running = FALSE;
+   }
+
+   //Wait for the clients to complete
+   for(i = 0; i < count; i++)
+   {
+      while(!clients[i].done)
+      {
+         osDelayTask(10);
+      }
+   }
+
+   //Aggregate statistics
+   for(requests = 0, errors = 0, i = 0; i < count; i++)
+   {
+      requests += clients[i].requests;
+      errors += clients[i].errors;
+   }
+
+   //Display results
+   printf("%2u client(s): %" PRIu32 " requests/s (%" PRIu32 " errors)\r\n",
+      count, requests * 1000 / BENCH_DURATION, errors);
+
+   //Give the server time to release the connection slots
+   osDelayTask(1000);
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t count;
+   size_t size;
+   NetInterface *interface;
+   HttpServerSettings httpServerSettings;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure the first interface as a loopback interface
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &loopbackDriver);
+
+   //Initialize the network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Assign the loopback address
+   ipv4SetHostAddr(interface, IPV4_ADDR(127, 0, 0, 1));
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+
+   //Fill the response body
+   osMemset(benchBody, 'x', sizeof(benchBody));
+
+   //Get default settings
+   httpServerGetDefaultSettings(&httpServerSettings);
+   //Bind the server to the loopback interface
+   httpServerSettings.interface = interface;
+   //One connection slot per client
+   httpServerSettings.maxConnections = BENCH_MAX_CLIENTS;
+   httpServerSettings.connections = httpConnections;
+   //Every request is answered by the callback
+   httpServerSettings.requestCallback = benchRequestCallback;
+
+   //HTTP server initialization
+   error = httpServerInit(&httpServerContext, &httpServerSettings);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Start HTTP server
+   error = httpServerStart(&httpServerContext);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //RAM needed per connection slot
+   size = sizeof(HttpConnection);
+
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == DISABLED && OS_STATIC_TASK_SUPPORT == DISABLED)
+   //Each slot also owns a dynamically allocated task stack
+   size += HTTP_SERVER_STACK_SIZE * sizeof(uint32_t);
+#endif
+
+   //Display the processing model under test
+   printf("HTTP_SERVER_EVENT_DRIVEN_SUPPORT %s, %" PRIuSIZE " bytes per connection\r\n",
+      (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED) ? "enabled" : "disabled",
+      size);
+
+   //Double the number of clients at each run
+   for(count = 1; count <= BENCH_MAX_CLIENTS; count *= 2)
+   {
+      benchRun(count);
+   }
+
+   //Successful processing
+   return EXIT_SUCCESS;
+}
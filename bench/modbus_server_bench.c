@@ -0,0 +1,406 @@
+/**
+ * @file modbus_server_bench.c
+ * @brief Modbus/TCP server latency and throughput benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The Modbus/TCP server runs on the loopback interface. Each simulated
+ * master task opens its own connection, writes a burst of Read Holding
+ * Registers requests with distinct transaction identifiers, then reads
+ * and checks the matching responses. A burst of one request corresponds
+ * to a strictly request/response master.
+ *
+ * The run is repeated for several numbers of masters and pipeline depths.
+ * The mean round-trip time of a burst is derived from the throughput, since
+ * each master always has one burst outstanding. Compare a build with
+ * MODBUS_SERVER_PIPELINING_SUPPORT enabled against a build with the option
+ * disabled. MODBUS_SERVER_MAX_CONNECTIONS must be at least
+ * BENCH_MAX_MASTERS
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "drivers/loopback/loopback_driver.h"
+#include "modbus/modbus_server.h"
+#include "debug.h"
+
+//Maximum number of simulated masters
+#ifndef BENCH_MAX_MASTERS
+   #define BENCH_MAX_MASTERS 16
+#endif
+
+//Maximum number of outstanding transactions per connection
+#ifndef BENCH_MAX_DEPTH
+   #define BENCH_MAX_DEPTH 8
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Number of holding registers read by each request
+#ifndef BENCH_REG_COUNT
+   #define BENCH_REG_COUNT 10
+#endif
+
+//Size of a request ADU
+#define BENCH_REQ_SIZE (sizeof(ModbusHeader) + sizeof(ModbusReadHoldingRegsReq))
+//Size of a response ADU
+#define BENCH_RESP_SIZE (sizeof(ModbusHeader) + \
+   sizeof(ModbusReadHoldingRegsResp) + BENCH_REG_COUNT * sizeof(uint16_t))
+
+
+/**
+ * @brief Simulated master context
+ **/
+
+typedef struct
+{
+   uint_t index;
+   uint_t depth;
+   volatile bool_t running;
+   volatile bool_t done;
+   uint32_t transactions;
+   uint32_t errors;
+} BenchMaster;
+
+
+//Modbus/TCP server context
+static ModbusServerContext modbusServerContext;
+//Simulated master contexts
+static BenchMaster masters[BENCH_MAX_MASTERS];
+
+
+/**
+ * @brief Get holding register value
+ * @param[in] role Client role OID
+ * @param[in] address Register address
+ * @param[out] value Register value
+ * @return Error code
+ **/
+
+error_t benchReadRegCallback(const char_t *role, uint16_t address,
+   uint16_t *value)
+{
+   //The register value is derived from its address
+   *value = address;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Perform a burst of transactions
+ * @param[in] socket Handle to the connection
+ * @param[in] transactionId Transaction identifier of the first request
+ * @param[in] depth Number of requests in the burst
+ * @return Error code
+ **/
+
+error_t benchSendBurst(Socket *socket, uint16_t transactionId, uint_t depth)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   ModbusHeader *header;
+   ModbusReadHoldingRegsReq *request;
+   ModbusReadHoldingRegsResp *response;
+   uint8_t buffer[BENCH_MAX_DEPTH * BENCH_RESP_SIZE];
+
+   //Format the requests back to back
+   for(i = 0; i < depth; i++)
+   {
+      //Point to the MBAP header of the current request
+      header = (ModbusHeader *) (buffer + i * BENCH_REQ_SIZE);
+      header->transactionId = htons(transactionId + i);
+      header->protocolId = HTONS(MODBUS_PROTOCOL_ID);
+      header->length = HTONS(sizeof(uint8_t) + sizeof(ModbusReadHoldingRegsReq));
+      header->unitId = MODBUS_DEFAULT_UNIT_ID;
+
+      //Format the PDU
+      request = (ModbusReadHoldingRegsReq *) header->pdu;
+      request->functionCode = MODBUS_FUNCTION_READ_HOLDING_REGS;
+      request->startingAddr = HTONS(0);
+      request->quantityOfRegs = HTONS(BENCH_REG_COUNT);
+   }
+
+   //Send the whole burst with a single call
+   error = socketSend(socket, buffer, depth * BENCH_REQ_SIZE, NULL,
+      SOCKET_FLAG_NO_DELAY);
+
+   //Check status code
+   if(!error)
+   {
+      //Wait for all the responses
+      error = socketReceive(socket, buffer, depth * BENCH_RESP_SIZE, &n,
+         SOCKET_FLAG_WAIT_ALL);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Responses must be returned in order
+      for(i = 0; i < depth && !error; i++)
+      {
+         //Point to the current response
+         header = (ModbusHeader *) (buffer + i * BENCH_RESP_SIZE);
+         response = (ModbusReadHoldingRegsResp *) header->pdu;
+
+         //Check the transaction identifier and the function code
+         if(ntohs(header->transactionId) != (uint16_t) (transactionId + i) ||
+            response->functionCode != MODBUS_FUNCTION_READ_HOLDING_REGS ||
+            response->byteCount != (BENCH_REG_COUNT * sizeof(uint16_t)))
+         {
+            error = ERROR_INVALID_RESPONSE;
+         }
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Simulated master task
+ * @param[in] master Pointer to the master context
+ **/
+
+void benchMasterTask(BenchMaster *master)
+{
+   error_t error;
+   uint16_t transactionId;
+   IpAddr ipAddr;
+   Socket *socket;
+
+   //Loopback address
+   ipAddr.length = sizeof(Ipv4Addr);
+   ipAddr.ipv4Addr = IPV4_ADDR(127, 0, 0, 1);
+
+   //Open a TCP socket
+   socket = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
+
+   //Successful socket creation?
+   if(socket != NULL)
+   {
+      //Do not block forever if the server stalls
+      socketSetTimeout(socket, 5000);
+
+      //Establish the connection
+      error = socketConnect(socket, &ipAddr, MODBUS_TCP_PORT);
+
+      //Start with an arbitrary transaction identifier
+      transactionId = master->index << 8;
+
+      //Run until the main task stops the benchmark
+      while(!error && master->running)
+      {
+         //Perform a burst of transactions
+         error = benchSendBurst(socket, transactionId, master->depth);
+
+         //Update statistics
+         if(!error)
+         {
+            master->transactions += master->depth;
+            transactionId += master->depth;
+         }
+         else
+         {
+            master->errors++;
+         }
+      }
+
+      //Gracefully close the connection
+      socketShutdown(socket, SOCKET_SD_BOTH);
+      socketClose(socket);
+   }
+   else
+   {
+      //The master could not run
+      master->errors++;
+   }
+
+   //The master has completed
+   master->done = TRUE;
+
+   //Kill ourselves
+   osDeleteTask(OS_SELF_TASK_ID);
+}
+
+
+/**
+ * @brief Run the benchmark with a given number of masters
+ * @param[in] count Number of simulated masters
+ * @param[in] depth Number of outstanding transactions per connection
+ **/
+
+void benchRun(uint_t count, uint_t depth)
+{
+   uint_t i;
+   uint32_t transactions;
+   uint32_t errors;
+   uint32_t rtt;
+   OsTaskId taskId;
+
+   //Start the simulated masters
+   for(i = 0; i < count; i++)
+   {
+      //Initialize master context
+      osMemset(&masters[i], 0, sizeof(BenchMaster));
+      masters[i].index = i;
+      masters[i].depth = depth;
+      masters[i].running = TRUE;
+
+      //Create a task
+      taskId = osCreateTask("Master", (OsTaskCode) benchMasterTask,
+         &masters[i], 1024, OS_TASK_PRIORITY_NORMAL);
+
+      //Failed to create task?
+      if(taskId == OS_INVALID_TASK_ID)
+      {
+         masters[i].done = TRUE;
+      }
+   }
+
+   //Let the masters run
+   osDelayTask(BENCH_DURATION);
+
+   //Stop the masters
+   for(i = 0; i < count; i++)
+   {
+      masters[i].running = FALSE;
+   }
+
+   //Wait for the masters to complete
+   for(i = 0; i < count; i++)
+   {
+      while(!masters[i].done)
+      {
+         osDelayTask(10);
+      }
+   }
+
+   //Aggregate statistics
+   for(transactions = 0, errors = 0, i = 0; i < count; i++)
+   {
+      transactions += masters[i].transactions;
+      errors += masters[i].errors;
+   }
+
+   //Each master has one burst outstanding, so the mean round-trip time of
+   //a burst (in microseconds) follows from the throughput
+   if(transactions > 0)
+   {
+      rtt = (uint32_t) ((uint64_t) BENCH_DURATION * 1000 * count * depth /
+         transactions);
+   }
+   else
+   {
+      rtt = 0;
+   }
+
+   //Display results
+   printf("%2u master(s), depth %u: %" PRIu32 " transactions/s, "
+      "%" PRIu32 " us per burst (%" PRIu32 " errors)\r\n", count, depth,
+      transactions * 1000 / BENCH_DURATION, rtt, errors);
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t count;
+   uint_t depth;
+   NetInterface *interface;
+   ModbusServerSettings modbusServerSettings;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure the first interface as a loopback interface
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &loopbackDriver);
+
+   //Initialize the network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Assign the loopback address
+   ipv4SetHostAddr(interface, IPV4_ADDR(127, 0, 0, 1));
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+
+   //Get default settings
+   modbusServerGetDefaultSettings(&modbusServerSettings);
+   //Bind the server to the loopback interface
+   modbusServerSettings.interface = interface;
+   //Holding registers are the only objects accessed by the masters
+   modbusServerSettings.readHoldingRegCallback = benchReadRegCallback;
+
+   //Modbus/TCP server initialization
+   error = modbusServerInit(&modbusServerContext, &modbusServerSettings);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Start Modbus/TCP server
+   error = modbusServerStart(&modbusServerContext);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Display the processing model under test
+   printf("MODBUS_SERVER_PIPELINING_SUPPORT %s\r\n",
+      (MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED) ? "enabled" : "disabled");
+
+   //Scale the number of masters and the pipeline depth independently
+   for(count = 1; count <= BENCH_MAX_MASTERS; count *= 4)
+   {
+      for(depth = 1; depth <= BENCH_MAX_DEPTH; depth *= 2)
+      {
+         benchRun(count, depth);
+      }
+   }
+
+   //Successful processing
+   return EXIT_SUCCESS;
+}
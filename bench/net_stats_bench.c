@@ -0,0 +1,276 @@
+/**
+ * @file net_stats_bench.c
+ * @brief Cost of the stack-wide statistics on the UDP datapath
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * A single task bounces UDP datagrams off itself over the loopback
+ * interface for a fixed duration, then sends a burst of datagrams to a
+ * port nobody listens on. The round-trip rate measures the per-packet
+ * overhead of the instrumentation: run a build with NET_STATS_SUPPORT
+ * enabled against a build with the option disabled.
+ *
+ * When the statistics are available, the snapshot taken at the end of the
+ * run is displayed. The UDP drop counters must account for the burst sent
+ * to the closed port
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "core/net_stats.h"
+#include "drivers/loopback/loopback_driver.h"
+#include "debug.h"
+
+//Duration of the run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//UDP port used by the benchmark
+#ifndef BENCH_PORT
+   #define BENCH_PORT 5000
+#endif
+
+//UDP port nobody listens on
+#ifndef BENCH_CLOSED_PORT
+   #define BENCH_CLOSED_PORT 5001
+#endif
+
+//Number of datagrams sent to the closed port
+#ifndef BENCH_DROP_COUNT
+   #define BENCH_DROP_COUNT 100
+#endif
+
+//Size of the datagrams
+#ifndef BENCH_DATAGRAM_SIZE
+   #define BENCH_DATAGRAM_SIZE 64
+#endif
+
+
+#if (NET_STATS_SUPPORT == ENABLED)
+
+/**
+ * @brief Display a latency histogram
+ * @param[in] name Name of the histogram
+ * @param[in] histogram Pointer to the histogram
+ **/
+
+void benchDumpHistogram(const char_t *name, const NetStatsHistogram *histogram)
+{
+   uint_t i;
+
+   //Display the summary
+   printf("%s: %" PRIu32 " samples, max %" PRIu32 "\r\n", name,
+      histogram->count, histogram->max);
+
+   //Display the non-empty buckets
+   for(i = 0; i < NET_STATS_HISTOGRAM_SIZE; i++)
+   {
+      if(histogram->bucket[i] != 0)
+      {
+         printf("  [%" PRIu32 ", %" PRIu32 "): %" PRIu32 "\r\n",
+            (i == 0) ? 0 : (uint32_t) 1 << (i - 1), (uint32_t) 1 << i,
+            histogram->bucket[i]);
+      }
+   }
+}
+
+
+/**
+ * @brief Display a snapshot of the stack-wide statistics
+ **/
+
+void benchDumpStats(void)
+{
+   uint_t i;
+   uint_t j;
+   static NetStats stats;
+   static const char_t *const layerNames[NET_STATS_LAYER_COUNT] =
+   {
+      "NIC", "IPv4", "IPv6", "UDP", "TCP"
+   };
+
+   //Take a consistent copy of the statistics
+   netStatsGetSnapshot(&stats);
+
+   //Per-layer counters
+   for(i = 0; i < NET_STATS_LAYER_COUNT; i++)
+   {
+      printf("%-4s rx %" PRIu32 " pkts, tx %" PRIu32 " pkts, drops",
+         layerNames[i], stats.layer[i].rxPackets, stats.layer[i].txPackets);
+
+      //Inbound drops, by reason
+      for(j = 0; j < NET_STATS_DROP_REASON_COUNT; j++)
+      {
+         if(stats.layer[i].rxDrops[j] != 0)
+         {
+            printf(" rx[%u]=%" PRIu32, j, stats.layer[i].rxDrops[j]);
+         }
+      }
+
+      //Outbound drops, by reason
+      for(j = 0; j < NET_STATS_DROP_REASON_COUNT; j++)
+      {
+         if(stats.layer[i].txDrops[j] != 0)
+         {
+            printf(" tx[%u]=%" PRIu32, j, stats.layer[i].txDrops[j]);
+         }
+      }
+
+      printf("\r\n");
+   }
+
+   //Latency histograms
+   benchDumpHistogram("RX to socket", &stats.rxLatency);
+   benchDumpHistogram("Send to NIC", &stats.txLatency);
+   benchDumpHistogram("netTask iteration", &stats.taskLatency);
+
+   //Check the drop accounting
+   printf("Port unreachable drops: %" PRIu32 " (expected %u)\r\n",
+      stats.layer[NET_STATS_LAYER_UDP].rxDrops[NET_STATS_DROP_PORT_UNREACHABLE],
+      BENCH_DROP_COUNT);
+}
+
+#endif
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint32_t roundTrips;
+   systime_t startTime;
+   IpAddr ipAddr;
+   Socket *socket;
+   NetInterface *interface;
+   uint8_t buffer[BENCH_DATAGRAM_SIZE];
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure the first interface as a loopback interface
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &loopbackDriver);
+
+   //Initialize the network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Assign the loopback address
+   ipv4SetHostAddr(interface, IPV4_ADDR(127, 0, 0, 1));
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+
+   //Loopback address
+   ipAddr.length = sizeof(Ipv4Addr);
+   ipAddr.ipv4Addr = IPV4_ADDR(127, 0, 0, 1);
+
+   //Open a UDP socket
+   socket = socketOpen(SOCKET_TYPE_DGRAM, SOCKET_IP_PROTO_UDP);
+   //Failed to open socket?
+   if(socket == NULL)
+      return EXIT_FAILURE;
+
+   //Bind the socket to the benchmark port
+   socketBind(socket, &IP_ADDR_ANY, BENCH_PORT);
+   //Do not block forever if a datagram is lost
+   socketSetTimeout(socket, 1000);
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Discard the packets exchanged during initialization
+   netStatsReset();
+#endif
+
+   //Fill the payload
+   osMemset(buffer, 0x55, sizeof(buffer));
+
+   //Start of the run
+   startTime = osGetSystemTime();
+
+   //Bounce datagrams off the socket itself
+   for(roundTrips = 0; timeCompare(osGetSystemTime(),
+      startTime + BENCH_DURATION) < 0; )
+   {
+      //Send a datagram to the socket itself
+      error = socketSendTo(socket, &ipAddr, BENCH_PORT, buffer,
+         sizeof(buffer), NULL, 0);
+
+      //Check status code
+      if(!error)
+      {
+         //Read the datagram back
+         error = socketReceiveFrom(socket, NULL, NULL, buffer, sizeof(buffer),
+            &n, 0);
+      }
+
+      //Successful round trip?
+      if(!error)
+      {
+         roundTrips++;
+      }
+   }
+
+   //Send datagrams that the stack must drop
+   for(i = 0; i < BENCH_DROP_COUNT; i++)
+   {
+      socketSendTo(socket, &ipAddr, BENCH_CLOSED_PORT, buffer, sizeof(buffer),
+         NULL, 0);
+   }
+
+   //Let the TCP/IP task process the last datagrams
+   osDelayTask(100);
+
+   //Display results
+   printf("NET_STATS_SUPPORT %s: %" PRIu32 " round trips/s\r\n",
+      (NET_STATS_SUPPORT == ENABLED) ? "enabled" : "disabled",
+      roundTrips * 1000 / BENCH_DURATION);
+
+#if (NET_STATS_SUPPORT == ENABLED)
+   //Display the statistics collected during the run
+   benchDumpStats();
+#endif
+
+   //Release the socket
+   socketClose(socket);
+
+   //Successful processing
+   return EXIT_SUCCESS;
+}
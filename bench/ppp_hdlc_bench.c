@@ -0,0 +1,375 @@
+/**
+ * @file ppp_hdlc_bench.c
+ * @brief PPP HDLC framing and FCS throughput benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The first part computes the FCS of a maximum-size frame repeatedly and
+ * reports the checksum throughput. Build it once with PPP_FAST_FCS_SUPPORT
+ * enabled and once with it disabled to compare the two implementations.
+ *
+ * The second part wires two PPP interfaces back to back through a dummy
+ * UART driver. Random IP frames are octet-stuffed into the TX queue of the
+ * first interface, moved byte by byte to the RX queue of the second one,
+ * as the UART interrupt handlers would do, and then de-stuffed. Every
+ * received frame is compared with the original. The run is repeated with
+ * the default ACCM, where all control characters are escaped, and with an
+ * empty ACCM, as negotiated by most peers. No LCP negotiation takes place,
+ * so the frames are dropped once they reach the PPP layer
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "ppp/ppp.h"
+#include "ppp/ppp_hdlc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (PPP_SUPPORT != ENABLED)
+   #error PPP_SUPPORT must be enabled
+#elif (NET_INTERFACE_COUNT < 2)
+   #error NET_INTERFACE_COUNT must be at least 2
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Size of the information field
+#ifndef BENCH_PAYLOAD_SIZE
+   #define BENCH_PAYLOAD_SIZE 1500
+#elif (BENCH_PAYLOAD_SIZE < 1 || BENCH_PAYLOAD_SIZE > PPP_MAX_MRU)
+   #error BENCH_PAYLOAD_SIZE parameter is not valid
+#endif
+
+//Number of distinct frames
+#ifndef BENCH_FRAME_COUNT
+   #define BENCH_FRAME_COUNT 16
+#endif
+
+//Size of the PPP frames, excluding flags and escape characters
+#define BENCH_FRAME_SIZE (PPP_FRAME_HEADER_SIZE + BENCH_PAYLOAD_SIZE + PPP_FCS_SIZE)
+
+
+//PPP contexts
+static PppContext pppContext[2];
+//Frames to be sent
+static NetBuffer *frames[BENCH_FRAME_COUNT];
+//Raw contents of the frames
+static uint8_t frameData[BENCH_FRAME_COUNT][BENCH_FRAME_SIZE];
+//Scratch buffer for the FCS measurement
+static uint8_t fcsData[BENCH_FRAME_SIZE];
+
+
+/**
+ * @brief UART configuration (dummy)
+ * @return Error code
+ **/
+
+error_t benchUartInit(void)
+{
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Enable UART interrupts (dummy)
+ **/
+
+void benchUartEnableIrq(void)
+{
+}
+
+
+/**
+ * @brief Disable UART interrupts (dummy)
+ **/
+
+void benchUartDisableIrq(void)
+{
+}
+
+
+/**
+ * @brief Start transmission (dummy)
+ **/
+
+void benchUartStartTx(void)
+{
+   //The TX queue is drained by the benchmark itself
+}
+
+
+/**
+ * @brief Dummy UART driver
+ **/
+
+const UartDriver benchUartDriver =
+{
+   benchUartInit,
+   benchUartEnableIrq,
+   benchUartDisableIrq,
+   benchUartStartTx
+};
+
+
+/**
+ * @brief Measure FCS throughput
+ **/
+
+void benchFcs(void)
+{
+   uint32_t count;
+   uint16_t fcs;
+   systime_t time;
+
+   //Initialize variables
+   count = 0;
+   fcs = 0;
+
+   //Start from the contents of a random frame
+   osMemcpy(fcsData, frameData[0], BENCH_FRAME_SIZE);
+
+   //Save current time
+   time = osGetSystemTime();
+
+   //Process the same frame over and over
+   while(timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+   {
+      //Chain the results so that the computation cannot be optimized out
+      fcsData[0] = (uint8_t) fcs;
+      fcs = pppCalcFcs(fcsData, BENCH_FRAME_SIZE);
+      count++;
+   }
+
+   //Display results
+   printf("FCS: %" PRIu32 " KB/s (PPP_FAST_FCS_SUPPORT %s)\r\n",
+      (uint32_t) ((uint64_t) count * BENCH_FRAME_SIZE / BENCH_DURATION),
+      (PPP_FAST_FCS_SUPPORT == ENABLED) ? "enabled" : "disabled");
+}
+
+
+/**
+ * @brief Measure framing throughput for a given ACCM
+ * @param[in] accm Async-Control-Character-Map
+ * @return Error code
+ **/
+
+error_t benchFraming(uint32_t accm)
+{
+   error_t error;
+   uint_t i;
+   int_t c;
+   uint32_t count;
+   uint32_t wireBytes;
+   systime_t time;
+   NetInterface *tx;
+   NetInterface *rx;
+
+   //Initialize variables
+   error = NO_ERROR;
+   count = 0;
+   wireBytes = 0;
+
+   //The first interface transmits, the second one receives
+   tx = &netInterface[0];
+   rx = &netInterface[1];
+
+   //Keep the network task away from the PPP contexts
+   osAcquireMutex(&netMutex);
+
+   //Select the ACCM under test
+   tx->pppContext->peerConfig.accm = accm;
+   rx->pppContext->localConfig.accm = accm;
+
+   //Save current time
+   time = osGetSystemTime();
+
+   //Run for a fixed duration
+   while(!error && timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+   {
+      //Select the next frame
+      i = count % BENCH_FRAME_COUNT;
+
+      //Perform octet stuffing
+      pppHdlcDriverSendPacket(tx, frames[i], 0, NULL);
+
+      //Move the characters from one queue to the other
+      while(1)
+      {
+         //Read a character from the TX queue
+         pppHdlcDriverReadTxQueue(tx, &c);
+
+         //The TX queue is empty?
+         if(c == EOF)
+            break;
+
+         //Write the character to the RX queue
+         pppHdlcDriverWriteRxQueue(rx, (uint8_t) c);
+         wireBytes++;
+      }
+
+      //The opening flag delimits an empty frame that is silently discarded
+      while(rx->pppContext->rxFrameCount > 0)
+      {
+         //Reverse the octet stuffing procedure
+         pppHdlcDriverReceivePacket(rx);
+         rx->pppContext->rxFrameCount--;
+      }
+
+      //The last frame is still available in the receive buffer
+      if(osMemcmp(rx->pppContext->frame, frameData[i], BENCH_FRAME_SIZE) ||
+         pppCalcFcs(rx->pppContext->frame, BENCH_FRAME_SIZE) != 0x0F47)
+      {
+         error = ERROR_FAILURE;
+      }
+
+      //Next frame
+      count++;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Display results
+   printf("ACCM 0x%08" PRIX32 ": %" PRIu32 " frames/s, %" PRIu32 " KB/s, "
+      "%" PRIu32 " wire bytes per frame%s\r\n", accm,
+      count * 1000 / BENCH_DURATION,
+      (uint32_t) ((uint64_t) count * BENCH_FRAME_SIZE / BENCH_DURATION),
+      (count > 0) ? wireBytes / count : 0,
+      error ? " (corrupted frame)" : "");
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t i;
+   uint_t j;
+   uint16_t fcs;
+   PppSettings pppSettings;
+   NetInterface *interface;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure two PPP interfaces
+   for(i = 0; i < 2; i++)
+   {
+      //Point to the current interface
+      interface = &netInterface[i];
+      //Set interface name
+      netSetInterfaceName(interface, (i == 0) ? "ppp0" : "ppp1");
+
+      //Get default PPP settings
+      pppGetDefaultSettings(&pppSettings);
+      //Select the underlying interface
+      pppSettings.interface = interface;
+
+      //Initialize PPP
+      error = pppInit(&pppContext[i], &pppSettings);
+      //Any error to report?
+      if(error)
+         return EXIT_FAILURE;
+
+      //Select the dummy UART driver
+      netSetUartDriver(interface, &benchUartDriver);
+
+      //Initialize the network interface
+      error = netConfigInterface(interface);
+      //Any error to report?
+      if(error)
+         return EXIT_FAILURE;
+   }
+
+   //Generate random IP frames
+   for(i = 0; i < BENCH_FRAME_COUNT; i++)
+   {
+      //Format PPP header
+      frameData[i][0] = PPP_ADDR_FIELD;
+      frameData[i][1] = PPP_CTRL_FIELD;
+      frameData[i][2] = MSB(PPP_PROTOCOL_IP);
+      frameData[i][3] = LSB(PPP_PROTOCOL_IP);
+
+      //Random information field
+      for(j = 0; j < BENCH_PAYLOAD_SIZE; j++)
+      {
+         frameData[i][PPP_FRAME_HEADER_SIZE + j] = (uint8_t) rand();
+      }
+
+      //The FCS is transmitted least significant octet first
+      fcs = pppCalcFcs(frameData[i], BENCH_FRAME_SIZE - PPP_FCS_SIZE);
+      frameData[i][BENCH_FRAME_SIZE - 2] = LSB(fcs);
+      frameData[i][BENCH_FRAME_SIZE - 1] = MSB(fcs);
+
+      //Allocate a buffer to hold the frame
+      frames[i] = netBufferAlloc(BENCH_FRAME_SIZE);
+      //Failed to allocate buffer?
+      if(frames[i] == NULL)
+         return EXIT_FAILURE;
+
+      //Copy the frame
+      netBufferWrite(frames[i], 0, frameData[i], BENCH_FRAME_SIZE);
+   }
+
+   //Measure FCS throughput
+   benchFcs();
+
+   //Default ACCM, then no control character escaped
+   error = benchFraming(PPP_DEFAULT_ACCM);
+
+   //Check status code
+   if(!error)
+   {
+      error = benchFraming(0x00000000);
+   }
+
+   //Release frames
+   for(i = 0; i < BENCH_FRAME_COUNT; i++)
+   {
+      netBufferFree(frames[i]);
+   }
+
+   //Return status code
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
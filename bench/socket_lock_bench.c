@@ -0,0 +1,269 @@
+/**
+ * @file socket_lock_bench.c
+ * @brief Multi-task UDP contention benchmark over the loopback interface
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * Each worker task owns a UDP socket bound to its own port on the loopback
+ * interface. It sends a datagram to itself, then reads it back, and does
+ * so repeatedly for a fixed duration. The aggregate number of round trips
+ * is reported at the end of the run.
+ *
+ * Build the benchmark against a hosted port of the stack (e.g. the POSIX
+ * port) twice, once with SOCKET_LOCK_SUPPORT enabled and once with it
+ * disabled, and compare the results for 1, 2, 4 and 8 workers on a
+ * multi-core host. Only the application side of the receive path runs
+ * outside netMutex, so the send path still bounds the scalability
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "drivers/loopback/loopback_driver.h"
+#include "debug.h"
+
+//Maximum number of worker tasks
+#ifndef BENCH_MAX_WORKERS
+   #define BENCH_MAX_WORKERS 8
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//First UDP port used by the workers
+#ifndef BENCH_BASE_PORT
+   #define BENCH_BASE_PORT 5000
+#endif
+
+//Size of the datagrams
+#ifndef BENCH_DATAGRAM_SIZE
+   #define BENCH_DATAGRAM_SIZE 64
+#endif
+
+
+/**
+ * @brief Worker task context
+ **/
+
+typedef struct
+{
+   uint_t index;
+   volatile bool_t running;
+   volatile bool_t done;
+   uint32_t roundTrips;
+   uint32_t errors;
+} BenchWorker;
+
+
+//Worker contexts
+static BenchWorker workers[BENCH_MAX_WORKERS];
+
+
+/**
+ * @brief Worker task
+ * @param[in] worker Pointer to the worker context
+ **/
+
+void benchWorkerTask(BenchWorker *worker)
+{
+   error_t error;
+   size_t n;
+   uint16_t port;
+   IpAddr ipAddr;
+   Socket *socket;
+   uint8_t buffer[BENCH_DATAGRAM_SIZE];
+
+   //Each worker uses its own port number
+   port = BENCH_BASE_PORT + worker->index;
+
+   //Loopback address
+   ipAddr.length = sizeof(Ipv4Addr);
+   ipAddr.ipv4Addr = IPV4_ADDR(127, 0, 0, 1);
+
+   //Open a UDP socket
+   socket = socketOpen(SOCKET_TYPE_DGRAM, SOCKET_IP_PROTO_UDP);
+
+   //Successful socket creation?
+   if(socket != NULL)
+   {
+      //Bind the socket to the worker port
+      socketBind(socket, &IP_ADDR_ANY, port);
+      //Do not block forever if a datagram is lost
+      socketSetTimeout(socket, 1000);
+
+      //Fill the payload
+      osMemset(buffer, worker->index, sizeof(buffer));
+
+      //Run until the main task stops the benchmark
+      while(worker->running)
+      {
+         //Send a datagram to the worker itself
+         error = socketSendTo(socket, &ipAddr, port, buffer, sizeof(buffer),
+            NULL, 0);
+
+         //Check status code
+         if(!error)
+         {
+            //Read the datagram back
+            error = socketReceiveFrom(socket, NULL, NULL, buffer,
+               sizeof(buffer), &n, 0);
+         }
+
+         //Update statistics
+         if(!error)
+         {
+            worker->roundTrips++;
+         }
+         else
+         {
+            worker->errors++;
+         }
+      }
+
+      //Release the socket
+      socketClose(socket);
+   }
+
+   //The worker has completed
+   worker->done = TRUE;
+
+   //Kill ourselves
+   osDeleteTask(OS_SELF_TASK_ID);
+}
+
+
+/**
+ * @brief Run the benchmark with a given number of workers
+ * @param[in] count Number of worker tasks
+ **/
+
+void benchRun(uint_t count)
+{
+   uint_t i;
+   uint32_t roundTrips;
+   uint32_t errors;
+   OsTaskId taskId;
+
+   //Start the worker tasks
+   for(i = 0; i < count; i++)
+   {
+      //Initialize worker context
+      osMemset(&workers[i], 0, sizeof(BenchWorker));
+      workers[i].index = i;
+      workers[i].running = TRUE;
+
+      //Create a task
+      taskId = osCreateTask("Bench", (OsTaskCode) benchWorkerTask,
+         &workers[i], 1024, OS_TASK_PRIORITY_NORMAL);
+
+      //Failed to create task?
+      if(taskId == OS_INVALID_TASK_ID)
+      {
+         workers[i].done = TRUE;
+      }
+   }
+
+   //Let the workers run
+   osDelayTask(BENCH_DURATION);
+
+   //Stop the workers
+   for(i = 0; i < count; i++)
+   {
+      workers[i].running = FALSE;
+   }
+
+   //Wait for the workers to complete
+   for(i = 0; i < count; i++)
+   {
+      while(!workers[i].done)
+      {
+         osDelayTask(10);
+      }
+   }
+
+   //Aggregate statistics
+   for(roundTrips = 0, errors = 0, i = 0; i < count; i++)
+   {
+      roundTrips += workers[i].roundTrips;
+      errors += workers[i].errors;
+   }
+
+   //Display results
+   printf("%u worker(s): %" PRIu32 " round trips/s (%" PRIu32 " errors)\r\n",
+      count, roundTrips * 1000 / BENCH_DURATION, errors);
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t count;
+   NetInterface *interface;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure the first interface as a loopback interface
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &loopbackDriver);
+
+   //Initialize the network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Assign the loopback address
+   ipv4SetHostAddr(interface, IPV4_ADDR(127, 0, 0, 1));
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+
+   //Display the locking scheme under test
+   printf("SOCKET_LOCK_SUPPORT %s\r\n",
+      (SOCKET_LOCK_SUPPORT == ENABLED) ? "enabled" : "disabled");
+
+   //Double the number of workers at each run
+   for(count = 1; count <= BENCH_MAX_WORKERS; count *= 2)
+   {
+      benchRun(count);
+   }
+
+   //Successful processing
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file tcp_conn_table_bench.c
+ * @brief TCP-MIB tcpConnectionTable walk benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * BENCH_SOCKET_COUNT TCP sockets are opened and bound to distinct local
+ * ports, so that each of them shows up as a row of the tcpConnectionTable.
+ * The table is then walked column after column by calling the getNext and
+ * getValue callbacks of the TCP-MIB, in the same order as a manager issuing
+ * GetNext requests would. The network mutex is held for the duration of a
+ * walk, as the SNMP agent does while processing a PDU.
+ *
+ * Build the benchmark once with MIB_TABLE_SNAPSHOT_SUPPORT enabled and once
+ * with it disabled. Without snapshots, every getNext call scans the whole
+ * socket table and the cost of a walk grows with the square of the number
+ * of rows
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "core/socket.h"
+#include "mibs/mib_common.h"
+#include "mibs/tcp_mib_module.h"
+#include "mibs/tcp_mib_impl.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (TCP_MIB_SUPPORT != ENABLED)
+   #error TCP_MIB_SUPPORT must be enabled
+#elif (TCP_SUPPORT != ENABLED)
+   #error TCP_SUPPORT must be enabled
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Number of rows in the tcpConnectionTable
+#ifndef BENCH_SOCKET_COUNT
+   #define BENCH_SOCKET_COUNT 256
+#elif (BENCH_SOCKET_COUNT < 1)
+   #error BENCH_SOCKET_COUNT parameter is not valid
+#endif
+
+//Check TCP/IP stack configuration
+#if (SOCKET_MAX_COUNT < BENCH_SOCKET_COUNT)
+   #error SOCKET_MAX_COUNT must be at least BENCH_SOCKET_COUNT
+#endif
+
+//First local port
+#define BENCH_FIRST_PORT 10000
+//Size of the OID buffers
+#define BENCH_OID_SIZE 64
+
+
+//Sockets populating the tcpConnectionTable
+static Socket *sockets[BENCH_SOCKET_COUNT];
+
+
+/**
+ * @brief Walk a column of the tcpConnectionTable
+ * @param[in] object Pointer to the MIB object descriptor
+ * @param[out] numRows Number of instances found
+ * @return Error code
+ **/
+
+error_t benchWalkColumn(const MibObject *object, uint_t *numRows)
+{
+   error_t error;
+   size_t oidLen;
+   size_t nextOidLen;
+   size_t valueLen;
+   uint8_t oid[BENCH_OID_SIZE];
+   uint8_t nextOid[BENCH_OID_SIZE];
+   uint32_t value[8];
+
+   //The first request names the column itself
+   osMemcpy(oid, object->oid, object->oidLen);
+   oidLen = object->oidLen;
+
+   //Number of instances found so far
+   *numRows = 0;
+
+   //Retrieve the instances one by one
+   while(1)
+   {
+      //Get the instance that follows the specified OID
+      nextOidLen = sizeof(nextOid);
+      error = object->getNext(object, oid, oidLen, nextOid, &nextOidLen);
+
+      //End of the column?
+      if(error == ERROR_OBJECT_NOT_FOUND)
+      {
+         error = NO_ERROR;
+         break;
+      }
+
+      //Any error to report?
+      if(error)
+         break;
+
+      //Retrieve the value of the instance
+      valueLen = sizeof(value);
+      error = object->getValue(object, nextOid, nextOidLen,
+         (MibVariant *) value, &valueLen);
+
+      //Any error to report?
+      if(error)
+         break;
+
+      //The next request names the instance returned last
+      osMemcpy(oid, nextOid, nextOidLen);
+      oidLen = nextOidLen;
+
+      //Update the number of instances
+      (*numRows)++;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Measure walk rate
+ * @return Error code
+ **/
+
+error_t benchWalk(void)
+{
+   error_t error;
+   uint_t i;
+   uint_t numRows;
+   uint_t numColumns;
+   uint32_t count;
+   uint32_t instances;
+   systime_t time;
+   const MibObject *object;
+
+   //Initialize variables
+   error = NO_ERROR;
+   count = 0;
+   instances = 0;
+   numColumns = 0;
+
+   //Save current time
+   time = osGetSystemTime();
+
+   //Run for a fixed duration
+   while(!error && timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+   {
+      //The agent holds the network mutex while processing a PDU
+      osAcquireMutex(&netMutex);
+
+      //Initialize the number of columns
+      numColumns = 0;
+
+      //Loop through the objects of the TCP-MIB
+      for(i = 0; i < tcpMibModule.numObjects && !error; i++)
+      {
+         //Point to the current object
+         object = &tcpMibModule.objects[i];
+
+         //Column of the tcpConnectionTable?
+         if(object->getNext == tcpMibGetNextTcpConnectionEntry)
+         {
+            //Walk the column
+            error = benchWalkColumn(object, &numRows);
+
+            //Every socket must be reported
+            if(!error && numRows != BENCH_SOCKET_COUNT)
+            {
+               error = ERROR_FAILURE;
+            }
+
+            //Update statistics
+            instances += numRows;
+            numColumns++;
+         }
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+
+      //Next walk
+      count++;
+   }
+
+   //Display results
+   printf("%u rows, %u columns: %" PRIu32 " walks/s, %" PRIu32 " ns per "
+      "instance (MIB_TABLE_SNAPSHOT_SUPPORT %s)%s\r\n", BENCH_SOCKET_COUNT,
+      numColumns, count * 1000 / BENCH_DURATION,
+      (instances > 0) ? (uint32_t) ((uint64_t) BENCH_DURATION * 1000000 / instances) : 0,
+      (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED) ? "enabled" : "disabled",
+      error ? " (walk failed)" : "");
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   uint_t i;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Initialize the TCP-MIB base
+   error = tcpMibInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Populate the tcpConnectionTable
+   for(i = 0; i < BENCH_SOCKET_COUNT && !error; i++)
+   {
+      //Open a TCP socket
+      sockets[i] = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
+
+      //Failed to open socket?
+      if(sockets[i] == NULL)
+      {
+         error = ERROR_OPEN_FAILED;
+      }
+      else
+      {
+         //Each socket is identified by its local port
+         error = socketBind(sockets[i], &IP_ADDR_ANY, BENCH_FIRST_PORT + i);
+      }
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Measure walk rate
+      error = benchWalk();
+   }
+
+   //Close sockets
+   for(i = 0; i < BENCH_SOCKET_COUNT; i++)
+   {
+      //Valid socket?
+      if(sockets[i] != NULL)
+      {
+         socketClose(sockets[i]);
+      }
+   }
+
+   //Return status code
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,614 @@
+/**
+ * @file tftp_bench.c
+ * @brief TFTP transfer time benchmark over a high-latency loopback link
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The TFTP server and client run in the same process. They are attached to
+ * a loopback interface whose driver holds every packet for
+ * BENCH_ONE_WAY_DELAY before delivering it, which emulates a high-latency
+ * link. The client downloads a generated file of BENCH_FILE_SIZE bytes,
+ * checks its contents and reports the transfer time.
+ *
+ * Build the benchmark once with TFTP_SERVER_OPTION_SUPPORT and
+ * TFTP_CLIENT_OPTION_SUPPORT enabled, and once with both disabled, to
+ * compare windowed transfers with large blocks against the lock-step
+ * exchange of 512-byte blocks
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "tftp/tftp_server.h"
+#include "tftp/tftp_client.h"
+#include "debug.h"
+
+//Size of the transferred file
+#ifndef BENCH_FILE_SIZE
+   #define BENCH_FILE_SIZE 2097152
+#endif
+
+//Latency injected in each direction, in ms
+#ifndef BENCH_ONE_WAY_DELAY
+   #define BENCH_ONE_WAY_DELAY 10
+#endif
+
+//Number of packets the delay line can hold
+#ifndef BENCH_QUEUE_SIZE
+   #define BENCH_QUEUE_SIZE 64
+#endif
+
+//Size of the buffer used by the client to read the file
+#define BENCH_READ_SIZE 4096
+
+
+/**
+ * @brief Delay line queue entry
+ **/
+
+typedef struct
+{
+   systime_t deliveryTime;
+   size_t length;
+   uint8_t data[ETH_MTU];
+} BenchQueueEntry;
+
+
+//Delay line queue
+static BenchQueueEntry queue[BENCH_QUEUE_SIZE];
+static volatile uint_t queueLength;
+static uint_t queueTxIndex;
+static uint_t queueRxIndex;
+
+//TFTP server context
+static TftpServerContext tftpServerContext;
+//TFTP client context
+static TftpClientContext tftpClientContext;
+//Dummy file handle
+static uint_t benchFile;
+
+
+//Delay line driver related functions
+error_t benchDriverInit(NetInterface *interface);
+void benchDriverTick(NetInterface *interface);
+void benchDriverEnableIrq(NetInterface *interface);
+void benchDriverDisableIrq(NetInterface *interface);
+void benchDriverEventHandler(NetInterface *interface);
+
+error_t benchDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t benchDriverUpdateMacAddrFilter(NetInterface *interface);
+
+
+/**
+ * @brief Delay line driver
+ **/
+
+const NicDriver benchDriver =
+{
+   NIC_TYPE_LOOPBACK,
+   ETH_MTU,
+   benchDriverInit,
+   benchDriverTick,
+   benchDriverEnableIrq,
+   benchDriverDisableIrq,
+   benchDriverEventHandler,
+   benchDriverSendPacket,
+   benchDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   FALSE,
+   FALSE,
+   FALSE,
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
+};
+
+
+/**
+ * @brief Delay line initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t benchDriverInit(NetInterface *interface)
+{
+   //Initialize variables
+   queueLength = 0;
+   queueTxIndex = 0;
+   queueRxIndex = 0;
+
+   //Force the TCP/IP stack to poll the link state at startup
+   interface->nicEvent = TRUE;
+   osSetEvent(&netEvent);
+
+   //The interface is now ready to send
+   osSetEvent(&interface->nicTxEvent);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Delay line timer handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void benchDriverTick(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void benchDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void benchDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Delay line event handler
+ *
+ * Only the packets whose delivery time has elapsed are passed to the
+ * upper layer
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void benchDriverEventHandler(NetInterface *interface)
+{
+   systime_t time;
+   NetRxAncillary ancillary;
+
+   //Link up event is pending?
+   if(!interface->linkState)
+   {
+      //Link is up
+      interface->linkState = TRUE;
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Deliver the packets that have spent enough time in the queue
+   while(queueLength > 0 &&
+      timeCompare(time, queue[queueRxIndex].deliveryTime) >= 0)
+   {
+      //Additional options can be passed to the stack along with the packet
+      ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+      //Pass the packet to the upper layer
+      nicProcessPacket(interface, queue[queueRxIndex].data,
+         queue[queueRxIndex].length, &ancillary);
+
+      //Increment index and wrap around if necessary
+      if(++queueRxIndex >= BENCH_QUEUE_SIZE)
+      {
+         queueRxIndex = 0;
+      }
+
+      //Update the length of the queue
+      queueLength--;
+   }
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t benchDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   error_t error;
+   size_t length;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Valid packet length?
+   if(length <= ETH_MTU)
+   {
+      //The packet is dropped when the queue is full, as a congested link
+      //would do
+      if(queueLength < BENCH_QUEUE_SIZE)
+      {
+         //Copy data to the queue
+         netBufferRead(queue[queueTxIndex].data, buffer, offset, length);
+         queue[queueTxIndex].length = length;
+
+         //Save the time at which the packet is to be delivered
+         queue[queueTxIndex].deliveryTime = osGetSystemTime() +
+            BENCH_ONE_WAY_DELAY;
+
+         //Increment index and wrap around if necessary
+         if(++queueTxIndex >= BENCH_QUEUE_SIZE)
+         {
+            queueTxIndex = 0;
+         }
+
+         //Update the length of the queue
+         queueLength++;
+      }
+   }
+   else
+   {
+      //Report an error
+      error = ERROR_INVALID_LENGTH;
+   }
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t benchDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //Not implemented
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Delay line task
+ *
+ * The task plays the role of a timer interrupt: it regularly notifies the
+ * TCP/IP stack while packets are waiting in the queue
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void benchDriverTask(NetInterface *interface)
+{
+   //Endless loop
+   while(1)
+   {
+      //Any packet waiting for delivery?
+      if(queueLength > 0)
+      {
+         //Set event flag
+         interface->nicEvent = TRUE;
+         //Notify the TCP/IP stack of the event
+         osSetEvent(&netEvent);
+      }
+
+      //Wait for the next time slot
+      osDelayTask(1);
+   }
+}
+
+
+/**
+ * @brief Open file callback
+ * @param[in] filename NULL-terminated string specifying the filename
+ * @param[in] mode File access mode
+ * @param[in] writeAccess Specifies whether the file is opened for writing
+ * @return File handle
+ **/
+
+void *benchOpenFileCallback(const char_t *filename, const char_t *mode,
+   bool_t writeAccess)
+{
+   //The generated file can only be read
+   if(writeAccess)
+      return NULL;
+
+   //Return a dummy file handle
+   return &benchFile;
+}
+
+
+/**
+ * @brief Read file callback
+ * @param[in] file File handle
+ * @param[in] offset Offset from the beginning of the file
+ * @param[out] data Buffer where to store the data
+ * @param[in] size Size of the buffer, in bytes
+ * @param[out] length Number of data bytes that have been read
+ * @return Error code
+ **/
+
+error_t benchReadFileCallback(void *file, size_t offset, uint8_t *data,
+   size_t size, size_t *length)
+{
+   size_t i;
+
+   //Do not read beyond the end of the file
+   if(offset < BENCH_FILE_SIZE)
+   {
+      *length = MIN(size, BENCH_FILE_SIZE - offset);
+   }
+   else
+   {
+      *length = 0;
+   }
+
+   //Each byte is derived from its position in the file
+   for(i = 0; i < *length; i++)
+   {
+      data[i] = (uint8_t) ((offset + i) * 7);
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Close file callback
+ * @param[in] file File handle
+ **/
+
+void benchCloseFileCallback(void *file)
+{
+   //Nothing to do
+}
+
+
+/**
+ * @brief Get file size callback
+ * @param[in] file File handle
+ * @param[out] size Size of the file, in bytes
+ * @return Error code
+ **/
+
+error_t benchGetFileSizeCallback(void *file, size_t *size)
+{
+   //Return the size of the generated file
+   *size = BENCH_FILE_SIZE;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Download the file and check its contents
+ * @param[in] interface Underlying network interface
+ * @param[out] total Number of bytes received
+ * @return Error code
+ **/
+
+error_t benchDownload(NetInterface *interface, size_t *total)
+{
+   error_t error;
+   size_t i;
+   size_t n;
+   IpAddr ipAddr;
+   static uint8_t buffer[BENCH_READ_SIZE];
+
+   //Nothing received yet
+   *total = 0;
+
+   //Loopback address
+   ipAddr.length = sizeof(Ipv4Addr);
+   ipAddr.ipv4Addr = IPV4_ADDR(127, 0, 0, 1);
+
+   //Initialize TFTP client context
+   error = tftpClientInit(&tftpClientContext);
+
+   //Check status code
+   if(!error)
+   {
+      //Select the underlying interface
+      error = tftpClientBindToInterface(&tftpClientContext, interface);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Specify the address of the TFTP server
+      error = tftpClientConnect(&tftpClientContext, &ipAddr, TFTP_PORT);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Open the file for reading
+      error = tftpClientOpenFile(&tftpClientContext, "bench.bin",
+         TFTP_FILE_MODE_READ | TFTP_FILE_MODE_OCTET);
+   }
+
+   //Read the whole file
+   while(!error)
+   {
+      //Read data
+      error = tftpClientReadFile(&tftpClientContext, buffer, sizeof(buffer),
+         &n, 0);
+
+      //Check status code
+      if(!error)
+      {
+         //Check the contents of the file
+         for(i = 0; i < n && !error; i++)
+         {
+            if(buffer[i] != (uint8_t) ((*total + i) * 7))
+            {
+               error = ERROR_FAILURE;
+            }
+         }
+
+         //Update the number of bytes received
+         *total += n;
+      }
+   }
+
+   //The end of the file has been reached?
+   if(error == ERROR_END_OF_STREAM)
+   {
+      //Make sure the whole file has been received
+      error = (*total == BENCH_FILE_SIZE) ? NO_ERROR : ERROR_INVALID_LENGTH;
+   }
+
+   //Close the file
+   tftpClientCloseFile(&tftpClientContext);
+   //Release TFTP client context
+   tftpClientDeinit(&tftpClientContext);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   size_t total;
+   systime_t time;
+   OsTaskId taskId;
+   NetInterface *interface;
+   TftpServerSettings tftpServerSettings;
+
+   //Initialize the TCP/IP stack
+   error = netInit();
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Configure the first interface as a delay line
+   interface = &netInterface[0];
+   netSetInterfaceName(interface, "lo");
+   netSetDriver(interface, &benchDriver);
+
+   //Initialize the network interface
+   error = netConfigInterface(interface);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Assign the loopback address
+   ipv4SetHostAddr(interface, IPV4_ADDR(127, 0, 0, 1));
+   ipv4SetSubnetMask(interface, IPV4_ADDR(255, 0, 0, 0));
+
+   //Create the task that releases delayed packets
+   taskId = osCreateTask("Delay", (OsTaskCode) benchDriverTask, interface,
+      256, OS_TASK_PRIORITY_HIGH);
+   //Failed to create the task?
+   if(taskId == OS_INVALID_TASK_ID)
+      return EXIT_FAILURE;
+
+   //Get default settings
+   tftpServerGetDefaultSettings(&tftpServerSettings);
+   //Bind the server to the delay line
+   tftpServerSettings.interface = interface;
+   //Serve the generated file
+   tftpServerSettings.openFileCallback = benchOpenFileCallback;
+   tftpServerSettings.readFileCallback = benchReadFileCallback;
+   tftpServerSettings.closeFileCallback = benchCloseFileCallback;
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   tftpServerSettings.getFileSizeCallback = benchGetFileSizeCallback;
+#endif
+
+   //TFTP server initialization
+   error = tftpServerInit(&tftpServerContext, &tftpServerSettings);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Start TFTP server
+   error = tftpServerStart(&tftpServerContext);
+   //Any error to report?
+   if(error)
+      return EXIT_FAILURE;
+
+   //Display the configuration under test
+   printf("Option negotiation %s, %u ms round-trip time, %u bytes\r\n",
+      (TFTP_CLIENT_OPTION_SUPPORT == ENABLED &&
+      TFTP_SERVER_OPTION_SUPPORT == ENABLED) ? "enabled" : "disabled",
+      2 * BENCH_ONE_WAY_DELAY, BENCH_FILE_SIZE);
+
+   //Start of the transfer
+   time = osGetSystemTime();
+   //Download the file
+   error = benchDownload(interface, &total);
+   //Duration of the transfer
+   time = osGetSystemTime() - time;
+
+   //Display results
+   if(!error)
+   {
+      printf("Transfer completed in %" PRIu32 " ms (%" PRIu32 " kB/s)\r\n",
+         (uint32_t) time, (uint32_t) (total / MAX(time, 1)));
+   }
+   else
+   {
+      printf("Transfer failed after %" PRIuSIZE " bytes (error %u)\r\n",
+         total, error);
+   }
+
+   //Return status code
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
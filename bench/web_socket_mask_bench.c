@@ -0,0 +1,288 @@
+/**
+ * @file web_socket_mask_bench.c
+ * @brief WebSocket masking and UTF-8 validation throughput benchmark
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The first part masks a payload of BENCH_PAYLOAD_SIZE bytes over and over,
+ * both with webSocketApplyMask and with a plain byte-at-a-time loop, and
+ * reports the throughput of each. The run is repeated with a payload that
+ * does not start on a word boundary. The payload is then masked in chunks
+ * of irregular size, as it happens when a frame spans several reads, and
+ * the result is compared with the reference loop.
+ *
+ * The second part validates text payloads with webSocketCheckUtf8Stream.
+ * A pure ASCII text exercises the word-at-a-time scan while a text mixing
+ * 2, 3 and 4-byte sequences exercises the UTF-8 decoder
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Dependencies
+#include <stdlib.h>
+#include <stdio.h>
+#include "core/net.h"
+#include "web_socket/web_socket.h"
+#include "web_socket/web_socket_misc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (WEB_SOCKET_SUPPORT != ENABLED)
+   #error WEB_SOCKET_SUPPORT must be enabled
+#endif
+
+//Duration of each run
+#ifndef BENCH_DURATION
+   #define BENCH_DURATION 5000
+#endif
+
+//Size of the payload
+#ifndef BENCH_PAYLOAD_SIZE
+   #define BENCH_PAYLOAD_SIZE WEB_SOCKET_BUFFER_SIZE
+#elif (BENCH_PAYLOAD_SIZE < 16)
+   #error BENCH_PAYLOAD_SIZE parameter is not valid
+#endif
+
+
+//Payload under test (one extra word to allow misalignment)
+static uint32_t payload[(BENCH_PAYLOAD_SIZE + 7) / 4];
+//Reference payload
+static uint8_t refPayload[BENCH_PAYLOAD_SIZE];
+//Text payload
+static uint8_t text[BENCH_PAYLOAD_SIZE];
+
+//Masking key
+static const uint8_t maskingKey[4] = {0x37, 0xFA, 0x21, 0x3D};
+
+//Sample text mixing 1, 2, 3 and 4-byte sequences
+static const char_t utf8Sample[] =
+   "Gr\xC3\xBC\xC3\x9F" "e \xE2\x82\xAC \xF0\x9F\x98\x80 "
+   "\xCE\xBA\xCE\xB1\xCE\xBB\xCE\xB7\xCE\xBC\xCE\xAD\xCF\x81\xCE\xB1 ";
+
+
+/**
+ * @brief Apply masking one byte at a time (reference implementation)
+ * @param[in,out] data Pointer to the data to be masked
+ * @param[in] length Number of bytes to process
+ * @param[in] offset Position of the first byte in the payload
+ **/
+
+void benchMaskBytewise(uint8_t *data, size_t length, size_t offset)
+{
+   size_t i;
+
+   //Convert masked data into unmasked data (and vice versa)
+   for(i = 0; i < length; i++)
+   {
+      data[i] ^= maskingKey[(offset + i) % 4];
+   }
+}
+
+
+/**
+ * @brief Measure masking throughput
+ * @param[in] misalignment Offset of the payload from a word boundary
+ **/
+
+void benchMask(uint_t misalignment)
+{
+   uint_t i;
+   uint32_t count[2];
+   systime_t time;
+   uint8_t *data;
+
+   //Point to the payload
+   data = (uint8_t *) payload + misalignment;
+
+   //Compare the two implementations
+   for(i = 0; i < 2; i++)
+   {
+      //Initialize variables
+      count[i] = 0;
+
+      //Save current time
+      time = osGetSystemTime();
+
+      //Mask the same payload over and over
+      while(timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+      {
+         //Select the implementation under test
+         if(i == 0)
+         {
+            benchMaskBytewise(data, BENCH_PAYLOAD_SIZE, 0);
+         }
+         else
+         {
+            webSocketApplyMask(data, BENCH_PAYLOAD_SIZE, maskingKey, 0);
+         }
+
+         //Next run
+         count[i]++;
+      }
+   }
+
+   //Display results
+   printf("Masking, misalignment %u: %" PRIu32 " KB/s byte-wise, "
+      "%" PRIu32 " KB/s word-wise\r\n", misalignment,
+      (uint32_t) ((uint64_t) count[0] * BENCH_PAYLOAD_SIZE / BENCH_DURATION),
+      (uint32_t) ((uint64_t) count[1] * BENCH_PAYLOAD_SIZE / BENCH_DURATION));
+}
+
+
+/**
+ * @brief Check chunked masking against the reference implementation
+ * @return Error code
+ **/
+
+error_t benchMaskChunks(void)
+{
+   size_t i;
+   size_t n;
+   uint8_t *data;
+
+   //Start from an odd address to exercise the unaligned head
+   data = (uint8_t *) payload + 1;
+
+   //Use the same random payload for both implementations
+   for(i = 0; i < BENCH_PAYLOAD_SIZE; i++)
+   {
+      data[i] = (uint8_t) rand();
+   }
+
+   //Save a copy of the payload
+   osMemcpy(refPayload, data, BENCH_PAYLOAD_SIZE);
+
+   //Mask the whole payload at once
+   benchMaskBytewise(refPayload, BENCH_PAYLOAD_SIZE, 0);
+
+   //Mask the payload in chunks of irregular size
+   for(i = 0; i < BENCH_PAYLOAD_SIZE; i += n)
+   {
+      //Chunks range from 1 to 13 bytes
+      n = MIN(1 + (rand() % 13), BENCH_PAYLOAD_SIZE - i);
+      //The offset selects the first byte of the masking key
+      webSocketApplyMask(data + i, n, maskingKey, i);
+   }
+
+   //Display results
+   printf("Chunked masking: %s\r\n",
+      osMemcmp(data, refPayload, BENCH_PAYLOAD_SIZE) ? "mismatch" : "ok");
+
+   //Return status code
+   return osMemcmp(data, refPayload, BENCH_PAYLOAD_SIZE) ? ERROR_FAILURE :
+      NO_ERROR;
+}
+
+
+/**
+ * @brief Measure UTF-8 validation throughput
+ * @param[in] name Description of the text
+ * @param[in] length Length of the text
+ * @return Error code
+ **/
+
+error_t benchUtf8(const char_t *name, size_t length)
+{
+   bool_t valid;
+   uint32_t count;
+   systime_t time;
+   WebSocketUtf8Context context;
+
+   //Initialize variables
+   valid = TRUE;
+   count = 0;
+
+   //Save current time
+   time = osGetSystemTime();
+
+   //Validate the same text over and over
+   while(valid && timeCompare(osGetSystemTime(), time + BENCH_DURATION) < 0)
+   {
+      //Reset the UTF-8 decoding context
+      osMemset(&context, 0, sizeof(WebSocketUtf8Context));
+      //The whole text is processed as a single chunk
+      valid = webSocketCheckUtf8Stream(&context, text, length, 0);
+      //Next run
+      count++;
+   }
+
+   //Display results
+   printf("UTF-8 validation, %s: %" PRIu32 " KB/s%s\r\n", name,
+      (uint32_t) ((uint64_t) count * length / BENCH_DURATION),
+      valid ? "" : " (rejected)");
+
+   //Return status code
+   return valid ? NO_ERROR : ERROR_FAILURE;
+}
+
+
+/**
+ * @brief Main entry point
+ * @return Status code
+ **/
+
+int_t main(void)
+{
+   error_t error;
+   size_t i;
+   size_t n;
+
+   //Measure masking throughput on aligned and unaligned payloads
+   benchMask(0);
+   benchMask(1);
+
+   //Check chunked masking
+   error = benchMaskChunks();
+
+   //Check status code
+   if(!error)
+   {
+      //Generate a pure ASCII text
+      for(i = 0; i < BENCH_PAYLOAD_SIZE; i++)
+      {
+         text[i] = 0x20 + (rand() % 0x5F);
+      }
+
+      //Measure UTF-8 validation throughput
+      error = benchUtf8("ASCII", BENCH_PAYLOAD_SIZE);
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Repeat the sample text, without splitting any sequence
+      for(i = 0, n = sizeof(utf8Sample) - 1; (i + n) <= BENCH_PAYLOAD_SIZE; i += n)
+      {
+         osMemcpy(text + i, utf8Sample, n);
+      }
+
+      //Measure UTF-8 validation throughput
+      error = benchUtf8("multi-byte", i);
+   }
+
+   //Return status code
+   return error ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -100,6 +100,62 @@
    #error COAP_SERVER_MAX_URI_LEN parameter is not valid
 #endif
 
+//Message deduplication support
+#ifndef COAP_SERVER_DEDUP_SUPPORT
+   #define COAP_SERVER_DEDUP_SUPPORT DISABLED
+#elif (COAP_SERVER_DEDUP_SUPPORT != ENABLED && COAP_SERVER_DEDUP_SUPPORT != DISABLED)
+   #error COAP_SERVER_DEDUP_SUPPORT parameter is not valid
+#endif
+
+//Number of entries in the deduplication cache
+#ifndef COAP_SERVER_DEDUP_CACHE_SIZE
+   #define COAP_SERVER_DEDUP_CACHE_SIZE 8
+#elif (COAP_SERVER_DEDUP_CACHE_SIZE < 1)
+   #error COAP_SERVER_DEDUP_CACHE_SIZE parameter is not valid
+#endif
+
+//EXCHANGE_LIFETIME (refer to RFC 7252, section 4.8.2)
+#ifndef COAP_SERVER_EXCHANGE_LIFETIME
+   #define COAP_SERVER_EXCHANGE_LIFETIME 247000
+#elif (COAP_SERVER_EXCHANGE_LIFETIME < 1000)
+   #error COAP_SERVER_EXCHANGE_LIFETIME parameter is not valid
+#endif
+
+//NON_LIFETIME (refer to RFC 7252, section 4.8.2)
+#ifndef COAP_SERVER_NON_LIFETIME
+   #define COAP_SERVER_NON_LIFETIME 145000
+#elif (COAP_SERVER_NON_LIFETIME < 1000)
+   #error COAP_SERVER_NON_LIFETIME parameter is not valid
+#endif
+
+//GET response cache support
+#ifndef COAP_SERVER_RESPONSE_CACHE_SUPPORT
+   #define COAP_SERVER_RESPONSE_CACHE_SUPPORT DISABLED
+#elif (COAP_SERVER_RESPONSE_CACHE_SUPPORT != ENABLED && COAP_SERVER_RESPONSE_CACHE_SUPPORT != DISABLED)
+   #error COAP_SERVER_RESPONSE_CACHE_SUPPORT parameter is not valid
+#endif
+
+//Number of entries in the GET response cache
+#ifndef COAP_SERVER_RESPONSE_CACHE_SIZE
+   #define COAP_SERVER_RESPONSE_CACHE_SIZE 4
+#elif (COAP_SERVER_RESPONSE_CACHE_SIZE < 1)
+   #error COAP_SERVER_RESPONSE_CACHE_SIZE parameter is not valid
+#endif
+
+//Maximum size of cache keys
+#ifndef COAP_SERVER_MAX_CACHE_KEY_SIZE
+   #define COAP_SERVER_MAX_CACHE_KEY_SIZE 128
+#elif (COAP_SERVER_MAX_CACHE_KEY_SIZE < 1)
+   #error COAP_SERVER_MAX_CACHE_KEY_SIZE parameter is not valid
+#endif
+
+//Maximum size of cached responses
+#ifndef COAP_SERVER_MAX_CACHED_RESPONSE_SIZE
+   #define COAP_SERVER_MAX_CACHED_RESPONSE_SIZE 256
+#elif (COAP_SERVER_MAX_CACHED_RESPONSE_SIZE < 4)
+   #error COAP_SERVER_MAX_CACHED_RESPONSE_SIZE parameter is not valid
+#endif
+
 //Priority at which the CoAP server should run
 #ifndef COAP_SERVER_PRIORITY
    #define COAP_SERVER_PRIORITY OS_TASK_PRIORITY_NORMAL
@@ -178,6 +234,41 @@ struct _CoapDtlsSession
 };
 
 
+/**
+ * @brief Deduplication cache entry
+ **/
+
+typedef struct
+{
+   bool_t valid;                                           ///<Valid entry
+   IpAddr clientIpAddr;                                    ///<Client's IP address
+   uint16_t clientPort;                                    ///<Client's port
+   uint16_t mid;                                           ///<Message ID
+   systime_t timestamp;                                    ///<Time at which the request was received
+   systime_t lifetime;                                     ///<Time during which the Message ID is remembered
+   uint8_t response[COAP_SERVER_MAX_CACHED_RESPONSE_SIZE]; ///<Response to the original request
+   size_t responseLen;                                     ///<Length of the response, in bytes
+} CoapServerDedupEntry;
+
+
+/**
+ * @brief GET response cache entry
+ **/
+
+typedef struct
+{
+   bool_t valid;                                           ///<Valid entry
+   char_t uri[COAP_SERVER_MAX_URI_LEN + 1];                ///<Resource identifier
+   uint8_t key[COAP_SERVER_MAX_CACHE_KEY_SIZE];            ///<Cache key
+   size_t keyLen;                                          ///<Length of the cache key, in bytes
+   systime_t timestamp;                                    ///<Time at which the response was cached
+   systime_t maxAge;                                       ///<Freshness lifetime
+   CoapCode code;                                          ///<Response code
+   uint8_t response[COAP_SERVER_MAX_CACHED_RESPONSE_SIZE]; ///<Options and payload of the response
+   size_t responseLen;                                     ///<Length of the response, in bytes
+} CoapServerCacheEntry;
+
+
 /**
  * @brief CoAP server context
  **/
@@ -207,6 +298,14 @@ struct _CoapServerContext
    char_t uri[COAP_SERVER_MAX_URI_LEN + 1];                  ///<Resource identifier
    CoapMessage request;                                      ///<CoAP request message
    CoapMessage response;                                     ///<CoAP response message
+#if (COAP_SERVER_DEDUP_SUPPORT == ENABLED)
+   CoapServerDedupEntry dedupCache[COAP_SERVER_DEDUP_CACHE_SIZE];          ///<Deduplication cache
+#endif
+#if (COAP_SERVER_RESPONSE_CACHE_SUPPORT == ENABLED)
+   CoapServerCacheEntry responseCache[COAP_SERVER_RESPONSE_CACHE_SIZE];    ///<GET response cache
+   uint8_t cacheKey[COAP_SERVER_MAX_CACHE_KEY_SIZE];                       ///<Cache key of the current request
+   size_t cacheKeyLen;                                                     ///<Length of the cache key, in bytes
+#endif
 };
 
 
@@ -0,0 +1,599 @@
+/**
+ * @file coap_server_cache.c
+ * @brief CoAP server message deduplication and response caching
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL COAP_TRACE_LEVEL
+
+//Dependencies
+#include "coap/coap_server.h"
+#include "coap/coap_server_cache.h"
+#include "coap/coap_server_misc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (COAP_SERVER_SUPPORT == ENABLED)
+
+//Upper bound on the freshness lifetime of cached responses, in seconds
+#define COAP_SERVER_MAX_CACHE_MAX_AGE 86400
+
+
+#if (COAP_SERVER_DEDUP_SUPPORT == ENABLED)
+
+/**
+ * @brief Check whether the incoming request is a duplicate
+ *
+ * A recipient might receive the same Confirmable message multiple times
+ * within the EXCHANGE_LIFETIME. It should acknowledge each duplicate copy
+ * with the same response, but should process any request only once (refer
+ * to RFC 7252, section 4.5)
+ *
+ * @param[in] context Pointer to the CoAP server context
+ * @return TRUE if the request is a duplicate, else FALSE
+ **/
+
+bool_t coapServerCheckDuplicate(CoapServerContext *context)
+{
+   uint_t i;
+   uint16_t mid;
+   systime_t time;
+   CoapServerDedupEntry *entry;
+   const CoapMessageHeader *header;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Point to the CoAP request header
+   header = (CoapMessageHeader *) context->request.buffer;
+   //Retrieve the Message ID of the request
+   mid = ntohs(header->mid);
+
+   //Loop through the deduplication cache
+   for(i = 0; i < COAP_SERVER_DEDUP_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->dedupCache[i];
+
+      //Valid entry?
+      if(entry->valid)
+      {
+         //The Message ID is only remembered during its lifetime
+         if(timeCompare(time, entry->timestamp + entry->lifetime) >= 0)
+         {
+            //The entry has expired
+            entry->valid = FALSE;
+         }
+         else if(entry->mid == mid && entry->clientPort == context->clientPort &&
+            ipCompAddr(&entry->clientIpAddr, &context->clientIpAddr))
+         {
+            //Debug message
+            TRACE_INFO("CoAP Server: Duplicate message received (MID = %" PRIu16 ")\r\n",
+               mid);
+
+            //Confirmable request?
+            if(header->type == COAP_TYPE_CON)
+            {
+               //Send the same response as for the original request
+               osMemcpy(context->response.buffer, entry->response,
+                  entry->responseLen);
+
+               //Set the length of the CoAP message
+               context->response.length = entry->responseLen;
+               context->response.pos = 0;
+            }
+            else
+            {
+               //A server should silently ignore duplicated Non-confirmable
+               //messages
+               context->response.length = 0;
+            }
+
+            //The request is a duplicate
+            return TRUE;
+         }
+      }
+   }
+
+   //The request has not been seen before
+   return FALSE;
+}
+
+
+/**
+ * @brief Save the response to the current request
+ * @param[in] context Pointer to the CoAP server context
+ **/
+
+void coapServerSaveResponse(CoapServerContext *context)
+{
+   uint_t i;
+   systime_t time;
+   CoapServerDedupEntry *entry;
+   CoapServerDedupEntry *oldestEntry;
+   const CoapMessageHeader *header;
+
+   //Responses that do not fit in the cache are not saved. Retransmitted
+   //copies of the request are then processed as new requests
+   if(context->response.length > COAP_SERVER_MAX_CACHED_RESPONSE_SIZE)
+      return;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Keep track of the oldest entry
+   oldestEntry = &context->dedupCache[0];
+
+   //Loop through the deduplication cache
+   for(i = 0; i < COAP_SERVER_DEDUP_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->dedupCache[i];
+
+      //Check whether the entry is available
+      if(!entry->valid ||
+         timeCompare(time, entry->timestamp + entry->lifetime) >= 0)
+      {
+         //Use the current entry
+         oldestEntry = entry;
+         break;
+      }
+
+      //Keep track of the oldest entry
+      if(timeCompare(entry->timestamp, oldestEntry->timestamp) < 0)
+      {
+         oldestEntry = entry;
+      }
+   }
+
+   //Point to the selected entry
+   entry = oldestEntry;
+   //Point to the CoAP request header
+   header = (CoapMessageHeader *) context->request.buffer;
+
+   //Save the source endpoint and the Message ID of the request
+   entry->clientIpAddr = context->clientIpAddr;
+   entry->clientPort = context->clientPort;
+   entry->mid = ntohs(header->mid);
+   entry->timestamp = time;
+
+   //Confirmable messages are remembered during EXCHANGE_LIFETIME whereas
+   //Non-confirmable messages are remembered during NON_LIFETIME
+   if(header->type == COAP_TYPE_CON)
+   {
+      entry->lifetime = COAP_SERVER_EXCHANGE_LIFETIME;
+   }
+   else
+   {
+      entry->lifetime = COAP_SERVER_NON_LIFETIME;
+   }
+
+   //Save the response
+   osMemcpy(entry->response, context->response.buffer,
+      context->response.length);
+
+   //Save the length of the response
+   entry->responseLen = context->response.length;
+   //The entry is now valid
+   entry->valid = TRUE;
+}
+
+#endif
+#if (COAP_SERVER_RESPONSE_CACHE_SUPPORT == ENABLED)
+
+/**
+ * @brief Answer a GET request from the response cache
+ * @param[in] context Pointer to the CoAP server context
+ * @return Error code
+ **/
+
+error_t coapServerGetCachedResponse(CoapServerContext *context)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   size_t etagLen;
+   uint32_t maxAge;
+   systime_t time;
+   const uint8_t *p;
+   uint8_t etag[8];
+   CoapServerCacheEntry *entry;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //The current request is not cacheable until a key has been computed
+   context->cacheKeyLen = 0;
+
+   //A registration request must always be forwarded to the request handler
+   error = coapGetOption(&context->request, COAP_OPT_OBSERVE, 0, &p, &n);
+   //Observe option found?
+   if(!error)
+      return ERROR_NOT_FOUND;
+
+   //Compute the cache key of the request
+   error = coapServerComputeCacheKey(context);
+
+   //Any error to report?
+   if(error)
+   {
+      //The response to this request will not be cached
+      context->cacheKeyLen = 0;
+      return ERROR_NOT_FOUND;
+   }
+
+   //Loop through the response cache
+   for(i = 0; i < COAP_SERVER_RESPONSE_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->responseCache[i];
+
+      //Valid entry?
+      if(entry->valid)
+      {
+         //Check whether the cached response is still fresh
+         if(timeCompare(time, entry->timestamp + entry->maxAge) >= 0)
+         {
+            //The entry has expired
+            entry->valid = FALSE;
+         }
+         else if(entry->keyLen == context->cacheKeyLen &&
+            !osMemcmp(entry->key, context->cacheKey, entry->keyLen))
+         {
+            //Matching entry found
+            break;
+         }
+      }
+   }
+
+   //No fresh response available?
+   if(i >= COAP_SERVER_RESPONSE_CACHE_SIZE)
+      return ERROR_NOT_FOUND;
+
+   //Debug message
+   TRACE_INFO("CoAP Server: Serving %s from cache...\r\n", entry->uri);
+
+   //Remaining freshness lifetime, in seconds
+   maxAge = (entry->timestamp + entry->maxAge - time) / 1000;
+
+   //The cached response follows the header and the token of the request
+   n = context->response.length;
+
+   //Restore the options and the payload of the cached response
+   osMemcpy(context->response.buffer + n, entry->response, entry->responseLen);
+   context->response.length = n + entry->responseLen;
+
+   //Restore the response code
+   error = coapSetCode(&context->response, entry->code);
+
+   //Check status code
+   if(!error)
+   {
+      //Any ETag option in the cached response?
+      error = coapGetOption(&context->response, COAP_OPT_ETAG, 0, &p,
+         &etagLen);
+
+      //Check whether the client already holds the current representation
+      if(!error && etagLen <= sizeof(etag))
+      {
+         //Save the entity-tag
+         osMemcpy(etag, p, etagLen);
+
+         //The ETag option may occur multiple times in a request
+         for(i = 0; ; i++)
+         {
+            //Retrieve the next entity-tag of the request
+            error = coapGetOption(&context->request, COAP_OPT_ETAG, i, &p, &n);
+            //No more entity-tags?
+            if(error)
+               break;
+
+            //Matching entity-tag?
+            if(n == etagLen && !osMemcmp(p, etag, n))
+               break;
+         }
+
+         //The client is only informed that its stored response is still
+         //valid (refer to RFC 7252, section 5.10.6.2)
+         if(!error)
+         {
+            //Discard the options and the payload of the cached response
+            coapServerInitResponse(context);
+
+            //Send a 2.03 Valid response
+            error = coapSetCode(&context->response, COAP_CODE_VALID);
+
+            //Check status code
+            if(!error)
+            {
+               //The response must include the entity-tag
+               error = coapSetOption(&context->response, COAP_OPT_ETAG, 0,
+                  etag, etagLen);
+            }
+         }
+      }
+
+      //Catch exception
+      if(error == ERROR_NOT_FOUND)
+         error = NO_ERROR;
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //The Max-Age option indicates the remaining freshness lifetime
+      error = coapSetUintOption(&context->response, COAP_OPT_MAX_AGE, 0,
+         maxAge);
+   }
+
+   //Failed to restore the cached response?
+   if(error)
+   {
+      //Discard the entry and forward the request to the handler
+      entry->valid = FALSE;
+      coapServerInitResponse(context);
+      error = ERROR_NOT_FOUND;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Update the response cache after a request has been processed
+ * @param[in] context Pointer to the CoAP server context
+ * @param[in] method Method code of the request
+ **/
+
+void coapServerUpdateResponseCache(CoapServerContext *context, CoapCode method)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint32_t maxAge;
+   systime_t time;
+   CoapCode code;
+   CoapServerCacheEntry *entry;
+   CoapServerCacheEntry *oldestEntry;
+   const CoapMessageHeader *header;
+
+   //Unsafe methods invalidate any cached representation of the target
+   //resource (refer to RFC 7252, section 5.6)
+   if(method != COAP_CODE_GET)
+   {
+      coapServerInvalidateCache(context, context->uri);
+      return;
+   }
+
+   //The request cannot be cached?
+   if(context->cacheKeyLen == 0)
+      return;
+
+   //Retrieve the response code
+   error = coapGetCode(&context->response, &code);
+   //Only 2.05 Content responses are cached
+   if(error || code != COAP_CODE_CONTENT)
+      return;
+
+   //Responses are only cached when the handler explicitly specifies their
+   //freshness lifetime
+   error = coapGetUintOption(&context->response, COAP_OPT_MAX_AGE, 0, &maxAge);
+   //Max-Age option not found?
+   if(error || maxAge == 0)
+      return;
+
+   //Point to the CoAP response header
+   header = (CoapMessageHeader *) context->response.buffer;
+   //Length of the header and the token
+   n = sizeof(CoapMessageHeader) + header->tokenLen;
+
+   //Make sure the response fits in the cache
+   if((context->response.length - n) > COAP_SERVER_MAX_CACHED_RESPONSE_SIZE)
+      return;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Loop through the response cache
+   for(i = 0; i < COAP_SERVER_RESPONSE_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->responseCache[i];
+
+      //A response with the same key replaces the existing entry
+      if(entry->valid && entry->keyLen == context->cacheKeyLen &&
+         !osMemcmp(entry->key, context->cacheKey, entry->keyLen))
+      {
+         break;
+      }
+   }
+
+   //No entry with the same key?
+   if(i >= COAP_SERVER_RESPONSE_CACHE_SIZE)
+   {
+      //Keep track of the oldest entry
+      oldestEntry = &context->responseCache[0];
+
+      //Loop through the response cache
+      for(i = 0; i < COAP_SERVER_RESPONSE_CACHE_SIZE; i++)
+      {
+         //Point to the current entry
+         entry = &context->responseCache[i];
+
+         //Check whether the entry is available
+         if(!entry->valid ||
+            timeCompare(time, entry->timestamp + entry->maxAge) >= 0)
+         {
+            //Use the current entry
+            oldestEntry = entry;
+            break;
+         }
+
+         //Keep track of the oldest entry
+         if(timeCompare(entry->timestamp, oldestEntry->timestamp) < 0)
+         {
+            oldestEntry = entry;
+         }
+      }
+
+      //Point to the selected entry
+      entry = oldestEntry;
+   }
+
+   //Save the resource identifier and the cache key
+   osStrcpy(entry->uri, context->uri);
+   osMemcpy(entry->key, context->cacheKey, context->cacheKeyLen);
+   entry->keyLen = context->cacheKeyLen;
+
+   //Save the freshness lifetime of the response
+   entry->timestamp = time;
+   entry->maxAge = MIN(maxAge, COAP_SERVER_MAX_CACHE_MAX_AGE) * 1000;
+
+   //Save the response code, options and payload
+   entry->code = code;
+   entry->responseLen = context->response.length - n;
+   osMemcpy(entry->response, context->response.buffer + n, entry->responseLen);
+
+   //The entry is now valid
+   entry->valid = TRUE;
+}
+
+
+/**
+ * @brief Invalidate cached responses
+ * @param[in] context Pointer to the CoAP server context
+ * @param[in] uri Resource identifier (NULL to flush the whole cache)
+ **/
+
+void coapServerInvalidateCache(CoapServerContext *context, const char_t *uri)
+{
+   uint_t i;
+   CoapServerCacheEntry *entry;
+
+   //Loop through the response cache
+   for(i = 0; i < COAP_SERVER_RESPONSE_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->responseCache[i];
+
+      //Matching resource?
+      if(uri == NULL || !osStrcmp(entry->uri, uri))
+      {
+         //Invalidate the cached response
+         entry->valid = FALSE;
+      }
+   }
+}
+
+
+/**
+ * @brief Compute the cache key of the current request
+ *
+ * The cache key is made of the options of the request, except the ETag
+ * option and the options marked as NoCacheKey (refer to RFC 7252, section
+ * 5.4.6)
+ *
+ * @param[in] context Pointer to the CoAP server context
+ * @return Error code
+ **/
+
+error_t coapServerComputeCacheKey(CoapServerContext *context)
+{
+   error_t error;
+   size_t n;
+   size_t length;
+   const uint8_t *p;
+   CoapOption option;
+   const CoapOptionParameters *optionParams;
+
+   //Point to the first byte of the CoAP request
+   p = context->request.buffer;
+   //Retrieve the length of the request
+   length = context->request.length;
+
+   //Parse message header
+   error = coapParseMessageHeader(p, length, &n);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Point to the first option of the message
+   p += n;
+   //Number of bytes left to process
+   length -= n;
+
+   //For the first option in a message, a preceding option instance with
+   //Option Number zero is assumed
+   option.number = 0;
+
+   //Loop through CoAP options
+   while(length > 0)
+   {
+      //Payload marker found?
+      if(*p == COAP_PAYLOAD_MARKER)
+         break;
+
+      //Parse current option
+      error = coapParseOption(p, length, option.number, &option, &n);
+      //Any error to report?
+      if(error)
+         return error;
+
+      //Retrieve option parameters
+      optionParams = coapGetOptionParameters(option.number);
+
+      //Check whether the option is part of the cache key
+      if(option.number != COAP_OPT_ETAG &&
+         (optionParams == NULL || !optionParams->noCacheKey))
+      {
+         //Make sure the key fits in the buffer
+         if((context->cacheKeyLen + option.length + 4) > COAP_SERVER_MAX_CACHE_KEY_SIZE)
+            return ERROR_BUFFER_OVERFLOW;
+
+         //Append the option number, length and value
+         STORE16BE(option.number, context->cacheKey + context->cacheKeyLen);
+         STORE16BE(option.length, context->cacheKey + context->cacheKeyLen + 2);
+         osMemcpy(context->cacheKey + context->cacheKeyLen + 4, option.value,
+            option.length);
+
+         //Update the length of the cache key
+         context->cacheKeyLen += option.length + 4;
+      }
+
+      //Jump to the next option
+      p += n;
+      length -= n;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+#endif
+#endif
@@ -36,6 +36,7 @@
 #include "coap/coap_server.h"
 #include "coap/coap_server_transport.h"
 #include "coap/coap_server_misc.h"
+#include "coap/coap_server_cache.h"
 #include "coap/coap_common.h"
 #include "coap/coap_debug.h"
 #include "debug.h"
@@ -115,9 +116,13 @@ error_t coapServerProcessRequest(CoapServerContext *context,
    const uint8_t *data, size_t length)
 {
    error_t error;
+   bool_t duplicate;
    CoapCode code;
    CoapMessageType type;
 
+   //Initialize flag
+   duplicate = FALSE;
+
    //Check the length of the CoAP message
    if(length > COAP_MAX_MSG_SIZE)
       return ERROR_INVALID_LENGTH;
@@ -155,8 +160,20 @@ error_t coapServerProcessRequest(CoapServerContext *context,
       //Check the type of the request
       if(type == COAP_TYPE_CON || type == COAP_TYPE_NON)
       {
+#if (COAP_SERVER_DEDUP_SUPPORT == ENABLED)
+         //A recipient must be prepared to receive the same message multiple
+         //times (refer to RFC 7252, section 4.5)
+         duplicate = coapServerCheckDuplicate(context);
+#endif
+
+         //Duplicate request?
+         if(duplicate)
+         {
+            //The response to the original request has been restored
+            error = NO_ERROR;
+         }
          //Check message code
-         if(code == COAP_CODE_GET ||
+         else if(code == COAP_CODE_GET ||
             code == COAP_CODE_POST ||
             code == COAP_CODE_PUT ||
             code == COAP_CODE_DELETE ||
@@ -175,12 +192,31 @@ error_t coapServerProcessRequest(CoapServerContext *context,
                osStrcpy(context->uri, "/");
             }
 
+#if (COAP_SERVER_RESPONSE_CACHE_SUPPORT == ENABLED)
+            //Fresh response available for a GET request?
+            if(code == COAP_CODE_GET &&
+               coapServerGetCachedResponse(context) == NO_ERROR)
+            {
+               //The request handler is not invoked
+               error = NO_ERROR;
+            }
+            else
+#endif
             //Any registered callback?
             if(context->settings.requestCallback != NULL)
             {
                //Invoke user callback function
                error = context->settings.requestCallback(context, code,
                   context->uri);
+
+#if (COAP_SERVER_RESPONSE_CACHE_SUPPORT == ENABLED)
+               //Check status code
+               if(!error)
+               {
+                  //Cache the response or invalidate stale entries
+                  coapServerUpdateResponseCache(context, code);
+               }
+#endif
             }
             else
             {
@@ -202,6 +238,16 @@ error_t coapServerProcessRequest(CoapServerContext *context,
             //5.8)
             error = coapSetCode(&context->response, COAP_CODE_METHOD_NOT_ALLOWED);
          }
+
+#if (COAP_SERVER_DEDUP_SUPPORT == ENABLED)
+         //Check status code
+         if(!error && !duplicate)
+         {
+            //Save the response so that retransmitted copies of the request
+            //are answered without processing the request again
+            coapServerSaveResponse(context);
+         }
+#endif
       }
       else
       {
@@ -627,6 +627,55 @@ uint16_t ipCalcUpperLayerChecksumEx(const void *pseudoHeader,
 }
 
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+
+/**
+ * @brief Complete an upper-layer checksum in software
+ *
+ * When the checksum is left to the NIC, the checksum field holds the checksum
+ * of the pseudo header only. This function completes the computation when the
+ * NIC cannot take care of it
+ *
+ * @param[in] buffer Multi-part buffer containing the upper-layer message
+ * @param[in] offset Offset to the first byte of the upper-layer message
+ * @param[in,out] ancillary Additional options passed to the stack along with
+ *   the packet
+ **/
+
+void ipCompleteUpperLayerChecksum(NetBuffer *buffer, size_t offset,
+   NetTxAncillary *ancillary)
+{
+   size_t length;
+   uint16_t checksum;
+
+   //Any upper-layer checksum left to the NIC?
+   if((ancillary->checksumFlags & (NET_CHECKSUM_TCP | NET_CHECKSUM_UDP)) != 0)
+   {
+      //Retrieve the length of the upper-layer message
+      length = netBufferGetLength(buffer) - offset;
+
+      //The checksum field is covered by the computation
+      checksum = ipCalcChecksumEx(buffer, offset, length);
+
+      //A computed UDP checksum of zero is transmitted as all ones
+      if((ancillary->checksumFlags & NET_CHECKSUM_UDP) != 0 &&
+         checksum == 0x0000)
+      {
+         checksum = 0xFFFF;
+      }
+
+      //Write the resulting checksum
+      netBufferWrite(buffer, offset + ancillary->checksumOffset, &checksum,
+         sizeof(uint16_t));
+
+      //The checksum is no longer pending
+      ancillary->checksumFlags &= ~(NET_CHECKSUM_TCP | NET_CHECKSUM_UDP);
+   }
+}
+
+#endif
+
+
 /**
  * @brief Allocate a buffer to hold an IP packet
  * @param[in] length Desired payload length
@@ -137,6 +137,9 @@ uint16_t ipCalcUpperLayerChecksum(const void *pseudoHeader,
 uint16_t ipCalcUpperLayerChecksumEx(const void *pseudoHeader,
    size_t pseudoHeaderLen, const NetBuffer *buffer, size_t offset, size_t length);
 
+void ipCompleteUpperLayerChecksum(NetBuffer *buffer, size_t offset,
+   NetTxAncillary *ancillary);
+
 NetBuffer *ipAllocBuffer(size_t length, size_t *offset);
 
 error_t ipStringToAddr(const char_t *str, IpAddr *ipAddr);
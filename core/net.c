@@ -38,6 +38,7 @@
 #include "core/raw_socket.h"
 #include "core/tcp_timer.h"
 #include "core/tcp_misc.h"
+#include "core/net_stats.h"
 #include "core/ethernet.h"
 #include "ipv4/arp.h"
 #include "ipv4/ipv4.h"
@@ -71,8 +72,17 @@
    #include "web_socket/web_socket.h"
 #endif
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+//Default TCP/IP stack instance
+static NetContext netDefaultContext;
+//Stack instance the calling task operates on
+NET_THREAD_LOCAL NetContext *netCurrentContext = &netDefaultContext;
+//Number of stack instances that have been initialized
+static uint_t netInstanceCount = 0;
+#else
 //TCP/IP stack context
 NetContext netContext;
+#endif
 
 
 /**
@@ -86,9 +96,22 @@ error_t netInit(void)
    uint_t i;
    NetInterface *interface;
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each instance has its own copy of the module variables
+   error = netAllocInstance(&i);
+   //Any error to report?
+   if(error)
+      return error;
+#endif
+
    //Clear TCP/IP stack context
    osMemset(&netContext, 0, sizeof(NetContext));
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Assign an index to the stack instance
+   netContext.instance = i;
+#endif
+
    //The TCP/IP process is currently suspended
    netTaskRunning = FALSE;
    //Get current time
@@ -131,6 +154,11 @@ error_t netInit(void)
       //Unique number identifying the interface
       interface->id = i;
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+      //Stack instance the interface belongs to
+      interface->stackContext = netCurrentContext;
+#endif
+
 #if (ETH_SUPPORT == ENABLED)
       //Default PHY address
       interface->phyAddr = UINT8_MAX;
@@ -243,7 +271,17 @@ error_t netInit(void)
    dnsSdTickCounter = 0;
 #endif
 
-#if (OS_STATIC_TASK_SUPPORT == ENABLED)
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED && OS_STATIC_TASK_SUPPORT == ENABLED)
+   //Create a task using statically allocated memory
+   netContext.taskId = osCreateStaticTask("TCP/IP Stack",
+      (OsTaskCode) netInstanceTask, netCurrentContext, &netContext.taskTcb,
+      netContext.taskStack, NET_TASK_STACK_SIZE, NET_TASK_PRIORITY);
+#elif (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Create a task that operates on the current stack instance
+   netContext.taskId = osCreateTask("TCP/IP Stack",
+      (OsTaskCode) netInstanceTask, netCurrentContext, NET_TASK_STACK_SIZE,
+      NET_TASK_PRIORITY);
+#elif (OS_STATIC_TASK_SUPPORT == ENABLED)
    //Create a task using statically allocated memory
    netContext.taskId = osCreateStaticTask("TCP/IP Stack",
       (OsTaskCode) netTask, NULL, &netContext.taskTcb, netContext.taskStack,
@@ -1378,6 +1416,9 @@ void netTask(void)
    systime_t time;
    systime_t timeout;
    NetInterface *interface;
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t taskTimestamp;
+#endif
 
 #if (NET_RTOS_SUPPORT == ENABLED)
    //Task prologue
@@ -1426,93 +1467,232 @@ void netTask(void)
       //link state of any network interfaces has changed
       status = osWaitForEvent(&netEvent, timeout);
 
-      //Check whether the specified event is in signaled state
-      if(status)
+#if (NET_STATS_SUPPORT == ENABLED)
+      //Save the time at which the current iteration starts
+      taskTimestamp = netStatsGetTimestamp();
+#endif
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+      //Release the buffers of completed scatter-gather transmissions. The
+      //memory pool has its own lock, so netMutex is not needed here
+      for(i = 0; i < NET_INTERFACE_COUNT; i++)
+      {
+         nicReleaseTxRequests(&netInterface[i]);
+      }
+#endif
+
+      //Get current time
+      time = osGetSystemTime();
+
+      //Any event to process or periodic operation to handle?
+      if(status || timeCompare(time, netTimestamp) >= 0)
       {
          //Get exclusive access
          osAcquireMutex(&netMutex);
 
-         //Process events
-         for(i = 0; i < NET_INTERFACE_COUNT; i++)
+         //Check whether the specified event is in signaled state
+         if(status)
          {
-            //Point to the current network interface
-            interface = &netInterface[i];
-
-            //Check whether a NIC event is pending
-            if(interface->nicEvent)
+            //Process events
+            for(i = 0; i < NET_INTERFACE_COUNT; i++)
             {
-               //Acknowledge the event by clearing the flag
-               interface->nicEvent = FALSE;
+               //Point to the current network interface
+               interface = &netInterface[i];
 
-               //Valid NIC driver?
-               if(interface->nicDriver != NULL)
+               //Check whether a NIC event is pending
+               if(interface->nicEvent)
                {
-                  //Disable hardware interrupts
-                  interface->nicDriver->disableIrq(interface);
-                  //Handle NIC events
-                  interface->nicDriver->eventHandler(interface);
-                  //Re-enable hardware interrupts
-                  interface->nicDriver->enableIrq(interface);
+                  //Acknowledge the event by clearing the flag
+                  interface->nicEvent = FALSE;
+
+                  //Valid NIC driver?
+                  if(interface->nicDriver != NULL)
+                  {
+#if (NET_RX_POLLING_SUPPORT == ENABLED)
+                     //Does the driver support budgeted polling?
+                     if(interface->nicDriver->receivePacket != NULL)
+                     {
+                        //Process a bounded number of frames
+                        netPollInterface(interface);
+                     }
+                     else
+#endif
+                     {
+                        //Disable hardware interrupts
+                        interface->nicDriver->disableIrq(interface);
+                        //Handle NIC events
+                        interface->nicDriver->eventHandler(interface);
+                        //Re-enable hardware interrupts
+                        interface->nicDriver->enableIrq(interface);
+                     }
+                  }
                }
-            }
 
 #if (ETH_SUPPORT == ENABLED)
-            //Check whether a PHY event is pending
-            if(interface->phyEvent)
-            {
-               //Acknowledge the event by clearing the flag
-               interface->phyEvent = FALSE;
-
-               //Valid NIC driver?
-               if(interface->nicDriver != NULL)
+               //Check whether a PHY event is pending
+               if(interface->phyEvent)
                {
-                  //Disable hardware interrupts
-                  interface->nicDriver->disableIrq(interface);
+                  //Acknowledge the event by clearing the flag
+                  interface->phyEvent = FALSE;
 
-                  //Valid Ethernet PHY or switch driver?
-                  if(interface->phyDriver != NULL)
-                  {
-                     //Handle events
-                     interface->phyDriver->eventHandler(interface);
-                  }
-                  else if(interface->switchDriver != NULL)
-                  {
-                     //Handle events
-                     interface->switchDriver->eventHandler(interface);
-                  }
-                  else
+                  //Valid NIC driver?
+                  if(interface->nicDriver != NULL)
                   {
-                     //The interface is not properly configured
+                     //Disable hardware interrupts
+                     interface->nicDriver->disableIrq(interface);
+
+                     //Valid Ethernet PHY or switch driver?
+                     if(interface->phyDriver != NULL)
+                     {
+                        //Handle events
+                        interface->phyDriver->eventHandler(interface);
+                     }
+                     else if(interface->switchDriver != NULL)
+                     {
+                        //Handle events
+                        interface->switchDriver->eventHandler(interface);
+                     }
+                     else
+                     {
+                        //The interface is not properly configured
+                     }
+
+                     //Re-enable hardware interrupts
+                     interface->nicDriver->enableIrq(interface);
                   }
-
-                  //Re-enable hardware interrupts
-                  interface->nicDriver->enableIrq(interface);
                }
-            }
 #endif
+            }
          }
 
-         //Release exclusive access
-         osReleaseMutex(&netMutex);
-      }
+         //Get current time
+         time = osGetSystemTime();
 
-      //Get current time
-      time = osGetSystemTime();
+         //Check current time
+         if(timeCompare(time, netTimestamp) >= 0)
+         {
+            //Handle periodic operations
+            netTick();
+            //Next event
+            netTimestamp = time + NET_TICK_INTERVAL;
+         }
+
+#if (NET_STATS_SUPPORT == ENABLED)
+         //Record the duration of the current iteration
+         netStatsRecordSample(&netStats.taskLatency,
+            netStatsGetTimestamp() - taskTimestamp);
+#endif
 
-      //Check current time
-      if(timeCompare(time, netTimestamp) >= 0)
-      {
-         //Get exclusive access
-         osAcquireMutex(&netMutex);
-         //Handle periodic operations
-         netTick();
          //Release exclusive access
          osReleaseMutex(&netMutex);
-
-         //Next event
-         netTimestamp = time + NET_TICK_INTERVAL;
       }
 #if (NET_RTOS_SUPPORT == ENABLED)
    }
 #endif
 }
+
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+
+/**
+ * @brief Select the TCP/IP stack instance the calling task operates on
+ *
+ * netInit() initializes the selected instance. The socket API switches to
+ * the instance a socket belongs to, but the interface configuration
+ * functions operate on the selected instance
+ *
+ * @param[in] context Pointer to the TCP/IP stack context
+ **/
+
+void netSetCurrentContext(NetContext *context)
+{
+   //Valid stack instance?
+   if(context != NULL)
+   {
+      netCurrentContext = context;
+   }
+}
+
+
+/**
+ * @brief Reserve the index of a new stack instance
+ *
+ * Several tasks may initialize their own instance at the same time, so the
+ * instance counter is updated atomically
+ *
+ * @param[out] instance Zero-based index of the stack instance
+ * @return Error code
+ **/
+
+error_t netAllocInstance(uint_t *instance)
+{
+   uint_t n;
+
+#if defined(__GNUC__)
+   //Read the current number of instances
+   n = __atomic_load_n(&netInstanceCount, __ATOMIC_RELAXED);
+
+   //Retry if another task has reserved an index in the meantime
+   do
+   {
+      //All the instances are already in use?
+      if(n >= NET_MAX_INSTANCES)
+         return ERROR_OUT_OF_RESOURCES;
+   } while(!__atomic_compare_exchange_n(&netInstanceCount, &n, n + 1,
+      FALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+#else
+   //Enter critical section
+   osSuspendAllTasks();
+
+   //Read the current number of instances
+   n = netInstanceCount;
+
+   //Reserve the next index
+   if(n < NET_MAX_INSTANCES)
+   {
+      netInstanceCount++;
+   }
+
+   //Exit critical section
+   osResumeAllTasks();
+
+   //All the instances are already in use?
+   if(n >= NET_MAX_INSTANCES)
+      return ERROR_OUT_OF_RESOURCES;
+#endif
+
+   //Return the index of the new instance
+   *instance = n;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Get the TCP/IP stack instance the calling task operates on
+ * @return Pointer to the TCP/IP stack context
+ **/
+
+NetContext *netGetCurrentContext(void)
+{
+   //Return the selected instance
+   return netCurrentContext;
+}
+
+
+/**
+ * @brief TCP/IP events handling for a given stack instance
+ * @param[in] context Pointer to the TCP/IP stack context
+ **/
+
+void netInstanceTask(NetContext *context)
+{
+   //The task operates on the specified stack instance
+   netCurrentContext = context;
+
+   //Process events
+   netTask();
+}
+
+#endif
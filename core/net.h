@@ -35,9 +35,53 @@
 struct _NetInterface;
 #define NetInterface struct _NetInterface
 
+//Forward declaration of NetContext structure
+struct _NetContext;
+#define NetContext struct _NetContext
+
 //Dependencies
 #include "os_port.h"
 #include "net_config.h"
+
+//Multiple stack instances support (the modules included below declare one
+//copy of their variables per instance when this option is enabled)
+#ifndef NET_MULTI_INSTANCE_SUPPORT
+   #define NET_MULTI_INSTANCE_SUPPORT DISABLED
+#elif (NET_MULTI_INSTANCE_SUPPORT != ENABLED && NET_MULTI_INSTANCE_SUPPORT != DISABLED)
+   #error NET_MULTI_INSTANCE_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of stack instances
+#ifndef NET_MAX_INSTANCES
+   #define NET_MAX_INSTANCES 2
+#elif (NET_MAX_INSTANCES < 1)
+   #error NET_MAX_INSTANCES parameter is not valid
+#endif
+
+//Storage class of the current instance pointer (each task must have its
+//own copy, otherwise concurrent instances select each other's context)
+#ifndef NET_THREAD_LOCAL
+   #if (NET_MULTI_INSTANCE_SUPPORT == DISABLED)
+      #define NET_THREAD_LOCAL
+   #elif defined(__GNUC__)
+      #define NET_THREAD_LOCAL __thread
+   #elif defined(_MSC_VER)
+      #define NET_THREAD_LOCAL __declspec(thread)
+   #elif (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L)
+      #define NET_THREAD_LOCAL _Thread_local
+   #else
+      #error NET_THREAD_LOCAL must be defined when NET_MULTI_INSTANCE_SUPPORT is enabled
+   #endif
+#endif
+
+//Stack-wide statistics and latency histograms (the socket structure
+//depends on this option, so it must be defined before the includes below)
+#ifndef NET_STATS_SUPPORT
+   #define NET_STATS_SUPPORT ENABLED
+#elif (NET_STATS_SUPPORT != ENABLED && NET_STATS_SUPPORT != DISABLED)
+   #error NET_STATS_SUPPORT parameter is not valid
+#endif
+
 #include "core/net_legacy.h"
 #include "core/net_mem.h"
 #include "core/net_misc.h"
@@ -169,6 +213,34 @@ struct _NetInterface;
    #define NET_TASK_PRIORITY OS_TASK_PRIORITY_HIGH
 #endif
 
+//In-stack packet capture
+#ifndef NET_CAPTURE_SUPPORT
+   #define NET_CAPTURE_SUPPORT DISABLED
+#elif (NET_CAPTURE_SUPPORT != ENABLED && NET_CAPTURE_SUPPORT != DISABLED)
+   #error NET_CAPTURE_SUPPORT parameter is not valid
+#endif
+
+//Budgeted polling of the receive rings
+#ifndef NET_RX_POLLING_SUPPORT
+   #define NET_RX_POLLING_SUPPORT DISABLED
+#elif (NET_RX_POLLING_SUPPORT != ENABLED && NET_RX_POLLING_SUPPORT != DISABLED)
+   #error NET_RX_POLLING_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of frames processed per interface and per poll
+#ifndef NET_RX_BUDGET
+   #define NET_RX_BUDGET 16
+#elif (NET_RX_BUDGET < 1)
+   #error NET_RX_BUDGET parameter is not valid
+#endif
+
+//Checksum offload support
+#ifndef NET_CHECKSUM_OFFLOAD_SUPPORT
+   #define NET_CHECKSUM_OFFLOAD_SUPPORT DISABLED
+#elif (NET_CHECKSUM_OFFLOAD_SUPPORT != ENABLED && NET_CHECKSUM_OFFLOAD_SUPPORT != DISABLED)
+   #error NET_CHECKSUM_OFFLOAD_SUPPORT parameter is not valid
+#endif
+
 //TCP/IP stack tick interval
 #ifndef NET_TICK_INTERVAL
    #define NET_TICK_INTERVAL 100
@@ -210,6 +282,12 @@ struct _NetInterface
    uint32_t linkSpeed;                            ///<Link speed
    NicDuplexMode duplexMode;                      ///<Duplex mode
    bool_t configured;                             ///<Configuration done
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   NetContext *stackContext;                      ///<TCP/IP stack instance the interface belongs to
+#endif
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+   NicTxRequest txRequests[NIC_TX_REQUEST_COUNT]; ///<Scatter-gather transmissions in flight
+#endif
 
 #if (ETH_SUPPORT == ENABLED)
    const PhyDriver *phyDriver;                    ///<Ethernet PHY driver
@@ -299,8 +377,11 @@ struct _NetInterface
  * @brief TCP/IP stack context
  **/
 
-typedef struct
+struct _NetContext
 {
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   uint_t instance;                              ///<Zero-based index of the stack instance
+#endif
    OsMutex mutex;                                ///<Mutex preventing simultaneous access to the TCP/IP stack
    OsEvent event;                                ///<Event object to receive notifications from drivers
    bool_t running;                               ///<The TCP/IP stack is currently running
@@ -316,11 +397,16 @@ typedef struct
    NetInterface interfaces[NET_INTERFACE_COUNT]; ///<Network interfaces
    NetLinkChangeCallbackEntry linkChangeCallbacks[NET_MAX_LINK_CHANGE_CALLBACKS];
    NetTimerCallbackEntry timerCallbacks[NET_MAX_TIMER_CALLBACKS];
-} NetContext;
+};
 
 
 //Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern NET_THREAD_LOCAL NetContext *netCurrentContext;
+#define netContext (*netCurrentContext)
+#else
 extern NetContext netContext;
+#endif
 
 //TCP/IP stack related functions
 error_t netInit(void);
@@ -371,6 +457,13 @@ error_t netStopInterface(NetInterface *interface);
 
 void netTask(void);
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+error_t netAllocInstance(uint_t *instance);
+void netSetCurrentContext(NetContext *context);
+NetContext *netGetCurrentContext(void);
+void netInstanceTask(NetContext *context);
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 }
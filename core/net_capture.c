@@ -0,0 +1,771 @@
+/**
+ * @file net_capture.c
+ * @brief In-stack packet capture ring with pcapng export
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * Frames are copied (up to the configured snaplen) into a preallocated ring
+ * as they cross nicProcessPacket() and nicSendPacket(). The stack is the
+ * only producer and always runs under the stack mutex. A single consumer
+ * drains the ring without holding the mutex, so exporting a capture never
+ * stalls the TCP/IP stack. Each side publishes its index after a memory
+ * barrier, so that a record is complete before the consumer sees it and is
+ * not overwritten before the consumer has released it. When the ring is
+ * full, new packets are dropped and accounted for rather than overwriting
+ * unread data
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_capture.h"
+#include "core/ethernet.h"
+#include "ipv4/ipv4.h"
+#include "ipv6/ipv6.h"
+#include "date_time.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+
+//Usable size of the capture ring
+#define NET_CAPTURE_RING_SIZE (sizeof(netCaptureContext.buffer))
+
+//Packet capture context
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+NetCaptureContext netCaptureContexts[NET_MAX_INSTANCES];
+#define netCaptureContext (netCaptureContexts[netContext.instance])
+#else
+NetCaptureContext netCaptureContext;
+#endif
+
+
+/**
+ * @brief Start capturing packets
+ * @param[in] filter Capture filter (NULL to capture every packet)
+ * @param[in] snapLen Maximum number of bytes captured from each packet
+ *   (0 to use the default value)
+ * @return Error code
+ **/
+
+error_t netCaptureStart(const NetCaptureFilter *filter, size_t snapLen)
+{
+   NetCaptureContext *context;
+
+   //Point to the packet capture context
+   context = &netCaptureContext;
+
+   //Use default snaplen if necessary
+   if(snapLen == 0)
+      snapLen = NET_CAPTURE_DEFAULT_SNAPLEN;
+
+   //Each record must fit in the ring
+   if(snapLen > 65535 ||
+      (sizeof(NetCaptureRecord) + snapLen + 4) > NET_CAPTURE_RING_SIZE)
+   {
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //The ring cannot be flushed while it is being drained
+   if(context->exporting)
+   {
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+      //Report an error
+      return ERROR_WRONG_STATE;
+   }
+
+   //Save capture filter
+   if(filter != NULL)
+   {
+      context->filter = *filter;
+   }
+   else
+   {
+      osMemset(&context->filter, 0, sizeof(NetCaptureFilter));
+   }
+
+   //Save snaplen
+   context->snapLen = snapLen;
+
+   //Record the time at which the capture starts
+   context->startTime = getCurrentUnixTime();
+   context->startTimestamp = osGetSystemTime();
+
+   //Flush the ring
+   context->writeIndex = 0;
+   context->readIndex = 0;
+   context->captured = 0;
+   context->dropped = 0;
+
+   //Start capturing packets
+   context->running = TRUE;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Stop capturing packets
+ *
+ * Packets that are still in the ring can be exported afterwards
+ *
+ **/
+
+void netCaptureStop(void)
+{
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Stop capturing packets
+   netCaptureContext.running = FALSE;
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+}
+
+
+/**
+ * @brief Capture an incoming packet
+ * @param[in] interface Underlying network interface
+ * @param[in] packet Incoming packet
+ * @param[in] length Length of the packet, in bytes
+ **/
+
+void netCaptureRxPacket(NetInterface *interface, const uint8_t *packet,
+   size_t length)
+{
+   NetBuffer1 buffer;
+
+   //Capture is idle?
+   if(!netCaptureContext.running)
+      return;
+
+   //The incoming packet fits in a single chunk
+   buffer.chunkCount = 1;
+   buffer.maxChunkCount = 1;
+   buffer.chunk[0].address = (void *) packet;
+   buffer.chunk[0].length = (uint16_t) length;
+   buffer.chunk[0].size = 0;
+
+   //Capture the packet
+   netCaptureProcessPacket(interface, NET_CAPTURE_DIR_RX,
+      (NetBuffer *) &buffer, 0);
+}
+
+
+/**
+ * @brief Capture an outgoing packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ **/
+
+void netCaptureTxPacket(NetInterface *interface, const NetBuffer *buffer,
+   size_t offset)
+{
+   //Capture is idle?
+   if(!netCaptureContext.running)
+      return;
+
+   //Capture the packet
+   netCaptureProcessPacket(interface, NET_CAPTURE_DIR_TX, buffer, offset);
+}
+
+
+/**
+ * @brief Filter a packet and append it to the capture ring
+ *
+ * This function is called with the stack mutex held, hence there is a single
+ * producer at any time
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] direction Packet direction
+ * @param[in] buffer Multi-part buffer containing the packet
+ * @param[in] offset Offset to the first byte of the packet
+ **/
+
+void netCaptureProcessPacket(NetInterface *interface,
+   NetCaptureDirection direction, const NetBuffer *buffer, size_t offset)
+{
+   size_t n;
+   size_t p;
+   size_t r;
+   size_t w;
+   size_t length;
+   NetCaptureRecord *record;
+   NetCaptureContext *context;
+   uint8_t data[NET_CAPTURE_FILTER_DEPTH];
+
+   //Point to the packet capture context
+   context = &netCaptureContext;
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Any filter criterion?
+   if(context->filter.flags != 0)
+   {
+      //Copy the leading bytes of the packet
+      n = netBufferRead(data, buffer, offset, NET_CAPTURE_FILTER_DEPTH);
+
+      //Discard packets that do not match the filter
+      if(!netCaptureMatchFilter(interface, data, n))
+         return;
+   }
+
+   //Limit the number of bytes to capture
+   n = MIN(length, context->snapLen);
+   //Compute the size of the record (4-byte aligned)
+   length = (sizeof(NetCaptureRecord) + n + 3) & ~3U;
+
+   //Retrieve the current position of the consumer and the producer
+   r = context->readIndex;
+   w = context->writeIndex;
+
+   //The consumer has finished reading the records it released
+   netCaptureMemoryBarrier();
+
+   //The ring is never allowed to become completely full, so that the
+   //producer and the consumer only meet when it is empty
+   if(w >= r)
+   {
+      //Enough room before the end of the ring?
+      if((NET_CAPTURE_RING_SIZE - w) > length ||
+         ((NET_CAPTURE_RING_SIZE - w) == length && r != 0))
+      {
+         //Store the record at the current position
+         p = w;
+      }
+      else if(r > length)
+      {
+         //Mark the end of the ring so that the consumer wraps around
+         context->buffer[w / 4] = 0;
+         //Store the record at the beginning of the ring
+         p = 0;
+      }
+      else
+      {
+         //The ring is full
+         context->dropped++;
+         return;
+      }
+   }
+   else
+   {
+      //Enough room between the producer and the consumer?
+      if((r - w) > length)
+      {
+         //Store the record at the current position
+         p = w;
+      }
+      else
+      {
+         //The ring is full
+         context->dropped++;
+         return;
+      }
+   }
+
+   //Point to the record
+   record = (NetCaptureRecord *) &context->buffer[p / 4];
+
+   //Format record header
+   record->length = length;
+   record->timestamp = osGetSystemTime();
+   record->origLength = netBufferGetLength(buffer) - offset;
+   record->capLength = (uint16_t) n;
+   record->interfaceIndex = (uint8_t) interface->index;
+   record->direction = (uint8_t) direction;
+
+   //Copy packet contents
+   netBufferRead((uint8_t *) record + sizeof(NetCaptureRecord), buffer,
+      offset, n);
+
+   //Advance the producer position
+   p += length;
+
+   //Wrap around if necessary
+   if(p >= NET_CAPTURE_RING_SIZE)
+   {
+      p = 0;
+   }
+
+   //The record must be complete before it becomes visible to the consumer
+   netCaptureMemoryBarrier();
+
+   //The record is visible to the consumer once the write index is updated
+   context->writeIndex = p;
+   //Total number of packets captured
+   context->captured++;
+}
+
+
+/**
+ * @brief Check whether a packet matches the capture filter
+ * @param[in] interface Underlying network interface
+ * @param[in] data Leading bytes of the packet
+ * @param[in] length Number of bytes available
+ * @return TRUE if the packet matches the filter, else FALSE
+ **/
+
+bool_t netCaptureMatchFilter(NetInterface *interface, const uint8_t *data,
+   size_t length)
+{
+   uint_t version;
+   uint16_t type;
+   uint8_t protocol;
+   size_t n;
+   size_t addrLen;
+   const uint8_t *srcAddr;
+   const uint8_t *destAddr;
+   const uint8_t *payload;
+   const NetCaptureFilter *filter;
+
+   //Point to the capture filter
+   filter = &netCaptureContext.filter;
+
+   //Offset to the IP header
+   n = 0;
+
+#if (ETH_SUPPORT == ENABLED)
+   //Ethernet interface?
+   if(interface->nicDriver->type == NIC_TYPE_ETHERNET)
+   {
+      //Malformed Ethernet frame?
+      if(length < sizeof(EthHeader))
+         return FALSE;
+
+      //Retrieve the EtherType
+      type = LOAD16BE(data + 12);
+      n = sizeof(EthHeader);
+
+      //Skip the 802.1Q tag if any
+      if(type == ETH_TYPE_VLAN && length >= (n + 4))
+      {
+         type = LOAD16BE(data + 16);
+         n += 4;
+      }
+
+      //Only IPv4 and IPv6 packets can be filtered
+      if(type != ETH_TYPE_IPV4 && type != ETH_TYPE_IPV6)
+         return FALSE;
+   }
+   else
+#endif
+   //PPP interface?
+   if(interface->nicDriver->type == NIC_TYPE_PPP)
+   {
+      //Skip the Address and Control fields if present
+      if(length >= 2 && data[0] == 0xFF && data[1] == 0x03)
+      {
+         n = 2;
+      }
+
+      //Malformed PPP frame?
+      if(length < (n + 2))
+         return FALSE;
+
+      //Compressed Protocol field?
+      if((data[n] & 0x01) != 0)
+      {
+         type = data[n];
+         n += 1;
+      }
+      else
+      {
+         type = LOAD16BE(data + n);
+         n += 2;
+      }
+
+      //Only IPv4 and IPv6 packets can be filtered
+      if(type != 0x0021 && type != 0x0057)
+         return FALSE;
+   }
+   else
+   {
+      //Other interface types carry raw IP packets
+   }
+
+   //Malformed packet?
+   if(length <= n)
+      return FALSE;
+
+   //Retrieve IP version
+   version = data[n] >> 4;
+
+   //Check IP version
+   if(version == 4 && length >= (n + 20))
+   {
+      //Retrieve the upper-layer protocol
+      protocol = data[n + 9];
+      //Point to the source and destination addresses
+      srcAddr = data + n + 12;
+      destAddr = data + n + 16;
+      addrLen = sizeof(Ipv4Addr);
+
+      //Non-first fragments do not carry the transport header
+      if((LOAD16BE(data + n + 6) & 0x1FFF) != 0)
+      {
+         payload = NULL;
+      }
+      else
+      {
+         payload = data + n + (data[n] & 0x0F) * 4;
+      }
+   }
+   else if(version == 6 && length >= (n + 40))
+   {
+      //Retrieve the Next Header field (extension headers are not parsed)
+      protocol = data[n + 6];
+      //Point to the source and destination addresses
+      srcAddr = data + n + 8;
+      destAddr = data + n + 24;
+      addrLen = sizeof(Ipv6Addr);
+      //Point to the transport header
+      payload = data + n + 40;
+   }
+   else
+   {
+      //Malformed IP packet
+      return FALSE;
+   }
+
+   //Filter by protocol?
+   if((filter->flags & NET_CAPTURE_FILTER_PROTOCOL) != 0)
+   {
+      //Check the upper-layer protocol
+      if(protocol != filter->protocol)
+         return FALSE;
+   }
+
+   //Filter by address?
+   if((filter->flags & NET_CAPTURE_FILTER_ADDR) != 0)
+   {
+      //Check the address family
+      if(filter->ipAddr.length != addrLen)
+         return FALSE;
+
+      //Check source and destination addresses
+      if(osMemcmp(srcAddr, &filter->ipAddr.ipv4Addr, addrLen) != 0 &&
+         osMemcmp(destAddr, &filter->ipAddr.ipv4Addr, addrLen) != 0)
+      {
+         return FALSE;
+      }
+   }
+
+   //Filter by port?
+   if((filter->flags & NET_CAPTURE_FILTER_PORT) != 0)
+   {
+      //Only TCP and UDP carry port numbers
+      if(protocol != 6 && protocol != 17)
+         return FALSE;
+
+      //Make sure the transport header is available
+      if(payload == NULL || (payload + 4) > (data + length))
+         return FALSE;
+
+      //Check source and destination ports
+      if(LOAD16BE(payload) != filter->port &&
+         LOAD16BE(payload + 2) != filter->port)
+      {
+         return FALSE;
+      }
+   }
+
+   //The packet matches the filter
+   return TRUE;
+}
+
+
+/**
+ * @brief Export the contents of the capture ring as a pcapng stream
+ *
+ * The stream starts with a Section Header Block and one Interface Description
+ * Block per network interface, followed by one Enhanced Packet Block per
+ * captured packet. Exported packets are removed from the ring. The callback
+ * may block (socket, HTTP connection or file); the stack keeps running and
+ * capturing in the meantime. Only the records present when the export starts
+ * are written, so packets generated by the export itself (e.g. when the
+ * stream is sent over a socket) cannot keep it running forever. Only one
+ * export may be in progress at a time
+ *
+ * @param[in] callback Function used to write the stream
+ * @param[in] param Opaque parameter passed to the callback
+ * @return Error code
+ **/
+
+error_t netCaptureExport(NetCaptureWriteCallback callback, void *param)
+{
+   error_t error;
+   uint_t i;
+   size_t r;
+   size_t w;
+   uint16_t linkType;
+   uint64_t timestamp;
+   uint32_t block[8];
+   NetCaptureRecord *record;
+   NetCaptureContext *context;
+   NetInterface *interface;
+
+   //Check parameters
+   if(callback == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Point to the packet capture context
+   context = &netCaptureContext;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //The ring supports a single consumer
+   if(!context->exporting)
+   {
+      //Claim the consumer side of the ring
+      context->exporting = TRUE;
+      error = NO_ERROR;
+   }
+   else
+   {
+      //Another export is in progress
+      error = ERROR_ALREADY_RUNNING;
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Format Section Header Block
+   block[0] = PCAPNG_BLOCK_TYPE_SHB;
+   block[1] = 28;
+   block[2] = PCAPNG_BYTE_ORDER_MAGIC;
+   ((uint16_t *) &block[3])[0] = 1;
+   ((uint16_t *) &block[3])[1] = 0;
+   block[4] = 0xFFFFFFFF;
+   block[5] = 0xFFFFFFFF;
+   block[6] = 28;
+
+   //Write Section Header Block
+   error = callback(param, block, 28);
+
+   //Write one Interface Description Block per network interface
+   for(i = 0; i < NET_INTERFACE_COUNT && !error; i++)
+   {
+      //Point to the current network interface
+      interface = &netInterface[i];
+
+      //Select the link type that matches the interface
+      if(interface->nicDriver == NULL ||
+         interface->nicDriver->type == NIC_TYPE_ETHERNET)
+      {
+         linkType = PCAPNG_LINKTYPE_ETHERNET;
+      }
+      else if(interface->nicDriver->type == NIC_TYPE_PPP)
+      {
+         linkType = PCAPNG_LINKTYPE_PPP;
+      }
+      else
+      {
+         linkType = PCAPNG_LINKTYPE_RAW;
+      }
+
+      //Format Interface Description Block
+      block[0] = PCAPNG_BLOCK_TYPE_IDB;
+      block[1] = 32;
+      ((uint16_t *) &block[2])[0] = linkType;
+      ((uint16_t *) &block[2])[1] = 0;
+      block[3] = context->snapLen;
+
+      //The if_tsresol option indicates millisecond timestamps
+      ((uint16_t *) &block[4])[0] = 9;
+      ((uint16_t *) &block[4])[1] = 1;
+      block[5] = 0;
+      ((uint8_t *) &block[5])[0] = 3;
+
+      //End of options
+      block[6] = 0;
+      block[7] = 32;
+
+      //Write Interface Description Block
+      error = callback(param, block, 32);
+   }
+
+   //Retrieve the current position of the consumer and the producer
+   r = context->readIndex;
+   w = context->writeIndex;
+
+   //The records up to the write index are complete
+   netCaptureMemoryBarrier();
+
+   //Drain the records that were present when the export started
+   while(r != w && !error)
+   {
+      //Point to the current record
+      record = (NetCaptureRecord *) &context->buffer[r / 4];
+
+      //End of ring marker?
+      if(record->length == 0)
+      {
+         //Wrap around
+         r = 0;
+         netCaptureMemoryBarrier();
+         context->readIndex = r;
+         continue;
+      }
+
+      //Convert the system time to a millisecond Unix timestamp
+      timestamp = (uint64_t) context->startTime * 1000 +
+         (systime_t) (record->timestamp - context->startTimestamp);
+
+      //Format Enhanced Packet Block
+      block[0] = PCAPNG_BLOCK_TYPE_EPB;
+      block[1] = 32 + ((record->capLength + 3) & ~3U);
+      block[2] = record->interfaceIndex;
+      block[3] = (uint32_t) (timestamp >> 32);
+      block[4] = (uint32_t) timestamp;
+      block[5] = record->capLength;
+      block[6] = record->origLength;
+
+      //Write block header
+      error = callback(param, block, 28);
+
+      //Write packet data
+      if(!error && record->capLength > 0)
+      {
+         error = callback(param, (uint8_t *) record + sizeof(NetCaptureRecord),
+            record->capLength);
+      }
+
+      //Packet data must be padded to a 32-bit boundary
+      if(!error && (record->capLength & 3) != 0)
+      {
+         block[7] = 0;
+         error = callback(param, &block[7], 4 - (record->capLength & 3));
+      }
+
+      //Write trailing block length
+      if(!error)
+      {
+         error = callback(param, &block[1], 4);
+      }
+
+      //Advance the consumer position
+      r += record->length;
+
+      //Wrap around if necessary
+      if(r >= NET_CAPTURE_RING_SIZE)
+      {
+         r = 0;
+      }
+
+      //The record must have been read before the producer can reuse it
+      netCaptureMemoryBarrier();
+
+      //Release the record
+      context->readIndex = r;
+   }
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Release the consumer side of the ring
+   context->exporting = FALSE;
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Socket write callback
+ * @param[in] param Handle referencing the socket
+ * @param[in] data Pointer to the data to write
+ * @param[in] length Number of bytes to write
+ * @return Error code
+ **/
+
+static error_t netCaptureSocketWrite(void *param, const void *data,
+   size_t length)
+{
+   //Send data over the connection
+   return socketSend((Socket *) param, data, length, NULL, 0);
+}
+
+
+/**
+ * @brief Export the contents of the capture ring over a TCP connection
+ * @param[in] socket Handle referencing a connected socket
+ * @return Error code
+ **/
+
+error_t netCaptureExportToSocket(Socket *socket)
+{
+   //Make sure the socket handle is valid
+   if(socket == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Write the pcapng stream to the socket
+   return netCaptureExport(netCaptureSocketWrite, socket);
+}
+
+
+/**
+ * @brief Retrieve capture statistics
+ * @param[out] captured Number of packets captured
+ * @param[out] dropped Number of packets dropped because the ring was full
+ **/
+
+void netCaptureGetStats(uint32_t *captured, uint32_t *dropped)
+{
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Return the number of packets captured
+   if(captured != NULL)
+      *captured = netCaptureContext.captured;
+
+   //Return the number of packets dropped
+   if(dropped != NULL)
+      *dropped = netCaptureContext.dropped;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+}
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file net_capture.h
+ * @brief In-stack packet capture ring with pcapng export
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _NET_CAPTURE_H
+#define _NET_CAPTURE_H
+
+//Dependencies
+#include "core/net.h"
+#include "core/socket.h"
+
+//Size of the capture ring, in bytes
+#ifndef NET_CAPTURE_BUFFER_SIZE
+   #define NET_CAPTURE_BUFFER_SIZE 8192
+#elif (NET_CAPTURE_BUFFER_SIZE < 256)
+   #error NET_CAPTURE_BUFFER_SIZE parameter is not valid
+#endif
+
+//Default number of bytes captured from each packet
+#ifndef NET_CAPTURE_DEFAULT_SNAPLEN
+   #define NET_CAPTURE_DEFAULT_SNAPLEN 128
+#elif (NET_CAPTURE_DEFAULT_SNAPLEN < 14)
+   #error NET_CAPTURE_DEFAULT_SNAPLEN parameter is not valid
+#endif
+
+//Number of leading bytes inspected by the capture filter
+#ifndef NET_CAPTURE_FILTER_DEPTH
+   #define NET_CAPTURE_FILTER_DEPTH 96
+#elif (NET_CAPTURE_FILTER_DEPTH < 64)
+   #error NET_CAPTURE_FILTER_DEPTH parameter is not valid
+#endif
+
+//Memory barrier ordering the ring contents and the ring indices (the
+//consumer runs without the stack mutex, possibly on another core)
+#ifndef netCaptureMemoryBarrier
+   #if defined(__GNUC__)
+      #define netCaptureMemoryBarrier() __sync_synchronize()
+   #elif defined(_WIN32)
+      #define netCaptureMemoryBarrier() MemoryBarrier()
+   #else
+      #error netCaptureMemoryBarrier must be defined for this compiler
+   #endif
+#endif
+
+//pcapng block types
+#define PCAPNG_BLOCK_TYPE_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_TYPE_IDB 0x00000001
+#define PCAPNG_BLOCK_TYPE_EPB 0x00000006
+
+//pcapng byte-order magic
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+//pcapng link types
+#define PCAPNG_LINKTYPE_ETHERNET 1
+#define PCAPNG_LINKTYPE_PPP      9
+#define PCAPNG_LINKTYPE_RAW      101
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Packet direction
+ **/
+
+typedef enum
+{
+   NET_CAPTURE_DIR_RX = 1,
+   NET_CAPTURE_DIR_TX = 2
+} NetCaptureDirection;
+
+
+/**
+ * @brief Capture filter flags
+ **/
+
+typedef enum
+{
+   NET_CAPTURE_FILTER_PROTOCOL = 0x01,
+   NET_CAPTURE_FILTER_PORT     = 0x02,
+   NET_CAPTURE_FILTER_ADDR     = 0x04
+} NetCaptureFilterFlags;
+
+
+/**
+ * @brief Capture filter
+ *
+ * A packet is captured when every enabled criterion matches. Port and
+ * address criteria match either the source or the destination. Non-IP
+ * packets are captured only when no criterion is enabled
+ *
+ **/
+
+typedef struct
+{
+   uint_t flags;     ///<Enabled criteria
+   uint8_t protocol; ///<IP protocol number
+   uint16_t port;    ///<TCP or UDP port number
+   IpAddr ipAddr;    ///<IPv4 or IPv6 address
+} NetCaptureFilter;
+
+
+/**
+ * @brief Record stored in the capture ring
+ **/
+
+typedef struct
+{
+   uint32_t length;         ///<Length of the record, including padding (0 marks a wrap)
+   systime_t timestamp;     ///<Capture time
+   uint32_t origLength;     ///<Original length of the packet
+   uint16_t capLength;      ///<Number of bytes captured
+   uint8_t interfaceIndex;  ///<Index of the network interface
+   uint8_t direction;       ///<Packet direction
+} NetCaptureRecord;
+
+
+/**
+ * @brief Callback used to export the capture as a pcapng stream
+ **/
+
+typedef error_t (*NetCaptureWriteCallback)(void *param, const void *data,
+   size_t length);
+
+
+/**
+ * @brief Packet capture context
+ **/
+
+typedef struct
+{
+   bool_t running;                  ///<Capture is in progress
+   bool_t exporting;                ///<An export is draining the ring
+   NetCaptureFilter filter;         ///<Capture filter
+   size_t snapLen;                  ///<Maximum number of bytes captured from each packet
+   time_t startTime;                ///<Unix time at which the capture started
+   systime_t startTimestamp;        ///<System time at which the capture started
+   volatile size_t writeIndex;      ///<Producer position in the ring
+   volatile size_t readIndex;       ///<Consumer position in the ring
+   uint32_t captured;               ///<Number of packets captured
+   uint32_t dropped;                ///<Number of packets dropped because the ring was full
+   uint32_t buffer[NET_CAPTURE_BUFFER_SIZE / 4]; ///<Preallocated storage
+} NetCaptureContext;
+
+
+//Packet capture related functions
+error_t netCaptureStart(const NetCaptureFilter *filter, size_t snapLen);
+void netCaptureStop(void);
+
+void netCaptureRxPacket(NetInterface *interface, const uint8_t *packet,
+   size_t length);
+
+void netCaptureTxPacket(NetInterface *interface, const NetBuffer *buffer,
+   size_t offset);
+
+void netCaptureProcessPacket(NetInterface *interface,
+   NetCaptureDirection direction, const NetBuffer *buffer, size_t offset);
+
+bool_t netCaptureMatchFilter(NetInterface *interface, const uint8_t *data,
+   size_t length);
+
+error_t netCaptureExport(NetCaptureWriteCallback callback, void *param);
+error_t netCaptureExportToSocket(Socket *socket);
+
+void netCaptureGetStats(uint32_t *captured, uint32_t *dropped);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
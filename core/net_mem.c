@@ -48,16 +48,31 @@
 //Use fixed-size blocks allocation?
 #if (NET_MEM_POOL_SUPPORT == ENABLED)
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+//Each stack instance has its own memory pool
+static OsMutex memPoolMutexes[NET_MAX_INSTANCES];
+static uint32_t memPools[NET_MAX_INSTANCES][NET_MEM_POOL_BUFFER_COUNT][NET_MEM_POOL_BUFFER_SIZE / 4];
+static uint_t memPoolAllocTables[NET_MAX_INSTANCES][NET_MEM_POOL_BUFFER_COUNT];
+uint_t memPoolCurrentUsages[NET_MAX_INSTANCES];
+uint_t memPoolMaxUsages[NET_MAX_INSTANCES];
+
+#define memPoolMutex (memPoolMutexes[netContext.instance])
+#define memPool (memPools[netContext.instance])
+#define memPoolAllocTable (memPoolAllocTables[netContext.instance])
+#define memPoolCurrentUsage (memPoolCurrentUsages[netContext.instance])
+#define memPoolMaxUsage (memPoolMaxUsages[netContext.instance])
+#else
 //Mutex preventing simultaneous access to the memory pool
 static OsMutex memPoolMutex;
 //Memory pool
 static uint32_t memPool[NET_MEM_POOL_BUFFER_COUNT][NET_MEM_POOL_BUFFER_SIZE / 4];
-//Allocation table
-static bool_t memPoolAllocTable[NET_MEM_POOL_BUFFER_COUNT];
+//Allocation table (number of references to each block)
+static uint_t memPoolAllocTable[NET_MEM_POOL_BUFFER_COUNT];
 //Number of buffers currently allocated
 uint_t memPoolCurrentUsage;
 //Maximum number of buffers that have been allocated so far
 uint_t memPoolMaxUsage;
+#endif
 
 #endif
 
@@ -124,7 +139,7 @@ void *memPoolAlloc(size_t size)
          if(!memPoolAllocTable[i])
          {
             //Mark the current entry as used
-            memPoolAllocTable[i] = TRUE;
+            memPoolAllocTable[i] = 1;
             //Point to the corresponding memory block
             p = memPool[i];
 
@@ -177,11 +192,18 @@ void memPoolFree(void *p)
    {
       if(memPool[i] == p)
       {
-         //Mark the current block as free
-         memPoolAllocTable[i] = FALSE;
+         //Drop one reference to the block
+         if(memPoolAllocTable[i] > 0)
+         {
+            memPoolAllocTable[i]--;
+         }
 
-         //Update statistics
-         memPoolCurrentUsage--;
+         //The block is free once the last reference has been dropped
+         if(memPoolAllocTable[i] == 0)
+         {
+            //Update statistics
+            memPoolCurrentUsage--;
+         }
 
          //Exit immediately
          break;
@@ -197,6 +219,56 @@ void memPoolFree(void *p)
 }
 
 
+/**
+ * @brief Take an additional reference to a memory block
+ *
+ * The block is only returned to the pool once memPoolFree() has been called
+ * for every reference. This allows a NIC driver to keep transmitting from a
+ * block after the stack has released it
+ *
+ * @param[in] p Address located anywhere within the memory block
+ * @return Start of the memory block, or NULL if the address does not belong
+ *   to an allocated block of the memory pool
+ **/
+
+void *memPoolRef(const void *p)
+{
+   //Pointer to the memory block
+   void *block = NULL;
+
+//Use fixed-size blocks allocation?
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+   uint_t i;
+
+   //Acquire exclusive access to the memory pool
+   osAcquireMutex(&memPoolMutex);
+
+   //Check whether the address lies within the memory pool
+   if((const uint8_t *) p >= (uint8_t *) memPool &&
+      (const uint8_t *) p < (uint8_t *) memPool + sizeof(memPool))
+   {
+      //Index of the block that contains the address
+      i = ((const uint8_t *) p - (uint8_t *) memPool) / NET_MEM_POOL_BUFFER_SIZE;
+
+      //Make sure the block is currently allocated
+      if(memPoolAllocTable[i] > 0)
+      {
+         //Add a reference to the block
+         memPoolAllocTable[i]++;
+         //Point to the start of the block
+         block = memPool[i];
+      }
+   }
+
+   //Release exclusive access to the memory pool
+   osReleaseMutex(&memPoolMutex);
+#endif
+
+   //Return a pointer to the memory block
+   return block;
+}
+
+
 /**
  * @brief Get memory pool usage
  * @param[out] currentUsage Number of buffers currently allocated
@@ -105,6 +105,7 @@ typedef struct
 error_t memPoolInit(void);
 void *memPoolAlloc(size_t size);
 void memPoolFree(void *p);
+void *memPoolRef(const void *p);
 void memPoolGetStats(uint_t *currentUsage, uint_t *maxUsage, uint_t *size);
 
 NetBuffer *netBufferAlloc(size_t length);
@@ -35,6 +35,7 @@
 #include "core/net.h"
 #include "core/net_misc.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "core/raw_socket.h"
 #include "core/tcp_timer.h"
 #include "core/tcp_misc.h"
@@ -96,6 +97,10 @@ const NetTxAncillary NET_DEFAULT_TX_ANCILLARY =
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    -1,      //Unique identifier for hardware time stamping
 #endif
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   0,       //No checksum left to the NIC
+   0,       //Offset of the checksum field
+#endif
 };
 
 //Default options passed to the stack (RX path)
@@ -113,6 +118,9 @@ const NetRxAncillary NET_DEFAULT_RX_ANCILLARY =
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    {0},     //Captured time stamp
 #endif
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   0,       //No checksum verified by the NIC
+#endif
 };
 
 
@@ -317,7 +325,9 @@ void netProcessLinkChange(NetInterface *interface)
       //Connectionless socket?
       if(socket->type == SOCKET_TYPE_DGRAM)
       {
+         socketLockReceiveQueue(socket);
          udpUpdateEvents(socket);
+         socketUnlockReceiveQueue(socket);
       }
 #endif
 
@@ -326,7 +336,9 @@ void netProcessLinkChange(NetInterface *interface)
       if(socket->type == SOCKET_TYPE_RAW_IP ||
          socket->type == SOCKET_TYPE_RAW_ETH)
       {
+         socketLockReceiveQueue(socket);
          rawSocketUpdateEvents(socket);
+         socketUnlockReceiveQueue(socket);
       }
 #endif
    }
@@ -740,6 +752,52 @@ void netTick(void)
 }
 
 
+/**
+ * @brief Budgeted polling of the receive ring
+ *
+ * At most NET_RX_BUDGET frames are processed per call. Interrupts remain
+ * masked until the receive ring has been drained, so that a busy interface
+ * is polled again on the next pass of the TCP/IP task, after the other
+ * interfaces have been serviced, instead of raising one interrupt per frame
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void netPollInterface(NetInterface *interface)
+{
+   uint_t n;
+   error_t error;
+
+   //Interrupts remain masked while the receive ring is being polled
+   interface->nicDriver->disableIrq(interface);
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Process up to NET_RX_BUDGET frames
+   for(n = 0; n < NET_RX_BUDGET && error != ERROR_BUFFER_EMPTY; n++)
+   {
+      //Read incoming packet
+      error = interface->nicDriver->receivePacket(interface);
+   }
+
+   //Receive ring drained?
+   if(error == ERROR_BUFFER_EMPTY)
+   {
+      //Re-enable hardware interrupts
+      interface->nicDriver->enableIrq(interface);
+   }
+   else
+   {
+      //The budget is exhausted. Keep interrupts masked and poll the
+      //interface again once the other interfaces have been serviced
+      interface->nicEvent = TRUE;
+      //Notify the TCP/IP stack of the event
+      osSetEvent(&netEvent);
+   }
+}
+
+
 /**
  * @brief Start timer
  * @param[in] timer Pointer to the timer structure
@@ -97,6 +97,19 @@ typedef struct
 } NetTimerCallbackEntry;
 
 
+/**
+ * @brief Checksums handled by the NIC
+ **/
+
+typedef enum
+{
+   NET_CHECKSUM_NONE = 0x00,
+   NET_CHECKSUM_IPV4 = 0x01, ///<IPv4 header checksum
+   NET_CHECKSUM_TCP  = 0x02, ///<TCP checksum
+   NET_CHECKSUM_UDP  = 0x04  ///<UDP checksum
+} NetChecksumFlags;
+
+
 /**
  * @brief Timestamp
  **/
@@ -140,6 +153,10 @@ struct _NetTxAncillary
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    int32_t timestampId; ///<Unique identifier for hardware time stamping
 #endif
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   uint8_t checksumFlags;   ///<Checksums left to the NIC (see #NetChecksumFlags)
+   uint16_t checksumOffset; ///<Offset of the checksum field in the upper-layer header
+#endif
 };
 
 
@@ -161,6 +178,9 @@ struct _NetRxAncillary
 #if (ETH_TIMESTAMP_SUPPORT == ENABLED)
    NetTimestamp timestamp; ///<Captured time stamp
 #endif
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   uint8_t checksumFlags;  ///<Checksums verified by the NIC (see #NetChecksumFlags)
+#endif
 };
 
 
@@ -207,6 +227,8 @@ error_t netDetachTimerCallback(NetTimerCallback callback, void *param);
 
 void netTick(void);
 
+void netPollInterface(NetInterface *interface);
+
 void netStartTimer(NetTimer *timer, systime_t interval);
 void netStopTimer(NetTimer *timer);
 bool_t netTimerRunning(NetTimer *timer);
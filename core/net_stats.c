@@ -0,0 +1,383 @@
+/**
+ * @file net_stats.c
+ * @brief Stack-wide statistics and latency histograms
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/net_stats.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (NET_STATS_SUPPORT == ENABLED)
+
+//Stack-wide statistics
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+NetStats netStatsTable[NET_MAX_INSTANCES];
+#else
+NetStats netStats;
+#endif
+
+//Pending latency measurements
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static bool_t netStatsRxPendings[NET_MAX_INSTANCES];
+static uint32_t netStatsRxTimestamps[NET_MAX_INSTANCES];
+static bool_t netStatsTxPendings[NET_MAX_INSTANCES];
+static uint32_t netStatsTxTimestamps[NET_MAX_INSTANCES];
+#define netStatsRxPending (netStatsRxPendings[netContext.instance])
+#define netStatsRxTimestamp (netStatsRxTimestamps[netContext.instance])
+#define netStatsTxPending (netStatsTxPendings[netContext.instance])
+#define netStatsTxTimestamp (netStatsTxTimestamps[netContext.instance])
+#else
+static bool_t netStatsRxPending;
+static uint32_t netStatsRxTimestamp;
+static bool_t netStatsTxPending;
+static uint32_t netStatsTxTimestamp;
+#endif
+
+
+/**
+ * @brief Take a consistent snapshot of the statistics
+ * @param[out] stats Pointer to the structure that receives the snapshot
+ **/
+
+void netStatsGetSnapshot(NetStats *stats)
+{
+   //Check parameter
+   if(stats != NULL)
+   {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+      //Copy the counters and histograms
+      osMemcpy(stats, &netStats, sizeof(NetStats));
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
+   }
+}
+
+
+/**
+ * @brief Retrieve the statistics of a TCP socket
+ * @param[in] socket Handle to a socket
+ * @param[out] stats Pointer to the structure that receives the statistics
+ * @return Error code
+ **/
+
+error_t netStatsGetTcpSocketStats(Socket *socket, NetStatsTcpSocket *stats)
+{
+#if (TCP_SUPPORT == ENABLED)
+   //Check parameters
+   if(socket == NULL || stats == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the socket is a TCP socket
+   if(socket->type != SOCKET_TYPE_STREAM)
+      return ERROR_INVALID_SOCKET;
+
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+
+   //Per-socket event counters
+   stats->retransmits = socket->statsRetransmits;
+   stats->dupAcks = socket->statsDupAcks;
+   stats->zeroWindowEvents = socket->statsZeroWindows;
+
+   //Current RTT estimator state
+   stats->srtt = socket->srtt;
+   stats->rttvar = socket->rttvar;
+   stats->rto = socket->rto;
+
+#if (TCP_CONGEST_CONTROL_SUPPORT == ENABLED)
+   //Current congestion control state
+   stats->cwnd = socket->cwnd;
+   stats->ssthresh = socket->ssthresh;
+#else
+   //Congestion control is not implemented
+   stats->cwnd = 0;
+   stats->ssthresh = 0;
+#endif
+
+   //Current window sizes
+   stats->sndWnd = socket->sndWnd;
+   stats->rcvWnd = socket->rcvWnd;
+
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Clear all the stack-wide statistics
+ **/
+
+void netStatsReset(void)
+{
+   //Get exclusive access
+   osAcquireMutex(&netMutex);
+   //Clear counters and histograms
+   osMemset(&netStats, 0, sizeof(NetStats));
+   //Release exclusive access
+   osReleaseMutex(&netMutex);
+}
+
+
+/**
+ * @brief Account for an incoming packet
+ * @param[in] layer Protocol layer
+ * @param[in] length Length of the packet, in bytes
+ **/
+
+void netStatsUpdateRx(NetStatsLayer layer, size_t length)
+{
+   //Update per-layer counters
+   netStats.layer[layer].rxPackets++;
+   netStats.layer[layer].rxBytes += length;
+}
+
+
+/**
+ * @brief Account for an outgoing packet
+ * @param[in] layer Protocol layer
+ * @param[in] length Length of the packet, in bytes
+ **/
+
+void netStatsUpdateTx(NetStatsLayer layer, size_t length)
+{
+   //Update per-layer counters
+   netStats.layer[layer].txPackets++;
+   netStats.layer[layer].txBytes += length;
+}
+
+
+/**
+ * @brief Account for an incoming packet that has been dropped
+ * @param[in] layer Protocol layer
+ * @param[in] error Error code describing why the packet was dropped
+ **/
+
+void netStatsUpdateRxDrop(NetStatsLayer layer, error_t error)
+{
+   //Update the counter matching the drop reason
+   netStats.layer[layer].rxDrops[netStatsGetDropReason(error)]++;
+}
+
+
+/**
+ * @brief Account for an outgoing packet that has been dropped
+ * @param[in] layer Protocol layer
+ * @param[in] error Error code describing why the packet was dropped
+ **/
+
+void netStatsUpdateTxDrop(NetStatsLayer layer, error_t error)
+{
+   //Update the counter matching the drop reason
+   netStats.layer[layer].txDrops[netStatsGetDropReason(error)]++;
+}
+
+
+/**
+ * @brief Start measuring the delivery latency of an incoming packet
+ **/
+
+void netStatsStartRx(void)
+{
+   //Save the time at which the NIC handed over the packet
+   netStatsRxTimestamp = netStatsGetTimestamp();
+   netStatsRxPending = TRUE;
+}
+
+
+/**
+ * @brief The incoming packet has been delivered to a socket
+ **/
+
+void netStatsCompleteRx(void)
+{
+   //Any measurement in progress?
+   if(netStatsRxPending)
+   {
+      //Record the delay between reception and delivery
+      netStatsRecordSample(&netStats.rxLatency,
+         netStatsGetTimestamp() - netStatsRxTimestamp);
+
+      //A packet is accounted for only once
+      netStatsRxPending = FALSE;
+   }
+}
+
+
+/**
+ * @brief Abort the current delivery latency measurement
+ **/
+
+void netStatsStopRx(void)
+{
+   //The packet has been consumed without reaching any socket
+   netStatsRxPending = FALSE;
+}
+
+
+/**
+ * @brief Start measuring the transmission latency of an outgoing packet
+ **/
+
+void netStatsStartTx(void)
+{
+   //Save the time at which the application handed over the data
+   netStatsTxTimestamp = netStatsGetTimestamp();
+   netStatsTxPending = TRUE;
+}
+
+
+/**
+ * @brief The outgoing packet has been handed over to the NIC
+ **/
+
+void netStatsCompleteTx(void)
+{
+   //Any measurement in progress?
+   if(netStatsTxPending)
+   {
+      //Record the delay between the send call and the NIC
+      netStatsRecordSample(&netStats.txLatency,
+         netStatsGetTimestamp() - netStatsTxTimestamp);
+
+      //A send call is accounted for only once
+      netStatsTxPending = FALSE;
+   }
+}
+
+
+/**
+ * @brief Abort the current transmission latency measurement
+ **/
+
+void netStatsStopTx(void)
+{
+   //The data has been buffered without reaching the NIC
+   netStatsTxPending = FALSE;
+}
+
+
+/**
+ * @brief Add a sample to a log2 histogram
+ * @param[in] histogram Pointer to the histogram
+ * @param[in] value Sample value
+ **/
+
+void netStatsRecordSample(NetStatsHistogram *histogram, uint32_t value)
+{
+   uint_t i;
+   uint32_t n;
+
+   //Compute the index of the bucket (position of the most significant bit)
+   for(i = 0, n = value; n != 0 && i < (NET_STATS_HISTOGRAM_SIZE - 1); i++)
+   {
+      n >>= 1;
+   }
+
+   //Update histogram
+   histogram->bucket[i]++;
+   histogram->count++;
+   histogram->sum += value;
+
+   //Keep track of the largest sample
+   if(value > histogram->max)
+   {
+      histogram->max = value;
+   }
+}
+
+
+/**
+ * @brief Map an error code to a drop reason
+ * @param[in] error Error code
+ * @return Drop reason
+ **/
+
+NetStatsDropReason netStatsGetDropReason(error_t error)
+{
+   NetStatsDropReason reason;
+
+   //Check error code
+   switch(error)
+   {
+   case ERROR_INVALID_LENGTH:
+      reason = NET_STATS_DROP_TRUNCATED;
+      break;
+   case ERROR_INVALID_HEADER:
+   case ERROR_INVALID_PACKET:
+      reason = NET_STATS_DROP_INVALID_HEADER;
+      break;
+   case ERROR_WRONG_CHECKSUM:
+      reason = NET_STATS_DROP_WRONG_CHECKSUM;
+      break;
+   case ERROR_INVALID_ADDRESS:
+      reason = NET_STATS_DROP_INVALID_ADDRESS;
+      break;
+   case ERROR_PROTOCOL_UNREACHABLE:
+      reason = NET_STATS_DROP_PROTOCOL_UNREACHABLE;
+      break;
+   case ERROR_PORT_UNREACHABLE:
+   case ERROR_CONNECTION_RESET:
+      reason = NET_STATS_DROP_PORT_UNREACHABLE;
+      break;
+   case ERROR_RECEIVE_QUEUE_FULL:
+   case ERROR_BUFFER_OVERFLOW:
+   case ERROR_DEVICE_BUSY:
+      reason = NET_STATS_DROP_QUEUE_FULL;
+      break;
+   case ERROR_OUT_OF_MEMORY:
+      reason = NET_STATS_DROP_OUT_OF_MEMORY;
+      break;
+   case ERROR_NO_ROUTE:
+      reason = NET_STATS_DROP_NO_ROUTE;
+      break;
+   case ERROR_INVALID_INTERFACE:
+      reason = NET_STATS_DROP_INTERFACE_DOWN;
+      break;
+   default:
+      reason = NET_STATS_DROP_OTHER;
+      break;
+   }
+
+   //Return the drop reason
+   return reason;
+}
+
+#endif
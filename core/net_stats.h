@@ -0,0 +1,216 @@
+/**
+ * @file net_stats.h
+ * @brief Stack-wide statistics and latency histograms
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _NET_STATS_H
+#define _NET_STATS_H
+
+//Dependencies
+#include "core/net.h"
+#include "core/socket.h"
+
+//Number of buckets in latency histograms
+#ifndef NET_STATS_HISTOGRAM_SIZE
+   #define NET_STATS_HISTOGRAM_SIZE 24
+#elif (NET_STATS_HISTOGRAM_SIZE < 2 || NET_STATS_HISTOGRAM_SIZE > 32)
+   #error NET_STATS_HISTOGRAM_SIZE parameter is not valid
+#endif
+
+//Time source used to measure latencies
+#ifndef netStatsGetTimestamp
+   #define netStatsGetTimestamp() ((uint32_t) osGetSystemTime())
+#endif
+
+//Statistics related macros
+#if (NET_STATS_SUPPORT == ENABLED)
+   #define NET_STATS_RX(layer, length) netStatsUpdateRx(layer, length)
+   #define NET_STATS_TX(layer, length) netStatsUpdateTx(layer, length)
+   #define NET_STATS_RX_DROP(layer, error) netStatsUpdateRxDrop(layer, error)
+   #define NET_STATS_TX_DROP(layer, error) netStatsUpdateTxDrop(layer, error)
+   #define NET_STATS_TCP_INC_COUNTER(socket, name) (socket)->name++
+   #define NET_STATS_RX_START() netStatsStartRx()
+   #define NET_STATS_RX_COMPLETE() netStatsCompleteRx()
+   #define NET_STATS_RX_STOP() netStatsStopRx()
+   #define NET_STATS_TX_START() netStatsStartTx()
+   #define NET_STATS_TX_COMPLETE() netStatsCompleteTx()
+   #define NET_STATS_TX_STOP() netStatsStopTx()
+#else
+   #define NET_STATS_RX(layer, length)
+   #define NET_STATS_TX(layer, length)
+   #define NET_STATS_RX_DROP(layer, error)
+   #define NET_STATS_TX_DROP(layer, error)
+   #define NET_STATS_TCP_INC_COUNTER(socket, name)
+   #define NET_STATS_RX_START()
+   #define NET_STATS_RX_COMPLETE()
+   #define NET_STATS_RX_STOP()
+   #define NET_STATS_TX_START()
+   #define NET_STATS_TX_COMPLETE()
+   #define NET_STATS_TX_STOP()
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @brief Protocol layers
+ **/
+
+typedef enum
+{
+   NET_STATS_LAYER_NIC   = 0,
+   NET_STATS_LAYER_IPV4  = 1,
+   NET_STATS_LAYER_IPV6  = 2,
+   NET_STATS_LAYER_UDP   = 3,
+   NET_STATS_LAYER_TCP   = 4,
+   NET_STATS_LAYER_COUNT = 5
+} NetStatsLayer;
+
+
+/**
+ * @brief Drop reasons
+ **/
+
+typedef enum
+{
+   NET_STATS_DROP_OTHER                = 0,
+   NET_STATS_DROP_TRUNCATED            = 1,
+   NET_STATS_DROP_INVALID_HEADER       = 2,
+   NET_STATS_DROP_WRONG_CHECKSUM       = 3,
+   NET_STATS_DROP_INVALID_ADDRESS      = 4,
+   NET_STATS_DROP_PROTOCOL_UNREACHABLE = 5,
+   NET_STATS_DROP_PORT_UNREACHABLE     = 6,
+   NET_STATS_DROP_QUEUE_FULL           = 7,
+   NET_STATS_DROP_OUT_OF_MEMORY        = 8,
+   NET_STATS_DROP_NO_ROUTE             = 9,
+   NET_STATS_DROP_INTERFACE_DOWN       = 10,
+   NET_STATS_DROP_REASON_COUNT         = 11
+} NetStatsDropReason;
+
+
+/**
+ * @brief Per-layer counters
+ **/
+
+typedef struct
+{
+   uint32_t rxPackets;                             ///<Number of packets received
+   uint64_t rxBytes;                               ///<Number of bytes received
+   uint32_t txPackets;                             ///<Number of packets sent
+   uint64_t txBytes;                               ///<Number of bytes sent
+   uint32_t rxDrops[NET_STATS_DROP_REASON_COUNT];  ///<Inbound packets dropped, by reason
+   uint32_t txDrops[NET_STATS_DROP_REASON_COUNT];  ///<Outbound packets dropped, by reason
+} NetStatsLayerCounters;
+
+
+/**
+ * @brief Log2 latency histogram
+ *
+ * Bucket 0 counts zero-duration samples. Bucket n (n >= 1) counts samples
+ * in the range [2^(n-1), 2^n), the last bucket collecting all larger values
+ *
+ **/
+
+typedef struct
+{
+   uint32_t count;                           ///<Number of samples
+   uint32_t max;                             ///<Largest sample
+   uint64_t sum;                             ///<Sum of all samples
+   uint32_t bucket[NET_STATS_HISTOGRAM_SIZE]; ///<Histogram buckets
+} NetStatsHistogram;
+
+
+/**
+ * @brief Stack-wide statistics
+ **/
+
+typedef struct
+{
+   NetStatsLayerCounters layer[NET_STATS_LAYER_COUNT]; ///<Per-layer counters
+   NetStatsHistogram rxLatency;                        ///<Delay between NIC reception and socket delivery
+   NetStatsHistogram txLatency;                        ///<Delay between socket send and NIC transmission
+   NetStatsHistogram taskLatency;                      ///<Duration of the TCP/IP task iterations
+} NetStats;
+
+
+/**
+ * @brief Per-socket TCP statistics
+ **/
+
+typedef struct
+{
+   uint32_t retransmits;      ///<Number of segments retransmitted
+   uint32_t dupAcks;          ///<Number of duplicate ACKs received
+   uint32_t zeroWindowEvents; ///<Number of times the peer advertised a zero window
+   uint32_t srtt;             ///<Smoothed round-trip time
+   uint32_t rttvar;           ///<Round-trip time variation
+   uint32_t rto;              ///<Retransmission timeout
+   uint32_t cwnd;             ///<Congestion window
+   uint32_t ssthresh;         ///<Slow start threshold
+   uint32_t sndWnd;           ///<Send window advertised by the peer
+   uint32_t rcvWnd;           ///<Receive window
+} NetStatsTcpSocket;
+
+
+//Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern NetStats netStatsTable[NET_MAX_INSTANCES];
+#define netStats (netStatsTable[netContext.instance])
+#else
+extern NetStats netStats;
+#endif
+
+//Statistics related functions
+void netStatsGetSnapshot(NetStats *stats);
+error_t netStatsGetTcpSocketStats(Socket *socket, NetStatsTcpSocket *stats);
+void netStatsReset(void);
+
+void netStatsUpdateRx(NetStatsLayer layer, size_t length);
+void netStatsUpdateTx(NetStatsLayer layer, size_t length);
+void netStatsUpdateRxDrop(NetStatsLayer layer, error_t error);
+void netStatsUpdateTxDrop(NetStatsLayer layer, error_t error);
+
+void netStatsStartRx(void);
+void netStatsCompleteRx(void);
+void netStatsStopRx(void);
+void netStatsStartTx(void);
+void netStatsCompleteTx(void);
+void netStatsStopTx(void);
+
+void netStatsRecordSample(NetStatsHistogram *histogram, uint32_t value);
+NetStatsDropReason netStatsGetDropReason(error_t error);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,13 +34,19 @@
 //Dependencies
 #include "core/net.h"
 #include "core/nic.h"
+#include "core/net_stats.h"
+#include "core/net_capture.h"
 #include "core/ethernet.h"
 #include "ipv4/ipv4.h"
 #include "ipv6/ipv6.h"
 #include "debug.h"
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t nicTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t nicTickCounter;
+#endif
 
 
 /**
@@ -282,6 +288,11 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
 {
    error_t error;
    bool_t status;
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+   uint_t chunkCount;
+   NicTxRequest *request;
+   NicTxChunk chunks[NIC_MAX_TX_CHUNKS];
+#endif
 
 #if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
    //Retrieve the length of the packet
@@ -313,22 +324,77 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
       //Check whether the specified event is in signaled state
       if(status)
       {
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+         //Capture the outgoing packet
+         netCaptureTxPacket(interface, buffer, offset);
+#endif
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+         //Check whether the driver is able to gather the chunks by itself
+         if(interface->nicDriver->sendChunks != NULL)
+         {
+            //Describe the packet as a list of chunks the driver can keep
+            //referencing after this function returns
+            request = nicPrepareTxRequest(interface, buffer, offset, chunks,
+               &chunkCount);
+         }
+         else
+         {
+            //The driver only supports the copy path
+            request = NULL;
+         }
+#endif
+
          //Disable interrupts
          interface->nicDriver->disableIrq(interface);
 
-         //Send the packet
-         error = interface->nicDriver->sendPacket(interface, buffer, offset,
-            ancillary);
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+         //Scatter-gather transmission?
+         if(request != NULL)
+         {
+            //Hand the chunk list over to the driver. The memory blocks are
+            //released by the TCP/IP stack task once the driver has invoked
+            //the completion callback
+            error = interface->nicDriver->sendChunks(interface, chunks,
+               chunkCount, ancillary, nicTxComplete, request);
+
+            //The driver does not reference the chunks of a rejected packet
+            if(error)
+            {
+               request->complete = TRUE;
+            }
+         }
+         else
+#endif
+         {
+            //Send the packet
+            error = interface->nicDriver->sendPacket(interface, buffer, offset,
+               ancillary);
+         }
 
          //Re-enable interrupts if necessary
          if(interface->configured)
          {
             interface->nicDriver->enableIrq(interface);
          }
+
+         //Check status code
+         if(!error)
+         {
+            //Update statistics
+            NET_STATS_TX(NET_STATS_LAYER_NIC, netBufferGetLength(buffer) - offset);
+            NET_STATS_TX_COMPLETE();
+         }
+         else
+         {
+            //The packet has been rejected by the driver
+            NET_STATS_TX_DROP(NET_STATS_LAYER_NIC, error);
+         }
       }
       else
       {
          //If the transmitter is busy, then drop the packet
+         NET_STATS_TX_DROP(NET_STATS_LAYER_NIC, ERROR_DEVICE_BUSY);
          error = NO_ERROR;
       }
    }
@@ -336,6 +402,8 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
    {
       //Report an error
       error = ERROR_INVALID_INTERFACE;
+      //Update statistics
+      NET_STATS_TX_DROP(NET_STATS_LAYER_NIC, error);
    }
 
    //Return status code
@@ -343,6 +411,233 @@ error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
 }
 
 
+/**
+ * @brief Describe a multi-part buffer as a list of contiguous chunks
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[out] chunks Array where to store the chunk descriptors
+ * @param[in] maxChunks Maximum number of entries the array can hold
+ * @return Number of chunks (0 if the packet cannot be described within the
+ *   specified limit)
+ **/
+
+uint_t nicGetTxChunks(const NetBuffer *buffer, size_t offset,
+   NicTxChunk *chunks, uint_t maxChunks)
+{
+   uint_t i;
+   uint_t n;
+
+   //Number of chunks
+   n = 0;
+
+   //Loop through data chunks
+   for(i = 0; i < buffer->chunkCount; i++)
+   {
+      //Skip the beginning of the buffer
+      if(offset >= buffer->chunk[i].length)
+      {
+         //Move to the next chunk
+         offset -= buffer->chunk[i].length;
+      }
+      else
+      {
+         //Make sure the array is large enough
+         if(n >= maxChunks)
+            return 0;
+
+         //Save the location and the length of the current chunk
+         chunks[n].address = (uint8_t *) buffer->chunk[i].address + offset;
+         chunks[n].length = buffer->chunk[i].length - offset;
+
+         //Process the next chunk from its beginning
+         offset = 0;
+         n++;
+      }
+   }
+
+   //Return the number of chunks
+   return n;
+}
+
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+
+/**
+ * @brief Prepare a scatter-gather transmission
+ *
+ * The caller may rewrite or release the buffer as soon as nicSendPacket()
+ * returns. The bytes stored in the memory block of the buffer itself (the
+ * protocol headers) are copied to a staging block, and a reference is taken
+ * to the memory blocks holding the other chunks
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[out] chunks Array where to store the chunk descriptors
+ * @param[out] chunkCount Number of chunks
+ * @return Pointer to the request, or NULL if the packet must be sent
+ *   through the copy path
+ **/
+
+NicTxRequest *nicPrepareTxRequest(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NicTxChunk *chunks,
+   uint_t *chunkCount)
+{
+   uint_t i;
+   uint_t n;
+   size_t stagedLength;
+   uint8_t *p;
+   uint8_t *staging;
+   NicTxRequest *request;
+
+   //Describe the packet as a list of contiguous memory regions
+   n = nicGetTxChunks(buffer, offset, chunks, NIC_MAX_TX_CHUNKS);
+   //Too many chunks?
+   if(n == 0)
+      return NULL;
+
+   //Loop through the requests
+   for(request = NULL, i = 0; i < NIC_TX_REQUEST_COUNT; i++)
+   {
+      //Check whether the current entry is free
+      if(!interface->txRequests[i].used)
+      {
+         request = &interface->txRequests[i];
+         break;
+      }
+   }
+
+   //Too many transmissions in flight?
+   if(request == NULL)
+      return NULL;
+
+   //Allocate a staging block for the headers
+   staging = memPoolAlloc(NET_MEM_POOL_BUFFER_SIZE);
+   //Failed to allocate memory?
+   if(staging == NULL)
+      return NULL;
+
+   //The staging block is released on completion
+   request->blocks[0] = staging;
+   request->blockCount = 1;
+   stagedLength = 0;
+
+   //Loop through the chunks
+   for(i = 0; i < n; i++)
+   {
+      //Point to the data
+      p = (uint8_t *) chunks[i].address;
+
+      //Chunk located in the memory block of the buffer itself?
+      if(p >= (uint8_t *) buffer &&
+         p < (uint8_t *) buffer + NET_MEM_POOL_BUFFER_SIZE)
+      {
+         //Make sure the staging block is large enough
+         if((stagedLength + chunks[i].length) > NET_MEM_POOL_BUFFER_SIZE)
+            break;
+
+         //Copy the data to the staging block
+         osMemcpy(staging + stagedLength, p, chunks[i].length);
+         //Transmit from the staging block
+         chunks[i].address = staging + stagedLength;
+         stagedLength += chunks[i].length;
+      }
+      else
+      {
+         //Keep the underlying memory block until the transmission completes
+         p = memPoolRef(p);
+         //The chunk does not belong to the memory pool?
+         if(p == NULL)
+            break;
+
+         //Save the reference
+         request->blocks[request->blockCount++] = p;
+      }
+   }
+
+   //Failed to reference all the chunks?
+   if(i < n)
+   {
+      //Release the memory blocks held so far
+      for(i = 0; i < request->blockCount; i++)
+      {
+         memPoolFree(request->blocks[i]);
+      }
+
+      //Fall back to the copy path
+      request->blockCount = 0;
+      return NULL;
+   }
+
+   //The request is now in flight
+   request->complete = FALSE;
+   request->used = TRUE;
+
+   //Return the number of chunks
+   *chunkCount = n;
+   //Return a pointer to the request
+   return request;
+}
+
+
+/**
+ * @brief Completion callback used by nicSendPacket
+ *
+ * The callback may be invoked from interrupt context. It only flags the
+ * request, the memory blocks are released by nicReleaseTxRequests()
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] param Pointer to the request
+ **/
+
+void nicTxComplete(NetInterface *interface, void *param)
+{
+   //The driver no longer references the chunks
+   ((NicTxRequest *) param)->complete = TRUE;
+}
+
+
+/**
+ * @brief Release the memory blocks of completed transmissions
+ *
+ * This function is called by the TCP/IP stack task without holding netMutex.
+ * The memory pool has its own lock
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void nicReleaseTxRequests(NetInterface *interface)
+{
+   uint_t i;
+   uint_t j;
+   NicTxRequest *request;
+
+   //Loop through the requests
+   for(i = 0; i < NIC_TX_REQUEST_COUNT; i++)
+   {
+      //Point to the current request
+      request = &interface->txRequests[i];
+
+      //Completed transmission?
+      if(request->used && request->complete)
+      {
+         //Drop the references to the memory blocks
+         for(j = 0; j < request->blockCount; j++)
+         {
+            memPoolFree(request->blocks[j]);
+         }
+
+         //The entry can be reused
+         request->blockCount = 0;
+         request->complete = FALSE;
+         request->used = FALSE;
+      }
+   }
+}
+
+#endif
+
+
 /**
  * @brief Configure MAC address filtering
  * @param[in] interface Underlying network interface
@@ -406,9 +701,24 @@ void nicProcessPacket(NetInterface *interface, uint8_t *packet, size_t length,
       TRACE_DEBUG("Packet received (%" PRIuSIZE " bytes)...\r\n", length);
       TRACE_DEBUG_ARRAY("  ", packet, length);
 
+      //Update statistics
+      NET_STATS_RX(NET_STATS_LAYER_NIC, length);
+      //Start measuring the delivery latency
+      NET_STATS_RX_START();
+
+#if (NET_CAPTURE_SUPPORT == ENABLED)
+      //Capture the incoming packet
+      netCaptureRxPacket(interface, packet, length);
+#endif
+
       //Retrieve network interface type
       type = interface->nicDriver->type;
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+      //Only trust the checksums the NIC driver claims to verify
+      ancillary->checksumFlags &= interface->nicDriver->rxChecksumOffload;
+#endif
+
 #if (ETH_SUPPORT == ENABLED)
       //Ethernet interface?
       if(type == NIC_TYPE_ETHERNET)
@@ -524,6 +834,9 @@ void nicProcessPacket(NetInterface *interface, uint8_t *packet, size_t length,
          //Silently discard the received packet
       }
 
+      //The packet has been fully processed
+      NET_STATS_RX_STOP();
+
       //Disable interrupts
       interface->nicDriver->disableIrq(interface);
    }
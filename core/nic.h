@@ -48,6 +48,20 @@
    #error NIC_MAX_BLOCKING_TIME parameter is not valid
 #endif
 
+//Maximum number of chunks passed to scatter-gather capable drivers
+#ifndef NIC_MAX_TX_CHUNKS
+   #define NIC_MAX_TX_CHUNKS 8
+#elif (NIC_MAX_TX_CHUNKS < 1)
+   #error NIC_MAX_TX_CHUNKS parameter is not valid
+#endif
+
+//Number of scatter-gather transmissions in flight per interface
+#ifndef NIC_TX_REQUEST_COUNT
+   #define NIC_TX_REQUEST_COUNT 4
+#elif (NIC_TX_REQUEST_COUNT < 1)
+   #error NIC_TX_REQUEST_COUNT parameter is not valid
+#endif
+
 //Size of the NIC driver context
 #ifndef NIC_CONTEXT_SIZE
    #define NIC_CONTEXT_SIZE 16
@@ -165,6 +179,30 @@ typedef struct
 } SwitchVlanEntry;
 
 
+/**
+ * @brief Transmit chunk
+ **/
+
+typedef struct
+{
+   const void *address; ///<Start of the chunk
+   size_t length;       ///<Length of the chunk, in bytes
+} NicTxChunk;
+
+
+/**
+ * @brief Scatter-gather transmission in flight
+ **/
+
+typedef struct
+{
+   volatile bool_t used;                ///<The entry is in use
+   volatile bool_t complete;            ///<The driver no longer references the chunks
+   uint_t blockCount;                   ///<Number of memory blocks held by the request
+   void *blocks[NIC_MAX_TX_CHUNKS + 1]; ///<Memory blocks released on completion
+} NicTxRequest;
+
+
 //NIC driver abstraction layer
 typedef error_t (*NicInit)(NetInterface *interface);
 typedef void (*NicTick)(NetInterface *interface);
@@ -178,6 +216,14 @@ typedef error_t (*NicSendPacket)(NetInterface *interface,
 typedef error_t (*NicUpdateMacAddrFilter)(NetInterface *interface);
 typedef error_t (*NicUpdateMacConfig)(NetInterface *interface);
 
+typedef error_t (*NicReceivePacket)(NetInterface *interface);
+
+typedef void (*NicTxCompleteCallback)(NetInterface *interface, void *param);
+
+typedef error_t (*NicSendChunks)(NetInterface *interface,
+   const NicTxChunk *chunks, uint_t count, NetTxAncillary *ancillary,
+   NicTxCompleteCallback callback, void *param);
+
 typedef void (*NicWritePhyReg)(uint8_t opcode, uint8_t phyAddr,
    uint8_t regAddr, uint16_t data);
 
@@ -295,6 +341,10 @@ typedef struct
    bool_t autoCrcCalc;
    bool_t autoCrcVerif;
    bool_t autoCrcStrip;
+   NicReceivePacket receivePacket;
+   NicSendChunks sendChunks;
+   uint8_t txChecksumOffload;
+   uint8_t rxChecksumOffload;
 } NicDriver;
 
 
@@ -397,7 +447,12 @@ typedef struct
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t nicTickCounters[NET_MAX_INSTANCES];
+#define nicTickCounter (nicTickCounters[netContext.instance])
+#else
 extern systime_t nicTickCounter;
+#endif
 
 //NIC abstraction layer
 NetInterface *nicGetLogicalInterface(NetInterface *interface);
@@ -413,6 +468,20 @@ void nicTick(NetInterface *interface);
 error_t nicSendPacket(NetInterface *interface, const NetBuffer *buffer,
    size_t offset, NetTxAncillary *ancillary);
 
+uint_t nicGetTxChunks(const NetBuffer *buffer, size_t offset,
+   NicTxChunk *chunks, uint_t maxChunks);
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+
+NicTxRequest *nicPrepareTxRequest(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NicTxChunk *chunks,
+   uint_t *chunkCount);
+
+void nicTxComplete(NetInterface *interface, void *param);
+void nicReleaseTxRequests(NetInterface *interface);
+
+#endif
+
 error_t nicUpdateMacAddrFilter(NetInterface *interface);
 
 void nicProcessPacket(NetInterface *interface, uint8_t *packet, size_t length,
@@ -40,12 +40,14 @@
 #include <string.h>
 #include "core/net.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "core/raw_socket.h"
 #include "core/ethernet_misc.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
 #include "ipv6/ipv6.h"
 #include "ipv6/ipv6_misc.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/if_mib_module.h"
 #include "debug.h"
@@ -169,6 +171,9 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
    if(i >= SOCKET_MAX_COUNT)
       return ERROR_PROTOCOL_UNREACHABLE;
 
+   //Get exclusive access to the receive queue
+   socketLockReceiveQueue(socket);
+
    //Empty receive queue?
    if(socket->receiveQueue == NULL)
    {
@@ -209,6 +214,9 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
          MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
          IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
 
+         //Release exclusive access to the receive queue
+         socketUnlockReceiveQueue(socket);
+
          //Report an error
          return ERROR_RECEIVE_QUEUE_FULL;
       }
@@ -240,6 +248,9 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
       MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
       IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
 
+      //Release exclusive access to the receive queue
+      socketUnlockReceiveQueue(socket);
+
       //Report an error
       return ERROR_OUT_OF_MEMORY;
    }
@@ -289,6 +300,12 @@ error_t rawSocketProcessIpPacket(NetInterface *interface,
    //Notify user that data is available
    rawSocketUpdateEvents(socket);
 
+   //Release exclusive access to the receive queue
+   socketUnlockReceiveQueue(socket);
+
+   //The packet has been delivered to the socket
+   NET_STATS_RX_COMPLETE();
+
    //Successful processing
    return NO_ERROR;
 }
@@ -351,6 +368,9 @@ void rawSocketProcessEthPacket(NetInterface *interface, EthHeader *header,
    if(i >= SOCKET_MAX_COUNT)
       return;
 
+   //Get exclusive access to the receive queue
+   socketLockReceiveQueue(socket);
+
    //Empty receive queue?
    if(socket->receiveQueue == NULL)
    {
@@ -391,6 +411,9 @@ void rawSocketProcessEthPacket(NetInterface *interface, EthHeader *header,
          MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
          IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
 
+         //Release exclusive access to the receive queue
+         socketUnlockReceiveQueue(socket);
+
          //Exit immediately
          return;
       }
@@ -422,6 +445,9 @@ void rawSocketProcessEthPacket(NetInterface *interface, EthHeader *header,
       MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
       IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
 
+      //Release exclusive access to the receive queue
+      socketUnlockReceiveQueue(socket);
+
       //Exit immediately
       return;
    }
@@ -447,6 +473,12 @@ void rawSocketProcessEthPacket(NetInterface *interface, EthHeader *header,
 
    //Notify user that data is available
    rawSocketUpdateEvents(socket);
+
+   //Release exclusive access to the receive queue
+   socketUnlockReceiveQueue(socket);
+
+   //The frame has been delivered to the socket
+   NET_STATS_RX_COMPLETE();
 }
 
 
@@ -742,11 +774,11 @@ error_t rawSocketReceiveIpPacket(Socket *socket, SocketMsg *message,
          osResetEvent(&socket->event);
 
          //Release exclusive access
-         osReleaseMutex(&netMutex);
+         socketReleaseRxAccess(socket);
          //Wait until an event is triggered
          osWaitForEvent(&socket->event, socket->timeout);
          //Get exclusive access
-         osAcquireMutex(&netMutex);
+         socketAcquireRxAccess(socket);
       }
    }
 
@@ -846,11 +878,11 @@ error_t rawSocketReceiveEthPacket(Socket *socket, SocketMsg *message,
          osResetEvent(&socket->event);
 
          //Release exclusive access
-         osReleaseMutex(&netMutex);
+         socketReleaseRxAccess(socket);
          //Wait until an event is triggered
          osWaitForEvent(&socket->event, socket->timeout);
          //Get exclusive access
-         osAcquireMutex(&netMutex);
+         socketAcquireRxAccess(socket);
       }
    }
 
@@ -40,6 +40,7 @@
 #include "core/udp.h"
 #include "core/tcp.h"
 #include "core/tcp_misc.h"
+#include "core/net_stats.h"
 #include "dns/dns_client.h"
 #include "mdns/mdns_client.h"
 #include "netbios/nbns_client.h"
@@ -47,7 +48,11 @@
 #include "debug.h"
 
 //Socket table
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+Socket socketTables[NET_MAX_INSTANCES][SOCKET_MAX_COUNT];
+#else
 Socket socketTable[SOCKET_MAX_COUNT];
+#endif
 
 //Default socket message
 const SocketMsg SOCKET_DEFAULT_MSG =
@@ -100,11 +105,34 @@ error_t socketInit(void)
       {
          //Clean up side effects
          for(j = 0; j < i; j++)
+         {
             osDeleteEvent(&socketTable[j].event);
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+            osDeleteMutex(&socketTable[j].mutex);
+#endif
+         }
+
+         //Report an error
+         return ERROR_OUT_OF_RESOURCES;
+      }
+
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+      //Create a mutex to protect the receive queue
+      if(!osCreateMutex(&socketTable[i].mutex))
+      {
+         //Clean up side effects
+         osDeleteEvent(&socketTable[i].event);
+
+         for(j = 0; j < i; j++)
+         {
+            osDeleteEvent(&socketTable[j].event);
+            osDeleteMutex(&socketTable[j].mutex);
+         }
 
          //Report an error
          return ERROR_OUT_OF_RESOURCES;
       }
+#endif
    }
 
    //Successful initialization
@@ -148,6 +176,9 @@ error_t socketSetTimeout(Socket *socket, systime_t timeout)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
    //Record timeout value
@@ -173,6 +204,9 @@ error_t socketSetTtl(Socket *socket, uint8_t ttl)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
    //Set TTL value
@@ -198,6 +232,9 @@ error_t socketSetMulticastTtl(Socket *socket, uint8_t ttl)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
    //Set TTL value
@@ -224,6 +261,9 @@ error_t socketSetDscp(Socket *socket, uint8_t dscp)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //The DSCP field is 6 bits wide
    if(dscp >= 64)
       return ERROR_INVALID_PARAMETER;
@@ -258,6 +298,9 @@ error_t socketSetVlanPcp(Socket *socket, uint8_t pcp)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //The PCP field is 3 bits wide
    if(pcp >= 8)
       return ERROR_INVALID_PARAMETER;
@@ -295,6 +338,9 @@ error_t socketSetVlanDei(Socket *socket, bool_t dei)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -328,6 +374,9 @@ error_t socketSetVmanPcp(Socket *socket, uint8_t pcp)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //The PCP field is 3 bits wide
    if(pcp >= 8)
       return ERROR_INVALID_PARAMETER;
@@ -365,6 +414,9 @@ error_t socketSetVmanDei(Socket *socket, bool_t dei)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -398,6 +450,9 @@ error_t socketEnableKeepAlive(Socket *socket, bool_t enabled)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -450,6 +505,9 @@ error_t socketSetKeepAliveParams(Socket *socket, systime_t idle,
       return ERROR_INVALID_PARAMETER;
    }
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -488,6 +546,9 @@ error_t socketSetTxBufferSize(Socket *socket, size_t size)
    //Make sure the socket handle is valid
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
+
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
    //Check parameter value
    if(size < 1 || size > TCP_MAX_TX_BUFFER_SIZE)
       return ERROR_INVALID_PARAMETER;
@@ -522,6 +583,9 @@ error_t socketSetRxBufferSize(Socket *socket, size_t size)
    //Make sure the socket handle is valid
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
+
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
    //Check parameter value
    if(size < 1 || size > TCP_MAX_RX_BUFFER_SIZE)
       return ERROR_INVALID_PARAMETER;
@@ -556,6 +620,9 @@ error_t socketSetInterface(Socket *socket, NetInterface *interface)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Explicitly associate the socket with the specified interface
    socket->interface = interface;
 
@@ -628,6 +695,9 @@ error_t socketConnect(Socket *socket, const IpAddr *remoteIpAddr, uint16_t remot
    if(socket == NULL || remoteIpAddr == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
 #if (TCP_SUPPORT == ENABLED)
    //Connection-oriented socket?
    if(socket->type == SOCKET_TYPE_STREAM)
@@ -691,6 +761,9 @@ error_t socketListen(Socket *socket, uint_t backlog)
    //Make sure the socket handle is valid
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
+
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
    //This function shall be used with connection-oriented socket types
    if(socket->type != SOCKET_TYPE_STREAM)
       return ERROR_INVALID_SOCKET;
@@ -728,6 +801,9 @@ Socket *socketAccept(Socket *socket, IpAddr *clientIpAddr, uint16_t *clientPort)
    //Make sure the socket handle is valid
    if(socket == NULL)
       return NULL;
+
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
    //This function shall be used with connection-oriented socket types
    if(socket->type != SOCKET_TYPE_STREAM)
       return NULL;
@@ -787,9 +863,15 @@ error_t socketSendTo(Socket *socket, const IpAddr *destIpAddr, uint16_t destPort
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
+   //Start measuring the transmission latency
+   NET_STATS_TX_START();
+
 #if (TCP_SUPPORT == ENABLED)
    //Connection-oriented socket?
    if(socket->type == SOCKET_TYPE_STREAM)
@@ -885,6 +967,9 @@ error_t socketSendTo(Socket *socket, const IpAddr *destIpAddr, uint16_t destPort
       }
    }
 
+   //Stop measuring the transmission latency
+   NET_STATS_TX_STOP();
+
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -909,9 +994,15 @@ error_t socketSendMsg(Socket *socket, const SocketMsg *message, uint_t flags)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
+   //Start measuring the transmission latency
+   NET_STATS_TX_START();
+
 #if (UDP_SUPPORT == ENABLED)
    //Connectionless socket?
    if(socket->type == SOCKET_TYPE_DGRAM)
@@ -941,6 +1032,9 @@ error_t socketSendMsg(Socket *socket, const SocketMsg *message, uint_t flags)
       error = ERROR_INVALID_SOCKET;
    }
 
+   //Stop measuring the transmission latency
+   NET_STATS_TX_STOP();
+
    //Release exclusive access
    osReleaseMutex(&netMutex);
 
@@ -1016,13 +1110,16 @@ error_t socketReceiveEx(Socket *socket, IpAddr *srcIpAddr, uint16_t *srcPort,
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
-   //Get exclusive access
-   osAcquireMutex(&netMutex);
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
 
 #if (TCP_SUPPORT == ENABLED)
    //Connection-oriented socket?
    if(socket->type == SOCKET_TYPE_STREAM)
    {
+      //Get exclusive access
+      osAcquireMutex(&netMutex);
+
       //Receive data
       error = tcpReceive(socket, data, size, received, flags);
 
@@ -1043,6 +1140,9 @@ error_t socketReceiveEx(Socket *socket, IpAddr *srcIpAddr, uint16_t *srcPort,
       {
          *destIpAddr = socket->localIpAddr;
       }
+
+      //Release exclusive access
+      osReleaseMutex(&netMutex);
    }
    else
 #endif
@@ -1052,6 +1152,9 @@ error_t socketReceiveEx(Socket *socket, IpAddr *srcIpAddr, uint16_t *srcPort,
       //Initialize structure
       message = SOCKET_DEFAULT_MSG;
 
+      //Get exclusive access
+      socketAcquireRxAccess(socket);
+
 #if (UDP_SUPPORT == ENABLED)
       //Connectionless socket?
       if(socket->type == SOCKET_TYPE_DGRAM)
@@ -1143,10 +1246,10 @@ error_t socketReceiveEx(Socket *socket, IpAddr *srcIpAddr, uint16_t *srcPort,
          //Total number of data that have been received
          *received = message.length;
       }
-   }
 
-   //Release exclusive access
-   osReleaseMutex(&netMutex);
+      //Release exclusive access
+      socketReleaseRxAccess(socket);
+   }
 
    //Return status code
    return error;
@@ -1172,8 +1275,11 @@ error_t socketReceiveMsg(Socket *socket, SocketMsg *message, uint_t flags)
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
-   osAcquireMutex(&netMutex);
+   socketAcquireRxAccess(socket);
 
 #if (UDP_SUPPORT == ENABLED)
    //Connectionless socket?
@@ -1205,7 +1311,7 @@ error_t socketReceiveMsg(Socket *socket, SocketMsg *message, uint_t flags)
    }
 
    //Release exclusive access
-   osReleaseMutex(&netMutex);
+   socketReleaseRxAccess(socket);
 
    //Return status code
    return error;
@@ -1226,6 +1332,9 @@ error_t socketGetLocalAddr(Socket *socket, IpAddr *localIpAddr, uint16_t *localP
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Retrieve local IP address
    if(localIpAddr != NULL)
    {
@@ -1257,6 +1366,9 @@ error_t socketGetRemoteAddr(Socket *socket, IpAddr *remoteIpAddr, uint16_t *remo
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Retrieve local IP address
    if(remoteIpAddr != NULL)
    {
@@ -1293,6 +1405,9 @@ error_t socketShutdown(Socket *socket, uint_t how)
    //Make sure the socket handle is valid
    if(socket == NULL)
       return ERROR_INVALID_PARAMETER;
+
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
    //Make sure the socket type is correct
    if(socket->type != SOCKET_TYPE_STREAM)
       return ERROR_INVALID_SOCKET;
@@ -1328,6 +1443,9 @@ void socketClose(Socket *socket)
    if(socket == NULL)
       return;
 
+   //Operate on the stack instance the socket belongs to
+   socketSelectContext(socket);
+
    //Get exclusive access
    osAcquireMutex(&netMutex);
 
@@ -1345,8 +1463,13 @@ void socketClose(Socket *socket)
       socket->type == SOCKET_TYPE_RAW_IP ||
       socket->type == SOCKET_TYPE_RAW_ETH)
    {
+      SocketQueueItem *queueItem;
+
+      //Get exclusive access to the receive queue
+      socketLockReceiveQueue(socket);
+
       //Point to the first item in the receive queue
-      SocketQueueItem *queueItem = socket->receiveQueue;
+      queueItem = socket->receiveQueue;
 
       //Purge the receive queue
       while(queueItem)
@@ -1361,6 +1484,9 @@ void socketClose(Socket *socket)
 
       //Mark the socket as closed
       socket->type = SOCKET_TYPE_UNUSED;
+
+      //Release exclusive access to the receive queue
+      socketUnlockReceiveQueue(socket);
    }
 #endif
 
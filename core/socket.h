@@ -62,6 +62,13 @@ struct _Socket;
    #error SOCKET_EPHEMERAL_PORT_MAX parameter is not valid
 #endif
 
+//Per-socket locking of the connectionless and raw socket receive queues
+#ifndef SOCKET_LOCK_SUPPORT
+   #define SOCKET_LOCK_SUPPORT DISABLED
+#elif (SOCKET_LOCK_SUPPORT != ENABLED && SOCKET_LOCK_SUPPORT != DISABLED)
+   #error SOCKET_LOCK_SUPPORT parameter is not valid
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -249,6 +256,9 @@ struct _Socket
    uint_t type;
    uint_t protocol;
    NetInterface *interface;
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   NetContext *stackContext;      ///<TCP/IP stack instance the socket belongs to
+#endif
    IpAddr localIpAddr;
    uint16_t localPort;
    IpAddr remoteIpAddr;
@@ -272,6 +282,9 @@ struct _Socket
    uint_t eventMask;
    uint_t eventFlags;
    OsEvent *userEvent;
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   OsMutex mutex;                 ///<Mutex protecting the receive queue and the socket events
+#endif
 
 //TCP specific variables
 #if (TCP_SUPPORT == ENABLED)
@@ -313,12 +326,20 @@ struct _Socket
    uint32_t recover;              ///<NewReno modification to TCP's fast recovery algorithm
 #endif
 
+#if (NET_STATS_SUPPORT == ENABLED)
+   uint32_t statsRetransmits;     ///<Number of segments retransmitted
+   uint32_t statsDupAcks;         ///<Number of duplicate ACKs received
+   uint32_t statsZeroWindows;     ///<Number of times the peer advertised a zero window
+#endif
+
    TcpTxBuffer txBuffer;          ///<Send buffer
    size_t txBufferSize;           ///<Size of the send buffer
    TcpRxBuffer rxBuffer;          ///<Receive buffer
    size_t rxBufferSize;           ///<Size of the receive buffer
 
-   TcpQueueItem *retransmitQueue; ///<Retransmission queue
+   TcpQueueItem retransmitQueue[TCP_MAX_RETRANSMIT_QUEUE_SIZE]; ///<Retransmission queue
+   uint_t retransmitQueueHead;    ///<Index of the first item in the retransmission queue
+   uint_t retransmitQueueLength;  ///<Number of items in the retransmission queue
    NetTimer retransmitTimer;      ///<Retransmission timer
    uint_t retransmitCount;        ///<Number of retransmissions
 
@@ -369,8 +390,20 @@ typedef struct
 //Global constants
 extern const SocketMsg SOCKET_DEFAULT_MSG;
 
+//Select the stack instance a socket belongs to
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   #define socketSelectContext(socket) netSetCurrentContext((socket)->stackContext)
+#else
+   #define socketSelectContext(socket)
+#endif
+
 //Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern Socket socketTables[NET_MAX_INSTANCES][SOCKET_MAX_COUNT];
+#define socketTable (socketTables[netContext.instance])
+#else
 extern Socket socketTable[SOCKET_MAX_COUNT];
+#endif
 
 //Socket related functions
 error_t socketInit(void);
@@ -57,6 +57,9 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
    uint16_t port;
    Socket *socket;
    OsEvent event;
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   OsMutex mutex;
+#endif
 
    //Initialize socket handle
    socket = NULL;
@@ -137,10 +140,23 @@ Socket *socketAllocate(uint_t type, uint_t protocol)
 
          //Save event object instance
          osMemcpy(&event, &socket->event, sizeof(OsEvent));
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+         //Save mutex object instance
+         osMemcpy(&mutex, &socket->mutex, sizeof(OsMutex));
+#endif
          //Clear associated structure
          osMemset(socket, 0, sizeof(Socket));
          //Reuse event objects and avoid recreating them whenever possible
          osMemcpy(&socket->event, &event, sizeof(OsEvent));
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+         //Reuse mutex objects
+         osMemcpy(&socket->mutex, &mutex, sizeof(OsMutex));
+#endif
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+         //Stack instance the socket belongs to
+         socket->stackContext = netCurrentContext;
+#endif
 
          //Save socket characteristics
          socket->descriptor = i;
@@ -197,8 +213,12 @@ void socketRegisterEvents(Socket *socket, OsEvent *event, uint_t eventMask)
    //Valid socket handle?
    if(socket != NULL)
    {
+      //Operate on the stack instance the socket belongs to
+      socketSelectContext(socket);
+
       //Get exclusive access
       osAcquireMutex(&netMutex);
+      socketLockReceiveQueue(socket);
 
       //An user event may have been previously registered...
       if(socket->userEvent != NULL)
@@ -237,6 +257,7 @@ void socketRegisterEvents(Socket *socket, OsEvent *event, uint_t eventMask)
 #endif
 
       //Release exclusive access
+      socketUnlockReceiveQueue(socket);
       osReleaseMutex(&netMutex);
    }
 }
@@ -252,13 +273,18 @@ void socketUnregisterEvents(Socket *socket)
    //Valid socket handle?
    if(socket != NULL)
    {
+      //Operate on the stack instance the socket belongs to
+      socketSelectContext(socket);
+
       //Get exclusive access
       osAcquireMutex(&netMutex);
+      socketLockReceiveQueue(socket);
 
       //Unsuscribe socket events
       socket->userEvent = NULL;
 
       //Release exclusive access
+      socketUnlockReceiveQueue(socket);
       osReleaseMutex(&netMutex);
    }
 }
@@ -277,13 +303,18 @@ uint_t socketGetEvents(Socket *socket)
    //Valid socket handle?
    if(socket != NULL)
    {
+      //Operate on the stack instance the socket belongs to
+      socketSelectContext(socket);
+
       //Get exclusive access
       osAcquireMutex(&netMutex);
+      socketLockReceiveQueue(socket);
 
       //Read event flags for the specified socket
       eventFlags = socket->eventFlags;
 
       //Release exclusive access
+      socketUnlockReceiveQueue(socket);
       osReleaseMutex(&netMutex);
    }
    else
@@ -295,3 +326,84 @@ uint_t socketGetEvents(Socket *socket)
    //Return the events in the signaled state
    return eventFlags;
 }
+
+
+/**
+ * @brief Get exclusive access to the receive queue of a socket
+ *
+ * When SOCKET_LOCK_SUPPORT is enabled, the receive queue and the event state
+ * of connectionless and raw sockets are protected by a per-socket mutex, so
+ * that application tasks can retrieve datagrams without contending for the
+ * global TCP/IP stack mutex
+ *
+ * Lock hierarchy:
+ * - netMutex protects the socket table, the routing tables, the ARP and
+ *   NDP caches, the interfaces, the TCP sockets and every send path
+ * - The per-socket mutex protects the receive queue and the event state of
+ *   connectionless and raw sockets
+ * - When both are needed, netMutex is acquired first. A task holding a
+ *   per-socket mutex never acquires netMutex
+ *
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketLockReceiveQueue(Socket *socket)
+{
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   //Acquire the per-socket mutex
+   osAcquireMutex(&socket->mutex);
+#endif
+}
+
+
+/**
+ * @brief Release exclusive access to the receive queue of a socket
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketUnlockReceiveQueue(Socket *socket)
+{
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   //Release the per-socket mutex
+   osReleaseMutex(&socket->mutex);
+#endif
+}
+
+
+/**
+ * @brief Get exclusive access to a connectionless or raw socket
+ *
+ * This function is called by the application when it retrieves data from
+ * the receive queue. The per-socket mutex is used when SOCKET_LOCK_SUPPORT
+ * is enabled, otherwise the global TCP/IP stack mutex is acquired
+ *
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketAcquireRxAccess(Socket *socket)
+{
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   //Acquire the per-socket mutex
+   osAcquireMutex(&socket->mutex);
+#else
+   //Acquire the global TCP/IP stack mutex
+   osAcquireMutex(&netMutex);
+#endif
+}
+
+
+/**
+ * @brief Release exclusive access to a connectionless or raw socket
+ * @param[in] socket Handle that identifies a socket
+ **/
+
+void socketReleaseRxAccess(Socket *socket)
+{
+#if (SOCKET_LOCK_SUPPORT == ENABLED)
+   //Release the per-socket mutex
+   osReleaseMutex(&socket->mutex);
+#else
+   //Release the global TCP/IP stack mutex
+   osReleaseMutex(&netMutex);
+#endif
+}
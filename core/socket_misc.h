@@ -47,6 +47,12 @@ void socketRegisterEvents(Socket *socket, OsEvent *event, uint_t eventMask);
 void socketUnregisterEvents(Socket *socket);
 uint_t socketGetEvents(Socket *socket);
 
+void socketLockReceiveQueue(Socket *socket);
+void socketUnlockReceiveQueue(Socket *socket);
+
+void socketAcquireRxAccess(Socket *socket);
+void socketReleaseRxAccess(Socket *socket);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -47,10 +47,19 @@
 #if (TCP_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t tcpTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t tcpTickCounter;
+#endif
 
 //Ephemeral ports are used for dynamic port assignment
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static uint16_t tcpDynamicPorts[NET_MAX_INSTANCES];
+#define tcpDynamicPort (tcpDynamicPorts[netContext.instance])
+#else
 static uint16_t tcpDynamicPort;
+#endif
 
 
 /**
@@ -245,6 +245,13 @@
    #error TCP_MAX_SACK_BLOCKS parameter is not valid
 #endif
 
+//Size of the retransmission queue
+#ifndef TCP_MAX_RETRANSMIT_QUEUE_SIZE
+   #define TCP_MAX_RETRANSMIT_QUEUE_SIZE 16
+#elif (TCP_MAX_RETRANSMIT_QUEUE_SIZE < 1)
+   #error TCP_MAX_RETRANSMIT_QUEUE_SIZE parameter is not valid
+#endif
+
 //Maximum TCP header length
 #define TCP_MAX_HEADER_LENGTH 60
 //Default maximum segment size
@@ -378,13 +385,12 @@ typedef __start_packed struct
  * @brief Retransmission queue item
  **/
 
-typedef struct _TcpQueueItem
+typedef struct
 {
-   struct _TcpQueueItem *next;
-   uint_t length;
-   uint_t sacked;
-   IpPseudoHeader pseudoHeader;
-   uint8_t header[TCP_MAX_HEADER_LENGTH];
+   uint32_t seqNum; ///<Sequence number of the first byte of the segment
+   uint16_t length; ///<Length of the segment data
+   uint8_t flags;   ///<Control flags
+   uint8_t sacked;  ///<The segment has been selectively acknowledged
 } TcpQueueItem;
 
 
@@ -440,7 +446,12 @@ typedef struct
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t tcpTickCounters[NET_MAX_INSTANCES];
+#define tcpTickCounter (tcpTickCounters[netContext.instance])
+#else
 extern systime_t tcpTickCounter;
+#endif
 
 //TCP related functions
 error_t tcpInit(void);
@@ -53,6 +53,7 @@
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
 #include "ipv6/ipv6.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/tcp_mib_module.h"
 #include "date_time.h"
@@ -118,6 +119,9 @@ void tcpProcessSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
    //Retrieve the length of the TCP segment
    length = netBufferGetLength(buffer) - offset;
 
+   //Update statistics
+   NET_STATS_RX(NET_STATS_LAYER_TCP, length);
+
    //Point to the TCP header
    segment = netBufferAt(buffer, offset);
    //Sanity check
@@ -133,6 +137,7 @@ void tcpProcessSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
       //Total number of segments received in error
       MIB2_TCP_INC_COUNTER32(tcpInErrs, 1);
       TCP_MIB_INC_COUNTER32(tcpInErrs, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_TCP, ERROR_INVALID_LENGTH);
 
       //Exit immediately
       return;
@@ -147,11 +152,20 @@ void tcpProcessSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
       //Total number of segments received in error
       MIB2_TCP_INC_COUNTER32(tcpInErrs, 1);
       TCP_MIB_INC_COUNTER32(tcpInErrs, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_TCP, ERROR_INVALID_HEADER);
 
       //Exit immediately
       return;
    }
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The checksum may already have been verified by the NIC
+   if((ancillary->checksumFlags & NET_CHECKSUM_TCP) != 0)
+   {
+      //Skip software verification
+   }
+   else
+#endif
    //Verify TCP checksum
    if(ipCalcUpperLayerChecksumEx(pseudoHeader->data,
       pseudoHeader->length, buffer, offset, length) != 0x0000)
@@ -162,6 +176,7 @@ void tcpProcessSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
       //Total number of segments received in error
       MIB2_TCP_INC_COUNTER32(tcpInErrs, 1);
       TCP_MIB_INC_COUNTER32(tcpInErrs, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_TCP, ERROR_WRONG_CHECKSUM);
 
       //Exit immediately
       return;
@@ -418,6 +433,9 @@ void tcpStateClosed(NetInterface *interface,
    //Debug message
    TRACE_DEBUG("TCP FSM: CLOSED state\r\n");
 
+   //No connection matches the incoming segment
+   NET_STATS_RX_DROP(NET_STATS_LAYER_TCP, ERROR_PORT_UNREACHABLE);
+
    //An incoming segment not containing a RST causes a reset to be sent in
    //response
    if((segment->flags & TCP_FLAG_RST) == 0)
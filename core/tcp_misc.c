@@ -42,6 +42,7 @@
 #include "core/ip.h"
 #include "ipv4/ipv4.h"
 #include "ipv6/ipv6.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/tcp_mib_module.h"
 #include "date_time.h"
@@ -72,158 +73,46 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
 {
    error_t error;
    size_t offset;
-   size_t totalLength;
    NetBuffer *buffer;
    TcpHeader *segment;
-   TcpQueueItem *queueItem;
    IpPseudoHeader pseudoHeader;
    NetTxAncillary ancillary;
 
-   //Maximum segment size
-   uint16_t mss = HTONS(socket->rmss);
-
    //Allocate a memory buffer to hold the TCP segment
    buffer = ipAllocBuffer(TCP_MAX_HEADER_LENGTH, &offset);
    //Failed to allocate memory?
    if(buffer == NULL)
       return ERROR_OUT_OF_MEMORY;
 
-   //Point to the beginning of the TCP segment
-   segment = netBufferAt(buffer, offset);
-
-   //Format TCP header
-   segment->srcPort = htons(socket->localPort);
-   segment->destPort = htons(socket->remotePort);
-   segment->seqNum = htonl(seqNum);
-   segment->ackNum = (flags & TCP_FLAG_ACK) ? htonl(ackNum) : 0;
-   segment->reserved1 = 0;
-   segment->dataOffset = 5;
-   segment->flags = flags;
-   segment->reserved2 = 0;
-   segment->window = htons(socket->rcvWnd);
-   segment->checksum = 0;
-   segment->urgentPointer = 0;
-
-   //SYN flag set?
-   if((flags & TCP_FLAG_SYN) != 0)
-   {
-      //Append MSS option
-      tcpAddOption(segment, TCP_OPTION_MAX_SEGMENT_SIZE, &mss, sizeof(mss));
-
-#if (TCP_SACK_SUPPORT == ENABLED)
-      //Append SACK Permitted option
-      tcpAddOption(segment, TCP_OPTION_SACK_PERMITTED, NULL, 0);
-#endif
-   }
-
-   //Adjust the length of the multi-part buffer
-   netBufferSetLength(buffer, offset + segment->dataOffset * 4);
-
-   //Any data to send?
-   if(length > 0)
-   {
-      //Copy data
-      error = tcpReadTxBuffer(socket, seqNum, buffer, length);
-      //Any error to report?
-      if(error)
-      {
-         //Clean up side effects
-         netBufferFree(buffer);
-         //Exit immediately
-         return error;
-      }
-   }
-
-   //Calculate the length of the complete TCP segment
-   totalLength = segment->dataOffset * 4 + length;
-
-#if (IPV4_SUPPORT == ENABLED)
-   //Destination address is an IPv4 address?
-   if(socket->remoteIpAddr.length == sizeof(Ipv4Addr))
-   {
-      //Format IPv4 pseudo header
-      pseudoHeader.length = sizeof(Ipv4PseudoHeader);
-      pseudoHeader.ipv4Data.srcAddr = socket->localIpAddr.ipv4Addr;
-      pseudoHeader.ipv4Data.destAddr = socket->remoteIpAddr.ipv4Addr;
-      pseudoHeader.ipv4Data.reserved = 0;
-      pseudoHeader.ipv4Data.protocol = IPV4_PROTOCOL_TCP;
-      pseudoHeader.ipv4Data.length = htons(totalLength);
-
-      //Calculate TCP header checksum
-      segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
-         sizeof(Ipv4PseudoHeader), buffer, offset, totalLength);
-   }
-   else
-#endif
-#if (IPV6_SUPPORT == ENABLED)
-   //Destination address is an IPv6 address?
-   if(socket->remoteIpAddr.length == sizeof(Ipv6Addr))
+   //Format TCP segment
+   error = tcpFormatSegment(socket, flags, seqNum, ackNum, length, buffer,
+      offset, &pseudoHeader);
+   //Any error to report?
+   if(error)
    {
-      //Format IPv6 pseudo header
-      pseudoHeader.length = sizeof(Ipv6PseudoHeader);
-      pseudoHeader.ipv6Data.srcAddr = socket->localIpAddr.ipv6Addr;
-      pseudoHeader.ipv6Data.destAddr = socket->remoteIpAddr.ipv6Addr;
-      pseudoHeader.ipv6Data.length = htonl(totalLength);
-      pseudoHeader.ipv6Data.reserved[0] = 0;
-      pseudoHeader.ipv6Data.reserved[1] = 0;
-      pseudoHeader.ipv6Data.reserved[2] = 0;
-      pseudoHeader.ipv6Data.nextHeader = IPV6_TCP_HEADER;
-
-      //Calculate TCP header checksum
-      segment->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
-         sizeof(Ipv6PseudoHeader), buffer, offset, totalLength);
-   }
-   else
-#endif
-   //Destination address is not valid?
-   {
-      //Free previously allocated memory
+      //Clean up side effects
       netBufferFree(buffer);
-      //This should never occur...
-      return ERROR_INVALID_ADDRESS;
+      //Exit immediately
+      return error;
    }
 
+   //Point to the beginning of the TCP segment
+   segment = netBufferAt(buffer, offset);
+
    //Add current segment to retransmission queue?
    if(addToQueue)
    {
-      //Empty retransmission queue?
-      if(socket->retransmitQueue == NULL)
-      {
-         //Create a new item
-         queueItem = memPoolAlloc(sizeof(TcpQueueItem));
-         //Add the newly created item to the queue
-         socket->retransmitQueue = queueItem;
-      }
-      else
-      {
-         //Point to the very first item
-         queueItem = socket->retransmitQueue;
-         //Reach the last item of the retransmission queue
-         while(queueItem->next) queueItem = queueItem->next;
-         //Create a new item
-         queueItem->next = memPoolAlloc(sizeof(TcpQueueItem));
-         //Point to the newly created item
-         queueItem = queueItem->next;
-      }
-
-      //Failed to allocate memory?
-      if(queueItem == NULL)
+      //Record the sequence range occupied by the segment
+      error = tcpAddRetransmitQueueItem(socket, flags, seqNum, length);
+      //Any error to report?
+      if(error)
       {
          //Free previously allocated memory
          netBufferFree(buffer);
          //Return status
-         return ERROR_OUT_OF_MEMORY;
+         return error;
       }
 
-      //Retransmission mechanism requires additional information
-      queueItem->next = NULL;
-      queueItem->length = length;
-      queueItem->sacked = FALSE;
-      //Save TCP header
-      osMemcpy(queueItem->header, segment, segment->dataOffset * 4);
-      //Save pseudo header
-      queueItem->pseudoHeader = pseudoHeader;
-
       //Take one RTT measurement at a time
       if(!socket->rttBusy)
       {
@@ -274,6 +163,9 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    TCP_MIB_INC_COUNTER32(tcpOutSegs, 1);
    TCP_MIB_INC_COUNTER64(tcpHCOutSegs, 1);
 
+   //Update statistics
+   NET_STATS_TX(NET_STATS_LAYER_TCP, netBufferGetLength(buffer) - offset);
+
    //RST flag set?
    if((flags & TCP_FLAG_RST) != 0)
    {
@@ -294,6 +186,12 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    //Set the TTL value to be used
    ancillary.ttl = socket->ttl;
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The TCP checksum has not been computed yet
+   ancillary.checksumFlags = NET_CHECKSUM_TCP;
+   ancillary.checksumOffset = 16;
+#endif
+
 #if (ETH_VLAN_SUPPORT == ENABLED)
    //Set VLAN PCP and DEI fields
    ancillary.vlanPcp = socket->vlanPcp;
@@ -318,6 +216,131 @@ error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
 }
 
 
+/**
+ * @brief Format a TCP segment
+ *
+ * The TCP header is built from the current state of the connection and the
+ * payload is read from the circular send buffer. This allows segments held
+ * in the retransmission queue to be rebuilt on demand
+ *
+ * @param[in] socket Handle referencing a socket
+ * @param[in] flags Value that contains bitwise OR of flags (see #TcpFlags enumeration)
+ * @param[in] seqNum Sequence number
+ * @param[in] ackNum Acknowledgment number
+ * @param[in] length Length of the segment data
+ * @param[in] buffer Multi-part buffer where to format the segment
+ * @param[in] offset Offset to the first byte of the TCP header
+ * @param[out] pseudoHeader TCP pseudo header
+ * @return Error code
+ **/
+
+error_t tcpFormatSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
+   uint32_t ackNum, size_t length, NetBuffer *buffer, size_t offset,
+   IpPseudoHeader *pseudoHeader)
+{
+   error_t error;
+   size_t totalLength;
+   TcpHeader *segment;
+
+   //Maximum segment size
+   uint16_t mss = HTONS(socket->rmss);
+
+   //Point to the beginning of the TCP segment
+   segment = netBufferAt(buffer, offset);
+
+   //Format TCP header
+   segment->srcPort = htons(socket->localPort);
+   segment->destPort = htons(socket->remotePort);
+   segment->seqNum = htonl(seqNum);
+   segment->ackNum = (flags & TCP_FLAG_ACK) ? htonl(ackNum) : 0;
+   segment->reserved1 = 0;
+   segment->dataOffset = 5;
+   segment->flags = flags;
+   segment->reserved2 = 0;
+   segment->window = htons(socket->rcvWnd);
+   segment->checksum = 0;
+   segment->urgentPointer = 0;
+
+   //SYN flag set?
+   if((flags & TCP_FLAG_SYN) != 0)
+   {
+      //Append MSS option
+      tcpAddOption(segment, TCP_OPTION_MAX_SEGMENT_SIZE, &mss, sizeof(mss));
+
+#if (TCP_SACK_SUPPORT == ENABLED)
+      //Append SACK Permitted option
+      tcpAddOption(segment, TCP_OPTION_SACK_PERMITTED, NULL, 0);
+#endif
+   }
+
+   //Adjust the length of the multi-part buffer
+   netBufferSetLength(buffer, offset + segment->dataOffset * 4);
+
+   //Any data to send?
+   if(length > 0)
+   {
+      //Copy data
+      error = tcpReadTxBuffer(socket, seqNum, buffer, length);
+      //Any error to report?
+      if(error)
+         return error;
+   }
+
+   //Calculate the length of the complete TCP segment
+   totalLength = segment->dataOffset * 4 + length;
+
+#if (IPV4_SUPPORT == ENABLED)
+   //Destination address is an IPv4 address?
+   if(socket->remoteIpAddr.length == sizeof(Ipv4Addr))
+   {
+      //Format IPv4 pseudo header
+      pseudoHeader->length = sizeof(Ipv4PseudoHeader);
+      pseudoHeader->ipv4Data.srcAddr = socket->localIpAddr.ipv4Addr;
+      pseudoHeader->ipv4Data.destAddr = socket->remoteIpAddr.ipv4Addr;
+      pseudoHeader->ipv4Data.reserved = 0;
+      pseudoHeader->ipv4Data.protocol = IPV4_PROTOCOL_TCP;
+      pseudoHeader->ipv4Data.length = htons(totalLength);
+   }
+   else
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+   //Destination address is an IPv6 address?
+   if(socket->remoteIpAddr.length == sizeof(Ipv6Addr))
+   {
+      //Format IPv6 pseudo header
+      pseudoHeader->length = sizeof(Ipv6PseudoHeader);
+      pseudoHeader->ipv6Data.srcAddr = socket->localIpAddr.ipv6Addr;
+      pseudoHeader->ipv6Data.destAddr = socket->remoteIpAddr.ipv6Addr;
+      pseudoHeader->ipv6Data.length = htonl(totalLength);
+      pseudoHeader->ipv6Data.reserved[0] = 0;
+      pseudoHeader->ipv6Data.reserved[1] = 0;
+      pseudoHeader->ipv6Data.reserved[2] = 0;
+      pseudoHeader->ipv6Data.nextHeader = IPV6_TCP_HEADER;
+   }
+   else
+#endif
+   //Destination address is not valid?
+   {
+      //This should never occur...
+      return ERROR_INVALID_ADDRESS;
+   }
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The checksum field holds the checksum of the pseudo header only. The IP
+   //layer completes it in software unless the NIC can take care of it
+   segment->checksum = ipCalcChecksum(pseudoHeader->data,
+      pseudoHeader->length) ^ 0xFFFF;
+#else
+   //Calculate TCP header checksum
+   segment->checksum = ipCalcUpperLayerChecksumEx(pseudoHeader->data,
+      pseudoHeader->length, buffer, offset, totalLength);
+#endif
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Send a TCP reset segment
  * @param[in] socket Handle referencing a socket
@@ -476,6 +499,9 @@ error_t tcpRejectSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
    MIB2_TCP_INC_COUNTER32(tcpOutRsts, 1);
    TCP_MIB_INC_COUNTER32(tcpOutRsts, 1);
 
+   //Update statistics
+   NET_STATS_TX(NET_STATS_LAYER_TCP, sizeof(TcpHeader));
+
    //Debug message
    TRACE_DEBUG("%s: Sending TCP reset segment...\r\n",
       formatSystemTime(osGetSystemTime(), NULL));
@@ -919,6 +945,7 @@ error_t tcpCheckAck(Socket *socket, TcpHeader *segment, size_t length)
       {
          //Increment duplicate ACK counter
          socket->dupAckCount++;
+         NET_STATS_TCP_INC_COUNTER(socket, statsDupAcks);
          //Debug message
          TRACE_INFO("TCP duplicate ACK #%u\r\n", socket->dupAckCount);
       }
@@ -1091,7 +1118,7 @@ bool_t tcpIsDuplicateAck(Socket *socket, TcpHeader *segment, size_t length)
    flag = FALSE;
 
    //The receiver of the ACK has outstanding data
-   if(socket->retransmitQueue != NULL)
+   if(socket->retransmitQueueLength > 0)
    {
       //The incoming acknowledgment carries no data
       if(length == 0)
@@ -1278,6 +1305,8 @@ void tcpProcessSegmentData(Socket *socket, TcpHeader *segment,
 
    //Copy the incoming data to the receive buffer
    tcpWriteRxBuffer(socket, leftEdge, buffer, offset, rightEdge - leftEdge);
+   //The data has been delivered to the socket
+   NET_STATS_RX_COMPLETE();
 
    //Update the list of non-contiguous blocks of data that
    //have been received and queued
@@ -1334,6 +1363,75 @@ void tcpDeleteControlBlock(Socket *socket)
 }
 
 
+/**
+ * @brief Add a segment to the retransmission queue
+ *
+ * The retransmission queue is a ring of sequence range descriptors. The
+ * payload itself remains in the circular send buffer until acknowledged
+ *
+ * @param[in] socket Handle referencing the socket
+ * @param[in] flags Control flags of the segment
+ * @param[in] seqNum Sequence number of the first byte of the segment
+ * @param[in] length Length of the segment data
+ * @return Error code
+ **/
+
+error_t tcpAddRetransmitQueueItem(Socket *socket, uint8_t flags,
+   uint32_t seqNum, size_t length)
+{
+   uint_t i;
+   TcpQueueItem *queueItem;
+
+   //Check whether the retransmission queue is full
+   if(socket->retransmitQueueLength >= TCP_MAX_RETRANSMIT_QUEUE_SIZE)
+   {
+      //Index of the last item of the queue
+      i = (socket->retransmitQueueHead + socket->retransmitQueueLength - 1) %
+         TCP_MAX_RETRANSMIT_QUEUE_SIZE;
+
+      //Point to the last item of the queue
+      queueItem = &socket->retransmitQueue[i];
+
+      //Contiguous segments can be merged as long as the resulting segment
+      //does not exceed the MSS
+      if((queueItem->flags & (TCP_FLAG_SYN | TCP_FLAG_FIN)) == 0 &&
+         (flags & TCP_FLAG_SYN) == 0 &&
+         (queueItem->seqNum + queueItem->length) == seqNum &&
+         (queueItem->length + length) <= socket->smss)
+      {
+         //Extend the sequence range covered by the last item
+         queueItem->length += length;
+         queueItem->flags |= flags;
+
+         //Successful processing
+         return NO_ERROR;
+      }
+
+      //Report an error
+      return ERROR_OUT_OF_RESOURCES;
+   }
+
+   //Index of the first free entry
+   i = (socket->retransmitQueueHead + socket->retransmitQueueLength) %
+      TCP_MAX_RETRANSMIT_QUEUE_SIZE;
+
+   //Point to the newly created item
+   queueItem = &socket->retransmitQueue[i];
+
+   //Retransmission mechanism requires additional information
+   queueItem->seqNum = seqNum;
+   queueItem->length = (uint16_t) length;
+   queueItem->flags = flags;
+   queueItem->sacked = FALSE;
+
+   //Update the number of items in the queue
+   socket->retransmitQueueLength++;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Remove acknowledged segments from retransmission queue
  * @param[in] socket Handle referencing the socket
@@ -1342,26 +1440,21 @@ void tcpDeleteControlBlock(Socket *socket)
 void tcpUpdateRetransmitQueue(Socket *socket)
 {
    size_t length;
-   TcpQueueItem *prevQueueItem;
    TcpQueueItem *queueItem;
-   TcpHeader *header;
 
-   //Point to the first item of the retransmission queue
-   prevQueueItem = NULL;
-   queueItem = socket->retransmitQueue;
-
-   //Loop through retransmission queue
-   while(queueItem != NULL)
+   //Segments are queued in sequence number order, so only the items at the
+   //head of the queue need to be examined
+   while(socket->retransmitQueueLength > 0)
    {
-      //Point to the TCP header
-      header = (TcpHeader *) queueItem->header;
+      //Point to the first item of the retransmission queue
+      queueItem = &socket->retransmitQueue[socket->retransmitQueueHead];
 
       //Calculate the length of the TCP segment
-      if(header->flags & TCP_FLAG_SYN)
+      if(queueItem->flags & TCP_FLAG_SYN)
       {
          length = 1;
       }
-      else if(header->flags & TCP_FLAG_FIN)
+      else if(queueItem->flags & TCP_FLAG_FIN)
       {
          length = queueItem->length + 1;
       }
@@ -1372,46 +1465,25 @@ void tcpUpdateRetransmitQueue(Socket *socket)
 
       //If an acknowledgment is received for a segment before its timer
       //expires, the segment is removed from the retransmission queue
-      if(TCP_CMP_SEQ(socket->sndUna, ntohl(header->seqNum) + length) >= 0)
-      {
-         //First item of the queue?
-         if(prevQueueItem == NULL)
-         {
-            //Remove the current item from the queue
-            socket->retransmitQueue = queueItem->next;
-            //The item can now be safely deleted
-            memPoolFree(queueItem);
-            //Point to the next item
-            queueItem = socket->retransmitQueue;
-         }
-         else
-         {
-            //Remove the current item from the queue
-            prevQueueItem->next = queueItem->next;
-            //The item can now be safely deleted
-            memPoolFree(queueItem);
-            //Point to the next item
-            queueItem = prevQueueItem->next;
-         }
+      if(TCP_CMP_SEQ(socket->sndUna, queueItem->seqNum + length) < 0)
+         break;
 
-         //When an ACK is received that acknowledges new data, restart the
-         //retransmission timer so that it will expire after RTO seconds
-         netStartTimer(&socket->retransmitTimer, socket->rto);
-         //Reset retransmission counter
-         socket->retransmitCount = 0;
-      }
-      //No acknowledgment received for the current segment...
-      else
-      {
-         //Point to the next item
-         prevQueueItem = queueItem;
-         queueItem = queueItem->next;
-      }
+      //Remove the current item from the queue
+      socket->retransmitQueueHead = (socket->retransmitQueueHead + 1) %
+         TCP_MAX_RETRANSMIT_QUEUE_SIZE;
+
+      socket->retransmitQueueLength--;
+
+      //When an ACK is received that acknowledges new data, restart the
+      //retransmission timer so that it will expire after RTO seconds
+      netStartTimer(&socket->retransmitTimer, socket->rto);
+      //Reset retransmission counter
+      socket->retransmitCount = 0;
    }
 
    //When all outstanding data has been acknowledged,
    //turn off the retransmission timer
-   if(socket->retransmitQueue == NULL)
+   if(socket->retransmitQueueLength == 0)
       netStopTimer(&socket->retransmitTimer);
 }
 
@@ -1423,22 +1495,9 @@ void tcpUpdateRetransmitQueue(Socket *socket)
 
 void tcpFlushRetransmitQueue(Socket *socket)
 {
-   //Point to the first item in the retransmission queue
-   TcpQueueItem *queueItem = socket->retransmitQueue;
-
-   //Loop through retransmission queue
-   while(queueItem != NULL)
-   {
-      //Keep track of the next item in the queue
-      TcpQueueItem *nextQueueItem = queueItem->next;
-      //Free previously allocated memory
-      memPoolFree(queueItem);
-      //Point to the next item
-      queueItem = nextQueueItem;
-   }
-
    //The retransmission queue is now flushed
-   socket->retransmitQueue = NULL;
+   socket->retransmitQueueHead = 0;
+   socket->retransmitQueueLength = 0;
 
    //Turn off the retransmission timer
    netStopTimer(&socket->retransmitTimer);
@@ -1558,6 +1617,9 @@ void tcpUpdateSendWindow(Socket *socket, TcpHeader *segment)
       //Check whether the remote host advertises a zero window
       if(segment->window == 0 && socket->sndWnd != 0)
       {
+         //Update statistics
+         NET_STATS_TCP_INC_COUNTER(socket, statsZeroWindows);
+
          //Start the persist timer
          socket->wndProbeCount = 0;
          socket->wndProbeInterval = TCP_DEFAULT_PROBE_INTERVAL;
@@ -1690,11 +1752,13 @@ bool_t tcpComputeRto(Socket *socket)
 error_t tcpRetransmitSegment(Socket *socket)
 {
    error_t error;
+   uint_t i;
    size_t offset;
    size_t length;
    NetBuffer *buffer;
    TcpQueueItem *queueItem;
    TcpHeader *header;
+   IpPseudoHeader pseudoHeader;
    NetTxAncillary ancillary;
 
    //Initialize error code
@@ -1702,12 +1766,13 @@ error_t tcpRetransmitSegment(Socket *socket)
    //Total number of bytes that have been retransmitted
    length = 0;
 
-   //Point to the retransmission queue
-   queueItem = socket->retransmitQueue;
-
    //Any segment in the retransmission queue?
-   while(queueItem != NULL)
+   for(i = 0; i < socket->retransmitQueueLength; i++)
    {
+      //Point to the current item
+      queueItem = &socket->retransmitQueue[(socket->retransmitQueueHead + i) %
+         TCP_MAX_RETRANSMIT_QUEUE_SIZE];
+
       //Total number of bytes that have been retransmitted
       length += queueItem->length;
 
@@ -1720,11 +1785,8 @@ error_t tcpRetransmitSegment(Socket *socket)
          break;
       }
 
-      //Point to the TCP header
-      header = (TcpHeader *) queueItem->header;
-
       //Allocate a memory buffer to hold the TCP segment
-      buffer = ipAllocBuffer(0, &offset);
+      buffer = ipAllocBuffer(TCP_MAX_HEADER_LENGTH, &offset);
       //Failed to allocate memory?
       if(buffer == NULL)
       {
@@ -1737,23 +1799,24 @@ error_t tcpRetransmitSegment(Socket *socket)
       //Start of exception handling block
       do
       {
-         //Copy TCP header
-         error = netBufferAppend(buffer, header, header->dataOffset * 4);
+         //Rebuild the TCP segment from the send buffer
+         error = tcpFormatSegment(socket, queueItem->flags, queueItem->seqNum,
+            socket->rcvNxt, queueItem->length, buffer, offset, &pseudoHeader);
          //Any error to report?
          if(error)
             break;
 
-         //Copy data from send buffer
-         error = tcpReadTxBuffer(socket, ntohl(header->seqNum), buffer,
-            queueItem->length);
-         //Any error to report?
-         if(error)
-            break;
+         //Point to the TCP header
+         header = netBufferAt(buffer, offset);
 
          //Total number of segments retransmitted
          MIB2_TCP_INC_COUNTER32(tcpRetransSegs, 1);
          TCP_MIB_INC_COUNTER32(tcpRetransSegs, 1);
 
+         //Update statistics
+         NET_STATS_TX(NET_STATS_LAYER_TCP, netBufferGetLength(buffer) - offset);
+         NET_STATS_TCP_INC_COUNTER(socket, statsRetransmits);
+
          //Dump TCP header contents for debugging purpose
          tcpDumpHeader(header, queueItem->length, socket->iss, socket->irs);
 
@@ -1762,6 +1825,12 @@ error_t tcpRetransmitSegment(Socket *socket)
          //Set the TTL value to be used
          ancillary.ttl = socket->ttl;
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+         //The TCP checksum has not been computed yet
+         ancillary.checksumFlags = NET_CHECKSUM_TCP;
+         ancillary.checksumOffset = 16;
+#endif
+
 #if (ETH_VLAN_SUPPORT == ENABLED)
          //Set VLAN PCP and DEI fields
          ancillary.vlanPcp = socket->vlanPcp;
@@ -1775,8 +1844,8 @@ error_t tcpRetransmitSegment(Socket *socket)
 #endif
          //Retransmit the lost segment without waiting for the retransmission
          //timer to expire
-         error = ipSendDatagram(socket->interface, &queueItem->pseudoHeader,
-            buffer, offset, &ancillary);
+         error = ipSendDatagram(socket->interface, &pseudoHeader, buffer,
+            offset, &ancillary);
 
          //End of exception handling block
       } while(0);
@@ -1790,9 +1859,6 @@ error_t tcpRetransmitSegment(Socket *socket)
          //Exit immediately
          break;
       }
-
-      //Point to the next segment in the queue
-      queueItem = queueItem->next;
    }
 
    //Return status code
@@ -1834,6 +1900,10 @@ error_t tcpNagleAlgo(Socket *socket, uint_t flags)
       if((int32_t) u <= 0)
          break;
 
+      //The retransmission queue must have room for the new segment
+      if(socket->retransmitQueueLength >= TCP_MAX_RETRANSMIT_QUEUE_SIZE)
+         break;
+
       //Calculate the number of bytes to send at a time
       n = MIN(u, socket->sndUser);
       n = MIN(n, socket->smss);
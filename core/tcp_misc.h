@@ -43,6 +43,10 @@ extern "C" {
 error_t tcpSendSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
    uint32_t ackNum, size_t length, bool_t addToQueue);
 
+error_t tcpFormatSegment(Socket *socket, uint8_t flags, uint32_t seqNum,
+   uint32_t ackNum, size_t length, NetBuffer *buffer, size_t offset,
+   IpPseudoHeader *pseudoHeader);
+
 error_t tcpSendResetSegment(Socket *socket, uint32_t seqNum);
 
 error_t tcpRejectSegment(NetInterface *interface, IpPseudoHeader *pseudoHeader,
@@ -74,6 +78,9 @@ void tcpProcessSegmentData(Socket *socket, TcpHeader *segment,
 
 void tcpDeleteControlBlock(Socket *socket);
 
+error_t tcpAddRetransmitQueueItem(Socket *socket, uint8_t flags,
+   uint32_t seqNum, size_t length);
+
 void tcpUpdateRetransmitQueue(Socket *socket);
 void tcpFlushRetransmitQueue(Socket *socket);
 
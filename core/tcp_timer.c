@@ -99,7 +99,7 @@ void tcpCheckRetransmitTimer(Socket *socket)
    if(socket->state != TCP_STATE_CLOSED)
    {
       //Any packet in the retransmission queue?
-      if(socket->retransmitQueue != NULL)
+      if(socket->retransmitQueueLength > 0)
       {
          //Retransmission timeout?
          if(netTimerExpired(&socket->retransmitTimer))
@@ -138,7 +138,7 @@ void tcpCheckRetransmitTimer(Socket *socket)
                TRACE_INFO("%s: TCP segment retransmission #%u (%u data bytes)...\r\n",
                   formatSystemTime(osGetSystemTime(), NULL),
                   socket->retransmitCount + 1,
-                  socket->retransmitQueue->length);
+                  socket->retransmitQueue[socket->retransmitQueueHead].length);
 
                //Retransmit the earliest segment that has not been acknowledged
                //by the TCP receiver
@@ -37,10 +37,12 @@
 #include "core/ip.h"
 #include "core/udp.h"
 #include "core/socket.h"
+#include "core/socket_misc.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
 #include "ipv6/ipv6.h"
 #include "ipv6/ipv6_misc.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/if_mib_module.h"
 #include "mibs/udp_mib_module.h"
@@ -50,9 +52,18 @@
 #if (UDP_SUPPORT == ENABLED)
 
 //Ephemeral ports are used for dynamic port assignment
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static uint16_t udpDynamicPorts[NET_MAX_INSTANCES];
+#define udpDynamicPort (udpDynamicPorts[netContext.instance])
+#else
 static uint16_t udpDynamicPort;
+#endif
 //Table that holds the registered user callbacks
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+UdpRxCallbackEntry udpCallbackTables[NET_MAX_INSTANCES][UDP_CALLBACK_TABLE_SIZE];
+#else
 UdpRxCallbackEntry udpCallbackTable[UDP_CALLBACK_TABLE_SIZE];
+#endif
 
 
 /**
@@ -135,6 +146,9 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
    //Retrieve the length of the UDP datagram
    length = netBufferGetLength(buffer) - offset;
 
+   //Update statistics
+   NET_STATS_RX(NET_STATS_LAYER_UDP, length);
+
    //Ensure the UDP header is valid
    if(length < sizeof(UdpHeader))
    {
@@ -142,6 +156,7 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
       //reasons other than the lack of an application at the destination port
       MIB2_UDP_INC_COUNTER32(udpInErrors, 1);
       UDP_MIB_INC_COUNTER32(udpInErrors, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_UDP, ERROR_INVALID_HEADER);
 
       //Report an error
       return ERROR_INVALID_HEADER;
@@ -158,6 +173,14 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
    //Dump UDP header contents for debugging purpose
    udpDumpHeader(header);
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The checksum may already have been verified by the NIC
+   if((ancillary->checksumFlags & NET_CHECKSUM_UDP) != 0)
+   {
+      //Skip software verification
+   }
+   else
+#endif
    //When UDP runs over IPv6, the checksum is mandatory
    if(header->checksum != 0x0000 || pseudoHeader->length == sizeof(Ipv6PseudoHeader))
    {
@@ -172,6 +195,7 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
          //reasons other than the lack of an application at the destination port
          MIB2_UDP_INC_COUNTER32(udpInErrors, 1);
          UDP_MIB_INC_COUNTER32(udpInErrors, 1);
+         NET_STATS_RX_DROP(NET_STATS_LAYER_UDP, ERROR_WRONG_CHECKSUM);
 
          //Report an error
          return ERROR_WRONG_CHECKSUM;
@@ -277,6 +301,9 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
       return error;
    }
 
+   //Get exclusive access to the receive queue
+   socketLockReceiveQueue(socket);
+
    //Empty receive queue?
    if(socket->receiveQueue == NULL)
    {
@@ -316,6 +343,10 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
          //though no errors had been detected
          MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
          IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
+         NET_STATS_RX_DROP(NET_STATS_LAYER_UDP, ERROR_RECEIVE_QUEUE_FULL);
+
+         //Release exclusive access to the receive queue
+         socketUnlockReceiveQueue(socket);
 
          //Report an error
          return ERROR_RECEIVE_QUEUE_FULL;
@@ -347,6 +378,10 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
       //though no errors had been detected
       MIB2_IF_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
       IF_MIB_INC_COUNTER32(ifTable[interface->index].ifInDiscards, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_UDP, ERROR_OUT_OF_MEMORY);
+
+      //Release exclusive access to the receive queue
+      socketUnlockReceiveQueue(socket);
 
       //Report an error
       return ERROR_OUT_OF_MEMORY;
@@ -397,11 +432,17 @@ error_t udpProcessDatagram(NetInterface *interface, IpPseudoHeader *pseudoHeader
    //Notify user that data is available
    udpUpdateEvents(socket);
 
+   //Release exclusive access to the receive queue
+   socketUnlockReceiveQueue(socket);
+
    //Total number of UDP datagrams delivered to UDP users
    MIB2_UDP_INC_COUNTER32(udpInDatagrams, 1);
    UDP_MIB_INC_COUNTER32(udpInDatagrams, 1);
    UDP_MIB_INC_COUNTER64(udpHCInDatagrams, 1);
 
+   //The datagram has been delivered to the socket
+   NET_STATS_RX_COMPLETE();
+
    //Successful processing
    return NO_ERROR;
 }
@@ -603,10 +644,6 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
       pseudoHeader.ipv4Data.reserved = 0;
       pseudoHeader.ipv4Data.protocol = IPV4_PROTOCOL_UDP;
       pseudoHeader.ipv4Data.length = htons(length);
-
-      //Calculate UDP header checksum
-      header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv4Data,
-         sizeof(Ipv4PseudoHeader), buffer, offset, length);
    }
    else
 #endif
@@ -639,10 +676,6 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
       pseudoHeader.ipv6Data.reserved[1] = 0;
       pseudoHeader.ipv6Data.reserved[2] = 0;
       pseudoHeader.ipv6Data.nextHeader = IPV6_UDP_HEADER;
-
-      //Calculate UDP header checksum
-      header->checksum = ipCalcUpperLayerChecksumEx(&pseudoHeader.ipv6Data,
-         sizeof(Ipv6PseudoHeader), buffer, offset, length);
    }
    else
 #endif
@@ -652,6 +685,20 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
       return ERROR_FAILURE;
    }
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The checksum field holds the checksum of the pseudo header only. The IP
+   //layer completes it in software unless the NIC can take care of it
+   header->checksum = ipCalcChecksum(pseudoHeader.data,
+      pseudoHeader.length) ^ 0xFFFF;
+
+   //The UDP checksum has not been computed yet
+   ancillary->checksumFlags |= NET_CHECKSUM_UDP;
+   ancillary->checksumOffset = 6;
+#else
+   //Calculate UDP header checksum
+   header->checksum = ipCalcUpperLayerChecksumEx(pseudoHeader.data,
+      pseudoHeader.length, buffer, offset, length);
+
    //If the computed checksum is zero, it is transmitted as all ones. An all
    //zero transmitted checksum value means that the transmitter generated no
    //checksum
@@ -659,12 +706,16 @@ error_t udpSendBuffer(NetInterface *interface, const IpAddr *srcIpAddr,
    {
       header->checksum = 0xFFFF;
    }
+#endif
 
    //Total number of UDP datagrams sent from this entity
    MIB2_UDP_INC_COUNTER32(udpOutDatagrams, 1);
    UDP_MIB_INC_COUNTER32(udpOutDatagrams, 1);
    UDP_MIB_INC_COUNTER64(udpHCOutDatagrams, 1);
 
+   //Update statistics
+   NET_STATS_TX(NET_STATS_LAYER_UDP, length);
+
    //Debug message
    TRACE_INFO("Sending UDP datagram (%" PRIuSIZE " bytes)\r\n", length);
    //Dump UDP header contents for debugging purpose
@@ -704,11 +755,11 @@ error_t udpReceiveDatagram(Socket *socket, SocketMsg *message, uint_t flags)
          osResetEvent(&socket->event);
 
          //Release exclusive access
-         osReleaseMutex(&netMutex);
+         socketReleaseRxAccess(socket);
          //Wait until an event is triggered
          osWaitForEvent(&socket->event, socket->timeout);
          //Get exclusive access
-         osAcquireMutex(&netMutex);
+         socketAcquireRxAccess(socket);
       }
    }
 
@@ -989,6 +1040,7 @@ error_t udpInvokeRxCallback(NetInterface *interface,
       //no application at the destination port
       MIB2_UDP_INC_COUNTER32(udpNoPorts, 1);
       UDP_MIB_INC_COUNTER32(udpNoPorts, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_UDP, ERROR_PORT_UNREACHABLE);
    }
    else
    {
@@ -996,6 +1048,9 @@ error_t udpInvokeRxCallback(NetInterface *interface,
       MIB2_UDP_INC_COUNTER32(udpInDatagrams, 1);
       UDP_MIB_INC_COUNTER32(udpInDatagrams, 1);
       UDP_MIB_INC_COUNTER64(udpHCInDatagrams, 1);
+
+      //The datagram has been delivered to the callback
+      NET_STATS_RX_COMPLETE();
    }
 
    //Return status code
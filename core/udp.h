@@ -113,7 +113,12 @@ typedef struct
 
 
 //Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern UdpRxCallbackEntry udpCallbackTables[NET_MAX_INSTANCES][UDP_CALLBACK_TABLE_SIZE];
+#define udpCallbackTable (udpCallbackTables[netContext.instance])
+#else
 extern UdpRxCallbackEntry udpCallbackTable[UDP_CALLBACK_TABLE_SIZE];
+#endif
 
 //UDP related functions
 error_t udpInit(void);
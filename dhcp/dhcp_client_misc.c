@@ -46,7 +46,11 @@
 #if (IPV4_SUPPORT == ENABLED && DHCP_CLIENT_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t dhcpClientTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t dhcpClientTickCounter;
+#endif
 
 //Requested DHCP options
 const uint8_t dhcpOptionList[] =
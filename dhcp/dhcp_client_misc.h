@@ -41,7 +41,12 @@ extern "C" {
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t dhcpClientTickCounters[NET_MAX_INSTANCES];
+#define dhcpClientTickCounter (dhcpClientTickCounters[netContext.instance])
+#else
 extern systime_t dhcpClientTickCounter;
+#endif
 
 //DHCP client related functions
 void dhcpClientTick(DhcpClientContext *context);
@@ -44,7 +44,11 @@
 #if (IPV4_SUPPORT == ENABLED && DHCP_SERVER_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t dhcpServerTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t dhcpServerTickCounter;
+#endif
 
 
 /**
@@ -41,7 +41,12 @@ extern "C" {
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t dhcpServerTickCounters[NET_MAX_INSTANCES];
+#define dhcpServerTickCounter (dhcpServerTickCounters[netContext.instance])
+#else
 extern systime_t dhcpServerTickCounter;
+#endif
 
 //DHCP server related functions
 void dhcpServerTick(DhcpServerContext *context);
@@ -49,7 +49,11 @@
 #if (IPV6_SUPPORT == ENABLED && DHCPV6_CLIENT_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t dhcpv6ClientTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t dhcpv6ClientTickCounter;
+#endif
 
 //Requested DHCPv6 options
 static const uint16_t dhcpv6OptionList[] =
@@ -41,7 +41,12 @@ extern "C" {
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t dhcpv6ClientTickCounters[NET_MAX_INSTANCES];
+#define dhcpv6ClientTickCounter (dhcpv6ClientTickCounters[netContext.instance])
+#else
 extern systime_t dhcpv6ClientTickCounter;
+#endif
 
 //DHCPv6 client related functions
 void dhcpv6ClientTick(Dhcpv6ClientContext *context);
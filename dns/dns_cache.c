@@ -47,9 +47,17 @@
    NBNS_CLIENT_SUPPORT == ENABLED || LLMNR_CLIENT_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t dnsTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t dnsTickCounter;
+#endif
 //DNS cache
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+DnsCacheEntry dnsCaches[NET_MAX_INSTANCES][DNS_CACHE_SIZE];
+#else
 DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
+#endif
 
 
 /**
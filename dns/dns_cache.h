@@ -112,8 +112,18 @@ typedef struct
 
 
 //Global variables
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t dnsTickCounters[NET_MAX_INSTANCES];
+#define dnsTickCounter (dnsTickCounters[netContext.instance])
+#else
 extern systime_t dnsTickCounter;
+#endif
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern DnsCacheEntry dnsCaches[NET_MAX_INSTANCES][DNS_CACHE_SIZE];
+#define dnsCache (dnsCaches[netContext.instance])
+#else
 extern DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
+#endif
 
 //DNS related functions
 error_t dnsInit(void);
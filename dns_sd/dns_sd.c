@@ -54,7 +54,11 @@
 #if (DNS_SD_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t dnsSdTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t dnsSdTickCounter;
+#endif
 
 
 /**
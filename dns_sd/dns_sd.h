@@ -151,7 +151,12 @@ struct _DnsSdContext
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t dnsSdTickCounters[NET_MAX_INSTANCES];
+#define dnsSdTickCounter (dnsSdTickCounters[netContext.instance])
+#else
 extern systime_t dnsSdTickCounter;
+#endif
 
 //DNS-SD related functions
 void dnsSdGetDefaultSettings(DnsSdSettings *settings);
@@ -0,0 +1,877 @@
+/**
+ * @file af_packet_driver.c
+ * @brief Linux AF_PACKET driver with memory-mapped rings
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The driver attaches the stack to an existing Linux network device (a
+ * physical NIC, or one end of a veth pair) through a packet socket. Incoming
+ * frames are read from a TPACKET_V3 receive ring and handed to the stack in
+ * place, without any intermediate copy. Outgoing frames are written to a
+ * TPACKET_V2 transmit ring and the kernel is kicked once per batch
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include <stdlib.h>
+#include "core/net.h"
+#include "drivers/af_packet/af_packet_driver.h"
+#include "debug.h"
+
+//Undefine conflicting definitions
+#undef Socket
+#undef htons
+#undef htonl
+#undef ntohs
+#undef ntohl
+
+//Linux dependencies
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+//Offset to the payload of a transmit frame
+#define AF_PACKET_DRIVER_TX_DATA_OFFSET TPACKET_ALIGN(sizeof(struct tpacket2_hdr))
+//Largest frame that fits in a transmit slot
+#define AF_PACKET_DRIVER_TX_MAX_LENGTH (AF_PACKET_DRIVER_TX_FRAME_SIZE - AF_PACKET_DRIVER_TX_DATA_OFFSET)
+
+
+/**
+ * @brief AF_PACKET driver context
+ **/
+
+typedef struct
+{
+   int rxSocket;                   ///<Packet socket bound to the receive ring
+   int txSocket;                   ///<Packet socket bound to the transmit ring
+   int eventFd;                    ///<Event counter used to wake up the receive task
+   uint8_t *rxRing;                ///<Memory-mapped receive ring
+   uint8_t *txRing;                ///<Memory-mapped transmit ring
+   uint_t rxBlockIndex;            ///<Index of the block being processed
+   uint_t rxPacketCount;           ///<Number of packets left in the current block
+   struct tpacket3_hdr *rxPacket;  ///<Next packet in the current block
+   bool_t rxNotified;              ///<The stack has been notified of pending packets
+   uint_t txFrameIndex;            ///<Index of the next free transmit frame
+   uint_t txPending;               ///<Number of frames queued since the last kick
+   bool_t txDeferred;              ///<Kicks are deferred until the receive batch ends
+   bool_t txBlocked;               ///<The transmit ring is full
+   char_t name[IFNAMSIZ];          ///<Name of the host network device
+} AfPacketDriverContext;
+
+
+//Host network devices
+static const char_t *afPacketDriverDeviceName[NET_INTERFACE_COUNT];
+
+
+/**
+ * @brief AF_PACKET driver
+ **/
+
+const NicDriver afPacketDriver =
+{
+   NIC_TYPE_ETHERNET,
+   ETH_MTU,
+   afPacketDriverInit,
+   afPacketDriverTick,
+   afPacketDriverEnableIrq,
+   afPacketDriverDisableIrq,
+   afPacketDriverEventHandler,
+   afPacketDriverSendPacket,
+   afPacketDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   TRUE,
+   TRUE,
+   TRUE,
+   TRUE,
+   afPacketDriverReceivePacket,
+   NULL,
+   0,
+   0
+};
+
+
+/**
+ * @brief Select the host network device
+ * @param[in] interface Underlying network interface
+ * @param[in] name Name of the host network device (e.g. "veth0")
+ * @return Error code
+ **/
+
+error_t afPacketDriverSetDeviceName(NetInterface *interface,
+   const char_t *name)
+{
+   //Check parameters
+   if(interface == NULL || name == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the name is not too long
+   if(osStrlen(name) >= IFNAMSIZ)
+      return ERROR_INVALID_LENGTH;
+
+   //The device is opened when the interface is configured
+   afPacketDriverDeviceName[interface->index] = name;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Release the resources held by the driver
+ * @param[in] context Pointer to the AF_PACKET driver context
+ **/
+
+static void afPacketDriverRelease(AfPacketDriverContext *context)
+{
+   //Unmap the receive ring
+   if(context->rxRing != NULL && context->rxRing != MAP_FAILED)
+   {
+      munmap(context->rxRing, AF_PACKET_DRIVER_RX_BLOCK_SIZE *
+         AF_PACKET_DRIVER_RX_BLOCK_COUNT);
+   }
+
+   //Unmap the transmit ring
+   if(context->txRing != NULL && context->txRing != MAP_FAILED)
+   {
+      munmap(context->txRing, AF_PACKET_DRIVER_TX_FRAME_SIZE *
+         AF_PACKET_DRIVER_TX_FRAME_COUNT);
+   }
+
+   //Close sockets
+   if(context->rxSocket >= 0)
+      close(context->rxSocket);
+
+   if(context->txSocket >= 0)
+      close(context->txSocket);
+
+   //Close the event counter
+   if(context->eventFd >= 0)
+      close(context->eventFd);
+
+   //Free the driver context
+   free(context);
+}
+
+
+/**
+ * @brief AF_PACKET driver initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverInit(NetInterface *interface)
+{
+   int_t ret;
+   int_t value;
+   uint_t ifIndex;
+   struct sockaddr_ll addr;
+   struct packet_mreq mreq;
+   struct tpacket_req3 rxReq;
+   struct tpacket_req txReq;
+   AfPacketDriverContext *context;
+#if (NET_RTOS_SUPPORT == ENABLED)
+   OsTaskId taskId;
+#endif
+
+   //Debug message
+   TRACE_INFO("Initializing AF_PACKET driver...\r\n");
+
+   //Allocate AF_PACKET driver context
+   context = (AfPacketDriverContext *) osAllocMem(sizeof(AfPacketDriverContext));
+
+   //Failed to allocate memory?
+   if(context == NULL)
+   {
+      //Debug message
+      printf("Failed to allocate context!\r\n");
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Attach the AF_PACKET driver context to the network interface
+   *((AfPacketDriverContext **) interface->nicContext) = context;
+   //Clear AF_PACKET driver context
+   osMemset(context, 0, sizeof(AfPacketDriverContext));
+
+   //Sockets are not opened yet
+   context->rxSocket = -1;
+   context->txSocket = -1;
+   context->eventFd = -1;
+
+   //Select the host network device
+   if(afPacketDriverDeviceName[interface->index] != NULL)
+   {
+      osStrncpy(context->name, afPacketDriverDeviceName[interface->index],
+         IFNAMSIZ - 1);
+   }
+   else
+   {
+      osStrncpy(context->name, AF_PACKET_DRIVER_DEVICE_NAME, IFNAMSIZ - 1);
+   }
+
+   //Retrieve the index of the host network device
+   ifIndex = if_nametoindex(context->name);
+
+   //Unknown device?
+   if(ifIndex == 0)
+   {
+      //Debug message
+      printf("Failed to find device %s!\r\n", context->name);
+
+      //Clean up side effects
+      afPacketDriverRelease(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Open the packet socket used for reception
+   context->rxSocket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+   //Open the packet socket used for transmission (no frame is queued to it)
+   context->txSocket = socket(AF_PACKET, SOCK_RAW, 0);
+
+   //Create the event counter used to wake up the receive task
+   context->eventFd = eventfd(0, EFD_NONBLOCK);
+
+   //Failed to open sockets?
+   if(context->rxSocket < 0 || context->txSocket < 0 || context->eventFd < 0)
+   {
+      //Debug message
+      printf("Failed to open packet sockets!\r\n");
+
+      //Clean up side effects
+      afPacketDriverRelease(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //The receive ring uses variable-length frames packed into blocks
+   value = TPACKET_V3;
+   ret = setsockopt(context->rxSocket, SOL_PACKET, PACKET_VERSION, &value,
+      sizeof(value));
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Format receive ring request (the frame size is only used for sanity
+      //checks since frames are packed back to back within each block)
+      osMemset(&rxReq, 0, sizeof(rxReq));
+      rxReq.tp_block_size = AF_PACKET_DRIVER_RX_BLOCK_SIZE;
+      rxReq.tp_block_nr = AF_PACKET_DRIVER_RX_BLOCK_COUNT;
+      rxReq.tp_frame_size = 2048;
+      rxReq.tp_frame_nr = (AF_PACKET_DRIVER_RX_BLOCK_SIZE /
+         rxReq.tp_frame_size) * AF_PACKET_DRIVER_RX_BLOCK_COUNT;
+      rxReq.tp_retire_blk_tov = AF_PACKET_DRIVER_RX_BLOCK_TIMEOUT;
+
+      //Allocate the receive ring
+      ret = setsockopt(context->rxSocket, SOL_PACKET, PACKET_RX_RING, &rxReq,
+         sizeof(rxReq));
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Map the receive ring into the address space of the process
+      context->rxRing = mmap(NULL, AF_PACKET_DRIVER_RX_BLOCK_SIZE *
+         AF_PACKET_DRIVER_RX_BLOCK_COUNT, PROT_READ | PROT_WRITE, MAP_SHARED,
+         context->rxSocket, 0);
+
+      //Mapping failed?
+      if(context->rxRing == MAP_FAILED)
+         ret = -1;
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //The transmit ring uses fixed-size frames
+      value = TPACKET_V2;
+      ret = setsockopt(context->txSocket, SOL_PACKET, PACKET_VERSION, &value,
+         sizeof(value));
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Frames are handed directly to the driver, bypassing the qdisc layer
+      //(this option is not available on older kernels)
+      value = 1;
+      setsockopt(context->txSocket, SOL_PACKET, PACKET_QDISC_BYPASS, &value,
+         sizeof(value));
+
+      //Format transmit ring request
+      osMemset(&txReq, 0, sizeof(txReq));
+      txReq.tp_block_size = AF_PACKET_DRIVER_TX_FRAME_SIZE *
+         AF_PACKET_DRIVER_TX_FRAME_COUNT;
+      txReq.tp_block_nr = 1;
+      txReq.tp_frame_size = AF_PACKET_DRIVER_TX_FRAME_SIZE;
+      txReq.tp_frame_nr = AF_PACKET_DRIVER_TX_FRAME_COUNT;
+
+      //Allocate the transmit ring
+      ret = setsockopt(context->txSocket, SOL_PACKET, PACKET_TX_RING, &txReq,
+         sizeof(txReq));
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Map the transmit ring into the address space of the process
+      context->txRing = mmap(NULL, AF_PACKET_DRIVER_TX_FRAME_SIZE *
+         AF_PACKET_DRIVER_TX_FRAME_COUNT, PROT_READ | PROT_WRITE, MAP_SHARED,
+         context->txSocket, 0);
+
+      //Mapping failed?
+      if(context->txRing == MAP_FAILED)
+         ret = -1;
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Bind the receive socket to the host network device
+      osMemset(&addr, 0, sizeof(addr));
+      addr.sll_family = AF_PACKET;
+      addr.sll_protocol = htons(ETH_P_ALL);
+      addr.sll_ifindex = ifIndex;
+
+      //Bind the socket
+      ret = bind(context->rxSocket, (struct sockaddr *) &addr, sizeof(addr));
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //Bind the transmit socket to the same device
+      addr.sll_protocol = 0;
+
+      //Bind the socket
+      ret = bind(context->txSocket, (struct sockaddr *) &addr, sizeof(addr));
+   }
+
+   //Check status code
+   if(ret == 0)
+   {
+      //The MAC address of the stack differs from the one of the host device,
+      //so the device must operate in promiscuous mode
+      osMemset(&mreq, 0, sizeof(mreq));
+      mreq.mr_ifindex = ifIndex;
+      mreq.mr_type = PACKET_MR_PROMISC;
+
+      //Join the promiscuous membership
+      ret = setsockopt(context->rxSocket, SOL_PACKET, PACKET_ADD_MEMBERSHIP,
+         &mreq, sizeof(mreq));
+   }
+
+   //Any error to report?
+   if(ret != 0)
+   {
+      //Debug message
+      printf("Failed to set up packet rings on %s!\r\n", context->name);
+
+      //Clean up side effects
+      afPacketDriverRelease(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Create the receive task
+   taskId = osCreateTask("AF_PACKET", (OsTaskCode) afPacketDriverTask,
+      interface, 0, 0);
+
+   //Failed to create the task?
+   if(taskId == OS_INVALID_TASK_ID)
+   {
+      //Debug message
+      printf("Failed to create task!\r\n");
+
+      //Clean up side effects
+      afPacketDriverRelease(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+#endif
+
+   //Accept any packets from the upper layer
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Kick the kernel to transmit queued frames
+ * @param[in] context Pointer to the AF_PACKET driver context
+ **/
+
+static void afPacketDriverFlushTx(AfPacketDriverContext *context)
+{
+   //Any frame waiting for transmission?
+   if(context->txPending > 0)
+   {
+      //A single system call sends every frame marked as ready
+      sendto(context->txSocket, NULL, 0, MSG_DONTWAIT, NULL, 0);
+      //Reset the batch
+      context->txPending = 0;
+   }
+}
+
+
+/**
+ * @brief Wake up the receive task
+ *
+ * The receive task must re-evaluate the set of events it waits for whenever
+ * the stack clears rxNotified or sets txBlocked
+ *
+ * @param[in] context Pointer to the AF_PACKET driver context
+ **/
+
+static void afPacketDriverWakeTask(AfPacketDriverContext *context)
+{
+   uint64_t value;
+
+   //Increment the event counter
+   value = 1;
+   write(context->eventFd, &value, sizeof(value));
+}
+
+
+/**
+ * @brief AF_PACKET timer handler
+ *
+ * This routine is periodically called by the TCP/IP stack to handle periodic
+ * operations such as polling the link state
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverTick(NetInterface *interface)
+{
+   bool_t linkState;
+   struct ifreq ifr;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Send any frame left over from a truncated receive batch
+   afPacketDriverFlushTx(context);
+
+   //Retrieve the flags of the host network device
+   osMemset(&ifr, 0, sizeof(ifr));
+   osStrncpy(ifr.ifr_name, context->name, IFNAMSIZ - 1);
+
+   //The link is up when the device is up and has a carrier
+   if(ioctl(context->rxSocket, SIOCGIFFLAGS, &ifr) == 0 &&
+      (ifr.ifr_flags & IFF_UP) != 0 && (ifr.ifr_flags & IFF_RUNNING) != 0)
+   {
+      linkState = TRUE;
+   }
+   else
+   {
+      linkState = FALSE;
+   }
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //Host devices do not report a meaningful speed
+      interface->linkSpeed = NIC_LINK_SPEED_1GBPS;
+      interface->duplexMode = NIC_FULL_DUPLEX_MODE;
+
+      //Update link state
+      interface->linkState = linkState;
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief AF_PACKET event handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverEventHandler(NetInterface *interface)
+{
+   error_t error;
+
+   //Process all pending packets
+   do
+   {
+      //Read incoming packet
+      error = afPacketDriverReceivePacket(interface);
+
+      //No more data in the receive ring?
+   } while(error != ERROR_BUFFER_EMPTY);
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t afPacketDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   size_t length;
+   uint8_t *frame;
+   struct tpacket2_hdr *header;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Check the frame length
+   if(length > AF_PACKET_DRIVER_TX_MAX_LENGTH)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+   //Point to the current transmit frame
+   frame = context->txRing + context->txFrameIndex * AF_PACKET_DRIVER_TX_FRAME_SIZE;
+   header = (struct tpacket2_hdr *) frame;
+
+   //Make sure the frame is owned by the application
+   if(header->tp_status != TP_STATUS_AVAILABLE &&
+      header->tp_status != TP_STATUS_WRONG_FORMAT)
+   {
+      //Push out whatever is queued and wait for the kernel
+      afPacketDriverFlushTx(context);
+      context->txBlocked = TRUE;
+      afPacketDriverWakeTask(context);
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Copy user data directly into the transmit ring
+   netBufferRead(frame + AF_PACKET_DRIVER_TX_DATA_OFFSET, buffer, offset,
+      length);
+
+   //Set the length of the frame
+   header->tp_len = length;
+   //Make sure the contents are visible before ownership changes
+   __sync_synchronize();
+   //Give the ownership of the frame to the kernel
+   header->tp_status = TP_STATUS_SEND_REQUEST;
+
+   //Point to the next transmit frame
+   context->txFrameIndex = (context->txFrameIndex + 1) %
+      AF_PACKET_DRIVER_TX_FRAME_COUNT;
+
+   //One more frame is waiting for a kick
+   context->txPending++;
+
+   //Frames generated while a receive batch is processed are sent together
+   //at the end of the batch
+   if(!context->txDeferred ||
+      context->txPending >= AF_PACKET_DRIVER_TX_BATCH_SIZE)
+   {
+      afPacketDriverFlushTx(context);
+   }
+
+   //Point to the next transmit frame
+   header = (struct tpacket2_hdr *) (context->txRing +
+      context->txFrameIndex * AF_PACKET_DRIVER_TX_FRAME_SIZE);
+
+   //Check whether the next frame is available
+   if(header->tp_status == TP_STATUS_AVAILABLE ||
+      header->tp_status == TP_STATUS_WRONG_FORMAT)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+   }
+   else
+   {
+      //Push out whatever is queued
+      afPacketDriverFlushTx(context);
+      //The receive task signals the stack when the kernel releases the frame
+      context->txBlocked = TRUE;
+      afPacketDriverWakeTask(context);
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Receive a packet
+ *
+ * Packets are handed to the stack in place, directly from the receive ring.
+ * A block is returned to the kernel once all its packets have been processed
+ *
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverReceivePacket(NetInterface *interface)
+{
+   struct tpacket3_hdr *packet;
+   struct tpacket_block_desc *block;
+   struct sockaddr_ll *addr;
+   AfPacketDriverContext *context;
+   NetRxAncillary ancillary;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+   //Point to the current block
+   block = (struct tpacket_block_desc *) (context->rxRing +
+      context->rxBlockIndex * AF_PACKET_DRIVER_RX_BLOCK_SIZE);
+
+   //Start processing a new block?
+   if(context->rxPacket == NULL)
+   {
+      //Make sure the block is owned by the application
+      if((block->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+      {
+         //Send the frames generated during the receive batch
+         afPacketDriverFlushTx(context);
+         //The receive task may notify the stack again
+         context->rxNotified = FALSE;
+         afPacketDriverWakeTask(context);
+
+         //No more data in the receive ring
+         return ERROR_BUFFER_EMPTY;
+      }
+
+      //Make sure the block contents are read after its status
+      __sync_synchronize();
+
+      //Point to the first packet of the block
+      context->rxPacketCount = block->hdr.bh1.num_pkts;
+      context->rxPacket = (struct tpacket3_hdr *) ((uint8_t *) block +
+         block->hdr.bh1.offset_to_first_pkt);
+   }
+
+   //Any packet left in the current block?
+   if(context->rxPacketCount > 0)
+   {
+      //Point to the current packet
+      packet = context->rxPacket;
+      //The link-layer address information follows the header
+      addr = (struct sockaddr_ll *) ((uint8_t *) packet +
+         TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+      //Discard the frames sent by the stack itself
+      if(addr->sll_pkttype != PACKET_OUTGOING && interface->linkState)
+      {
+         //Additional options can be passed to the stack along with the packet
+         ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+         //Defer the frames generated in response to this packet
+         context->txDeferred = TRUE;
+
+         //Pass the packet to the upper layer without copying it
+         nicProcessPacket(interface, (uint8_t *) packet + packet->tp_mac,
+            packet->tp_snaplen, &ancillary);
+
+         //End of deferral
+         context->txDeferred = FALSE;
+      }
+
+      //Point to the next packet
+      context->rxPacket = (struct tpacket3_hdr *) ((uint8_t *) packet +
+         packet->tp_next_offset);
+      context->rxPacketCount--;
+   }
+
+   //All the packets of the block have been processed?
+   if(context->rxPacketCount == 0)
+   {
+      //Make sure the block is no longer accessed before it is released
+      __sync_synchronize();
+      //Give the ownership of the block back to the kernel
+      block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+      //Point to the next block
+      context->rxBlockIndex = (context->rxBlockIndex + 1) %
+         AF_PACKET_DRIVER_RX_BLOCK_COUNT;
+      context->rxPacket = NULL;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t afPacketDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //The device operates in promiscuous mode and the Ethernet layer of the
+   //stack discards the frames that are not addressed to it
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief AF_PACKET receive task
+ *
+ * The task only signals the TCP/IP stack. Packets are processed by the
+ * stack itself, directly from the receive ring
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void afPacketDriverTask(NetInterface *interface)
+{
+   uint64_t value;
+   struct pollfd fds[3];
+   struct tpacket2_hdr *header;
+   struct tpacket_block_desc *block;
+   AfPacketDriverContext *context;
+
+   //Point to the AF_PACKET driver context
+   context = *((AfPacketDriverContext **) interface->nicContext);
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Notify the instance of the TCP/IP stack the interface belongs to
+   netSetCurrentContext(interface->stackContext);
+#endif
+
+   //Process events
+   while(1)
+   {
+      //Do not wait for blocks while the stack is still processing the
+      //previous ones, otherwise poll() would return immediately
+      fds[0].fd = context->rxSocket;
+      fds[0].events = context->rxNotified ? 0 : POLLIN;
+      fds[0].revents = 0;
+
+      //Wait for the kernel to release transmit frames if the ring is full
+      fds[1].fd = context->txSocket;
+      fds[1].events = context->txBlocked ? POLLOUT : 0;
+      fds[1].revents = 0;
+
+      //The stack signals the event counter when the above events change
+      fds[2].fd = context->eventFd;
+      fds[2].events = POLLIN;
+      fds[2].revents = 0;
+
+      //Wait for an event
+      poll(fds, 3, AF_PACKET_DRIVER_TIMEOUT);
+
+      //Reset the event counter before the state is examined, so that a
+      //subsequent change cannot be missed
+      if((fds[2].revents & POLLIN) != 0)
+      {
+         read(context->eventFd, &value, sizeof(value));
+      }
+
+      //Point to the next block to be processed by the stack
+      block = (struct tpacket_block_desc *) (context->rxRing +
+         context->rxBlockIndex * AF_PACKET_DRIVER_RX_BLOCK_SIZE);
+
+      //Any packet received?
+      if(!context->rxNotified &&
+         (block->hdr.bh1.block_status & TP_STATUS_USER) != 0)
+      {
+         //Only notify the stack once per receive batch
+         context->rxNotified = TRUE;
+
+         //Set event flag
+         interface->nicEvent = TRUE;
+         //Notify the TCP/IP stack of the event
+         osSetEvent(&netEvent);
+      }
+
+      //Point to the next frame to be filled by the stack
+      header = (struct tpacket2_hdr *) (context->txRing +
+         context->txFrameIndex * AF_PACKET_DRIVER_TX_FRAME_SIZE);
+
+      //The kernel has released the frame?
+      if(context->txBlocked && (header->tp_status == TP_STATUS_AVAILABLE ||
+         header->tp_status == TP_STATUS_WRONG_FORMAT))
+      {
+         //The transmitter can accept another packet
+         context->txBlocked = FALSE;
+         osSetEvent(&interface->nicTxEvent);
+      }
+
+#if (NET_RTOS_SUPPORT == DISABLED)
+      //Return to the caller
+      break;
+#endif
+   }
+}
@@ -0,0 +1,127 @@
+/**
+ * @file af_packet_driver.h
+ * @brief Linux AF_PACKET driver with memory-mapped rings
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _AF_PACKET_DRIVER_H
+#define _AF_PACKET_DRIVER_H
+
+//Dependencies
+#include "core/nic.h"
+
+//Default host network device
+#ifndef AF_PACKET_DRIVER_DEVICE_NAME
+   #define AF_PACKET_DRIVER_DEVICE_NAME "veth0"
+#endif
+
+//Size of the receive ring blocks (multiple of the page size)
+#ifndef AF_PACKET_DRIVER_RX_BLOCK_SIZE
+   #define AF_PACKET_DRIVER_RX_BLOCK_SIZE 65536
+#elif (AF_PACKET_DRIVER_RX_BLOCK_SIZE < 4096 || (AF_PACKET_DRIVER_RX_BLOCK_SIZE % 4096) != 0)
+   #error AF_PACKET_DRIVER_RX_BLOCK_SIZE parameter is not valid
+#endif
+
+//Number of blocks in the receive ring
+#ifndef AF_PACKET_DRIVER_RX_BLOCK_COUNT
+   #define AF_PACKET_DRIVER_RX_BLOCK_COUNT 16
+#elif (AF_PACKET_DRIVER_RX_BLOCK_COUNT < 2)
+   #error AF_PACKET_DRIVER_RX_BLOCK_COUNT parameter is not valid
+#endif
+
+//Time after which a partially filled receive block is handed over, in ms
+#ifndef AF_PACKET_DRIVER_RX_BLOCK_TIMEOUT
+   #define AF_PACKET_DRIVER_RX_BLOCK_TIMEOUT 1
+#elif (AF_PACKET_DRIVER_RX_BLOCK_TIMEOUT < 1)
+   #error AF_PACKET_DRIVER_RX_BLOCK_TIMEOUT parameter is not valid
+#endif
+
+//Size of the transmit ring frames (power of two)
+#ifndef AF_PACKET_DRIVER_TX_FRAME_SIZE
+   #define AF_PACKET_DRIVER_TX_FRAME_SIZE 2048
+#elif (AF_PACKET_DRIVER_TX_FRAME_SIZE < 2048 || (AF_PACKET_DRIVER_TX_FRAME_SIZE & (AF_PACKET_DRIVER_TX_FRAME_SIZE - 1)) != 0)
+   #error AF_PACKET_DRIVER_TX_FRAME_SIZE parameter is not valid
+#endif
+
+//Number of frames in the transmit ring
+#ifndef AF_PACKET_DRIVER_TX_FRAME_COUNT
+   #define AF_PACKET_DRIVER_TX_FRAME_COUNT 256
+#elif (AF_PACKET_DRIVER_TX_FRAME_COUNT < 2 || ((AF_PACKET_DRIVER_TX_FRAME_COUNT * AF_PACKET_DRIVER_TX_FRAME_SIZE) % 4096) != 0)
+   #error AF_PACKET_DRIVER_TX_FRAME_COUNT parameter is not valid
+#endif
+
+//Maximum number of frames queued before the kernel is kicked
+#ifndef AF_PACKET_DRIVER_TX_BATCH_SIZE
+   #define AF_PACKET_DRIVER_TX_BATCH_SIZE 16
+#elif (AF_PACKET_DRIVER_TX_BATCH_SIZE < 1 || AF_PACKET_DRIVER_TX_BATCH_SIZE > AF_PACKET_DRIVER_TX_FRAME_COUNT)
+   #error AF_PACKET_DRIVER_TX_BATCH_SIZE parameter is not valid
+#endif
+
+//Polling timeout of the receive task, in ms (safety net only, since the
+//stack wakes up the task whenever it needs to)
+#ifndef AF_PACKET_DRIVER_TIMEOUT
+   #define AF_PACKET_DRIVER_TIMEOUT 10
+#elif (AF_PACKET_DRIVER_TIMEOUT < 1)
+   #error AF_PACKET_DRIVER_TIMEOUT parameter is not valid
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//AF_PACKET driver
+extern const NicDriver afPacketDriver;
+
+//AF_PACKET related functions
+error_t afPacketDriverSetDeviceName(NetInterface *interface,
+   const char_t *name);
+
+error_t afPacketDriverInit(NetInterface *interface);
+
+void afPacketDriverTick(NetInterface *interface);
+
+void afPacketDriverEnableIrq(NetInterface *interface);
+void afPacketDriverDisableIrq(NetInterface *interface);
+
+void afPacketDriverEventHandler(NetInterface *interface);
+
+error_t afPacketDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t afPacketDriverReceivePacket(NetInterface *interface);
+
+error_t afPacketDriverUpdateMacAddrFilter(NetInterface *interface);
+
+void afPacketDriverTask(NetInterface *interface);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
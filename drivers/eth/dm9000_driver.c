@@ -59,7 +59,11 @@ const NicDriver dm9000Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -58,7 +58,11 @@ const NicDriver enc28j60Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
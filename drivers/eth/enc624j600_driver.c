@@ -58,7 +58,11 @@ const NicDriver enc624j600Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
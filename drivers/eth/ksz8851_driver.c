@@ -58,7 +58,11 @@ const NicDriver ksz8851Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
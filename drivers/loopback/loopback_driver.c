@@ -36,12 +36,12 @@
 #include "loopback_driver.h"
 #include "debug.h"
 
-//Loopback interface queue
-static LoopbackDriverQueueEntry queue[LOOPBACK_DRIVER_QUEUE_SIZE];
-
-static uint_t queueLength;
-static uint_t queueTxIndex;
-static uint_t queueRxIndex;
+//Loopback interface contexts (one per stack instance)
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static LoopbackDriverContext loopbackDriverContexts[NET_MAX_INSTANCES];
+#else
+static LoopbackDriverContext loopbackDriverContexts[1];
+#endif
 
 
 /**
@@ -65,7 +65,11 @@ const NicDriver loopbackDriver =
    FALSE,
    FALSE,
    FALSE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -77,13 +81,18 @@ const NicDriver loopbackDriver =
 
 error_t loopbackDriverInit(NetInterface *interface)
 {
+   LoopbackDriverContext *context;
+
    //Debug message
    TRACE_INFO("Initializing loopback interface...\r\n");
 
+   //Point to the loopback interface context
+   context = loopbackDriverGetContext(interface);
+
    //Initialize variables
-   queueLength = 0;
-   queueTxIndex = 0;
-   queueRxIndex = 0;
+   context->queueLength = 0;
+   context->queueTxIndex = 0;
+   context->queueRxIndex = 0;
 
    //Force the TCP/IP stack to poll the link state at startup
    interface->nicEvent = TRUE;
@@ -141,6 +150,11 @@ void loopbackDriverDisableIrq(NetInterface *interface)
 
 void loopbackDriverEventHandler(NetInterface *interface)
 {
+   LoopbackDriverContext *context;
+
+   //Point to the loopback interface context
+   context = loopbackDriverGetContext(interface);
+
    //Link up event is pending?
    if(!interface->linkState)
    {
@@ -154,7 +168,7 @@ void loopbackDriverEventHandler(NetInterface *interface)
    loopbackDriverReceivePacket(interface);
 
    //Check whether another packet is pending in the queue
-   if(queueLength > 0)
+   if(context->queueLength > 0)
    {
       //Set event flag
       interface->nicEvent = TRUE;
@@ -179,10 +193,15 @@ error_t loopbackDriverSendPacket(NetInterface *interface,
 {
    error_t error;
    size_t length;
+   LoopbackDriverQueueEntry *entry;
+   LoopbackDriverContext *context;
 
    //Initialize status code
    error = NO_ERROR;
 
+   //Point to the loopback interface context
+   context = loopbackDriverGetContext(interface);
+
    //Retrieve the length of the packet
    length = netBufferGetLength(buffer) - offset;
 
@@ -190,23 +209,25 @@ error_t loopbackDriverSendPacket(NetInterface *interface,
    if(length <= ETH_MTU)
    {
       //Check whether the queue is full
-      if(queueLength < LOOPBACK_DRIVER_QUEUE_SIZE)
+      if(context->queueLength < LOOPBACK_DRIVER_QUEUE_SIZE)
       {
+         //Point to the current entry
+         entry = &context->queue[context->queueTxIndex];
+
          //Retrieve the length of the packet
-         queue[queueTxIndex].length = netBufferGetLength(buffer) - offset;
+         entry->length = netBufferGetLength(buffer) - offset;
 
          //Copy data to the queue
-         netBufferRead(queue[queueTxIndex].data, buffer,
-            offset, queue[queueTxIndex].length);
+         netBufferRead(entry->data, buffer, offset, entry->length);
 
          //Increment index and wrap around if necessary
-         if(++queueTxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
+         if(++context->queueTxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
          {
-            queueTxIndex = 0;
+            context->queueTxIndex = 0;
          }
 
          //Update the length of the queue
-         queueLength++;
+         context->queueLength++;
 
          //Set event flag
          interface->nicEvent = TRUE;
@@ -238,25 +259,32 @@ error_t loopbackDriverReceivePacket(NetInterface *interface)
 {
    error_t error;
    NetRxAncillary ancillary;
+   LoopbackDriverQueueEntry *entry;
+   LoopbackDriverContext *context;
+
+   //Point to the loopback interface context
+   context = loopbackDriverGetContext(interface);
 
    //Check whether a packet is pending in the queue
-   if(queueLength > 0)
+   if(context->queueLength > 0)
    {
+      //Point to the current entry
+      entry = &context->queue[context->queueRxIndex];
+
       //Additional options can be passed to the stack along with the packet
       ancillary = NET_DEFAULT_RX_ANCILLARY;
 
       //Pass the packet to the upper layer
-      nicProcessPacket(interface, queue[queueRxIndex].data,
-         queue[queueRxIndex].length, &ancillary);
+      nicProcessPacket(interface, entry->data, entry->length, &ancillary);
 
       //Increment index and wrap around if necessary
-      if(++queueRxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
+      if(++context->queueRxIndex >= LOOPBACK_DRIVER_QUEUE_SIZE)
       {
-         queueRxIndex = 0;
+         context->queueRxIndex = 0;
       }
 
       //Update the length of the queue
-      queueLength--;
+      context->queueLength--;
 
       //Packet successfully received
       error = NO_ERROR;
@@ -283,3 +311,22 @@ error_t loopbackDriverUpdateMacAddrFilter(NetInterface *interface)
    //Not implemented
    return NO_ERROR;
 }
+
+
+/**
+ * @brief Get the loopback interface context
+ * @param[in] interface Underlying network interface
+ * @return Pointer to the context of the stack instance the interface
+ *   belongs to
+ **/
+
+LoopbackDriverContext *loopbackDriverGetContext(NetInterface *interface)
+{
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each stack instance has its own queue
+   return &loopbackDriverContexts[interface->stackContext->instance];
+#else
+   //Single stack instance
+   return &loopbackDriverContexts[0];
+#endif
+}
@@ -53,6 +53,19 @@ typedef struct
 } LoopbackDriverQueueEntry;
 
 
+/**
+ * @brief Loopback interface context
+ **/
+
+typedef struct
+{
+   LoopbackDriverQueueEntry queue[LOOPBACK_DRIVER_QUEUE_SIZE]; ///<Packet queue
+   uint_t queueLength;                                         ///<Number of packets in the queue
+   uint_t queueTxIndex;                                        ///<Write index
+   uint_t queueRxIndex;                                        ///<Read index
+} LoopbackDriverContext;
+
+
 //Loopback interface driver
 extern const NicDriver loopbackDriver;
 
@@ -72,4 +85,6 @@ error_t loopbackDriverReceivePacket(NetInterface *interface);
 
 error_t loopbackDriverUpdateMacAddrFilter(NetInterface *interface);
 
+LoopbackDriverContext *loopbackDriverGetContext(NetInterface *interface);
+
 #endif
@@ -103,7 +103,11 @@ const NicDriver a2fxxxm3EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   a2fxxxm3EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
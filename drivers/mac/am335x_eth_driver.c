@@ -140,7 +140,11 @@ const NicDriver am335xEthPort1Driver =
    FALSE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -165,7 +169,11 @@ const NicDriver am335xEthPort2Driver =
    FALSE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
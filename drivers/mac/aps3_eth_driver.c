@@ -79,7 +79,11 @@ const NicDriver aps3EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
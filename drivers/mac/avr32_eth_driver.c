@@ -104,7 +104,11 @@ const NicDriver avr32EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
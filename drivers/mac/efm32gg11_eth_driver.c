@@ -104,7 +104,11 @@ const NicDriver efm32gg11EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
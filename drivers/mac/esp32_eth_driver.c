@@ -81,7 +81,11 @@ const NicDriver esp32EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   esp32EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
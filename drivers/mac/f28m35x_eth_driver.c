@@ -88,7 +88,11 @@ const NicDriver f28m35xEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
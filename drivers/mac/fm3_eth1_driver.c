@@ -101,7 +101,11 @@ const NicDriver fm3Eth1Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   fm3Eth1ReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
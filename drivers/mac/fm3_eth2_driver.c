@@ -101,7 +101,11 @@ const NicDriver fm3Eth2Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   fm3Eth2ReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -101,7 +101,11 @@ const NicDriver fm4EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   fm4EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
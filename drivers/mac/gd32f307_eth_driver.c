@@ -101,7 +101,11 @@ const NicDriver gd32f307EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   gd32f307EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -95,7 +95,11 @@ const NicDriver lm3sEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
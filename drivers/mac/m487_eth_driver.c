@@ -101,7 +101,11 @@ const NicDriver m487EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   m487EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -107,7 +107,11 @@ const NicDriver mcimx6ulEth2Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
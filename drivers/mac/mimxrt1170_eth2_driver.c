@@ -107,7 +107,11 @@ const NicDriver mimxrt1170Eth2Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
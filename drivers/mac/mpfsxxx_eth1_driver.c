@@ -97,7 +97,11 @@ const NicDriver mpfsxxxEth1Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -97,7 +97,11 @@ const NicDriver mpfsxxxEth2Driver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
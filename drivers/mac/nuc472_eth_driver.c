@@ -101,7 +101,11 @@ const NicDriver nuc472EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   nuc472EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -118,7 +118,11 @@ const NicDriver omapl138EthDriver =
    FALSE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -101,7 +101,11 @@ const NicDriver ra6EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   ra6EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -102,7 +102,11 @@ const NicDriver rx62nEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
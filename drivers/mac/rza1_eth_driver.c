@@ -107,7 +107,11 @@ const NicDriver rza1EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
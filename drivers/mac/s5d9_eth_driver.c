@@ -102,7 +102,11 @@ const NicDriver s5d9EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   s5d9EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -102,7 +102,11 @@ const NicDriver s7g2Eth1Driver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   s7g2Eth1ReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
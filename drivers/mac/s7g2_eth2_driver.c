@@ -102,7 +102,11 @@ const NicDriver s7g2Eth2Driver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   s7g2Eth2ReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -106,7 +106,11 @@ const NicDriver sama5d3GigabitEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
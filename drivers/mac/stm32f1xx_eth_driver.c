@@ -107,7 +107,11 @@ const NicDriver stm32f1xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32f1xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -106,7 +106,11 @@ const NicDriver stm32f2xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32f2xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -81,6 +81,14 @@ static Stm32f4xxRxDmaDesc rxDmaDesc[STM32F4XX_ETH_RX_BUFFER_COUNT]
 
 //Pointer to the current TX DMA descriptor
 static Stm32f4xxTxDmaDesc *txCurDmaDesc;
+//Pointer to the oldest TX DMA descriptor not yet reclaimed
+static Stm32f4xxTxDmaDesc *txDirtyDmaDesc;
+//Number of TX DMA descriptors not yet reclaimed
+static uint_t txPendingCount;
+//Completion callbacks of scatter-gather transmissions
+static NicTxCompleteCallback txCallback[STM32F4XX_ETH_TX_BUFFER_COUNT];
+//Completion callback parameters
+static void *txCallbackParam[STM32F4XX_ETH_TX_BUFFER_COUNT];
 //Pointer to the current RX DMA descriptor
 static Stm32f4xxRxDmaDesc *rxCurDmaDesc;
 
@@ -106,7 +114,11 @@ const NicDriver stm32f4xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32f4xxEthReceivePacket,
+   stm32f4xxEthSendChunks,
+   0,
+   0
 };
 
 
@@ -648,6 +660,13 @@ void stm32f4xxEthInitDmaDesc(NetInterface *interface)
    //Initialize TX DMA descriptor list
    for(i = 0; i < STM32F4XX_ETH_TX_BUFFER_COUNT; i++)
    {
+      //Transmissions still in flight are aborted
+      if(txCallback[i] != NULL)
+      {
+         txCallback[i](interface, txCallbackParam[i]);
+         txCallback[i] = NULL;
+      }
+
       //Use chain structure rather than ring structure
       txDmaDesc[i].tdes0 = ETH_TDES0_IC | ETH_TDES0_TCH;
       //Initialize transmit buffer size
@@ -668,6 +687,9 @@ void stm32f4xxEthInitDmaDesc(NetInterface *interface)
    txDmaDesc[i - 1].tdes3 = (uint32_t) &txDmaDesc[0];
    //Point to the very first descriptor
    txCurDmaDesc = &txDmaDesc[0];
+   txDirtyDmaDesc = &txDmaDesc[0];
+   //No descriptor is pending
+   txPendingCount = 0;
 
    //Initialize RX DMA descriptor list
    for(i = 0; i < STM32F4XX_ETH_RX_BUFFER_COUNT; i++)
@@ -810,8 +832,15 @@ void ETH_IRQHandler(void)
       //Clear TS interrupt flag
       ETH->DMASR = ETH_DMASR_TS;
 
+      //Complete the scatter-gather transmissions released by the DMA
+      if(stm32f4xxEthReclaimTxDesc(nicDriverInterface))
+      {
+         //Let the TCP/IP stack task release the underlying buffers
+         flag |= osSetEventFromIsr(&netEvent);
+      }
+
       //Check whether the TX buffer is available for writing
-      if((txCurDmaDesc->tdes0 & ETH_TDES0_OWN) == 0)
+      if(txPendingCount < STM32F4XX_ETH_TX_BUFFER_COUNT)
       {
          //Notify the TCP/IP stack that the transmitter is ready to send
          flag |= osSetEventFromIsr(&nicDriverInterface->nicTxEvent);
@@ -885,19 +914,26 @@ error_t stm32f4xxEthSendPacket(NetInterface *interface,
       return ERROR_INVALID_LENGTH;
    }
 
+   //Reclaim the descriptors released by the DMA
+   stm32f4xxEthReclaimTxDesc(interface);
+
    //Make sure the current buffer is available for writing
-   if((txCurDmaDesc->tdes0 & ETH_TDES0_OWN) != 0)
+   if(txPendingCount >= STM32F4XX_ETH_TX_BUFFER_COUNT)
    {
       return ERROR_FAILURE;
    }
 
+   //The descriptor may have been used by a scatter-gather transmission
+   txCurDmaDesc->tdes2 = (uint32_t) txBuffer[txCurDmaDesc - txDmaDesc];
+
    //Copy user data to the transmit buffer
    netBufferRead((uint8_t *) txCurDmaDesc->tdes2, buffer, offset, length);
 
    //Write the number of bytes to send
    txCurDmaDesc->tdes1 = length & ETH_TDES1_TBS1;
    //Set LS and FS flags as the data fits in a single buffer
-   txCurDmaDesc->tdes0 |= ETH_TDES0_LS | ETH_TDES0_FS;
+   txCurDmaDesc->tdes0 = ETH_TDES0_IC | ETH_TDES0_LS | ETH_TDES0_FS |
+      ETH_TDES0_TCH;
    //Give the ownership of the descriptor to the DMA
    txCurDmaDesc->tdes0 |= ETH_TDES0_OWN;
 
@@ -908,9 +944,11 @@ error_t stm32f4xxEthSendPacket(NetInterface *interface,
 
    //Point to the next descriptor in the list
    txCurDmaDesc = (Stm32f4xxTxDmaDesc *) txCurDmaDesc->tdes3;
+   //Update the number of pending descriptors
+   txPendingCount++;
 
    //Check whether the next buffer is available for writing
-   if((txCurDmaDesc->tdes0 & ETH_TDES0_OWN) == 0)
+   if(txPendingCount < STM32F4XX_ETH_TX_BUFFER_COUNT)
    {
       //The transmitter can accept another packet
       osSetEvent(&interface->nicTxEvent);
@@ -921,6 +959,164 @@ error_t stm32f4xxEthSendPacket(NetInterface *interface,
 }
 
 
+/**
+ * @brief Send a packet described as a list of chunks
+ *
+ * Each chunk is transmitted directly from its location in memory, using one
+ * DMA descriptor per chunk. The memory must be accessible by the Ethernet
+ * DMA (the CCM RAM is not)
+ *
+ * @param[in] interface Underlying network interface
+ * @param[in] chunks List of contiguous memory regions that form the packet
+ * @param[in] count Number of chunks
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @param[in] callback Function to invoke once the chunks are released
+ * @param[in] param Callback function parameter
+ * @return Error code
+ **/
+
+error_t stm32f4xxEthSendChunks(NetInterface *interface,
+   const NicTxChunk *chunks, uint_t count, NetTxAncillary *ancillary,
+   NicTxCompleteCallback callback, void *param)
+{
+   uint_t i;
+   size_t length;
+   Stm32f4xxTxDmaDesc *desc;
+   Stm32f4xxTxDmaDesc *lastDesc;
+
+   //Compute the length of the packet
+   for(length = 0, i = 0; i < count; i++)
+   {
+      length += chunks[i].length;
+   }
+
+   //Check the frame length
+   if(count == 0 || length > STM32F4XX_ETH_TX_BUFFER_SIZE)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+   //Reclaim the descriptors released by the DMA
+   stm32f4xxEthReclaimTxDesc(interface);
+
+   //Make sure enough descriptors are available
+   if((txPendingCount + count) > STM32F4XX_ETH_TX_BUFFER_COUNT)
+   {
+      return ERROR_FAILURE;
+   }
+
+   //Point to the first descriptor of the frame
+   desc = txCurDmaDesc;
+   lastDesc = desc;
+
+   //Loop through the chunks
+   for(i = 0; i < count; i++)
+   {
+      //Transmit the chunk directly from its location in memory
+      desc->tdes2 = (uint32_t) chunks[i].address;
+      //Write the number of bytes to send
+      desc->tdes1 = chunks[i].length & ETH_TDES1_TBS1;
+      //Use chain structure rather than ring structure
+      desc->tdes0 = ETH_TDES0_TCH;
+
+      //First descriptor of the frame?
+      if(i == 0)
+      {
+         desc->tdes0 |= ETH_TDES0_FS;
+      }
+      else
+      {
+         //The first descriptor is given to the DMA last
+         desc->tdes0 |= ETH_TDES0_OWN;
+      }
+
+      //Point to the next descriptor in the list
+      lastDesc = desc;
+      desc = (Stm32f4xxTxDmaDesc *) desc->tdes3;
+   }
+
+   //Request an interrupt once the last descriptor has been processed
+   lastDesc->tdes0 |= ETH_TDES0_LS | ETH_TDES0_IC;
+
+   //The callback is invoked when the last descriptor is reclaimed
+   txCallback[lastDesc - txDmaDesc] = callback;
+   txCallbackParam[lastDesc - txDmaDesc] = param;
+
+   //Give the ownership of the first descriptor to the DMA
+   txCurDmaDesc->tdes0 |= ETH_TDES0_OWN;
+
+   //Clear TBUS flag to resume processing
+   ETH->DMASR = ETH_DMASR_TBUS;
+   //Instruct the DMA to poll the transmit descriptor list
+   ETH->DMATPDR = 0;
+
+   //Point to the next free descriptor
+   txCurDmaDesc = desc;
+   //Update the number of pending descriptors
+   txPendingCount += count;
+
+   //Check whether the next buffer is available for writing
+   if(txPendingCount < STM32F4XX_ETH_TX_BUFFER_COUNT)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+   }
+
+   //Data successfully written
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Reclaim the TX DMA descriptors released by the DMA
+ *
+ * This function is called from the interrupt service routine, and from the
+ * send functions while interrupts are disabled
+ *
+ * @param[in] interface Underlying network interface
+ * @return TRUE if a completion callback has been invoked, else FALSE
+ **/
+
+bool_t stm32f4xxEthReclaimTxDesc(NetInterface *interface)
+{
+   uint_t i;
+   bool_t flag;
+
+   //No completion callback has been invoked yet
+   flag = FALSE;
+
+   //Loop through the descriptors released by the DMA
+   while(txPendingCount > 0 && (txDirtyDmaDesc->tdes0 & ETH_TDES0_OWN) == 0)
+   {
+      //Index of the current descriptor
+      i = txDirtyDmaDesc - txDmaDesc;
+
+      //Last descriptor of a scatter-gather transmission?
+      if(txCallback[i] != NULL)
+      {
+         //The chunks are no longer referenced
+         txCallback[i](interface, txCallbackParam[i]);
+         txCallback[i] = NULL;
+
+         //Set flag
+         flag = TRUE;
+      }
+
+      //Point to the next descriptor in the list
+      txDirtyDmaDesc = (Stm32f4xxTxDmaDesc *) txDirtyDmaDesc->tdes3;
+      //Update the number of pending descriptors
+      txPendingCount--;
+   }
+
+   //Return TRUE if a completion callback has been invoked
+   return flag;
+}
+
+
 /**
  * @brief Receive a packet
  * @param[in] interface Underlying network interface
@@ -215,6 +215,12 @@ void stm32f4xxEthEventHandler(NetInterface *interface);
 error_t stm32f4xxEthSendPacket(NetInterface *interface,
    const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
 
+error_t stm32f4xxEthSendChunks(NetInterface *interface,
+   const NicTxChunk *chunks, uint_t count, NetTxAncillary *ancillary,
+   NicTxCompleteCallback callback, void *param);
+
+bool_t stm32f4xxEthReclaimTxDesc(NetInterface *interface);
+
 error_t stm32f4xxEthReceivePacket(NetInterface *interface);
 
 error_t stm32f4xxEthUpdateMacAddrFilter(NetInterface *interface);
@@ -106,7 +106,11 @@ const NicDriver stm32f7xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32f7xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -106,7 +106,11 @@ const NicDriver stm32h7xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32h7xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -102,7 +102,11 @@ const NicDriver stm32mp1xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   stm32mp1xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
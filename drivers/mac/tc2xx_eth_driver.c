@@ -106,7 +106,11 @@ const NicDriver tc2xxEthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   tc2xxEthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -122,7 +122,11 @@ const NicDriver tms570EthDriver =
    FALSE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
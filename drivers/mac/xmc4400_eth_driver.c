@@ -105,7 +105,11 @@ const NicDriver xmc4400EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   xmc4400EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -105,7 +105,11 @@ const NicDriver xmc4500EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   xmc4500EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
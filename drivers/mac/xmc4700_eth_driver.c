@@ -105,7 +105,11 @@ const NicDriver xmc4700EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   xmc4700EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
@@ -105,7 +105,11 @@ const NicDriver xmc4800EthDriver =
    TRUE,
    TRUE,
    TRUE,
-   FALSE
+   FALSE,
+   xmc4800EthReceivePacket,
+   NULL,
+   0,
+   0
 };
 
 
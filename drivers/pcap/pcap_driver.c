@@ -96,7 +96,11 @@ const NicDriver pcapDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -476,6 +480,11 @@ void pcapDriverTask(NetInterface *interface)
    //Point to the PCAP driver context
    context = *((PcapDriverContext **) interface->nicContext);
 
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Notify the instance of the TCP/IP stack the interface belongs to
+   netSetCurrentContext(interface->stackContext);
+#endif
+
    //Process events
    while(1)
    {
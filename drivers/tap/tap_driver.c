@@ -0,0 +1,658 @@
+/**
+ * @file tap_driver.c
+ * @brief Linux TAP driver
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @section Description
+ *
+ * The driver attaches the stack to a Linux TAP device, so that the host can
+ * reach it through a regular network interface. TAP queues cannot be memory
+ * mapped: incoming frames are read straight into the receive queue, which
+ * is then processed in place, and outgoing frames are gathered from the
+ * network buffer chunks with a single writev() call
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include <stdlib.h>
+#include "core/net.h"
+#include "drivers/tap/tap_driver.h"
+#include "debug.h"
+
+//Undefine conflicting definitions
+#undef Socket
+#undef htons
+#undef htonl
+#undef ntohs
+#undef ntohl
+
+//Linux dependencies
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+
+/**
+ * @brief Packet descriptor
+ **/
+
+typedef struct
+{
+   size_t length;
+   uint8_t data[TAP_DRIVER_MAX_PACKET_SIZE];
+} TapDriverPacket;
+
+
+/**
+ * @brief TAP driver context
+ **/
+
+typedef struct
+{
+   int fd;
+   int ctrlSocket;
+   char_t name[IFNAMSIZ];
+   uint_t writeIndex;
+   uint_t readIndex;
+   TapDriverPacket queue[TAP_DRIVER_QUEUE_SIZE];
+} TapDriverContext;
+
+
+//TAP devices
+static const char_t *tapDriverDeviceName[NET_INTERFACE_COUNT];
+
+
+/**
+ * @brief TAP driver
+ **/
+
+const NicDriver tapDriver =
+{
+   NIC_TYPE_ETHERNET,
+   ETH_MTU,
+   tapDriverInit,
+   tapDriverTick,
+   tapDriverEnableIrq,
+   tapDriverDisableIrq,
+   tapDriverEventHandler,
+   tapDriverSendPacket,
+   tapDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   TRUE,
+   TRUE,
+   TRUE,
+   TRUE,
+   tapDriverReceivePacket,
+   tapDriverSendChunks,
+   0,
+   0
+};
+
+
+/**
+ * @brief Select the TAP device
+ * @param[in] interface Underlying network interface
+ * @param[in] name Name of the TAP device (e.g. "tap0")
+ * @return Error code
+ **/
+
+error_t tapDriverSetDeviceName(NetInterface *interface, const char_t *name)
+{
+   //Check parameters
+   if(interface == NULL || name == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Make sure the name is not too long
+   if(osStrlen(name) >= IFNAMSIZ)
+      return ERROR_INVALID_LENGTH;
+
+   //The device is opened when the interface is configured
+   tapDriverDeviceName[interface->index] = name;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief TAP driver initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t tapDriverInit(NetInterface *interface)
+{
+   struct ifreq ifr;
+   TapDriverContext *context;
+#if (NET_RTOS_SUPPORT == ENABLED)
+   OsTaskId taskId;
+#endif
+
+   //Debug message
+   TRACE_INFO("Initializing TAP driver...\r\n");
+
+   //Allocate TAP driver context
+   context = (TapDriverContext *) osAllocMem(sizeof(TapDriverContext));
+
+   //Failed to allocate memory?
+   if(context == NULL)
+   {
+      //Debug message
+      printf("Failed to allocate context!\r\n");
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Attach the TAP driver context to the network interface
+   *((TapDriverContext **) interface->nicContext) = context;
+   //Clear TAP driver context
+   osMemset(context, 0, sizeof(TapDriverContext));
+
+   //Select the TAP device
+   if(tapDriverDeviceName[interface->index] != NULL)
+   {
+      osStrncpy(context->name, tapDriverDeviceName[interface->index],
+         IFNAMSIZ - 1);
+   }
+   else
+   {
+      osStrncpy(context->name, TAP_DRIVER_DEVICE_NAME, IFNAMSIZ - 1);
+   }
+
+   //Open the clone device
+#if (NET_RTOS_SUPPORT == ENABLED)
+   context->fd = open("/dev/net/tun", O_RDWR);
+#else
+   context->fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+#endif
+
+   //Failed to open device?
+   if(context->fd < 0)
+   {
+      //Debug message
+      printf("Failed to open /dev/net/tun!\r\n");
+
+      //Clean up side effects
+      free(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Attach to the TAP device (it is created if it does not exist yet)
+   osMemset(&ifr, 0, sizeof(ifr));
+   osStrncpy(ifr.ifr_name, context->name, IFNAMSIZ - 1);
+   ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+
+   //Failed to attach to the device?
+   if(ioctl(context->fd, TUNSETIFF, &ifr) < 0)
+   {
+      //Debug message
+      printf("Failed to attach to %s!\r\n", context->name);
+
+      //Clean up side effects
+      close(context->fd);
+      free(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //The kernel may have picked another name
+   osStrncpy(context->name, ifr.ifr_name, IFNAMSIZ - 1);
+
+   //Open a socket used to query and configure the device
+   context->ctrlSocket = socket(AF_INET, SOCK_DGRAM, 0);
+
+   //Failed to open socket?
+   if(context->ctrlSocket < 0)
+   {
+      //Debug message
+      printf("Failed to open control socket!\r\n");
+
+      //Clean up side effects
+      close(context->fd);
+      free(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+
+   //Bring the device up (this requires CAP_NET_ADMIN, so the device may
+   //also be configured beforehand by the administrator)
+   if(ioctl(context->ctrlSocket, SIOCGIFFLAGS, &ifr) == 0 &&
+      (ifr.ifr_flags & IFF_UP) == 0)
+   {
+      ifr.ifr_flags |= IFF_UP;
+      ioctl(context->ctrlSocket, SIOCSIFFLAGS, &ifr);
+   }
+
+#if (NET_RTOS_SUPPORT == ENABLED)
+   //Create the receive task
+   taskId = osCreateTask("TAP", (OsTaskCode) tapDriverTask, interface, 0, 0);
+
+   //Failed to create the task?
+   if(taskId == OS_INVALID_TASK_ID)
+   {
+      //Debug message
+      printf("Failed to create task!\r\n");
+
+      //Clean up side effects
+      close(context->ctrlSocket);
+      close(context->fd);
+      free(context);
+
+      //Report an error
+      return ERROR_FAILURE;
+   }
+#endif
+
+   //Accept any packets from the upper layer
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief TAP timer handler
+ *
+ * This routine is periodically called by the TCP/IP stack to handle periodic
+ * operations such as polling the link state
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void tapDriverTick(NetInterface *interface)
+{
+   bool_t linkState;
+   struct ifreq ifr;
+   TapDriverContext *context;
+
+   //Point to the TAP driver context
+   context = *((TapDriverContext **) interface->nicContext);
+
+   //Retrieve the flags of the TAP device
+   osMemset(&ifr, 0, sizeof(ifr));
+   osStrncpy(ifr.ifr_name, context->name, IFNAMSIZ - 1);
+
+   //The link is up as long as the device is up on the host side
+   if(ioctl(context->ctrlSocket, SIOCGIFFLAGS, &ifr) == 0 &&
+      (ifr.ifr_flags & IFF_UP) != 0)
+   {
+      linkState = TRUE;
+   }
+   else
+   {
+      linkState = FALSE;
+   }
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //TAP devices do not report a meaningful speed
+      interface->linkSpeed = NIC_LINK_SPEED_1GBPS;
+      interface->duplexMode = NIC_FULL_DUPLEX_MODE;
+
+      //Update link state
+      interface->linkState = linkState;
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void tapDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void tapDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief TAP event handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void tapDriverEventHandler(NetInterface *interface)
+{
+   error_t error;
+
+   //Process all pending packets
+   do
+   {
+      //Read incoming packet
+      error = tapDriverReceivePacket(interface);
+
+      //No more data in the receive queue?
+   } while(error != ERROR_BUFFER_EMPTY);
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t tapDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   uint_t i;
+   uint_t n;
+   ssize_t ret;
+   size_t length;
+   struct iovec iov[TAP_DRIVER_MAX_CHUNK_COUNT];
+   TapDriverContext *context;
+
+   //Point to the TAP driver context
+   context = *((TapDriverContext **) interface->nicContext);
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Check the frame length
+   if(length > TAP_DRIVER_MAX_PACKET_SIZE)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+   //Gather the chunks that make up the packet
+   for(i = 0, n = 0; i < buffer->chunkCount; i++)
+   {
+      //Skip the chunks that precede the data
+      if(offset >= buffer->chunk[i].length)
+      {
+         offset -= buffer->chunk[i].length;
+         continue;
+      }
+
+      //Too many chunks?
+      if(n >= TAP_DRIVER_MAX_CHUNK_COUNT)
+         break;
+
+      //Point to the data held by the current chunk
+      iov[n].iov_base = (uint8_t *) buffer->chunk[i].address + offset;
+      iov[n].iov_len = buffer->chunk[i].length - offset;
+
+      //Process the next chunk
+      offset = 0;
+      n++;
+   }
+
+   //Write the frame to the TAP device without copying it
+   if(i >= buffer->chunkCount)
+   {
+      ret = writev(context->fd, iov, n);
+   }
+   else
+   {
+      //The packet is too fragmented
+      ret = -1;
+   }
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   if(ret < 0)
+   {
+      return ERROR_FAILURE;
+   }
+   else
+   {
+      return NO_ERROR;
+   }
+}
+
+
+/**
+ * @brief Send a packet described as a list of chunks
+ * @param[in] interface Underlying network interface
+ * @param[in] chunks List of contiguous memory regions that form the packet
+ * @param[in] count Number of chunks
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @param[in] callback Function to invoke once the chunks are released
+ * @param[in] param Callback function parameter
+ * @return Error code
+ **/
+
+error_t tapDriverSendChunks(NetInterface *interface,
+   const NicTxChunk *chunks, uint_t count, NetTxAncillary *ancillary,
+   NicTxCompleteCallback callback, void *param)
+{
+   uint_t i;
+   ssize_t ret;
+   size_t length;
+   struct iovec iov[NIC_MAX_TX_CHUNKS];
+   TapDriverContext *context;
+
+   //Point to the TAP driver context
+   context = *((TapDriverContext **) interface->nicContext);
+
+   //Make sure the chunk list fits in the I/O vector
+   if(count > NIC_MAX_TX_CHUNKS)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_PARAMETER;
+   }
+
+   //Build the I/O vector directly from the chunk list
+   for(length = 0, i = 0; i < count; i++)
+   {
+      iov[i].iov_base = (void *) chunks[i].address;
+      iov[i].iov_len = chunks[i].length;
+      length += chunks[i].length;
+   }
+
+   //Check the frame length
+   if(length > TAP_DRIVER_MAX_PACKET_SIZE)
+   {
+      //The transmitter can accept another packet
+      osSetEvent(&interface->nicTxEvent);
+      //Report an error
+      return ERROR_INVALID_LENGTH;
+   }
+
+   //The kernel copies the frame before writev returns
+   ret = writev(context->fd, iov, count);
+
+   //The chunks are no longer referenced
+   callback(interface, param);
+   //Let the TCP/IP stack task release the underlying buffers
+   osSetEvent(&netEvent);
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   if(ret < 0)
+   {
+      return ERROR_FAILURE;
+   }
+   else
+   {
+      return NO_ERROR;
+   }
+}
+
+
+/**
+ * @brief Receive a packet
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t tapDriverReceivePacket(NetInterface *interface)
+{
+   TapDriverContext *context;
+   NetRxAncillary ancillary;
+
+   //Point to the TAP driver context
+   context = *((TapDriverContext **) interface->nicContext);
+
+   //Any pending packet?
+   if(context->queue[context->readIndex].length == 0)
+      return ERROR_BUFFER_EMPTY;
+
+   //Additional options can be passed to the stack along with the packet
+   ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+   //Pass the packet to the upper layer
+   nicProcessPacket(interface, context->queue[context->readIndex].data,
+      context->queue[context->readIndex].length, &ancillary);
+
+   //Release the current packet
+   context->queue[context->readIndex].length = 0;
+
+   //Point to the next packet descriptor
+   context->readIndex = (context->readIndex + 1) % TAP_DRIVER_QUEUE_SIZE;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t tapDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //The Ethernet layer of the stack discards the frames that are not
+   //addressed to it
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief TAP receive task
+ * @param[in] interface Underlying network interface
+ **/
+
+void tapDriverTask(NetInterface *interface)
+{
+   uint_t n;
+   ssize_t length;
+   struct pollfd fds;
+   TapDriverContext *context;
+
+   //Point to the TAP driver context
+   context = *((TapDriverContext **) interface->nicContext);
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Notify the instance of the TCP/IP stack the interface belongs to
+   netSetCurrentContext(interface->stackContext);
+#endif
+
+   //Process events
+   while(1)
+   {
+      //Compute the index of the next packet descriptor
+      n = (context->writeIndex + 1) % TAP_DRIVER_QUEUE_SIZE;
+
+      //Ensure the receive queue is not full
+      if(n != context->readIndex)
+      {
+         //Wait for an incoming packet
+         fds.fd = context->fd;
+         fds.events = POLLIN;
+         fds.revents = 0;
+
+         //Any packet received?
+         if(poll(&fds, 1, TAP_DRIVER_TIMEOUT) > 0)
+         {
+            //Read the packet directly into the receive queue
+            length = read(context->fd, context->queue[context->writeIndex].data,
+               TAP_DRIVER_MAX_PACKET_SIZE);
+
+            //Check whether the link is up
+            if(length > 0 && interface->linkState)
+            {
+               //Save the length of the packet
+               context->queue[context->writeIndex].length = length;
+
+               //Point to the next packet descriptor
+               context->writeIndex = n;
+
+               //Set event flag
+               interface->nicEvent = TRUE;
+               //Notify the TCP/IP stack of the event
+               osSetEvent(&netEvent);
+            }
+         }
+      }
+      else
+      {
+         //Give the TCP/IP stack some time to drain the receive queue
+         osDelayTask(TAP_DRIVER_TIMEOUT);
+      }
+
+#if (NET_RTOS_SUPPORT == DISABLED)
+      //Return to the caller
+      break;
+#endif
+   }
+}
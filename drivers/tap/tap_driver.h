@@ -0,0 +1,108 @@
+/**
+ * @file tap_driver.h
+ * @brief Linux TAP driver
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _TAP_DRIVER_H
+#define _TAP_DRIVER_H
+
+//Dependencies
+#include "core/nic.h"
+
+//Default TAP device
+#ifndef TAP_DRIVER_DEVICE_NAME
+   #define TAP_DRIVER_DEVICE_NAME "tap0"
+#endif
+
+//Maximum packet size
+#ifndef TAP_DRIVER_MAX_PACKET_SIZE
+   #define TAP_DRIVER_MAX_PACKET_SIZE 1536
+#elif (TAP_DRIVER_MAX_PACKET_SIZE < 1)
+   #error TAP_DRIVER_MAX_PACKET_SIZE parameter is not valid
+#endif
+
+//Maximum number of packets in the receive queue
+#ifndef TAP_DRIVER_QUEUE_SIZE
+   #define TAP_DRIVER_QUEUE_SIZE 64
+#elif (TAP_DRIVER_QUEUE_SIZE < 2)
+   #error TAP_DRIVER_QUEUE_SIZE parameter is not valid
+#endif
+
+//Maximum number of chunks gathered by a single write
+#ifndef TAP_DRIVER_MAX_CHUNK_COUNT
+   #define TAP_DRIVER_MAX_CHUNK_COUNT 16
+#elif (TAP_DRIVER_MAX_CHUNK_COUNT < 1)
+   #error TAP_DRIVER_MAX_CHUNK_COUNT parameter is not valid
+#endif
+
+//Polling timeout of the receive task, in ms
+#ifndef TAP_DRIVER_TIMEOUT
+   #define TAP_DRIVER_TIMEOUT 10
+#elif (TAP_DRIVER_TIMEOUT < 1)
+   #error TAP_DRIVER_TIMEOUT parameter is not valid
+#endif
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//TAP driver
+extern const NicDriver tapDriver;
+
+//TAP related functions
+error_t tapDriverSetDeviceName(NetInterface *interface, const char_t *name);
+
+error_t tapDriverInit(NetInterface *interface);
+
+void tapDriverTick(NetInterface *interface);
+
+void tapDriverEnableIrq(NetInterface *interface);
+void tapDriverDisableIrq(NetInterface *interface);
+
+void tapDriverEventHandler(NetInterface *interface);
+
+error_t tapDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t tapDriverSendChunks(NetInterface *interface,
+   const NicTxChunk *chunks, uint_t count, NetTxAncillary *ancillary,
+   NicTxCompleteCallback callback, void *param);
+
+error_t tapDriverReceivePacket(NetInterface *interface);
+
+error_t tapDriverUpdateMacAddrFilter(NetInterface *interface);
+
+void tapDriverTask(NetInterface *interface);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
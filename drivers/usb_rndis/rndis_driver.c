@@ -75,7 +75,11 @@ const NicDriver rndisDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -0,0 +1,797 @@
+/**
+ * @file virtual_wire_driver.c
+ * @brief Virtual wire driver (in-memory Ethernet link)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL NIC_TRACE_LEVEL
+
+//Dependencies
+#include "core/net.h"
+#include "core/tcp.h"
+#include "core/udp.h"
+#include "drivers/virtual_wire/virtual_wire_driver.h"
+#include "debug.h"
+
+//Virtual wire endpoints
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static VirtualWireDriverEndpoint endpoints[NET_MAX_INSTANCES][NET_INTERFACE_COUNT];
+#else
+static VirtualWireDriverEndpoint endpoints[NET_INTERFACE_COUNT];
+#endif
+
+
+/**
+ * @brief Virtual wire driver
+ **/
+
+const NicDriver virtualWireDriver =
+{
+   NIC_TYPE_ETHERNET,
+   ETH_MTU,
+   virtualWireDriverInit,
+   virtualWireDriverTick,
+   virtualWireDriverEnableIrq,
+   virtualWireDriverDisableIrq,
+   virtualWireDriverEventHandler,
+   virtualWireDriverSendPacket,
+   virtualWireDriverUpdateMacAddrFilter,
+   NULL,
+   NULL,
+   NULL,
+   TRUE,
+   TRUE,
+   TRUE,
+   TRUE,
+   NULL,
+   NULL,
+   NET_CHECKSUM_IPV4 | NET_CHECKSUM_TCP | NET_CHECKSUM_UDP,
+   NET_CHECKSUM_IPV4 | NET_CHECKSUM_TCP | NET_CHECKSUM_UDP
+};
+
+
+/**
+ * @brief Connect two network interfaces with a virtual wire
+ *
+ * Frames sent on one interface are delivered to the other one through an
+ * in-memory queue, which makes it possible to run client and server
+ * protocols against each other inside a single process. The interfaces
+ * may belong to different instances of the TCP/IP stack. Both interfaces
+ * must have been configured before they are connected
+ *
+ * @param[in] interface1 First network interface
+ * @param[in] interface2 Second network interface
+ * @return Error code
+ **/
+
+error_t virtualWireDriverConnect(NetInterface *interface1,
+   NetInterface *interface2)
+{
+   VirtualWireDriverEndpoint *endpoint1;
+   VirtualWireDriverEndpoint *endpoint2;
+
+   //Check parameters
+   if(interface1 == NULL || interface2 == NULL || interface1 == interface2)
+      return ERROR_INVALID_PARAMETER;
+
+   //Point to the endpoints
+   endpoint1 = virtualWireDriverGetEndpoint(interface1);
+   endpoint2 = virtualWireDriverGetEndpoint(interface2);
+
+   //Make sure both interfaces have been configured
+   if(endpoint1->interface == NULL || endpoint2->interface == NULL)
+      return ERROR_WRONG_STATE;
+
+   //Attach the first endpoint to its peer
+   osAcquireMutex(&endpoint1->mutex);
+   endpoint1->peer = interface2;
+   endpoint1->linkEnabled = TRUE;
+   osReleaseMutex(&endpoint1->mutex);
+
+   //Attach the second endpoint to its peer
+   osAcquireMutex(&endpoint2->mutex);
+   endpoint2->peer = interface1;
+   endpoint2->linkEnabled = TRUE;
+   osReleaseMutex(&endpoint2->mutex);
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Simulate a cable plug or unplug
+ * @param[in] interface Network interface attached to the virtual wire
+ * @param[in] linkState Desired link state
+ **/
+
+void virtualWireDriverSetLinkState(NetInterface *interface, bool_t linkState)
+{
+   NetInterface *peer;
+   VirtualWireDriverEndpoint *endpoint;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //Update the administrative state of the link
+   osAcquireMutex(&endpoint->mutex);
+   endpoint->linkEnabled = linkState;
+   peer = endpoint->peer;
+   osReleaseMutex(&endpoint->mutex);
+
+   //Both ends of the wire share the same link state
+   if(peer != NULL)
+   {
+      //Point to the remote endpoint
+      endpoint = virtualWireDriverGetEndpoint(peer);
+
+      //Update the administrative state of the link
+      osAcquireMutex(&endpoint->mutex);
+      endpoint->linkEnabled = linkState;
+      osReleaseMutex(&endpoint->mutex);
+   }
+}
+
+
+/**
+ * @brief Inject frame loss on the virtual wire
+ *
+ * Loss is deterministic: one frame out of every N frames sent by the
+ * specified interface is silently dropped
+ *
+ * @param[in] interface Network interface attached to the virtual wire
+ * @param[in] interval Loss interval (0 disables loss injection)
+ **/
+
+void virtualWireDriverSetLossInterval(NetInterface *interface, uint_t interval)
+{
+   VirtualWireDriverEndpoint *endpoint;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //Get exclusive access
+   osAcquireMutex(&endpoint->mutex);
+
+   //Save loss interval
+   endpoint->lossInterval = interval;
+   //Reset frame counter
+   endpoint->txFrameCount = 0;
+
+   //Release exclusive access
+   osReleaseMutex(&endpoint->mutex);
+}
+
+
+/**
+ * @brief Retrieve the endpoint attached to a given interface
+ * @param[in] interface Underlying network interface
+ * @return Pointer to the virtual wire endpoint
+ **/
+
+VirtualWireDriverEndpoint *virtualWireDriverGetEndpoint(NetInterface *interface)
+{
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Each instance of the TCP/IP stack owns its own set of endpoints
+   return &endpoints[interface->stackContext->instance][interface->index];
+#else
+   //Endpoints are indexed by interface
+   return &endpoints[interface->index];
+#endif
+}
+
+
+/**
+ * @brief Notify the TCP/IP stack that a frame is pending
+ * @param[in] interface Network interface that received the frame
+ **/
+
+void virtualWireDriverNotify(NetInterface *interface)
+{
+   //Set event flag
+   interface->nicEvent = TRUE;
+
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+   //Wake up the instance of the TCP/IP stack the interface belongs to
+   osSetEvent(&interface->stackContext->event);
+#else
+   //Notify the TCP/IP stack of the event
+   osSetEvent(&netEvent);
+#endif
+}
+
+
+/**
+ * @brief Virtual wire driver initialization
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t virtualWireDriverInit(NetInterface *interface)
+{
+   VirtualWireDriverEndpoint *endpoint;
+
+   //Debug message
+   TRACE_INFO("Initializing virtual wire driver...\r\n");
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //First initialization?
+   if(endpoint->interface == NULL)
+   {
+      //Create a mutex to protect the receive queue
+      if(!osCreateMutex(&endpoint->mutex))
+      {
+         //Failed to create mutex
+         return ERROR_OUT_OF_RESOURCES;
+      }
+
+      //Attach the endpoint to the interface
+      endpoint->interface = interface;
+   }
+
+   //Get exclusive access
+   osAcquireMutex(&endpoint->mutex);
+
+   //Flush receive queue
+   endpoint->queueLength = 0;
+   endpoint->queueTxIndex = 0;
+   endpoint->queueRxIndex = 0;
+   endpoint->txFrameCount = 0;
+
+   //Release exclusive access
+   osReleaseMutex(&endpoint->mutex);
+
+   //Force the TCP/IP stack to poll the link state at startup
+   virtualWireDriverNotify(interface);
+
+   //Accept any packets from the upper layer
+   osSetEvent(&interface->nicTxEvent);
+
+   //Successful initialization
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Virtual wire timer handler
+ *
+ * This routine is periodically called by the TCP/IP stack to handle periodic
+ * operations such as polling the link state
+ *
+ * @param[in] interface Underlying network interface
+ **/
+
+void virtualWireDriverTick(NetInterface *interface)
+{
+   bool_t linkState;
+   VirtualWireDriverEndpoint *endpoint;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //The link is up when the wire is connected and enabled
+   osAcquireMutex(&endpoint->mutex);
+   linkState = (endpoint->peer != NULL && endpoint->linkEnabled);
+   osReleaseMutex(&endpoint->mutex);
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //Notify the TCP/IP stack of the event
+      virtualWireDriverNotify(interface);
+   }
+}
+
+
+/**
+ * @brief Enable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void virtualWireDriverEnableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Disable interrupts
+ * @param[in] interface Underlying network interface
+ **/
+
+void virtualWireDriverDisableIrq(NetInterface *interface)
+{
+   //Not implemented
+}
+
+
+/**
+ * @brief Virtual wire event handler
+ * @param[in] interface Underlying network interface
+ **/
+
+void virtualWireDriverEventHandler(NetInterface *interface)
+{
+   error_t error;
+   bool_t linkState;
+   VirtualWireDriverEndpoint *endpoint;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //The link is up when the wire is connected and enabled
+   osAcquireMutex(&endpoint->mutex);
+   linkState = (endpoint->peer != NULL && endpoint->linkEnabled);
+   osReleaseMutex(&endpoint->mutex);
+
+   //Link state change detected?
+   if(linkState != interface->linkState)
+   {
+      //Update link state
+      interface->linkState = linkState;
+
+      //Link is up?
+      if(linkState)
+      {
+         //The virtual wire behaves as a full-duplex gigabit link
+         interface->linkSpeed = NIC_LINK_SPEED_1GBPS;
+         interface->duplexMode = NIC_FULL_DUPLEX_MODE;
+      }
+      else
+      {
+         //Frames still pending in the queue are lost
+         osAcquireMutex(&endpoint->mutex);
+         endpoint->queueLength = 0;
+         endpoint->queueTxIndex = 0;
+         endpoint->queueRxIndex = 0;
+         osReleaseMutex(&endpoint->mutex);
+      }
+
+      //Process link state change event
+      nicNotifyLinkChange(interface);
+   }
+
+   //Process all pending packets
+   do
+   {
+      //Read incoming packet
+      error = virtualWireDriverReceivePacket(interface);
+
+      //No more data in the receive queue?
+   } while(error != ERROR_BUFFER_EMPTY);
+}
+
+
+/**
+ * @brief Send a packet
+ * @param[in] interface Underlying network interface
+ * @param[in] buffer Multi-part buffer containing the data to send
+ * @param[in] offset Offset to the first data byte
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ * @return Error code
+ **/
+
+error_t virtualWireDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
+{
+   error_t error;
+   bool_t drop;
+   size_t length;
+   NetInterface *peer;
+   VirtualWireDriverEndpoint *endpoint;
+   VirtualWireDriverEndpoint *peerEndpoint;
+   VirtualWireDriverQueueEntry *entry;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //Retrieve the length of the packet
+   length = netBufferGetLength(buffer) - offset;
+
+   //Get exclusive access to the local endpoint
+   osAcquireMutex(&endpoint->mutex);
+
+   //Point to the interface at the other end of the wire
+   peer = endpoint->peer;
+
+   //The frame is lost when the link is down
+   if(peer == NULL || !endpoint->linkEnabled || !peer->linkState)
+   {
+      drop = TRUE;
+   }
+   else
+   {
+      //Increment frame counter
+      endpoint->txFrameCount++;
+
+      //Loss injection enabled?
+      drop = (endpoint->lossInterval > 0 &&
+         (endpoint->txFrameCount % endpoint->lossInterval) == 0);
+   }
+
+   //Release exclusive access to the local endpoint
+   osReleaseMutex(&endpoint->mutex);
+
+   //Check the frame length
+   if(length > ETH_MAX_FRAME_SIZE)
+   {
+      //Report an error
+      error = ERROR_INVALID_LENGTH;
+   }
+   else if(drop)
+   {
+      //Silently drop the frame
+   }
+   else
+   {
+      //Point to the remote endpoint
+      peerEndpoint = virtualWireDriverGetEndpoint(peer);
+
+      //Get exclusive access to the remote endpoint
+      osAcquireMutex(&peerEndpoint->mutex);
+
+      //Check whether the receive queue of the peer is full
+      if(peerEndpoint->queueLength < VIRTUAL_WIRE_DRIVER_QUEUE_SIZE)
+      {
+         //Point to the next free entry
+         entry = &peerEndpoint->queue[peerEndpoint->queueTxIndex];
+
+         //Save the length of the frame
+         entry->length = length;
+         //Copy data to the queue
+         netBufferRead(entry->data, buffer, offset, length);
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+         //Emulate transmit checksum offload
+         virtualWireDriverInsertChecksums(entry->data, length, ancillary);
+#endif
+
+         //Increment index and wrap around if necessary
+         if(++peerEndpoint->queueTxIndex >= VIRTUAL_WIRE_DRIVER_QUEUE_SIZE)
+         {
+            peerEndpoint->queueTxIndex = 0;
+         }
+
+         //Update the length of the queue
+         peerEndpoint->queueLength++;
+
+         //Release exclusive access to the remote endpoint
+         osReleaseMutex(&peerEndpoint->mutex);
+
+         //Notify the instance of the TCP/IP stack the peer belongs to
+         virtualWireDriverNotify(peer);
+      }
+      else
+      {
+         //Release exclusive access to the remote endpoint
+         osReleaseMutex(&peerEndpoint->mutex);
+      }
+   }
+
+   //The transmitter can accept another packet
+   osSetEvent(&interface->nicTxEvent);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Receive a packet
+ *
+ * The queue lock is only held while the indexes are read and updated. The
+ * oldest entry cannot be overwritten by the sender until the length of the
+ * queue is decremented, so the frame is processed outside the lock
+ *
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t virtualWireDriverReceivePacket(NetInterface *interface)
+{
+   error_t error;
+   NetRxAncillary ancillary;
+   VirtualWireDriverEndpoint *endpoint;
+   VirtualWireDriverQueueEntry *entry;
+
+   //Point to the local endpoint
+   endpoint = virtualWireDriverGetEndpoint(interface);
+
+   //Check whether a packet is pending in the queue
+   osAcquireMutex(&endpoint->mutex);
+   entry = (endpoint->queueLength > 0) ?
+      &endpoint->queue[endpoint->queueRxIndex] : NULL;
+   osReleaseMutex(&endpoint->mutex);
+
+   //Any packet pending in the queue?
+   if(entry != NULL)
+   {
+      //Additional options can be passed to the stack along with the packet
+      ancillary = NET_DEFAULT_RX_ANCILLARY;
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+      //Emulate receive checksum offload
+      ancillary.checksumFlags = virtualWireDriverVerifyChecksums(entry->data,
+         entry->length);
+#endif
+
+      //Pass the packet to the upper layer
+      nicProcessPacket(interface, entry->data, entry->length, &ancillary);
+
+      //Get exclusive access
+      osAcquireMutex(&endpoint->mutex);
+
+      //The link may have been reset while the frame was being processed
+      if(endpoint->queueLength > 0)
+      {
+         //Increment index and wrap around if necessary
+         if(++endpoint->queueRxIndex >= VIRTUAL_WIRE_DRIVER_QUEUE_SIZE)
+         {
+            endpoint->queueRxIndex = 0;
+         }
+
+         //Update the length of the queue
+         endpoint->queueLength--;
+      }
+
+      //Release exclusive access
+      osReleaseMutex(&endpoint->mutex);
+
+      //Packet successfully received
+      error = NO_ERROR;
+   }
+   else
+   {
+      //No more packet in the queue
+      error = ERROR_BUFFER_EMPTY;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Configure MAC address filtering
+ * @param[in] interface Underlying network interface
+ * @return Error code
+ **/
+
+error_t virtualWireDriverUpdateMacAddrFilter(NetInterface *interface)
+{
+   //Destination MAC address filtering is performed by the Ethernet layer
+   return NO_ERROR;
+}
+
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+
+/**
+ * @brief Locate the IPv4 header of an Ethernet frame
+ * @param[in] frame Pointer to the Ethernet frame
+ * @param[in] length Length of the frame, in bytes
+ * @param[out] ipLength Length of the IPv4 packet, in bytes
+ * @return Pointer to the IPv4 header, or NULL if the frame does not carry
+ *   a valid IPv4 packet
+ **/
+
+Ipv4Header *virtualWireDriverGetIpv4Header(uint8_t *frame, size_t length,
+   size_t *ipLength)
+{
+   size_t n;
+   uint16_t type;
+   Ipv4Header *header;
+
+   //Skip the destination and source MAC addresses
+   n = 2 * sizeof(MacAddr);
+
+   //Parse the Ethernet type field, skipping VLAN and VMAN tags if any
+   while(1)
+   {
+      //Malformed frame?
+      if((n + sizeof(uint16_t)) > length)
+         return NULL;
+
+      //Retrieve the Ethernet type field
+      type = LOAD16BE(frame + n);
+      n += sizeof(uint16_t);
+
+      //Skip the tag control information
+      if(type == ETH_TYPE_VLAN || type == ETH_TYPE_VMAN)
+      {
+         n += sizeof(uint16_t);
+      }
+      else
+      {
+         break;
+      }
+   }
+
+   //Only IPv4 packets are processed
+   if(type != ETH_TYPE_IPV4)
+      return NULL;
+
+   //Malformed packet?
+   if((n + sizeof(Ipv4Header)) > length)
+      return NULL;
+
+   //Point to the IPv4 header
+   header = (Ipv4Header *) (frame + n);
+
+   //Check the IHL and total length fields
+   if(header->headerLength < 5 ||
+      ntohs(header->totalLength) < (header->headerLength * 4) ||
+      ntohs(header->totalLength) > (length - n))
+   {
+      return NULL;
+   }
+
+   //Return the length of the IPv4 packet
+   *ipLength = ntohs(header->totalLength);
+
+   //Return a pointer to the IPv4 header
+   return header;
+}
+
+
+/**
+ * @brief Compute the checksums left to the NIC (transmit path)
+ * @param[in,out] frame Pointer to the Ethernet frame
+ * @param[in] length Length of the frame, in bytes
+ * @param[in] ancillary Additional options passed to the stack along with
+ *   the packet
+ **/
+
+void virtualWireDriverInsertChecksums(uint8_t *frame, size_t length,
+   const NetTxAncillary *ancillary)
+{
+   size_t n;
+   uint8_t *p;
+   uint16_t checksum;
+   Ipv4Header *header;
+
+   //Any checksum left to the NIC?
+   if(ancillary == NULL || ancillary->checksumFlags == NET_CHECKSUM_NONE)
+      return;
+
+   //Point to the IPv4 header
+   header = virtualWireDriverGetIpv4Header(frame, length, &n);
+   //Not an IPv4 packet?
+   if(header == NULL)
+      return;
+
+   //Compute the IP header checksum
+   if((ancillary->checksumFlags & NET_CHECKSUM_IPV4) != 0)
+   {
+      header->headerChecksum = 0;
+      header->headerChecksum = ipCalcChecksum(header, header->headerLength * 4);
+   }
+
+   //Compute the upper-layer checksum
+   if((ancillary->checksumFlags & (NET_CHECKSUM_TCP | NET_CHECKSUM_UDP)) != 0)
+   {
+      //Point to the upper-layer header
+      p = (uint8_t *) header + header->headerLength * 4;
+      n -= header->headerLength * 4;
+
+      //Make sure the checksum field lies within the packet
+      if((ancillary->checksumOffset + sizeof(uint16_t)) <= n)
+      {
+         //The checksum field holds the checksum of the pseudo header
+         checksum = ipCalcChecksum(p, n);
+
+         //A computed UDP checksum of zero is transmitted as all ones
+         if((ancillary->checksumFlags & NET_CHECKSUM_UDP) != 0 &&
+            checksum == 0x0000)
+         {
+            checksum = 0xFFFF;
+         }
+
+         //Write the resulting checksum
+         osMemcpy(p + ancillary->checksumOffset, &checksum, sizeof(uint16_t));
+      }
+   }
+}
+
+
+/**
+ * @brief Verify the checksums of an incoming frame (receive path)
+ * @param[in] frame Pointer to the Ethernet frame
+ * @param[in] length Length of the frame, in bytes
+ * @return Checksums that have been successfully verified
+ **/
+
+uint8_t virtualWireDriverVerifyChecksums(uint8_t *frame, size_t length)
+{
+   size_t n;
+   uint8_t flags;
+   uint8_t *p;
+   Ipv4Header *header;
+   Ipv4PseudoHeader pseudoHeader;
+
+   //No checksum verified so far
+   flags = NET_CHECKSUM_NONE;
+
+   //Point to the IPv4 header
+   header = virtualWireDriverGetIpv4Header(frame, length, &n);
+
+   //Verify the IP header checksum
+   if(header != NULL &&
+      ipCalcChecksum(header, header->headerLength * 4) == 0x0000)
+   {
+      //The IP header checksum is correct
+      flags |= NET_CHECKSUM_IPV4;
+
+      //Fragments cannot be verified individually
+      if((ntohs(header->fragmentOffset) & (IPV4_FLAG_MF | IPV4_OFFSET_MASK)) == 0)
+      {
+         //Point to the upper-layer header
+         p = (uint8_t *) header + header->headerLength * 4;
+         n -= header->headerLength * 4;
+
+         //Format IPv4 pseudo header
+         pseudoHeader.srcAddr = header->srcAddr;
+         pseudoHeader.destAddr = header->destAddr;
+         pseudoHeader.reserved = 0;
+         pseudoHeader.protocol = header->protocol;
+         pseudoHeader.length = htons(n);
+
+         //Verify the TCP checksum
+         if(header->protocol == IPV4_PROTOCOL_TCP && n >= sizeof(TcpHeader))
+         {
+            if(ipCalcUpperLayerChecksum(&pseudoHeader, sizeof(Ipv4PseudoHeader),
+               p, n) == 0x0000)
+            {
+               flags |= NET_CHECKSUM_TCP;
+            }
+         }
+
+         //Verify the UDP checksum (a zero checksum means no checksum)
+         if(header->protocol == IPV4_PROTOCOL_UDP && n >= sizeof(UdpHeader) &&
+            ((UdpHeader *) p)->checksum != 0x0000)
+         {
+            if(ipCalcUpperLayerChecksum(&pseudoHeader, sizeof(Ipv4PseudoHeader),
+               p, n) == 0x0000)
+            {
+               flags |= NET_CHECKSUM_UDP;
+            }
+         }
+      }
+   }
+
+   //Return the checksums that have been verified
+   return flags;
+}
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file virtual_wire_driver.h
+ * @brief Virtual wire driver (in-memory Ethernet link)
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _VIRTUAL_WIRE_DRIVER_H
+#define _VIRTUAL_WIRE_DRIVER_H
+
+//Dependencies
+#include "core/nic.h"
+
+//Queue size
+#ifndef VIRTUAL_WIRE_DRIVER_QUEUE_SIZE
+   #define VIRTUAL_WIRE_DRIVER_QUEUE_SIZE 16
+#elif (VIRTUAL_WIRE_DRIVER_QUEUE_SIZE < 1)
+   #error VIRTUAL_WIRE_DRIVER_QUEUE_SIZE parameter is not valid
+#endif
+
+
+/**
+ * @brief Virtual wire queue entry
+ **/
+
+typedef struct
+{
+   size_t length;
+   uint8_t data[ETH_MAX_FRAME_SIZE];
+} VirtualWireDriverQueueEntry;
+
+
+/**
+ * @brief Virtual wire endpoint
+ **/
+
+typedef struct
+{
+   NetInterface *interface; ///<Network interface the endpoint is attached to
+   NetInterface *peer;      ///<Network interface at the other end of the wire
+   OsMutex mutex;           ///<Mutex protecting the endpoint
+   bool_t linkEnabled;      ///<Administrative state of the link
+   uint_t lossInterval;     ///<One frame out of N is dropped (0 means no loss)
+   uint_t txFrameCount;     ///<Number of frames sent over the wire
+   uint_t queueLength;      ///<Number of frames pending in the receive queue
+   uint_t queueTxIndex;     ///<Index of the next free entry
+   uint_t queueRxIndex;     ///<Index of the oldest pending frame
+   VirtualWireDriverQueueEntry queue[VIRTUAL_WIRE_DRIVER_QUEUE_SIZE]; ///<Receive queue
+} VirtualWireDriverEndpoint;
+
+
+//Virtual wire driver
+extern const NicDriver virtualWireDriver;
+
+//Virtual wire related functions
+error_t virtualWireDriverConnect(NetInterface *interface1,
+   NetInterface *interface2);
+
+void virtualWireDriverSetLinkState(NetInterface *interface, bool_t linkState);
+void virtualWireDriverSetLossInterval(NetInterface *interface, uint_t interval);
+
+VirtualWireDriverEndpoint *virtualWireDriverGetEndpoint(NetInterface *interface);
+void virtualWireDriverNotify(NetInterface *interface);
+
+error_t virtualWireDriverInit(NetInterface *interface);
+
+void virtualWireDriverTick(NetInterface *interface);
+
+void virtualWireDriverEnableIrq(NetInterface *interface);
+void virtualWireDriverDisableIrq(NetInterface *interface);
+void virtualWireDriverEventHandler(NetInterface *interface);
+
+error_t virtualWireDriverSendPacket(NetInterface *interface,
+   const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary);
+
+error_t virtualWireDriverReceivePacket(NetInterface *interface);
+
+error_t virtualWireDriverUpdateMacAddrFilter(NetInterface *interface);
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+
+Ipv4Header *virtualWireDriverGetIpv4Header(uint8_t *frame, size_t length,
+   size_t *ipLength);
+
+void virtualWireDriverInsertChecksums(uint8_t *frame, size_t length,
+   const NetTxAncillary *ancillary);
+
+uint8_t virtualWireDriverVerifyChecksums(uint8_t *frame, size_t length);
+
+#endif
+
+#endif
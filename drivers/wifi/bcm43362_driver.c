@@ -94,7 +94,11 @@ const NicDriver bcm43362StaDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -119,7 +123,11 @@ const NicDriver bcm43362ApDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
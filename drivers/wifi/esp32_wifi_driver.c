@@ -85,7 +85,11 @@ const NicDriver esp32WifiStaDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -110,7 +114,11 @@ const NicDriver esp32WifiApDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
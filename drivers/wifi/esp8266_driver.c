@@ -65,7 +65,11 @@ const NicDriver esp8266WifiStaDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -90,7 +94,11 @@ const NicDriver esp8266WifiApDriver =
    TRUE,
    TRUE,
    TRUE,
-   TRUE
+   TRUE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
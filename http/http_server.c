@@ -134,6 +134,49 @@ error_t httpServerInit(HttpServerContext *context, const HttpServerSettings *set
    //Client connections
    context->connections = settings->connections;
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Create an event object to poll the state of sockets
+   if(!osCreateEvent(&context->event))
+      return ERROR_OUT_OF_RESOURCES;
+
+   //One event descriptor is needed for each client connection, plus an
+   //additional one for the listening socket
+   context->eventDesc = osAllocMem((context->settings.maxConnections + 1) *
+      sizeof(SocketEventDesc));
+   //Failed to allocate memory?
+   if(context->eventDesc == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Loop through client connections
+   for(i = 0; i < context->settings.maxConnections; i++)
+   {
+      //Point to the structure representing the client connection
+      connection = &context->connections[i];
+
+      //Initialize the structure
+      osMemset(connection, 0, sizeof(HttpConnection));
+
+      //Reference to the HTTP server settings
+      connection->settings = &context->settings;
+      //Reference to the HTTP server context
+      connection->serverContext = context;
+   }
+
+   //Create a mutex to protect the hand-off of connections to worker tasks
+   if(!osCreateMutex(&context->workerMutex))
+      return ERROR_OUT_OF_RESOURCES;
+
+   //Loop through worker tasks
+   for(i = 0; i < HTTP_SERVER_MAX_WORKERS; i++)
+   {
+      //Reference to the HTTP server context
+      context->workers[i].context = context;
+
+      //Create an event object to start request processing
+      if(!osCreateEvent(&context->workers[i].event))
+         return ERROR_OUT_OF_RESOURCES;
+   }
+#else
    //Create a semaphore to limit the number of simultaneous connections
    if(!osCreateSemaphore(&context->semaphore, context->settings.maxConnections))
       return ERROR_OUT_OF_RESOURCES;
@@ -151,6 +194,7 @@ error_t httpServerInit(HttpServerContext *context, const HttpServerSettings *set
       if(!osCreateEvent(&connection->startEvent))
          return ERROR_OUT_OF_RESOURCES;
    }
+#endif
 
 #if (HTTP_SERVER_TLS_SUPPORT == ENABLED && TLS_TICKET_SUPPORT == ENABLED)
    //Initialize ticket encryption context
@@ -166,14 +210,31 @@ error_t httpServerInit(HttpServerContext *context, const HttpServerSettings *set
       return ERROR_OUT_OF_RESOURCES;
 #endif
 
+#if (HTTP_SERVER_SSI_SUPPORT == ENABLED && HTTP_SERVER_SSI_CACHE_SUPPORT == ENABLED)
+   //Create a mutex to prevent simultaneous access to the SSI template cache
+   if(!osCreateMutex(&context->ssiCacheMutex))
+      return ERROR_OUT_OF_RESOURCES;
+#endif
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   //Create a mutex to prevent simultaneous access to the resource cache
+   if(!osCreateMutex(&context->resCacheMutex))
+      return ERROR_OUT_OF_RESOURCES;
+#endif
+
    //Open a TCP socket
    context->socket = socketOpen(SOCKET_TYPE_STREAM, SOCKET_IP_PROTO_TCP);
    //Failed to open socket?
    if(context->socket == NULL)
       return ERROR_OPEN_FAILED;
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Force the socket to operate in non-blocking mode
+   error = socketSetTimeout(context->socket, 0);
+#else
    //Set timeout for blocking functions
    error = socketSetTimeout(context->socket, INFINITE_DELAY);
+#endif
    //Any error to report?
    if(error)
       return error;
@@ -210,7 +271,11 @@ error_t httpServerInit(HttpServerContext *context, const HttpServerSettings *set
 error_t httpServerStart(HttpServerContext *context)
 {
    uint_t i;
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   HttpServerWorker *worker;
+#else
    HttpConnection *connection;
+#endif
 
    //Make sure the HTTP server context is valid
    if(context == NULL)
@@ -219,6 +284,41 @@ error_t httpServerStart(HttpServerContext *context)
    //Debug message
    TRACE_INFO("Starting HTTP server...\r\n");
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Loop through worker tasks
+   for(i = 0; i < HTTP_SERVER_MAX_WORKERS; i++)
+   {
+      //Point to the current worker
+      worker = &context->workers[i];
+
+#if (OS_STATIC_TASK_SUPPORT == ENABLED)
+      //Create a task using statically allocated memory
+      worker->taskId = osCreateStaticTask("HTTP Worker",
+         (OsTaskCode) httpServerWorkerTask, worker, &worker->taskTcb,
+         worker->taskStack, HTTP_SERVER_STACK_SIZE, HTTP_SERVER_PRIORITY);
+#else
+      //Create a task
+      worker->taskId = osCreateTask("HTTP Worker",
+         (OsTaskCode) httpServerWorkerTask, worker, HTTP_SERVER_STACK_SIZE,
+         HTTP_SERVER_PRIORITY);
+#endif
+
+      //Unable to create the task?
+      if(worker->taskId == OS_INVALID_TASK_ID)
+         return ERROR_OUT_OF_RESOURCES;
+   }
+
+#if (OS_STATIC_TASK_SUPPORT == ENABLED)
+   //Create a task using statically allocated memory
+   context->taskId = osCreateStaticTask("HTTP Server",
+      (OsTaskCode) httpServerTask, context, &context->taskTcb,
+      context->taskStack, HTTP_SERVER_STACK_SIZE, HTTP_SERVER_PRIORITY);
+#else
+   //Create a task
+   context->taskId = osCreateTask("HTTP Server", (OsTaskCode) httpServerTask,
+      context, HTTP_SERVER_STACK_SIZE, HTTP_SERVER_PRIORITY);
+#endif
+#else
    //Loop through client connections
    for(i = 0; i < context->settings.maxConnections; i++)
    {
@@ -250,6 +350,7 @@ error_t httpServerStart(HttpServerContext *context)
    //Create a task
    context->taskId = osCreateTask("HTTP Listener", httpListenerTask,
       context, HTTP_SERVER_STACK_SIZE, HTTP_SERVER_PRIORITY);
+#endif
 #endif
 
    //Unable to create the task?
@@ -261,6 +362,156 @@ error_t httpServerStart(HttpServerContext *context)
 }
 
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+
+/**
+ * @brief HTTP server task (event-driven mode)
+ * @param[in] context Pointer to the HTTP server context
+ **/
+
+void httpServerTask(HttpServerContext *context)
+{
+   error_t error;
+   uint_t i;
+   uint_t n;
+   systime_t timeout;
+   HttpConnection *connection;
+   SocketEventDesc *eventDesc;
+
+   //Task prologue
+   osEnterTask();
+
+   //Number of client connections
+   n = context->settings.maxConnections;
+   //Point to the socket event descriptors
+   eventDesc = context->eventDesc;
+
+   //Process events
+   while(1)
+   {
+      //Hand complete request headers over to idle worker tasks
+      httpServerDispatchRequests(context);
+
+      //Set polling timeout
+      timeout = HTTP_SERVER_TICK_INTERVAL;
+
+      //Clear event descriptor set
+      osMemset(eventDesc, 0, (n + 1) * sizeof(SocketEventDesc));
+
+      //Specify the events the application is interested in
+      for(i = 0; i < n; i++)
+      {
+         //Point to the structure describing the current connection
+         connection = &context->connections[i];
+
+         //Connections owned by a worker task are left untouched
+         if(connection->worker == NULL &&
+            connection->state != HTTP_CONN_STATE_IDLE)
+         {
+            //Register connection events
+            httpServerRegisterConnectionEvents(connection, &eventDesc[i]);
+
+            //Check whether the socket is ready for I/O operation
+            if(eventDesc[i].eventFlags != 0)
+            {
+               //No need to poll the underlying socket for incoming traffic
+               timeout = 0;
+            }
+         }
+      }
+
+      //The HTTP server listens for connection requests
+      eventDesc[n].socket = context->socket;
+      eventDesc[n].eventMask = SOCKET_EVENT_RX_READY;
+
+      //Wait for one of the set of sockets to become ready to perform I/O
+      error = socketPoll(eventDesc, n + 1, &context->event, timeout);
+
+      //Check status code
+      if(error == NO_ERROR || error == ERROR_TIMEOUT)
+      {
+         //Event-driven processing
+         for(i = 0; i < n; i++)
+         {
+            //Point to the structure describing the current connection
+            connection = &context->connections[i];
+
+            //Connections owned by a worker task are left untouched
+            if(connection->worker == NULL &&
+               connection->state != HTTP_CONN_STATE_IDLE)
+            {
+               //Check whether the socket is ready to perform I/O
+               if(eventDesc[i].eventFlags != 0)
+               {
+                  //Connection event handler
+                  httpServerProcessConnectionEvents(connection);
+               }
+            }
+         }
+
+         //Any connection request received?
+         if(eventDesc[n].eventFlags != 0)
+         {
+            //Accept connection request
+            httpServerAcceptConnection(context);
+         }
+      }
+
+      //Handle periodic operations
+      httpServerTick(context);
+   }
+}
+
+
+/**
+ * @brief HTTP worker task (event-driven mode)
+ *
+ * User callbacks, SSI scripts and request body reads may block. They are run
+ * by a small pool of worker tasks so that a slow client does not stall the
+ * connections served by the event loop. Static resources never reach the
+ * workers
+ *
+ * @param[in] worker Pointer to the worker task context
+ **/
+
+void httpServerWorkerTask(HttpServerWorker *worker)
+{
+   HttpConnection *connection;
+
+   //Task prologue
+   osEnterTask();
+
+   //Process incoming requests
+   while(1)
+   {
+      //Wait for the event loop to assign a connection
+      osWaitForEvent(&worker->event, INFINITE_DELAY);
+
+      //Retrieve the connection to be processed
+      osAcquireMutex(&worker->context->workerMutex);
+      connection = worker->done ? NULL : worker->connection;
+      osReleaseMutex(&worker->context->workerMutex);
+
+      //Any request pending?
+      if(connection != NULL)
+      {
+         //Generate the response to the request
+         httpServerGenerateResponse(connection);
+
+         //The event loop takes the connection back once the mutex has been
+         //released, so all the updates made to the connection are visible
+         osAcquireMutex(&worker->context->workerMutex);
+         worker->done = TRUE;
+         osReleaseMutex(&worker->context->workerMutex);
+
+         //Wake up the event loop
+         osSetEvent(&worker->context->event);
+      }
+   }
+}
+
+#else
+
 /**
  * @brief HTTP server listener task
  * @param[in] param Pointer to the HTTP server context
@@ -367,66 +618,15 @@ void httpConnectionTask(void *param)
          //Debug message
          TRACE_INFO("Initializing TLS session...\r\n");
 
-         //Start of exception handling block
-         do
-         {
-            //Allocate TLS context
-            connection->tlsContext = tlsInit();
-            //Initialization failed?
-            if(connection->tlsContext == NULL)
-            {
-               //Report an error
-               error = ERROR_OUT_OF_MEMORY;
-               //Exit immediately
-               break;
-            }
-
-            //Select server operation mode
-            error = tlsSetConnectionEnd(connection->tlsContext,
-               TLS_CONNECTION_END_SERVER);
-            //Any error to report?
-            if(error)
-               break;
-
-            //Bind TLS to the relevant socket
-            error = tlsSetSocket(connection->tlsContext, connection->socket);
-            //Any error to report?
-            if(error)
-               break;
-
-#if (TLS_TICKET_SUPPORT == ENABLED)
-            //Enable session ticket mechanism
-            error = tlsEnableSessionTickets(connection->tlsContext, TRUE);
-            //Any error to report?
-            if(error)
-               break;
-
-            //Register ticket encryption/decryption callbacks
-            error = tlsSetTicketCallbacks(connection->tlsContext, tlsEncryptTicket,
-               tlsDecryptTicket, &connection->serverContext->tlsTicketContext);
-            //Any error to report?
-            if(error)
-               break;
-#endif
-            //Invoke user-defined callback, if any
-            if(connection->settings->tlsInitCallback != NULL)
-            {
-               //Perform TLS related initialization
-               error = connection->settings->tlsInitCallback(connection,
-                  connection->tlsContext);
-               //Any error to report?
-               if(error)
-                  break;
-            }
+         //TLS initialization
+         error = httpOpenSecureConnection(connection);
 
+         //Check status code
+         if(!error)
+         {
             //Establish a secure session
             error = tlsConnect(connection->tlsContext);
-            //Any error to report?
-            if(error)
-               break;
-
-            //End of exception handling block
-         } while(0);
+         }
       }
       else
       {
@@ -459,137 +659,8 @@ void httpConnectionTask(void *param)
                break;
             }
 
-#if (HTTP_SERVER_BASIC_AUTH_SUPPORT == ENABLED || HTTP_SERVER_DIGEST_AUTH_SUPPORT == ENABLED)
-            //No Authorization header found?
-            if(!connection->request.auth.found)
-            {
-               //Invoke user-defined callback, if any
-               if(connection->settings->authCallback != NULL)
-               {
-                  //Check whether the access to the specified URI is authorized
-                  connection->status = connection->settings->authCallback(connection,
-                     connection->request.auth.user, connection->request.uri);
-               }
-               else
-               {
-                  //Access to the specified URI is allowed
-                  connection->status = HTTP_ACCESS_ALLOWED;
-               }
-            }
-
-            //Check access status
-            if(connection->status == HTTP_ACCESS_ALLOWED)
-            {
-               //Access to the specified URI is allowed
-               error = NO_ERROR;
-            }
-            else if(connection->status == HTTP_ACCESS_BASIC_AUTH_REQUIRED)
-            {
-               //Basic access authentication is required
-               connection->response.auth.mode = HTTP_AUTH_MODE_BASIC;
-               //Report an error
-               error = ERROR_AUTH_REQUIRED;
-            }
-            else if(connection->status == HTTP_ACCESS_DIGEST_AUTH_REQUIRED)
-            {
-               //Digest access authentication is required
-               connection->response.auth.mode = HTTP_AUTH_MODE_DIGEST;
-               //Report an error
-               error = ERROR_AUTH_REQUIRED;
-            }
-            else
-            {
-               //Access to the specified URI is denied
-               error = ERROR_NOT_FOUND;
-            }
-#endif
-            //Debug message
-            TRACE_INFO("Sending HTTP response to the client...\r\n");
-
-            //Check status code
-            if(!error)
-            {
-               //Default HTTP header fields
-               httpInitResponseHeader(connection);
-
-               //Invoke user-defined callback, if any
-               if(connection->settings->requestCallback != NULL)
-               {
-                  error = connection->settings->requestCallback(connection,
-                     connection->request.uri);
-               }
-               else
-               {
-                  //Keep processing...
-                  error = ERROR_NOT_FOUND;
-               }
-
-               //Check status code
-               if(error == ERROR_NOT_FOUND)
-               {
-#if (HTTP_SERVER_SSI_SUPPORT == ENABLED)
-                  //Use server-side scripting to dynamically generate HTML code?
-                  if(httpCompExtension(connection->request.uri, ".stm") ||
-                     httpCompExtension(connection->request.uri, ".shtm") ||
-                     httpCompExtension(connection->request.uri, ".shtml"))
-                  {
-                     //SSI processing (Server Side Includes)
-                     error = ssiExecuteScript(connection, connection->request.uri, 0);
-                  }
-                  else
-#endif
-                  {
-                     //Set the maximum age for static resources
-                     connection->response.maxAge = HTTP_SERVER_MAX_AGE;
-
-                     //Send the contents of the requested page
-                     error = httpSendResponse(connection, connection->request.uri);
-                  }
-               }
-
-               //The requested resource is not available?
-               if(error == ERROR_NOT_FOUND)
-               {
-                  //Default HTTP header fields
-                  httpInitResponseHeader(connection);
-
-                  //Invoke user-defined callback, if any
-                  if(connection->settings->uriNotFoundCallback != NULL)
-                  {
-                     error = connection->settings->uriNotFoundCallback(connection,
-                        connection->request.uri);
-                  }
-               }
-            }
-
-            //Check status code
-            if(error)
-            {
-               //Default HTTP header fields
-               httpInitResponseHeader(connection);
-
-               //Bad request?
-               if(error == ERROR_INVALID_REQUEST)
-               {
-                  //Send an error 400 and close the connection immediately
-                  httpSendErrorResponse(connection, 400,
-                     "The request is badly formed");
-               }
-               //Authorization required?
-               else if(error == ERROR_AUTH_REQUIRED)
-               {
-                  //Send an error 401 and keep the connection alive
-                  error = httpSendErrorResponse(connection, 401,
-                     "Authorization required");
-               }
-               //Page not found?
-               else if(error == ERROR_NOT_FOUND)
-               {
-                  //Send an error 404 and keep the connection alive
-                  error = httpSendErrorResponse(connection, 404,
-                     "The requested page could not be found");
-               }
-            }
+            //Generate the response to the request
+            error = httpProcessRequest(connection);
 
             //Internal error?
             if(error)
@@ -642,6 +713,171 @@ void httpConnectionTask(void *param)
    }
 }
 
+#endif
+
+
+/**
+ * @brief Process an HTTP request whose header has been parsed
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpProcessRequest(HttpConnection *connection)
+{
+   error_t error;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+#if (HTTP_SERVER_BASIC_AUTH_SUPPORT == ENABLED || HTTP_SERVER_DIGEST_AUTH_SUPPORT == ENABLED)
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == DISABLED)
+   //No Authorization header found?
+   if(!connection->request.auth.found)
+   {
+      //Invoke user-defined callback, if any
+      if(connection->settings->authCallback != NULL)
+      {
+         //Check whether the access to the specified URI is authorized
+         connection->status = connection->settings->authCallback(connection,
+            connection->request.auth.user, connection->request.uri);
+      }
+      else
+      {
+         //Access to the specified URI is allowed
+         connection->status = HTTP_ACCESS_ALLOWED;
+      }
+   }
+#endif
+
+   //Check access status (in event-driven mode, the access status has already
+   //been determined by httpServerProcessRequest)
+   if(connection->status == HTTP_ACCESS_ALLOWED)
+   {
+      //Access to the specified URI is allowed
+      error = NO_ERROR;
+   }
+   else if(connection->status == HTTP_ACCESS_BASIC_AUTH_REQUIRED)
+   {
+      //Basic access authentication is required
+      connection->response.auth.mode = HTTP_AUTH_MODE_BASIC;
+      //Report an error
+      error = ERROR_AUTH_REQUIRED;
+   }
+   else if(connection->status == HTTP_ACCESS_DIGEST_AUTH_REQUIRED)
+   {
+      //Digest access authentication is required
+      connection->response.auth.mode = HTTP_AUTH_MODE_DIGEST;
+      //Report an error
+      error = ERROR_AUTH_REQUIRED;
+   }
+   else
+   {
+      //Access to the specified URI is denied
+      error = ERROR_NOT_FOUND;
+   }
+#endif
+   //Debug message
+   TRACE_INFO("Sending HTTP response to the client...\r\n");
+
+   //Check status code
+   if(!error)
+   {
+      //Default HTTP header fields
+      httpInitResponseHeader(connection);
+
+      //Invoke user-defined callback, if any
+      if(connection->settings->requestCallback != NULL)
+      {
+         error = connection->settings->requestCallback(connection,
+            connection->request.uri);
+      }
+      else
+      {
+         //Keep processing...
+         error = ERROR_NOT_FOUND;
+      }
+
+      //Check status code
+      if(error == ERROR_NOT_FOUND)
+      {
+#if (HTTP_SERVER_SSI_SUPPORT == ENABLED)
+         //Use server-side scripting to dynamically generate HTML code?
+         if(httpCompExtension(connection->request.uri, ".stm") ||
+            httpCompExtension(connection->request.uri, ".shtm") ||
+            httpCompExtension(connection->request.uri, ".shtml"))
+         {
+            //SSI processing (Server Side Includes)
+            error = ssiExecuteScript(connection, connection->request.uri, 0);
+         }
+         else
+#endif
+         {
+            //Set the maximum age for static resources
+            connection->response.maxAge = HTTP_SERVER_MAX_AGE;
+
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+            //The body of static resources can be sent asynchronously
+            connection->state = HTTP_CONN_STATE_RESP_HEADER;
+#endif
+            //Send the contents of the requested page
+            error = httpSendResponse(connection, connection->request.uri);
+
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+            //The resource could not be sent?
+            if(connection->state == HTTP_CONN_STATE_RESP_HEADER)
+               connection->state = HTTP_CONN_STATE_REQ_BODY;
+#endif
+         }
+      }
+
+      //The requested resource is not available?
+      if(error == ERROR_NOT_FOUND)
+      {
+         //Default HTTP header fields
+         httpInitResponseHeader(connection);
+
+         //Invoke user-defined callback, if any
+         if(connection->settings->uriNotFoundCallback != NULL)
+         {
+            error = connection->settings->uriNotFoundCallback(connection,
+               connection->request.uri);
+         }
+      }
+   }
+
+   //Check status code
+   if(error)
+   {
+      //Default HTTP header fields
+      httpInitResponseHeader(connection);
+
+      //Bad request?
+      if(error == ERROR_INVALID_REQUEST)
+      {
+         //Send an error 400 and close the connection immediately
+         httpSendErrorResponse(connection, 400,
+            "The request is badly formed");
+      }
+      //Authorization required?
+      else if(error == ERROR_AUTH_REQUIRED)
+      {
+         //Send an error 401 and keep the connection alive
+         error = httpSendErrorResponse(connection, 401,
+            "Authorization required");
+      }
+      //Page not found?
+      else if(error == ERROR_NOT_FOUND)
+      {
+         //Send an error 404 and keep the connection alive
+         error = httpSendErrorResponse(connection, 404,
+            "The requested page could not be found");
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
 
 /**
  * @brief Send HTTP response header
@@ -662,6 +898,23 @@ error_t httpWriteHeader(HttpConnection *connection)
    //Format HTTP response header
    error = httpFormatResponseHeader(connection, connection->buffer);
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Static resource served by the HTTP server itself?
+   if(!error && connection->state == HTTP_CONN_STATE_RESP_HEADER)
+   {
+      //Debug message
+      TRACE_DEBUG("HTTP response header:\r\n%s", connection->buffer);
+
+      //The header is kept in the buffer and sent along with the body as the
+      //socket becomes writable
+      connection->bufferPos = 0;
+      connection->bufferLen = osStrlen(connection->buffer);
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
    //Check status code
    if(!error)
    {
@@ -863,6 +1116,22 @@ error_t httpCloseStream(HttpConnection *connection)
 {
    error_t error;
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Response without body to a request for a static resource?
+   if(connection->state == HTTP_CONN_STATE_RESP_HEADER)
+   {
+      //Only the header is pending in the buffer
+      connection->bodyPos = 0;
+      connection->bodyLen = 0;
+
+      //The header is sent without blocking the HTTP server task
+      connection->state = HTTP_CONN_STATE_RESP_BODY;
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
    //Use chunked encoding transfer?
    if(connection->response.chunkedEncoding)
    {
@@ -889,136 +1158,148 @@ error_t httpCloseStream(HttpConnection *connection)
 
 error_t httpSendResponse(HttpConnection *connection, const char_t *uri)
 {
-#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
    error_t error;
+   size_t length;
+   HttpResourceInfo info;
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
    size_t n;
-   uint32_t length;
    FsFile *file;
+#else
+   const uint8_t *data;
+#endif
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   size_t offset;
+   size_t count;
+#endif
 
-   //Retrieve the full pathname
-   httpGetAbsolutePath(connection, uri, connection->buffer,
-      HTTP_SERVER_BUFFER_SIZE);
-
-#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
-   //Check whether gzip compression is supported by the client
-   if(connection->request.acceptGzipEncoding)
-   {
-      //Calculate the length of the pathname
-      n = osStrlen(connection->buffer);
-
-      //Sanity check
-      if(n < (HTTP_SERVER_BUFFER_SIZE - 4))
-      {
-         //Append gzip extension
-         osStrcpy(connection->buffer + n, ".gz");
-         //Retrieve the size of the compressed resource, if any
-         error = fsGetFileSize(connection->buffer, &length);
-      }
-      else
-      {
-         //Report an error
-         error = ERROR_NOT_FOUND;
-      }
+   //Locate the resource and retrieve its metadata
+   error = httpGetResourceInfo(connection, uri, &info);
+   //The specified URI cannot be found?
+   if(error)
+      return error;
 
-      //Check whether the gzip-compressed file exists
-      if(!error)
-      {
-         //Use gzip format
-         connection->response.gzipEncoding = TRUE;
-      }
-      else
-      {
-         //Strip the gzip extension
-         connection->buffer[n] = '\0';
+   //Length of the representation
+   length = info.length;
 
-         //Retrieve the size of the non-compressed resource
-         error = fsGetFileSize(connection->buffer, &length);
-         //The specified URI cannot be found?
-         if(error)
-            return ERROR_NOT_FOUND;
-      }
-   }
-   else
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //Use gzip format?
+   connection->response.gzipEncoding = info.gzipEncoding;
 #endif
-   {
-      //Retrieve the size of the specified file
-      error = fsGetFileSize(connection->buffer, &length);
-      //The specified URI cannot be found?
-      if(error)
-         return ERROR_NOT_FOUND;
-   }
 
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
    //Open the file for reading
    file = fsOpenFile(connection->buffer, FS_FILE_MODE_READ);
    //Failed to open the file?
    if(file == NULL)
       return ERROR_NOT_FOUND;
 #else
-   error_t error;
-   size_t length;
-   const uint8_t *data;
+   //Point to the resource data
+   data = info.data;
+#endif
 
-   //Retrieve the full pathname
-   httpGetAbsolutePath(connection, uri, connection->buffer,
-      HTTP_SERVER_BUFFER_SIZE);
+   //Format HTTP response header
+   connection->response.statusCode = 200;
+   connection->response.contentType = info.contentType;
+   connection->response.chunkedEncoding = FALSE;
+   connection->response.contentLength = length;
 
-#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
-   //Check whether gzip compression is supported by the client
-   if(connection->request.acceptGzipEncoding)
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   //The modification time of the file is known?
+   if(info.modifiedValid)
    {
-      size_t n;
+      //The entity tag is derived from the size and the modification time
+      httpFormatEtag(connection, length,
+         (uint32_t) convertDateToUnixTime(&info.modified));
+   }
+#else
+   //The entity tag is derived from the location and the size of the resource
+   httpFormatEtag(connection, length, (uint32_t) (size_t) data);
+#endif
 
-      //Calculate the length of the pathname
-      n = osStrlen(connection->buffer);
+   //The client already holds the current representation?
+   if(connection->request.ifNoneMatch[0] != '\0' &&
+      httpCheckIfNoneMatch(connection))
+   {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //Close the file
+      fsCloseFile(file);
+#endif
+      //Send a 304 response without message body
+      connection->response.statusCode = 304;
+      connection->response.contentType = NULL;
+      connection->response.contentLength = 0;
 
-      //Sanity check
-      if(n < (HTTP_SERVER_BUFFER_SIZE - 4))
-      {
-         //Append gzip extension
-         osStrcpy(connection->buffer + n, ".gz");
-         //Get the compressed resource data associated with the URI, if any
-         error = resGetData(connection->buffer, &data, &length);
-      }
-      else
+      //Send the header to the client
+      error = httpWriteHeader(connection);
+
+      //Check status code
+      if(!error)
       {
-         //Report an error
-         error = ERROR_NOT_FOUND;
+         //Properly close the output stream
+         error = httpCloseStream(connection);
       }
 
-      //Check whether the gzip-compressed resource exists
+      //Return status code
+      return error;
+   }
+#endif
+
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   //Select the part of the representation to be sent
+   error = httpSelectRange(connection, length, &offset, &count);
+
+   //Unsatisfiable range?
+   if(error)
+   {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //Close the file
+      fsCloseFile(file);
+#endif
+      //Send a 416 response without message body
+      connection->response.statusCode = 416;
+      connection->response.contentType = NULL;
+      connection->response.contentLength = 0;
+
+      //Send the header to the client
+      error = httpWriteHeader(connection);
+
+      //Check status code
       if(!error)
       {
-         //Use gzip format
-         connection->response.gzipEncoding = TRUE;
+         //Properly close the output stream
+         error = httpCloseStream(connection);
       }
-      else
-      {
-         //Strip the gzip extension
-         connection->buffer[n] = '\0';
 
-         //Get the non-compressed resource data associated with the URI
-         error = resGetData(connection->buffer, &data, &length);
-         //The specified URI cannot be found?
-         if(error)
-            return error;
-      }
+      //Return status code
+      return error;
    }
-   else
-#endif
+
+   //Partial content?
+   if(offset > 0)
    {
-      //Get the resource data associated with the URI
-      error = resGetData(connection->buffer, &data, &length);
-      //The specified URI cannot be found?
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //Move to the first byte of the range
+      error = fsSeekFile(file, offset, FS_SEEK_SET);
+
+      //Any error to report?
       if(error)
+      {
+         //Close the file
+         fsCloseFile(file);
+         //Return status code
          return error;
-   }
+      }
+#else
+      //Point to the first byte of the range
+      data += offset;
 #endif
+   }
 
-   //Format HTTP response header
-   connection->response.statusCode = 200;
-   connection->response.contentType = mimeGetType(uri);
-   connection->response.chunkedEncoding = FALSE;
-   connection->response.contentLength = length;
+   //Number of bytes to be sent
+   length = count;
+   connection->response.contentLength = count;
+#endif
 
    //Send the header to the client
    error = httpWriteHeader(connection);
@@ -1033,6 +1314,29 @@ error_t httpSendResponse(HttpConnection *connection, const char_t *uri)
       return error;
    }
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   //Static resource requested by the HTTP server itself?
+   if(connection->state == HTTP_CONN_STATE_RESP_HEADER)
+   {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //The file will be read as the socket becomes writable, once the header
+      //has been sent
+      connection->file = file;
+#else
+      //Point to the resource data
+      connection->bodyStart = (uint8_t *) data;
+#endif
+      connection->bodyPos = 0;
+      connection->bodyLen = length;
+
+      //The response body is sent without blocking the HTTP server task
+      connection->state = HTTP_CONN_STATE_RESP_BODY;
+
+      //Successful processing
+      return NO_ERROR;
+   }
+#endif
+
 #if (HTTP_SERVER_FS_SUPPORT == ENABLED)
    //Send response body
    while(length > 0)
@@ -65,6 +65,20 @@
    #error HTTP_SERVER_SSI_SUPPORT parameter is not valid
 #endif
 
+//SSI template cache
+#ifndef HTTP_SERVER_SSI_CACHE_SUPPORT
+   #define HTTP_SERVER_SSI_CACHE_SUPPORT DISABLED
+#elif (HTTP_SERVER_SSI_CACHE_SUPPORT != ENABLED && HTTP_SERVER_SSI_CACHE_SUPPORT != DISABLED)
+   #error HTTP_SERVER_SSI_CACHE_SUPPORT parameter is not valid
+#endif
+
+//Resource metadata cache
+#ifndef HTTP_SERVER_RES_CACHE_SUPPORT
+   #define HTTP_SERVER_RES_CACHE_SUPPORT DISABLED
+#elif (HTTP_SERVER_RES_CACHE_SUPPORT != ENABLED && HTTP_SERVER_RES_CACHE_SUPPORT != DISABLED)
+   #error HTTP_SERVER_RES_CACHE_SUPPORT parameter is not valid
+#endif
+
 //HTTP over TLS
 #ifndef HTTP_SERVER_TLS_SUPPORT
    #define HTTP_SERVER_TLS_SUPPORT DISABLED
@@ -114,6 +128,20 @@
    #error HTTP_SERVER_MULTIPART_TYPE_SUPPORT parameter is not valid
 #endif
 
+//Entity tag and conditional request support
+#ifndef HTTP_SERVER_ETAG_SUPPORT
+   #define HTTP_SERVER_ETAG_SUPPORT DISABLED
+#elif (HTTP_SERVER_ETAG_SUPPORT != ENABLED && HTTP_SERVER_ETAG_SUPPORT != DISABLED)
+   #error HTTP_SERVER_ETAG_SUPPORT parameter is not valid
+#endif
+
+//Byte range request support
+#ifndef HTTP_SERVER_RANGE_SUPPORT
+   #define HTTP_SERVER_RANGE_SUPPORT DISABLED
+#elif (HTTP_SERVER_RANGE_SUPPORT != ENABLED && HTTP_SERVER_RANGE_SUPPORT != DISABLED)
+   #error HTTP_SERVER_RANGE_SUPPORT parameter is not valid
+#endif
+
 //Cookie support
 #ifndef HTTP_SERVER_COOKIE_SUPPORT
    #define HTTP_SERVER_COOKIE_SUPPORT DISABLED
@@ -121,6 +149,14 @@
    #error HTTP_SERVER_COOKIE_SUPPORT parameter is not valid
 #endif
 
+//Event-driven mode (a single task services all the connections and serves
+//static resources, user callbacks are run by a pool of worker tasks)
+#ifndef HTTP_SERVER_EVENT_DRIVEN_SUPPORT
+   #define HTTP_SERVER_EVENT_DRIVEN_SUPPORT DISABLED
+#elif (HTTP_SERVER_EVENT_DRIVEN_SUPPORT != ENABLED && HTTP_SERVER_EVENT_DRIVEN_SUPPORT != DISABLED)
+   #error HTTP_SERVER_EVENT_DRIVEN_SUPPORT parameter is not valid
+#endif
+
 //Stack size required to run the HTTP server
 #ifndef HTTP_SERVER_STACK_SIZE
    #define HTTP_SERVER_STACK_SIZE 650
@@ -133,6 +169,20 @@
    #define HTTP_SERVER_PRIORITY OS_TASK_PRIORITY_NORMAL
 #endif
 
+//HTTP server tick interval (event-driven mode)
+#ifndef HTTP_SERVER_TICK_INTERVAL
+   #define HTTP_SERVER_TICK_INTERVAL 1000
+#elif (HTTP_SERVER_TICK_INTERVAL < 100)
+   #error HTTP_SERVER_TICK_INTERVAL parameter is not valid
+#endif
+
+//Number of worker tasks running user callbacks (event-driven mode)
+#ifndef HTTP_SERVER_MAX_WORKERS
+   #define HTTP_SERVER_MAX_WORKERS 2
+#elif (HTTP_SERVER_MAX_WORKERS < 1)
+   #error HTTP_SERVER_MAX_WORKERS parameter is not valid
+#endif
+
 //HTTP connection timeout
 #ifndef HTTP_SERVER_TIMEOUT
    #define HTTP_SERVER_TIMEOUT 10000
@@ -232,6 +282,50 @@
    #error HTTP_SERVER_SSI_MAX_RECURSION parameter is not valid
 #endif
 
+//Number of entries in the SSI template cache
+#ifndef HTTP_SERVER_SSI_CACHE_SIZE
+   #define HTTP_SERVER_SSI_CACHE_SIZE 4
+#elif (HTTP_SERVER_SSI_CACHE_SIZE < 1)
+   #error HTTP_SERVER_SSI_CACHE_SIZE parameter is not valid
+#endif
+
+//Maximum size of a template that can be cached
+#ifndef HTTP_SERVER_SSI_CACHE_MAX_FILE_SIZE
+   #define HTTP_SERVER_SSI_CACHE_MAX_FILE_SIZE 8192
+#elif (HTTP_SERVER_SSI_CACHE_MAX_FILE_SIZE < 1)
+   #error HTTP_SERVER_SSI_CACHE_MAX_FILE_SIZE parameter is not valid
+#endif
+
+//Number of entries in the resource metadata cache
+#ifndef HTTP_SERVER_RES_CACHE_SIZE
+   #define HTTP_SERVER_RES_CACHE_SIZE 16
+#elif (HTTP_SERVER_RES_CACHE_SIZE < 1)
+   #error HTTP_SERVER_RES_CACHE_SIZE parameter is not valid
+#endif
+
+//Associativity of the resource metadata cache (number of entries in each
+//hash bucket, the least recently used one being replaced when it is full)
+#ifndef HTTP_SERVER_RES_CACHE_WAYS
+   #if ((HTTP_SERVER_RES_CACHE_SIZE % 4) == 0)
+      #define HTTP_SERVER_RES_CACHE_WAYS 4
+   #elif ((HTTP_SERVER_RES_CACHE_SIZE % 2) == 0)
+      #define HTTP_SERVER_RES_CACHE_WAYS 2
+   #else
+      #define HTTP_SERVER_RES_CACHE_WAYS HTTP_SERVER_RES_CACHE_SIZE
+   #endif
+#elif (HTTP_SERVER_RES_CACHE_WAYS < 1 || (HTTP_SERVER_RES_CACHE_SIZE % HTTP_SERVER_RES_CACHE_WAYS) != 0)
+   #error HTTP_SERVER_RES_CACHE_WAYS parameter is not valid
+#endif
+
+//Lifetime of resource metadata cache entries (bounds the time before a
+//modified file or a newly created gzip-compressed variant is taken into
+//account, as cached entries are not revalidated)
+#ifndef HTTP_SERVER_RES_CACHE_LIFETIME
+   #define HTTP_SERVER_RES_CACHE_LIFETIME 10000
+#elif (HTTP_SERVER_RES_CACHE_LIFETIME < 1000)
+   #error HTTP_SERVER_RES_CACHE_LIFETIME parameter is not valid
+#endif
+
 //Maximum age for static resources
 #ifndef HTTP_SERVER_MAX_AGE
    #define HTTP_SERVER_MAX_AGE 0
@@ -274,6 +368,13 @@
    #error HTTP_SERVER_COOKIE_MAX_LEN parameter is not valid
 #endif
 
+//Maximum length for entity tags
+#ifndef HTTP_SERVER_ETAG_MAX_LEN
+   #define HTTP_SERVER_ETAG_MAX_LEN 63
+#elif (HTTP_SERVER_ETAG_MAX_LEN < 31)
+   #error HTTP_SERVER_ETAG_MAX_LEN parameter is not valid
+#endif
+
 //Application specific context
 #ifndef HTTP_SERVER_PRIVATE_CONTEXT
    #define HTTP_SERVER_PRIVATE_CONTEXT
@@ -356,7 +457,8 @@ typedef enum
    HTTP_CONN_STATE_RESP_HEADER = 4,
    HTTP_CONN_STATE_RESP_BODY   = 5,
    HTTP_CONN_STATE_SHUTDOWN    = 6,
-   HTTP_CONN_STATE_CLOSE       = 7
+   HTTP_CONN_STATE_CLOSE       = 7,
+   HTTP_CONN_STATE_CONNECT_TLS = 8
 } HttpConnState;
 
 
@@ -501,6 +603,15 @@ typedef struct
 #if (HTTP_SERVER_COOKIE_SUPPORT == ENABLED)
    char_t cookie[HTTP_SERVER_COOKIE_MAX_LEN + 1];            ///<Cookie header field
 #endif
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   char_t ifNoneMatch[HTTP_SERVER_ETAG_MAX_LEN + 1];         ///<If-None-Match header field
+#endif
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   bool_t rangeFound;                                        ///<The request contains a single byte range
+   size_t rangeFirst;                                        ///<First byte position (UINT_MAX for a suffix range)
+   size_t rangeLast;                                         ///<Last byte position or suffix length (UINT_MAX if omitted)
+   char_t ifRange[HTTP_SERVER_ETAG_MAX_LEN + 1];             ///<If-Range header field
+#endif
 } HttpRequest;
 
 
@@ -529,6 +640,15 @@ typedef struct
 #if (HTTP_SERVER_COOKIE_SUPPORT == ENABLED)
    char_t setCookie[HTTP_SERVER_COOKIE_MAX_LEN + 1]; ///<Set-Cookie header field
 #endif
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   char_t etag[HTTP_SERVER_ETAG_MAX_LEN + 1];        ///<ETag header field
+#endif
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   bool_t acceptRanges;                              ///<Byte range requests are accepted
+   size_t rangeFirst;                                ///<First byte position of the partial content
+   size_t rangeLast;                                 ///<Last byte position of the partial content
+   size_t completeLength;                            ///<Length of the complete representation
+#endif
 } HttpResponse;
 
 
@@ -572,6 +692,97 @@ typedef struct
 } HttpNonceCacheEntry;
 
 
+/**
+ * @brief Node of a precompiled SSI template
+ **/
+
+typedef struct
+{
+   uint32_t offset;  ///<Offset of the span from the beginning of the template
+   uint32_t length;  ///<Length of the span
+   bool_t directive; ///<The span is the contents of an SSI tag (literal text otherwise)
+} HttpSsiNode;
+
+
+/**
+ * @brief SSI template cache entry
+ **/
+
+typedef struct
+{
+   char_t path[HTTP_SERVER_ROOT_DIR_MAX_LEN + HTTP_SERVER_URI_MAX_LEN + 2]; ///<Full pathname of the template
+   const char_t *data;                                                     ///<Contents of the template
+   size_t length;                                                          ///<Length of the template
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   DateTime modified;                                                      ///<Modification time of the file
+#endif
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   char_t *buffer;                                                         ///<Copy of the file contents
+#endif
+   HttpSsiNode *nodes;                                                     ///<Literal spans and SSI directives
+   uint_t numNodes;                                                        ///<Number of nodes
+   uint_t refCount;                                                        ///<Number of connections using the entry
+   systime_t timestamp;                                                    ///<Time stamp to manage entry lifetime
+} HttpSsiCacheEntry;
+
+
+/**
+ * @brief Metadata of a static resource
+ **/
+
+typedef struct
+{
+   bool_t gzipEncoding;       ///<The gzip-compressed variant of the resource is served
+   size_t length;             ///<Length of the representation
+   const char_t *contentType; ///<MIME type
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   bool_t modifiedValid;      ///<The modification time of the file is known
+   DateTime modified;         ///<Modification time of the file
+#endif
+#if (HTTP_SERVER_FS_SUPPORT == DISABLED)
+   const uint8_t *data;       ///<Resource data
+#endif
+} HttpResourceInfo;
+
+
+/**
+ * @brief Resource metadata cache entry
+ *
+ * The cache is set-associative. The hash of the resource identifier selects
+ * a set of HTTP_SERVER_RES_CACHE_WAYS entries, so that a lookup only needs
+ * to examine a few entries
+ *
+ **/
+
+typedef struct
+{
+   char_t uri[HTTP_SERVER_URI_MAX_LEN + 1]; ///<Resource identifier
+   uint32_t hash;                           ///<Hash of the resource identifier
+   bool_t acceptGzip;                       ///<The client accepts gzip encoding
+   HttpResourceInfo info;                   ///<Metadata of the resource
+   systime_t created;                       ///<Time at which the entry was created
+   systime_t timestamp;                     ///<Time of the last access (LRU replacement)
+} HttpResCacheEntry;
+
+
+/**
+ * @brief Worker task (event-driven mode)
+ **/
+
+typedef struct
+{
+   HttpServerContext *context;                         ///<Reference to the HTTP server context
+   HttpConnection *connection;                         ///<Connection being processed (NULL if the worker is idle)
+   OsEvent event;                                      ///<Event object used to start processing
+   bool_t done;                                        ///<The request has been processed
+   OsTaskId taskId;                                    ///<Task identifier
+#if (OS_STATIC_TASK_SUPPORT == ENABLED)
+   OsTaskTcb taskTcb;                                  ///<Task control block
+   OsStackType taskStack[HTTP_SERVER_STACK_SIZE];      ///<Task stack
+#endif
+} HttpServerWorker;
+
+
 /**
  * @brief HTTP server context
  **/
@@ -579,7 +790,14 @@ typedef struct
 struct _HttpServerContext
 {
    HttpServerSettings settings;                                  ///<User settings
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   OsEvent event;                                                ///<Event object used to poll the sockets
+   SocketEventDesc *eventDesc;                                   ///<Socket event descriptors (one per connection plus the listening socket)
+   OsMutex workerMutex;                                          ///<Mutex protecting the hand-off between the event loop and the workers
+   HttpServerWorker workers[HTTP_SERVER_MAX_WORKERS];            ///<Worker tasks running user callbacks
+#else
    OsSemaphore semaphore;                                        ///<Semaphore limiting the number of connections
+#endif
    OsTaskId taskId;                                              ///<Task identifier
 #if (OS_STATIC_TASK_SUPPORT == ENABLED)
    OsTaskTcb taskTcb;                                            ///<Task control block
@@ -594,6 +812,14 @@ struct _HttpServerContext
    OsMutex nonceCacheMutex;                                      ///<Mutex preventing simultaneous access to the nonce cache
    HttpNonceCacheEntry nonceCache[HTTP_SERVER_NONCE_CACHE_SIZE]; ///<Nonce cache
 #endif
+#if (HTTP_SERVER_SSI_SUPPORT == ENABLED && HTTP_SERVER_SSI_CACHE_SUPPORT == ENABLED)
+   OsMutex ssiCacheMutex;                                        ///<Mutex preventing simultaneous access to the SSI template cache
+   HttpSsiCacheEntry ssiCache[HTTP_SERVER_SSI_CACHE_SIZE];       ///<SSI template cache
+#endif
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   OsMutex resCacheMutex;                                        ///<Mutex preventing simultaneous access to the resource cache
+   HttpResCacheEntry resCache[HTTP_SERVER_RES_CACHE_SIZE];       ///<Resource metadata cache
+#endif
 };
 
 
@@ -609,12 +835,14 @@ struct _HttpConnection
 {
    HttpServerSettings *settings;                       ///<Reference to the HTTP server settings
    HttpServerContext *serverContext;                   ///<Reference to the HTTP server context
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == DISABLED)
    OsEvent startEvent;
    bool_t running;
    OsTaskId taskId;                                    ///<Task identifier
 #if (OS_STATIC_TASK_SUPPORT == ENABLED)
    OsTaskTcb taskTcb;                                  ///<Task control block
    OsStackType taskStack[HTTP_SERVER_STACK_SIZE];      ///<Task stack
+#endif
 #endif
    Socket *socket;                                     ///<Socket
 #if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
@@ -626,7 +854,7 @@ struct _HttpConnection
    char_t cgiParam[HTTP_SERVER_CGI_PARAM_MAX_LEN + 1]; ///<CGI parameter
    uint32_t dummy;                                     ///<Force alignment of the buffer on 32-bit boundaries
    char_t buffer[HTTP_SERVER_BUFFER_SIZE];             ///<Memory buffer for input/output operations
-#if (NET_RTOS_SUPPORT == DISABLED)
+#if (NET_RTOS_SUPPORT == DISABLED || HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
    HttpConnState state;                                ///<Connection state
    systime_t timestamp;
    size_t bufferPos;
@@ -634,6 +862,13 @@ struct _HttpConnection
    uint8_t *bodyStart;
    size_t bodyPos;
    size_t bodyLen;
+#endif
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+   uint_t requestCount;                                ///<Number of requests processed on this connection
+   HttpServerWorker *worker;                           ///<Worker task processing the current request
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   FsFile *file;                                       ///<File being sent in the response body
+#endif
 #endif
    HTTP_SERVER_PRIVATE_CONTEXT                         ///<Application specific context
 };
@@ -644,8 +879,15 @@ void httpServerGetDefaultSettings(HttpServerSettings *settings);
 error_t httpServerInit(HttpServerContext *context, const HttpServerSettings *settings);
 error_t httpServerStart(HttpServerContext *context);
 
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+void httpServerTask(HttpServerContext *context);
+void httpServerWorkerTask(HttpServerWorker *worker);
+#else
 void httpListenerTask(void *param);
 void httpConnectionTask(void *param);
+#endif
+
+error_t httpProcessRequest(HttpConnection *connection);
 
 error_t httpWriteHeader(HttpConnection *connection);
 
@@ -58,6 +58,7 @@ static const HttpStatusCodeDesc statusCodeList[] =
    {201, "Created"},
    {202, "Accepted"},
    {204, "No Content"},
+   {206, "Partial Content"},
    //Redirection
    {301, "Moved Permanently"},
    {302, "Found"},
@@ -67,6 +68,7 @@ static const HttpStatusCodeDesc statusCodeList[] =
    {401, "Unauthorized"},
    {403, "Forbidden"},
    {404, "Not Found"},
+   {416, "Range Not Satisfiable"},
    //Server error
    {500, "Internal Server Error"},
    {501, "Not Implemented"},
@@ -125,6 +127,13 @@ error_t httpReadRequestHeader(HttpConnection *connection)
    connection->request.connectionUpgrade = FALSE;
    osStrcpy(connection->request.clientKey, "");
 #endif
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   osStrcpy(connection->request.ifNoneMatch, "");
+#endif
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   connection->request.rangeFound = FALSE;
+   osStrcpy(connection->request.ifRange, "");
+#endif
 
    //HTTP 0.9 does not support Full-Request
    if(connection->request.version >= HTTP_VERSION_1_0)
@@ -488,6 +497,33 @@ void httpParseHeaderField(HttpConnection *connection,
       httpParseCookieField(connection, value);
    }
 #endif
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   //If-None-Match header field?
+   else if(!osStrcasecmp(name, "If-None-Match"))
+   {
+      //Save the list of entity tags (the field is ignored if it is too long)
+      if(osStrlen(value) <= HTTP_SERVER_ETAG_MAX_LEN)
+         osStrcpy(connection->request.ifNoneMatch, value);
+   }
+#endif
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   //Range header field?
+   else if(!osStrcasecmp(name, "Range"))
+   {
+      //Parse Range header field
+      httpParseRangeField(connection, value);
+   }
+   //If-Range header field?
+   else if(!osStrcasecmp(name, "If-Range"))
+   {
+      //Save the validator. A validator that is too long to be stored is
+      //replaced with a value that never matches the current entity tag
+      if(osStrlen(value) <= HTTP_SERVER_ETAG_MAX_LEN)
+         osStrcpy(connection->request.ifRange, value);
+      else
+         osStrcpy(connection->request.ifRange, "?");
+   }
+#endif
 }
 
 
@@ -657,6 +693,249 @@ void httpParseCookieField(HttpConnection *connection, char_t *value)
 }
 
 
+/**
+ * @brief Parse Range header field
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] value Range field value
+ **/
+
+void httpParseRangeField(HttpConnection *connection, char_t *value)
+{
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   char_t *p;
+   size_t first;
+   size_t last;
+
+   //Only byte ranges are supported
+   if(osStrncasecmp(value, "bytes=", 6))
+      return;
+
+   //Point to the byte-range-set
+   value = strTrimWhitespace(value + 6);
+
+   //Multiple ranges are not supported. The Range header field is then
+   //ignored and the full representation is returned
+   if(osStrchr(value, ',') != NULL)
+      return;
+
+   //Suffix byte range?
+   if(value[0] == '-')
+   {
+      //The suffix-length specifies the number of bytes at the end
+      first = UINT_MAX;
+      last = osStrtoul(value + 1, &p, 10);
+
+      //Syntax error?
+      if(p == value + 1 || *p != '\0')
+         return;
+   }
+   else
+   {
+      //Parse first-byte-pos
+      first = osStrtoul(value, &p, 10);
+
+      //Syntax error?
+      if(p == value || *p != '-')
+         return;
+
+      //Point to the last-byte-pos
+      value = p + 1;
+
+      //If the last-byte-pos value is absent, the range extends to the end
+      //of the representation
+      if(*value == '\0')
+      {
+         last = UINT_MAX;
+      }
+      else
+      {
+         //Parse last-byte-pos
+         last = osStrtoul(value, &p, 10);
+
+         //Syntax error?
+         if(*p != '\0' || last < first)
+            return;
+      }
+   }
+
+   //Save the byte range
+   connection->request.rangeFound = TRUE;
+   connection->request.rangeFirst = first;
+   connection->request.rangeLast = last;
+#endif
+}
+
+
+/**
+ * @brief Format the entity tag of a static resource
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] length Length of the representation
+ * @param[in] id Value identifying the version of the resource
+ **/
+
+void httpFormatEtag(HttpConnection *connection, size_t length, uint32_t id)
+{
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   const char_t *suffix;
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //Compressed and non-compressed representations must have distinct tags
+   suffix = connection->response.gzipEncoding ? "-gz" : "";
+#else
+   //Only non-compressed representations are served
+   suffix = "";
+#endif
+
+   //Format strong entity tag
+   osSprintf(connection->response.etag, "\"%" PRIX32 "-%" PRIXSIZE "%s\"",
+      id, length, suffix);
+#endif
+}
+
+
+/**
+ * @brief Evaluate the If-None-Match precondition
+ * @param[in] connection Structure representing an HTTP connection
+ * @return TRUE if the current entity tag matches one of the listed tags
+ **/
+
+bool_t httpCheckIfNoneMatch(HttpConnection *connection)
+{
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   size_t n;
+   const char_t *p;
+   const char_t *etag;
+
+   //Point to the current entity tag
+   etag = connection->response.etag;
+   //Get the length of the entity tag
+   n = osStrlen(etag);
+
+   //No entity tag available?
+   if(n == 0)
+      return FALSE;
+
+   //Point to the list of entity tags
+   p = connection->request.ifNoneMatch;
+
+   //Parse the comma-separated list
+   while(*p != '\0')
+   {
+      //Skip separators
+      while(*p == ' ' || *p == '\t' || *p == ',')
+         p++;
+
+      //The "*" value matches any current representation
+      if(*p == '*')
+         return TRUE;
+
+      //A recipient must use the weak comparison function when comparing
+      //entity tags for If-None-Match
+      if(!osStrncasecmp(p, "W/", 2))
+         p += 2;
+
+      //Compare entity tags
+      if(!osStrncmp(p, etag, n) && (p[n] == '\0' || p[n] == ',' ||
+         p[n] == ' ' || p[n] == '\t'))
+      {
+         return TRUE;
+      }
+
+      //Skip the current entity tag
+      while(*p != '\0' && *p != ',')
+         p++;
+   }
+
+   //The current entity tag does not match any of the listed tags
+   return FALSE;
+#else
+   //Not implemented
+   return FALSE;
+#endif
+}
+
+
+/**
+ * @brief Select the part of the representation to be sent
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] length Length of the complete representation
+ * @param[out] offset Offset of the first byte to be sent
+ * @param[out] count Number of bytes to be sent
+ * @return Error code (ERROR_OUT_OF_RANGE if the range cannot be satisfied)
+ **/
+
+error_t httpSelectRange(HttpConnection *connection, size_t length,
+   size_t *offset, size_t *count)
+{
+   //Send the complete representation by default
+   *offset = 0;
+   *count = length;
+
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   //Byte range requests are accepted for static resources
+   connection->response.acceptRanges = TRUE;
+   //Save the length of the complete representation
+   connection->response.completeLength = length;
+
+   //No Range header field?
+   if(!connection->request.rangeFound)
+      return NO_ERROR;
+
+   //The If-Range header field makes the range request conditional
+   if(connection->request.ifRange[0] != '\0')
+   {
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+      //Strong comparison of entity tags
+      if(osStrcmp(connection->request.ifRange, connection->response.etag) ||
+         connection->response.etag[0] == '\0')
+      {
+         //The representation has changed, so send it entirely
+         return NO_ERROR;
+      }
+#else
+      //The validator cannot be checked
+      return NO_ERROR;
+#endif
+   }
+
+   //Suffix byte range?
+   if(connection->request.rangeFirst == UINT_MAX)
+   {
+      //A suffix range of zero length cannot be satisfied
+      if(connection->request.rangeLast == 0 || length == 0)
+         return ERROR_OUT_OF_RANGE;
+
+      //Select the final bytes of the representation
+      *count = MIN(connection->request.rangeLast, length);
+      *offset = length - *count;
+   }
+   else
+   {
+      //The first byte position must lie within the representation
+      if(connection->request.rangeFirst >= length)
+         return ERROR_OUT_OF_RANGE;
+
+      //Select the requested bytes
+      *offset = connection->request.rangeFirst;
+
+      //The last byte position is limited to the end of the representation
+      if(connection->request.rangeLast >= length)
+         *count = length - *offset;
+      else
+         *count = connection->request.rangeLast - *offset + 1;
+   }
+
+   //Send a partial response
+   connection->response.statusCode = 206;
+   connection->response.rangeFirst = *offset;
+   connection->response.rangeLast = *offset + *count - 1;
+#endif
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
 /**
  * @brief Read chunk-size field from the input stream
  * @param[in] connection Structure representing an HTTP connection
@@ -759,6 +1038,16 @@ void httpInitResponseHeader(HttpConnection *connection)
    connection->response.gzipEncoding = FALSE;
 #endif
 
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   //No entity tag
+   connection->response.etag[0] = '\0';
+#endif
+
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   //Byte range requests are not accepted by default
+   connection->response.acceptRanges = FALSE;
+#endif
+
 #if (HTTP_SERVER_PERSISTENT_CONN_SUPPORT == ENABLED)
    //Persistent connections are accepted
    connection->response.keepAlive = connection->request.keepAlive;
@@ -916,14 +1205,49 @@ error_t httpFormatResponseHeader(HttpConnection *connection, char_t *buffer)
    }
 #endif
 
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED)
+   //Valid entity tag?
+   if(connection->response.etag[0] != '\0')
+   {
+      //Set ETag field
+      p += osSprintf(p, "ETag: %s\r\n", connection->response.etag);
+   }
+#endif
+
+#if (HTTP_SERVER_RANGE_SUPPORT == ENABLED)
+   //Byte range requests accepted?
+   if(connection->response.acceptRanges)
+   {
+      //Set Accept-Ranges field
+      p += osSprintf(p, "Accept-Ranges: bytes\r\n");
+   }
+
+   //Partial content?
+   if(connection->response.statusCode == 206)
+   {
+      //Set Content-Range field
+      p += osSprintf(p, "Content-Range: bytes %" PRIuSIZE "-%" PRIuSIZE
+         "/%" PRIuSIZE "\r\n", connection->response.rangeFirst,
+         connection->response.rangeLast, connection->response.completeLength);
+   }
+   //Unsatisfiable range?
+   else if(connection->response.statusCode == 416)
+   {
+      //Set Content-Range field
+      p += osSprintf(p, "Content-Range: bytes */%" PRIuSIZE "\r\n",
+         connection->response.completeLength);
+   }
+#endif
+
    //Use chunked encoding transfer?
    if(connection->response.chunkedEncoding)
    {
       //Set Transfer-Encoding field
       p += osSprintf(p, "Transfer-Encoding: chunked\r\n");
    }
-   //Persistent connection?
-   else if(connection->response.keepAlive)
+   //Persistent connection? (a 304 response cannot contain a message body)
+   else if(connection->response.keepAlive &&
+      connection->response.statusCode != 304)
    {
       //Set Content-Length field
       p += osSprintf(p, "Content-Length: %" PRIuSIZE "\r\n", connection->response.contentLength);
@@ -1067,6 +1391,1529 @@ error_t httpReceive(HttpConnection *connection,
 }
 
 
+/**
+ * @brief Initialize the TLS context of a client connection
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpOpenSecureConnection(HttpConnection *connection)
+{
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+   error_t error;
+
+   //Allocate TLS context
+   connection->tlsContext = tlsInit();
+   //Initialization failed?
+   if(connection->tlsContext == NULL)
+      return ERROR_OUT_OF_MEMORY;
+
+   //Select server operation mode
+   error = tlsSetConnectionEnd(connection->tlsContext,
+      TLS_CONNECTION_END_SERVER);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Bind TLS to the relevant socket
+   error = tlsSetSocket(connection->tlsContext, connection->socket);
+   //Any error to report?
+   if(error)
+      return error;
+
+#if (TLS_TICKET_SUPPORT == ENABLED)
+   //Enable session ticket mechanism
+   error = tlsEnableSessionTickets(connection->tlsContext, TRUE);
+   //Any error to report?
+   if(error)
+      return error;
+
+   //Register ticket encryption/decryption callbacks
+   error = tlsSetTicketCallbacks(connection->tlsContext, tlsEncryptTicket,
+      tlsDecryptTicket, &connection->serverContext->tlsTicketContext);
+   //Any error to report?
+   if(error)
+      return error;
+#endif
+
+   //Invoke user-defined callback, if any
+   if(connection->settings->tlsInitCallback != NULL)
+   {
+      //Perform TLS related initialization
+      error = connection->settings->tlsInitCallback(connection,
+         connection->tlsContext);
+      //Any error to report?
+      if(error)
+         return error;
+   }
+
+   //Successful initialization
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+#if (HTTP_SERVER_EVENT_DRIVEN_SUPPORT == ENABLED)
+
+/**
+ * @brief Handle periodic operations (event-driven mode)
+ * @param[in] context Pointer to the HTTP server context
+ **/
+
+void httpServerTick(HttpServerContext *context)
+{
+   uint_t i;
+   systime_t time;
+   systime_t timeout;
+   HttpConnection *connection;
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Loop through the connection table
+   for(i = 0; i < context->settings.maxConnections; i++)
+   {
+      //Point to the current entry
+      connection = &context->connections[i];
+
+      //Connections owned by a worker task rely on the socket timeout
+      if(connection->worker == NULL &&
+         connection->state != HTTP_CONN_STATE_IDLE)
+      {
+         //Persistent connections waiting for a subsequent request are subject
+         //to the idle timeout
+         if(connection->state == HTTP_CONN_STATE_REQ_LINE &&
+            connection->bufferLen == 0)
+         {
+            timeout = HTTP_SERVER_IDLE_TIMEOUT;
+         }
+         else
+         {
+            timeout = HTTP_SERVER_TIMEOUT;
+         }
+
+         //Disconnect inactive client after timeout
+         if(timeCompare(time, connection->timestamp + timeout) >= 0)
+         {
+            //Debug message
+            TRACE_INFO("HTTP Server: Closing inactive connection...\r\n");
+            //Close the HTTP connection
+            httpServerCloseConnection(connection);
+         }
+      }
+   }
+}
+
+
+/**
+ * @brief Accept connection request (event-driven mode)
+ * @param[in] context Pointer to the HTTP server context
+ **/
+
+void httpServerAcceptConnection(HttpServerContext *context)
+{
+   uint_t i;
+   Socket *socket;
+   IpAddr clientIpAddr;
+   uint16_t clientPort;
+   HttpConnection *connection;
+
+   //Accept incoming connection
+   socket = socketAccept(context->socket, &clientIpAddr, &clientPort);
+
+   //Make sure the socket handle is valid
+   if(socket != NULL)
+   {
+      //Force the socket to operate in non-blocking mode
+      socketSetTimeout(socket, 0);
+
+      //Initialize pointer
+      connection = NULL;
+
+      //Loop through the connection table
+      for(i = 0; i < context->settings.maxConnections; i++)
+      {
+         //Check the state of the current connection (connections owned by a
+         //worker task are not returned to the pool until they are given back)
+         if(context->connections[i].worker == NULL &&
+            context->connections[i].state == HTTP_CONN_STATE_IDLE)
+         {
+            //The current entry is free
+            connection = &context->connections[i];
+            break;
+         }
+      }
+
+      //If the connection table runs out of space, then the client's connection
+      //request is rejected
+      if(connection != NULL)
+      {
+         //Debug message
+         TRACE_INFO("HTTP Server: Connection established with client %s port %"
+            PRIu16 "...\r\n", ipAddrToString(&clientIpAddr, NULL), clientPort);
+
+         //Reference to the HTTP server settings
+         connection->settings = &context->settings;
+         //Reference to the HTTP server context
+         connection->serverContext = context;
+         //Reference to the new socket
+         connection->socket = socket;
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+         connection->tlsContext = NULL;
+#endif
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+         connection->file = NULL;
+#endif
+         //Flush receive buffer
+         connection->bufferPos = 0;
+         connection->bufferLen = 0;
+         //No request has been processed yet
+         connection->requestCount = 0;
+         //The connection is owned by the event loop
+         connection->worker = NULL;
+         //Initialize time stamp
+         connection->timestamp = osGetSystemTime();
+
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+         //TLS-secured connection?
+         if(context->settings.tlsInitCallback != NULL)
+         {
+            error_t error;
+
+            //TLS initialization
+            error = httpOpenSecureConnection(connection);
+
+            //Check status code
+            if(!error)
+            {
+               //Perform TLS handshake
+               connection->state = HTTP_CONN_STATE_CONNECT_TLS;
+            }
+            else
+            {
+               //Close connection with the client
+               httpServerCloseConnection(connection);
+            }
+         }
+         else
+#endif
+         {
+            //Wait for incoming HTTP requests
+            connection->state = HTTP_CONN_STATE_REQ_LINE;
+         }
+      }
+      else
+      {
+         //Debug message
+         TRACE_INFO("HTTP Server: Connection refused with client %s port %"
+            PRIu16 "...\r\n", ipAddrToString(&clientIpAddr, NULL), clientPort);
+
+         //The HTTP server cannot accept the incoming connection request
+         socketClose(socket);
+      }
+   }
+}
+
+
+/**
+ * @brief Register connection events (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] eventDesc Event to be registered
+ **/
+
+void httpServerRegisterConnectionEvents(HttpConnection *connection,
+   SocketEventDesc *eventDesc)
+{
+   //Check the state of the connection
+   if(connection->state == HTTP_CONN_STATE_CONNECT_TLS)
+   {
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+      //Any data pending in the send buffer?
+      if(tlsIsTxReady(connection->tlsContext))
+      {
+         //Wait until there is more room in the send buffer
+         eventDesc->socket = connection->socket;
+         eventDesc->eventMask = SOCKET_EVENT_TX_READY;
+      }
+      else
+      {
+         //Wait for data to be available for reading
+         eventDesc->socket = connection->socket;
+         eventDesc->eventMask = SOCKET_EVENT_RX_READY;
+      }
+#endif
+   }
+   else if(connection->state == HTTP_CONN_STATE_REQ_LINE ||
+      connection->state == HTTP_CONN_STATE_REQ_HEADER)
+   {
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+      //Any data available in the receive buffer?
+      if(connection->tlsContext != NULL &&
+         tlsIsRxReady(connection->tlsContext))
+      {
+         //No need to poll the underlying socket for incoming traffic
+         eventDesc->eventFlags |= SOCKET_EVENT_RX_READY;
+      }
+      else
+#endif
+      {
+         //Wait for data to be available for reading
+         eventDesc->socket = connection->socket;
+         eventDesc->eventMask = SOCKET_EVENT_RX_READY;
+      }
+   }
+   else if(connection->state == HTTP_CONN_STATE_RESP_BODY)
+   {
+      //Wait until there is more room in the send buffer
+      eventDesc->socket = connection->socket;
+      eventDesc->eventMask = SOCKET_EVENT_TX_READY;
+   }
+   else if(connection->state == HTTP_CONN_STATE_SHUTDOWN)
+   {
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+      //The TLS session must be closed first
+      if(connection->tlsContext != NULL)
+      {
+         //Wait until there is more room in the send buffer
+         eventDesc->socket = connection->socket;
+         eventDesc->eventMask = SOCKET_EVENT_TX_READY;
+      }
+      else
+#endif
+      {
+         //Wait for the pending data to be transmitted before sending a FIN
+         eventDesc->socket = connection->socket;
+         eventDesc->eventMask = SOCKET_EVENT_TX_DONE;
+      }
+   }
+   else if(connection->state == HTTP_CONN_STATE_CLOSE)
+   {
+      //Wait for the FIN to be acknowledged and for the client to close its
+      //side of the connection
+      eventDesc->socket = connection->socket;
+      eventDesc->eventMask = SOCKET_EVENT_CLOSED;
+   }
+   else
+   {
+      //Just for sanity
+   }
+}
+
+
+/**
+ * @brief Connection event handler (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ **/
+
+void httpServerProcessConnectionEvents(HttpConnection *connection)
+{
+   error_t error;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Update time stamp
+   connection->timestamp = osGetSystemTime();
+
+   //Check the state of the connection
+   if(connection->state == HTTP_CONN_STATE_CONNECT_TLS)
+   {
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+      //Perform TLS handshake
+      error = tlsConnect(connection->tlsContext);
+
+      //Check status code
+      if(!error)
+      {
+         //Wait for incoming HTTP requests
+         connection->state = HTTP_CONN_STATE_REQ_LINE;
+      }
+#else
+      //HTTP over TLS is not implemented
+      error = ERROR_WRONG_STATE;
+#endif
+   }
+   else if(connection->state == HTTP_CONN_STATE_REQ_LINE ||
+      connection->state == HTTP_CONN_STATE_REQ_HEADER)
+   {
+      //Receive the HTTP request header
+      error = httpServerReceiveRequestHeader(connection);
+
+      //The client has closed the connection while the server was waiting
+      //for a subsequent request?
+      if(error == ERROR_END_OF_STREAM &&
+         connection->state == HTTP_CONN_STATE_REQ_LINE &&
+         connection->bufferLen == 0)
+      {
+         //Initiate a graceful connection shutdown
+         connection->state = HTTP_CONN_STATE_SHUTDOWN;
+         error = NO_ERROR;
+      }
+   }
+   else if(connection->state == HTTP_CONN_STATE_RESP_BODY)
+   {
+      //Send the remaining part of the response body
+      error = httpServerSendResponseBody(connection);
+   }
+   else if(connection->state == HTTP_CONN_STATE_SHUTDOWN)
+   {
+      //Graceful connection shutdown
+      error = httpServerShutdownConnection(connection);
+   }
+   else if(connection->state == HTTP_CONN_STATE_CLOSE)
+   {
+      //Close the HTTP connection
+      httpServerCloseConnection(connection);
+   }
+   else
+   {
+      //Invalid state
+      error = ERROR_WRONG_STATE;
+   }
+
+   //Any communication error?
+   if(error != NO_ERROR && error != ERROR_TIMEOUT)
+   {
+      //Close the HTTP connection
+      httpServerCloseConnection(connection);
+   }
+}
+
+
+/**
+ * @brief Receive HTTP request header (event-driven mode)
+ *
+ * The request header is read line by line without blocking. Header fields
+ * are parsed as soon as they are complete, so the buffer only needs to hold
+ * the field being unfolded and the line being received
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpServerReceiveRequestHeader(HttpConnection *connection)
+{
+   error_t error;
+   size_t n;
+   char_t c;
+   char_t *line;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Process as many lines as possible
+   while(!error && (connection->state == HTTP_CONN_STATE_REQ_LINE ||
+      connection->state == HTTP_CONN_STATE_REQ_HEADER))
+   {
+      //Make sure the buffer can hold more data
+      if(connection->bufferLen >= (HTTP_SERVER_BUFFER_SIZE - 1))
+      {
+         error = ERROR_INVALID_REQUEST;
+         break;
+      }
+
+      //Read data until a CRLF character is encountered
+      error = httpServerReceiveData(connection, connection->buffer +
+         connection->bufferLen, HTTP_SERVER_BUFFER_SIZE - 1 -
+         connection->bufferLen, &n, SOCKET_FLAG_BREAK_CRLF);
+
+      //A partial line may have been received before the timeout exception
+      connection->bufferLen += n;
+
+      //Any error to report?
+      if(error)
+         break;
+
+      //Incomplete line?
+      if(connection->bufferLen == 0 ||
+         connection->buffer[connection->bufferLen - 1] != '\n')
+      {
+         continue;
+      }
+
+      //Check the state of the connection
+      if(connection->state == HTTP_CONN_STATE_REQ_LINE)
+      {
+         //Properly terminate the string with a NULL character
+         connection->buffer[connection->bufferLen] = '\0';
+         //Debug message
+         TRACE_INFO("%s", connection->buffer);
+
+         //Clear request header (default value for properties)
+         osMemset(&connection->request, 0, sizeof(HttpRequest));
+         //Clear response header
+         osMemset(&connection->response, 0, sizeof(HttpResponse));
+
+         //Parse the Request-Line
+         error = httpParseRequestLine(connection, connection->buffer);
+         //Any error to report?
+         if(error)
+            break;
+
+         //Flush buffer
+         connection->bufferPos = 0;
+         connection->bufferLen = 0;
+
+         //HTTP 0.9 does not support Full-Request
+         if(connection->request.version >= HTTP_VERSION_1_0)
+         {
+            //Parse the header fields of the HTTP request
+            connection->state = HTTP_CONN_STATE_REQ_HEADER;
+         }
+         else
+         {
+            //Process HTTP request
+            error = httpServerProcessRequest(connection);
+         }
+      }
+      else
+      {
+         //Point to the line that has just been received
+         line = connection->buffer + connection->bufferPos;
+         n = connection->bufferLen - connection->bufferPos;
+
+         //Remove trailing CRLF sequence
+         connection->bufferLen -= 1;
+
+         if(connection->bufferLen > connection->bufferPos &&
+            connection->buffer[connection->bufferLen - 1] == '\r')
+         {
+            connection->bufferLen -= 1;
+         }
+
+         //LWSP character found?
+         if(connection->bufferPos > 0 && (line[0] == ' ' || line[0] == '\t'))
+         {
+            //Unfolding is accomplished by regarding CRLF immediately
+            //followed by a LWSP as equivalent to the LWSP character
+            connection->bufferPos = connection->bufferLen;
+         }
+         else
+         {
+            //The previous header field is now complete
+            if(connection->bufferPos > 0)
+            {
+               //Save the first character of the current line
+               c = line[0];
+               //Properly terminate the previous header field
+               connection->buffer[connection->bufferPos] = '\0';
+
+               //Parse HTTP header field
+               httpServerParseHeaderLine(connection, connection->buffer);
+
+               //Restore the first character of the current line
+               line[0] = c;
+               //Move the current line to the beginning of the buffer
+               osMemmove(connection->buffer, line, n);
+            }
+
+            //Length of the current line, excluding the CRLF sequence
+            n = connection->bufferLen - connection->bufferPos;
+
+            //An empty line indicates the end of the header fields
+            if(n == 0)
+            {
+               //Flush buffer
+               connection->bufferPos = 0;
+               connection->bufferLen = 0;
+
+               //Process HTTP request
+               error = httpServerProcessRequest(connection);
+            }
+            else
+            {
+               //The current line may be followed by continuation lines
+               connection->bufferPos = n;
+               connection->bufferLen = n;
+            }
+         }
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Parse a complete header field (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] line NULL-terminated string that contains the header field
+ **/
+
+void httpServerParseHeaderLine(HttpConnection *connection, char_t *line)
+{
+   char_t *separator;
+   char_t *name;
+   char_t *value;
+
+   //Debug message
+   TRACE_DEBUG("%s\r\n", line);
+
+   //Check whether a separator is present
+   separator = osStrchr(line, ':');
+
+   //Separator found?
+   if(separator != NULL)
+   {
+      //Split the line
+      *separator = '\0';
+
+      //Trim whitespace characters
+      name = strTrimWhitespace(line);
+      value = strTrimWhitespace(separator + 1);
+
+      //Parse HTTP header field
+      httpParseHeaderField(connection, name, value);
+   }
+}
+
+
+/**
+ * @brief Process HTTP request (event-driven mode)
+ *
+ * Static resources are served by the event loop. Any other request is
+ * queued until a worker task becomes available, and the event loop keeps
+ * serving the other connections in the meantime
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpServerProcessRequest(HttpConnection *connection)
+{
+   error_t error;
+
+   //Prepare to read the HTTP request body
+   if(connection->request.chunkedEncoding)
+   {
+      connection->request.byteCount = 0;
+      connection->request.firstChunk = TRUE;
+      connection->request.lastChunk = FALSE;
+   }
+   else
+   {
+      connection->request.byteCount = connection->request.contentLength;
+   }
+
+   //Number of requests processed on this connection
+   connection->requestCount++;
+
+#if (HTTP_SERVER_BASIC_AUTH_SUPPORT == ENABLED || HTTP_SERVER_DIGEST_AUTH_SUPPORT == ENABLED)
+   //No Authorization header found?
+   if(!connection->request.auth.found)
+   {
+      //Invoke user-defined callback, if any
+      if(connection->settings->authCallback != NULL)
+      {
+         //Check whether the access to the specified URI is authorized
+         connection->status = connection->settings->authCallback(connection,
+            connection->request.auth.user, connection->request.uri);
+      }
+      else
+      {
+         //Access to the specified URI is allowed
+         connection->status = HTTP_ACCESS_ALLOWED;
+      }
+   }
+#endif
+
+   //Static resource?
+   if(httpServerIsStaticRequest(connection))
+   {
+      //Default HTTP header fields
+      httpInitResponseHeader(connection);
+      //Set the maximum age for static resources
+      connection->response.maxAge = HTTP_SERVER_MAX_AGE;
+
+      //The response is formatted in the buffer and sent as the socket
+      //becomes writable
+      connection->state = HTTP_CONN_STATE_RESP_HEADER;
+
+      //Prepare the response
+      error = httpSendResponse(connection, connection->request.uri);
+
+      //The resource has been removed in the meantime?
+      if(error == ERROR_NOT_FOUND)
+      {
+         //Let a worker task invoke the user callbacks
+         connection->state = HTTP_CONN_STATE_REQ_BODY;
+         error = NO_ERROR;
+      }
+   }
+   else
+   {
+      //The request body, if any, is read by the user callbacks
+      connection->state = HTTP_CONN_STATE_REQ_BODY;
+      //Successful processing
+      error = NO_ERROR;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Check whether a request targets a static resource (event-driven mode)
+ *
+ * GET and HEAD requests without body that map to a file or to a resource
+ * manager entry are served by the event loop. The request callback is not
+ * invoked for such resources
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ * @return TRUE if the request can be served without a worker task
+ **/
+
+bool_t httpServerIsStaticRequest(HttpConnection *connection)
+{
+   HttpResourceInfo info;
+
+   //Only GET and HEAD requests are eligible
+   if(osStrcasecmp(connection->request.method, "GET") &&
+      osStrcasecmp(connection->request.method, "HEAD"))
+   {
+      return FALSE;
+   }
+
+   //The request body must be consumed by the user callbacks
+   if(connection->request.chunkedEncoding ||
+      connection->request.contentLength > 0)
+   {
+      return FALSE;
+   }
+
+#if (HTTP_SERVER_BASIC_AUTH_SUPPORT == ENABLED || HTTP_SERVER_DIGEST_AUTH_SUPPORT == ENABLED)
+   //Error responses may invoke user callbacks
+   if(connection->status != HTTP_ACCESS_ALLOWED)
+      return FALSE;
+#endif
+
+#if (HTTP_SERVER_SSI_SUPPORT == ENABLED)
+   //SSI scripts are run by the worker tasks
+   if(httpCompExtension(connection->request.uri, ".stm") ||
+      httpCompExtension(connection->request.uri, ".shtm") ||
+      httpCompExtension(connection->request.uri, ".shtml"))
+   {
+      return FALSE;
+   }
+#endif
+
+   //Locate the resource
+   return httpGetResourceInfo(connection, connection->request.uri,
+      &info) ? FALSE : TRUE;
+}
+
+
+/**
+ * @brief Assign pending requests to idle worker tasks (event-driven mode)
+ *
+ * Connections whose request has been processed are first taken back from
+ * the worker tasks. The ownership of a connection only changes while the
+ * mutex is held
+ *
+ * @param[in] context Pointer to the HTTP server context
+ **/
+
+void httpServerDispatchRequests(HttpServerContext *context)
+{
+   uint_t i;
+   uint_t j;
+   HttpConnection *connection;
+   HttpServerWorker *worker;
+
+   //Get exclusive access
+   osAcquireMutex(&context->workerMutex);
+
+   //Loop through worker tasks
+   for(j = 0; j < HTTP_SERVER_MAX_WORKERS; j++)
+   {
+      //Point to the current worker
+      worker = &context->workers[j];
+
+      //The request has been processed?
+      if(worker->connection != NULL && worker->done)
+      {
+         //Update time stamp
+         worker->connection->timestamp = osGetSystemTime();
+
+         //Give the connection back to the event loop
+         worker->connection->worker = NULL;
+         worker->connection = NULL;
+         worker->done = FALSE;
+      }
+   }
+
+   //Loop through the connection table
+   for(i = 0, j = 0; i < context->settings.maxConnections; i++)
+   {
+      //Point to the current entry
+      connection = &context->connections[i];
+
+      //Request waiting for a worker task?
+      if(connection->worker == NULL &&
+         connection->state == HTTP_CONN_STATE_REQ_BODY)
+      {
+         //Search for an idle worker task
+         while(j < HTTP_SERVER_MAX_WORKERS &&
+            context->workers[j].connection != NULL)
+         {
+            j++;
+         }
+
+         //All the worker tasks are busy?
+         if(j >= HTTP_SERVER_MAX_WORKERS)
+            break;
+
+         //Point to the idle worker task
+         worker = &context->workers[j];
+
+         //The connection is now owned by the worker task
+         connection->worker = worker;
+         worker->connection = connection;
+
+         //Start processing the request
+         osSetEvent(&worker->event);
+      }
+   }
+
+   //Release exclusive access
+   osReleaseMutex(&context->workerMutex);
+}
+
+
+/**
+ * @brief Generate the response to a request (event-driven mode)
+ *
+ * This function is called by a worker task. User callbacks and SSI scripts
+ * are run to completion and are allowed to perform blocking I/O operations
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ **/
+
+void httpServerGenerateResponse(HttpConnection *connection)
+{
+   error_t error;
+
+   //Blocking operations are bounded by the connection timeout
+   socketSetTimeout(connection->socket, HTTP_SERVER_TIMEOUT);
+
+   //Generate the response to the request
+   error = httpProcessRequest(connection);
+
+   //The connection may have been upgraded to a WebSocket
+   if(connection->socket == NULL)
+   {
+      //The socket is no longer attached to the HTTP connection
+      connection->state = HTTP_CONN_STATE_IDLE;
+      //Exit immediately
+      return;
+   }
+
+   //Revert to non-blocking mode
+   socketSetTimeout(connection->socket, 0);
+
+   //Check status code
+   if(!error)
+   {
+      //The body of a static resource is sent by the event loop as the
+      //socket becomes writable
+      if(connection->state != HTTP_CONN_STATE_RESP_BODY)
+      {
+         //The response has been entirely sent
+         httpServerCompleteRequest(connection);
+      }
+   }
+   else
+   {
+      //Debug message
+      TRACE_INFO("HTTP Server: Request processing failed...\r\n");
+      //Initiate a graceful connection shutdown
+      connection->state = HTTP_CONN_STATE_SHUTDOWN;
+   }
+}
+
+
+/**
+ * @brief Send the remaining part of the response body (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpServerSendResponseBody(HttpConnection *connection)
+{
+   error_t error;
+   size_t n;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send as much data as possible
+   while(!error)
+   {
+      //Any data pending in the buffer (response header or file contents)?
+      if(connection->bufferPos < connection->bufferLen)
+      {
+         //Send more data
+         error = httpServerSendData(connection, connection->buffer +
+            connection->bufferPos, connection->bufferLen - connection->bufferPos,
+            &n, 0);
+
+         //Advance data pointer
+         connection->bufferPos += n;
+      }
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      else if(connection->bodyPos < connection->bodyLen)
+      {
+         //Limit the number of bytes to read at a time
+         n = MIN(connection->bodyLen - connection->bodyPos,
+            HTTP_SERVER_BUFFER_SIZE);
+
+         //Read data from the specified file
+         error = fsReadFile(connection->file, connection->buffer, n, &n);
+
+         //Check status code
+         if(!error)
+         {
+            //Advance file pointer
+            connection->bodyPos += n;
+
+            //Fill the buffer
+            connection->bufferPos = 0;
+            connection->bufferLen = n;
+         }
+      }
+#else
+      else if(connection->bodyPos < connection->bodyLen)
+      {
+         //Send more data
+         error = httpServerSendData(connection, connection->bodyStart +
+            connection->bodyPos, connection->bodyLen - connection->bodyPos,
+            &n, 0);
+
+         //Advance data pointer
+         connection->bodyPos += n;
+      }
+#endif
+      else
+      {
+         //Flush the send buffer
+         error = httpServerSendData(connection, "", 0, &n,
+            SOCKET_FLAG_NO_DELAY);
+
+         //Check status code
+         if(!error)
+         {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+            //Responses without body do not open any file
+            if(connection->file != NULL)
+            {
+               //Close the file
+               fsCloseFile(connection->file);
+               connection->file = NULL;
+            }
+#endif
+            //Flush buffer
+            connection->bufferPos = 0;
+            connection->bufferLen = 0;
+
+            //The response has been entirely sent
+            httpServerCompleteRequest(connection);
+         }
+
+         //We are done
+         break;
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Complete the current request (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ **/
+
+void httpServerCompleteRequest(HttpConnection *connection)
+{
+   //Check whether the connection is persistent or not
+   if(connection->request.keepAlive && connection->response.keepAlive &&
+      connection->requestCount < HTTP_SERVER_MAX_REQUESTS)
+   {
+      //Wait for the next HTTP request
+      connection->state = HTTP_CONN_STATE_REQ_LINE;
+   }
+   else
+   {
+      //Initiate a graceful connection shutdown
+      connection->state = HTTP_CONN_STATE_SHUTDOWN;
+   }
+}
+
+
+/**
+ * @brief Shutdown network connection (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @return Error code
+ **/
+
+error_t httpServerShutdownConnection(HttpConnection *connection)
+{
+   error_t error;
+
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+   //Valid TLS context?
+   if(connection->tlsContext != NULL)
+   {
+      //Gracefully close TLS session
+      error = tlsShutdown(connection->tlsContext);
+
+      //Check status code
+      if(!error)
+      {
+         //Release TLS context
+         tlsFree(connection->tlsContext);
+         connection->tlsContext = NULL;
+      }
+   }
+   else
+#endif
+   {
+      //Debug message
+      TRACE_INFO("HTTP Server: Graceful shutdown...\r\n");
+
+      //Shutdown transmission (a timeout exception is reported until the FIN
+      //has been acknowledged)
+      error = socketShutdown(connection->socket, SOCKET_SD_SEND);
+      //Wait for the client to close its side of the connection
+      connection->state = HTTP_CONN_STATE_CLOSE;
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Close network connection (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ **/
+
+void httpServerCloseConnection(HttpConnection *connection)
+{
+   //Debug message
+   TRACE_INFO("HTTP Server: Closing connection...\r\n");
+
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   //Any file being sent?
+   if(connection->file != NULL)
+   {
+      //Close the file
+      fsCloseFile(connection->file);
+      connection->file = NULL;
+   }
+#endif
+
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+   //Valid TLS context?
+   if(connection->tlsContext != NULL)
+   {
+      //Release TLS context
+      tlsFree(connection->tlsContext);
+      connection->tlsContext = NULL;
+   }
+#endif
+
+   //Valid socket handle?
+   if(connection->socket != NULL)
+   {
+      //Close TCP socket
+      socketClose(connection->socket);
+      connection->socket = NULL;
+   }
+
+   //Mark the connection as closed
+   connection->state = HTTP_CONN_STATE_IDLE;
+}
+
+
+/**
+ * @brief Send data to the client without blocking (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] data Pointer to a buffer containing the data to be transmitted
+ * @param[in] length Number of bytes to be transmitted
+ * @param[out] written Actual number of bytes written
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t httpServerSendData(HttpConnection *connection, const void *data,
+   size_t length, size_t *written, uint_t flags)
+{
+   error_t error;
+
+   //No data has been sent yet
+   *written = 0;
+
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+   //Check whether a secure connection is being used
+   if(connection->tlsContext != NULL)
+   {
+      //Use TLS to transmit data to the client
+      error = tlsWrite(connection->tlsContext, data, length, written, flags);
+   }
+   else
+#endif
+   {
+      //Transmit data to the client
+      error = socketSend(connection->socket, data, length, written, flags);
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Receive data from the client without blocking (event-driven mode)
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[out] data Buffer into which received data will be placed
+ * @param[in] size Maximum number of bytes that can be received
+ * @param[out] received Actual number of bytes that have been received
+ * @param[in] flags Set of flags that influences the behavior of this function
+ * @return Error code
+ **/
+
+error_t httpServerReceiveData(HttpConnection *connection, void *data,
+   size_t size, size_t *received, uint_t flags)
+{
+   error_t error;
+
+   //No data has been received yet
+   *received = 0;
+
+#if (HTTP_SERVER_TLS_SUPPORT == ENABLED)
+   //Check whether a secure connection is being used
+   if(connection->tlsContext != NULL)
+   {
+      //Use TLS to receive data from the client
+      error = tlsRead(connection->tlsContext, data, size, received, flags);
+   }
+   else
+#endif
+   {
+      //Receive data from the client
+      error = socketReceive(connection->socket, data, size, received, flags);
+   }
+
+   //Return status code
+   return error;
+}
+
+#endif
+
+
+/**
+ * @brief Locate a static resource and retrieve its metadata
+ *
+ * On success, the buffer associated with the connection contains the full
+ * pathname of the resource (including the gzip extension, if the compressed
+ * variant is to be served)
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] uri NULL-terminated string containing the resource identifier
+ * @param[out] info Metadata of the resource
+ * @return Error code
+ **/
+
+error_t httpGetResourceInfo(HttpConnection *connection, const char_t *uri,
+   HttpResourceInfo *info)
+{
+   error_t error;
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   uint32_t length;
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED || HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   FsFileStat fileStat;
+#endif
+#else
+   size_t length;
+   const uint8_t *data;
+#endif
+
+   //Retrieve the full pathname
+   httpGetAbsolutePath(connection, uri, connection->buffer,
+      HTTP_SERVER_BUFFER_SIZE);
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   //Search the resource cache for a matching entry
+   error = httpFindResCacheEntry(connection, uri, info);
+
+   //Cache hit?
+   if(!error)
+   {
+      //The gzip-compressed variant is served?
+      if(info->gzipEncoding)
+      {
+         //Append gzip extension
+         osStrcat(connection->buffer, ".gz");
+      }
+
+      //The entry is trusted until it expires, so a cache hit does not
+      //access the file system
+      return NO_ERROR;
+   }
+#endif
+
+   //The non-compressed variant is served by default
+   info->gzipEncoding = FALSE;
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //Check whether gzip compression is supported by the client
+   if(connection->request.acceptGzipEncoding)
+   {
+      size_t n;
+
+      //Calculate the length of the pathname
+      n = osStrlen(connection->buffer);
+
+      //Sanity check
+      if(n < (HTTP_SERVER_BUFFER_SIZE - 4))
+      {
+         //Append gzip extension
+         osStrcpy(connection->buffer + n, ".gz");
+
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+         //Retrieve the size of the compressed resource, if any
+         error = fsGetFileSize(connection->buffer, &length);
+#else
+         //Get the compressed resource data associated with the URI, if any
+         error = resGetData(connection->buffer, &data, &length);
+#endif
+      }
+      else
+      {
+         //Report an error
+         error = ERROR_NOT_FOUND;
+      }
+
+      //Check whether the gzip-compressed resource exists
+      if(!error)
+      {
+         //Use gzip format
+         info->gzipEncoding = TRUE;
+      }
+      else
+      {
+         //Strip the gzip extension
+         connection->buffer[n] = '\0';
+      }
+   }
+   else
+   {
+      //The client does not accept gzip encoding
+      error = ERROR_NOT_FOUND;
+   }
+
+   //The non-compressed resource must be used?
+   if(error)
+#endif
+   {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //Retrieve the size of the specified file
+      error = fsGetFileSize(connection->buffer, &length);
+      //The specified URI cannot be found?
+      if(error)
+         return ERROR_NOT_FOUND;
+#else
+      //Get the resource data associated with the URI
+      error = resGetData(connection->buffer, &data, &length);
+      //The specified URI cannot be found?
+      if(error)
+         return error;
+#endif
+   }
+
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+#if (HTTP_SERVER_ETAG_SUPPORT == ENABLED || HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   //Retrieve the modification time of the file
+   error = fsGetFileStat(connection->buffer, &fileStat);
+
+   //Not all file systems report modification times. The resource is then
+   //served without entity tag and its metadata is not cached
+   if(!error)
+   {
+      //Save the modification time
+      info->modifiedValid = TRUE;
+      info->modified = fileStat.modified;
+   }
+   else
+#endif
+   {
+      //The modification time is not known
+      info->modifiedValid = FALSE;
+   }
+#endif
+
+#if (HTTP_SERVER_FS_SUPPORT == DISABLED)
+   //Point to the resource data
+   info->data = data;
+#endif
+
+   //Save the length of the representation
+   info->length = length;
+   //Resolve the MIME type
+   info->contentType = mimeGetType(uri);
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   //Cached metadata cannot be revalidated without the modification time
+   if(info->modifiedValid)
+#endif
+   {
+      //Save the metadata in the resource cache
+      httpAddResCacheEntry(connection, uri, info);
+   }
+#endif
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Search the resource metadata cache
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] uri NULL-terminated string containing the resource identifier
+ * @param[out] info Metadata of the resource
+ * @return Error code (ERROR_NOT_FOUND on cache miss)
+ **/
+
+error_t httpFindResCacheEntry(HttpConnection *connection, const char_t *uri,
+   HttpResourceInfo *info)
+{
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   error_t error;
+   uint_t i;
+   uint32_t hash;
+   bool_t acceptGzip;
+   systime_t time;
+   HttpResCacheEntry *entry;
+   HttpResCacheEntry *set;
+   HttpServerContext *context;
+
+   //Point to the HTTP server context
+   context = connection->serverContext;
+
+   //Get current time
+   time = osGetSystemTime();
+   //Hash the resource identifier
+   hash = httpHashUri(uri);
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //The resolved variant depends on whether the client accepts gzip encoding
+   acceptGzip = connection->request.acceptGzipEncoding;
+#else
+   //Only non-compressed resources are served
+   acceptGzip = FALSE;
+#endif
+
+   //Point to the set the resource belongs to
+   set = httpGetResCacheSet(context, hash, acceptGzip);
+
+   //Initialize status code
+   error = ERROR_NOT_FOUND;
+
+   //Acquire exclusive access to the resource cache
+   osAcquireMutex(&context->resCacheMutex);
+
+   //Loop through the entries of the set
+   for(i = 0; i < HTTP_SERVER_RES_CACHE_WAYS; i++)
+   {
+      //Point to the current entry
+      entry = &set[i];
+
+      //Compare the hash first to avoid unnecessary string comparisons
+      if(entry->uri[0] != '\0' && entry->hash == hash &&
+         entry->acceptGzip == acceptGzip && !osStrcmp(entry->uri, uri))
+      {
+         //Check the lifetime of the entry
+         if(timeCompare(time, entry->created + HTTP_SERVER_RES_CACHE_LIFETIME) < 0)
+         {
+            //Retrieve the metadata of the resource
+            *info = entry->info;
+            //Keep track of the last access
+            entry->timestamp = time;
+            //Cache hit
+            error = NO_ERROR;
+         }
+         else
+         {
+            //The file may have been modified or a gzip-compressed variant may
+            //have been created in the meantime
+            entry->uri[0] = '\0';
+         }
+
+         //A resource occupies at most one entry
+         break;
+      }
+   }
+
+   //Release exclusive access to the resource cache
+   osReleaseMutex(&context->resCacheMutex);
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return ERROR_NOT_FOUND;
+#endif
+}
+
+
+/**
+ * @brief Add an entry to the resource metadata cache
+ *
+ * The entry is stored in the set selected by the hash of the resource
+ * identifier. When the set is full, the least recently used entry is
+ * replaced
+ *
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] uri NULL-terminated string containing the resource identifier
+ * @param[in] info Metadata of the resource
+ **/
+
+void httpAddResCacheEntry(HttpConnection *connection, const char_t *uri,
+   const HttpResourceInfo *info)
+{
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+   uint_t i;
+   uint32_t hash;
+   bool_t acceptGzip;
+   systime_t time;
+   HttpResCacheEntry *entry;
+   HttpResCacheEntry *oldestEntry;
+   HttpResCacheEntry *set;
+   HttpServerContext *context;
+
+   //Make sure the resource identifier fits in the cache entry
+   if(osStrlen(uri) > HTTP_SERVER_URI_MAX_LEN)
+      return;
+
+   //Point to the HTTP server context
+   context = connection->serverContext;
+
+   //Get current time
+   time = osGetSystemTime();
+   //Hash the resource identifier
+   hash = httpHashUri(uri);
+
+#if (HTTP_SERVER_GZIP_TYPE_SUPPORT == ENABLED)
+   //The resolved variant depends on whether the client accepts gzip encoding
+   acceptGzip = connection->request.acceptGzipEncoding;
+#else
+   //Only non-compressed resources are served
+   acceptGzip = FALSE;
+#endif
+
+   //Point to the set the resource belongs to
+   set = httpGetResCacheSet(context, hash, acceptGzip);
+
+   //Acquire exclusive access to the resource cache
+   osAcquireMutex(&context->resCacheMutex);
+
+   //Keep track of the least recently used entry
+   oldestEntry = NULL;
+
+   //Loop through the entries of the set
+   for(i = 0; i < HTTP_SERVER_RES_CACHE_WAYS; i++)
+   {
+      //Point to the current entry
+      entry = &set[i];
+
+      //Check whether the entry is free or already describes the resource
+      if(entry->uri[0] == '\0' || (entry->hash == hash &&
+         entry->acceptGzip == acceptGzip && !osStrcmp(entry->uri, uri)))
+      {
+         //Use this entry
+         oldestEntry = entry;
+         break;
+      }
+
+      //Keep track of the least recently used entry
+      if(oldestEntry == NULL ||
+         timeCompare(entry->timestamp, oldestEntry->timestamp) < 0)
+      {
+         oldestEntry = entry;
+      }
+   }
+
+   //Save the metadata of the resource
+   osStrcpy(oldestEntry->uri, uri);
+   oldestEntry->hash = hash;
+   oldestEntry->acceptGzip = acceptGzip;
+   oldestEntry->info = *info;
+   oldestEntry->created = time;
+   oldestEntry->timestamp = time;
+
+   //Release exclusive access to the resource cache
+   osReleaseMutex(&context->resCacheMutex);
+#endif
+}
+
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+
+/**
+ * @brief Select the set of the resource metadata cache a resource belongs to
+ * @param[in] context Pointer to the HTTP server context
+ * @param[in] hash Hash of the resource identifier
+ * @param[in] acceptGzip The client accepts gzip encoding
+ * @return Pointer to the first entry of the set
+ **/
+
+HttpResCacheEntry *httpGetResCacheSet(HttpServerContext *context,
+   uint32_t hash, bool_t acceptGzip)
+{
+   uint_t i;
+
+   //Both variants of a resource are stored in distinct sets
+   i = (hash + acceptGzip) % (HTTP_SERVER_RES_CACHE_SIZE /
+      HTTP_SERVER_RES_CACHE_WAYS);
+
+   //Return a pointer to the first entry of the set
+   return &context->resCache[i * HTTP_SERVER_RES_CACHE_WAYS];
+}
+
+#endif
+
+
+/**
+ * @brief Hash a resource identifier
+ * @param[in] uri NULL-terminated string containing the resource identifier
+ * @return Hash value
+ **/
+
+uint32_t httpHashUri(const char_t *uri)
+{
+   uint32_t h;
+
+   //FNV-1a hash function
+   for(h = 2166136261U; *uri != '\0'; uri++)
+   {
+      h ^= (uint8_t) *uri;
+      h *= 16777619U;
+   }
+
+   //Return hash value
+   return h;
+}
+
+
 /**
  * @brief Retrieve the full pathname to the specified resource
  * @param[in] connection Structure representing an HTTP connection
@@ -59,6 +59,13 @@ void httpParseAcceptEncodingField(HttpConnection *connection,
    char_t *value);
 
 void httpParseCookieField(HttpConnection *connection, char_t *value);
+void httpParseRangeField(HttpConnection *connection, char_t *value);
+
+void httpFormatEtag(HttpConnection *connection, size_t length, uint32_t id);
+bool_t httpCheckIfNoneMatch(HttpConnection *connection);
+
+error_t httpSelectRange(HttpConnection *connection, size_t length,
+   size_t *offset, size_t *count);
 
 error_t httpReadChunkSize(HttpConnection *connection);
 
@@ -71,6 +78,50 @@ error_t httpSend(HttpConnection *connection,
 error_t httpReceive(HttpConnection *connection,
    void *data, size_t size, size_t *received, uint_t flags);
 
+error_t httpOpenSecureConnection(HttpConnection *connection);
+
+void httpServerTick(HttpServerContext *context);
+void httpServerAcceptConnection(HttpServerContext *context);
+
+void httpServerRegisterConnectionEvents(HttpConnection *connection,
+   SocketEventDesc *eventDesc);
+
+void httpServerProcessConnectionEvents(HttpConnection *connection);
+
+error_t httpServerReceiveRequestHeader(HttpConnection *connection);
+void httpServerParseHeaderLine(HttpConnection *connection, char_t *line);
+error_t httpServerProcessRequest(HttpConnection *connection);
+bool_t httpServerIsStaticRequest(HttpConnection *connection);
+void httpServerDispatchRequests(HttpServerContext *context);
+void httpServerGenerateResponse(HttpConnection *connection);
+error_t httpServerSendResponseBody(HttpConnection *connection);
+void httpServerCompleteRequest(HttpConnection *connection);
+
+error_t httpServerShutdownConnection(HttpConnection *connection);
+void httpServerCloseConnection(HttpConnection *connection);
+
+error_t httpServerSendData(HttpConnection *connection, const void *data,
+   size_t length, size_t *written, uint_t flags);
+
+error_t httpServerReceiveData(HttpConnection *connection, void *data,
+   size_t size, size_t *received, uint_t flags);
+
+error_t httpGetResourceInfo(HttpConnection *connection, const char_t *uri,
+   HttpResourceInfo *info);
+
+error_t httpFindResCacheEntry(HttpConnection *connection, const char_t *uri,
+   HttpResourceInfo *info);
+
+void httpAddResCacheEntry(HttpConnection *connection, const char_t *uri,
+   const HttpResourceInfo *info);
+
+#if (HTTP_SERVER_RES_CACHE_SUPPORT == ENABLED)
+HttpResCacheEntry *httpGetResCacheSet(HttpServerContext *context,
+   uint32_t hash, bool_t acceptGzip);
+#endif
+
+uint32_t httpHashUri(const char_t *uri);
+
 void httpGetAbsolutePath(HttpConnection *connection,
    const char_t *relative, char_t *absolute, size_t maxLen);
 
@@ -100,6 +100,11 @@ static const MimeType mimeTypeList[] =
    {".zip",   "application/zip"}
 };
 
+//Hash table indexing the MIME type list by file extension
+static uint16_t mimeHashTable[MIME_HASH_TABLE_SIZE];
+//The hash table is built on first use
+static bool_t mimeHashTableReady = FALSE;
+
 
 /**
  * @brief Get the MIME type from a given extension
@@ -113,6 +118,8 @@ static const MimeType mimeTypeList[] =
 const char_t *mimeGetType(const char_t *filename)
 {
    uint_t i;
+   uint_t j;
+   uint_t k;
    uint_t n;
    uint_t m;
 
@@ -125,17 +132,137 @@ const char_t *mimeGetType(const char_t *filename)
       //Get the length of the specified filename
       n = osStrlen(filename);
 
-      //Search the MIME type that matches the specified extension
-      for(i = 0; i < arraysize(mimeTypeList); i++)
+      //The hash table is built on first use
+      if(!mimeHashTableReady)
+         mimeBuildHashTable();
+
+      //Check whether the hash table is available
+      if(mimeHashTableReady)
+      {
+         //Index of the first matching entry
+         k = arraysize(mimeTypeList);
+
+         //Hash the extension of the filename
+         j = mimeHashExtension(filename) & (MIME_HASH_TABLE_SIZE - 1);
+
+         //Linear probing (the table is never full, so the loop terminates)
+         while(mimeHashTable[j] != 0)
+         {
+            //Retrieve the index of the current candidate
+            i = mimeHashTable[j] - 1;
+            //Length of the extension
+            m = osStrlen(mimeTypeList[i].extension);
+
+            //Compare file extensions. When several entries match, the one
+            //that appears first in the list takes precedence
+            if(i < k && m <= n &&
+               !osStrcasecmp(filename + n - m, mimeTypeList[i].extension))
+            {
+               k = i;
+            }
+
+            //Next slot
+            j = (j + 1) & (MIME_HASH_TABLE_SIZE - 1);
+         }
+
+         //Matching extension found?
+         if(k < arraysize(mimeTypeList))
+            return mimeTypeList[k].type;
+      }
+      else
       {
-         //Length of the extension
-         m = osStrlen(mimeTypeList[i].extension);
-         //Compare file extensions
-         if(m <= n && !osStrcasecmp(filename + n - m, mimeTypeList[i].extension))
-            return mimeTypeList[i].type;
+         //Search the MIME type that matches the specified extension
+         for(i = 0; i < arraysize(mimeTypeList); i++)
+         {
+            //Length of the extension
+            m = osStrlen(mimeTypeList[i].extension);
+            //Compare file extensions
+            if(m <= n && !osStrcasecmp(filename + n - m, mimeTypeList[i].extension))
+               return mimeTypeList[i].type;
+         }
       }
    }
 
    //Return the default MIME type when an unknown extension is encountered
    return defaultMimeType;
 }
+
+
+/**
+ * @brief Build the hash table indexing the MIME type list
+ *
+ * Each entry of the MIME type list is indexed by the last component of its
+ * extension. Insertions are idempotent, so concurrent callers produce the
+ * same table
+ *
+ **/
+
+void mimeBuildHashTable(void)
+{
+   uint_t i;
+   uint_t j;
+
+   //The table must contain at least one free slot to terminate the probing
+   if(arraysize(mimeTypeList) >= MIME_HASH_TABLE_SIZE ||
+      arraysize(mimeTypeList) >= UINT16_MAX)
+   {
+      //Fall back to linear search
+      return;
+   }
+
+   //Loop through the MIME type list
+   for(i = 0; i < arraysize(mimeTypeList); i++)
+   {
+      //Hash the extension
+      j = mimeHashExtension(mimeTypeList[i].extension) &
+         (MIME_HASH_TABLE_SIZE - 1);
+
+      //Search for the entry or a free slot
+      while(mimeHashTable[j] != 0 && mimeHashTable[j] != (i + 1))
+      {
+         j = (j + 1) & (MIME_HASH_TABLE_SIZE - 1);
+      }
+
+      //Save the index of the entry
+      mimeHashTable[j] = i + 1;
+   }
+
+   //The hash table is now ready to use
+   mimeHashTableReady = TRUE;
+}
+
+
+/**
+ * @brief Hash the extension of a filename
+ *
+ * The hash covers the characters that follow the last dot (the whole string
+ * is used when no dot is present). Hashing is case-insensitive
+ *
+ * @param[in] filename NULL-terminated string
+ * @return Hash value
+ **/
+
+uint32_t mimeHashExtension(const char_t *filename)
+{
+   uint32_t h;
+   const char_t *p;
+
+   //Point to the last dot, if any
+   p = osStrrchr(filename, '.');
+
+   //No extension?
+   if(p == NULL)
+      p = filename;
+   else
+      p++;
+
+   //FNV-1a hash function
+   for(h = 2166136261U; *p != '\0'; p++)
+   {
+      h ^= (uint8_t) osTolower(*p);
+      h *= 16777619U;
+   }
+
+   //Return hash value
+   return h;
+}
@@ -39,6 +39,13 @@
    #define MIME_CUSTOM_TYPES
 #endif
 
+//Size of the hash table used to index the MIME type list
+#ifndef MIME_HASH_TABLE_SIZE
+   #define MIME_HASH_TABLE_SIZE 128
+#elif (MIME_HASH_TABLE_SIZE < 8 || (MIME_HASH_TABLE_SIZE & (MIME_HASH_TABLE_SIZE - 1)) != 0)
+   #error MIME_HASH_TABLE_SIZE parameter is not valid
+#endif
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +66,9 @@ typedef struct
 //MIME related functions
 const char_t *mimeGetType(const char_t *filename);
 
+void mimeBuildHashTable(void);
+uint32_t mimeHashExtension(const char_t *filename);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -80,6 +80,9 @@ error_t ssiExecuteScript(HttpConnection *connection, const char_t *uri, uint_t l
    uint_t j;
    const char_t *data;
 #endif
+#if (HTTP_SERVER_SSI_CACHE_SUPPORT == ENABLED)
+   HttpSsiCacheEntry *entry;
+#endif
 
    //Recursion limit exceeded?
    if(level >= HTTP_SERVER_SSI_MAX_RECURSION)
@@ -89,6 +92,33 @@ error_t ssiExecuteScript(HttpConnection *connection, const char_t *uri, uint_t l
    httpGetAbsolutePath(connection, uri,
       connection->buffer, HTTP_SERVER_BUFFER_SIZE);
 
+#if (HTTP_SERVER_SSI_CACHE_SUPPORT == ENABLED)
+   //Retrieve the precompiled template from the cache
+   error = ssiGetCacheEntry(connection->serverContext, connection->buffer,
+      &entry);
+
+   //Check status code
+   if(!error)
+   {
+      //Emit literal spans and process SSI directives
+      error = ssiExecuteCachedScript(connection, entry, uri, level);
+      //The cache entry is no longer used
+      ssiReleaseCacheEntry(connection->serverContext, entry);
+
+      //Return status code
+      return error;
+   }
+   else if(error == ERROR_NOT_FOUND)
+   {
+      //The specified URI cannot be found
+      return error;
+   }
+   else
+   {
+      //The template cannot be cached and is processed on the fly
+   }
+#endif
+
 #if (HTTP_SERVER_FS_SUPPORT == ENABLED)
    //Open the file for reading
    file = fsOpenFile(connection->buffer, FS_FILE_MODE_READ);
@@ -816,6 +846,491 @@ error_t ssiProcessExecCommand(HttpConnection *connection, const char_t *tag, siz
 }
 
 
+#if (HTTP_SERVER_SSI_CACHE_SUPPORT == ENABLED)
+
+/**
+ * @brief Execute a precompiled SSI template
+ * @param[in] connection Structure representing an HTTP connection
+ * @param[in] entry Pointer to the SSI template cache entry
+ * @param[in] uri NULL-terminated string containing the file to process
+ * @param[in] level Current level of recursion
+ * @return Error code
+ **/
+
+error_t ssiExecuteCachedScript(HttpConnection *connection,
+   const HttpSsiCacheEntry *entry, const char_t *uri, uint_t level)
+{
+   error_t error;
+   uint_t i;
+   const HttpSsiNode *node;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send the HTTP response header before executing the script
+   if(!level)
+   {
+      //Format HTTP response header
+      connection->response.statusCode = 200;
+      connection->response.contentType = mimeGetType(uri);
+      connection->response.chunkedEncoding = TRUE;
+
+      //Send the header to the client
+      error = httpWriteHeader(connection);
+   }
+
+   //Loop through the nodes of the template
+   for(i = 0; i < entry->numNodes && !error; i++)
+   {
+      //Point to the current node
+      node = &entry->nodes[i];
+
+      //SSI directive?
+      if(node->directive)
+      {
+         //Process SSI directive
+         error = ssiProcessCommand(connection, entry->data + node->offset,
+            node->length, uri, level);
+      }
+      else
+      {
+         //Send literal text
+         error = httpWriteStream(connection, entry->data + node->offset,
+            node->length);
+      }
+   }
+
+   //Properly close the output stream
+   if(!level && !error)
+      error = httpCloseStream(connection);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Retrieve a precompiled SSI template from the cache
+ *
+ * The template is parsed when it is first requested and whenever the
+ * underlying file changes. The entry is locked until ssiReleaseCacheEntry
+ * is called
+ *
+ * @param[in] context Pointer to the HTTP server context
+ * @param[in] path Full pathname of the template
+ * @param[out] entry Pointer to the SSI template cache entry
+ * @return Error code
+ **/
+
+error_t ssiGetCacheEntry(HttpServerContext *context, const char_t *path,
+   HttpSsiCacheEntry **entry)
+{
+   error_t error;
+   uint_t i;
+   size_t length;
+   HttpSsiCacheEntry *p;
+   HttpSsiCacheEntry *newEntry;
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   FsFileStat fileStat;
+#else
+   const uint8_t *data;
+#endif
+
+   //Initialize pointers
+   *entry = NULL;
+   newEntry = NULL;
+
+   //Check the length of the pathname
+   if(osStrlen(path) >= sizeof(context->ssiCache[0].path))
+      return ERROR_INVALID_LENGTH;
+
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   //Retrieve the size and the modification time of the file
+   error = fsGetFileStat(path, &fileStat);
+   //The specified URI cannot be found?
+   if(error)
+      return ERROR_NOT_FOUND;
+
+   //Large templates are processed on the fly
+   if(fileStat.size > HTTP_SERVER_SSI_CACHE_MAX_FILE_SIZE)
+      return ERROR_BUFFER_OVERFLOW;
+
+   //Size of the template
+   length = fileStat.size;
+#else
+   //Get the resource data associated with the URI
+   error = resGetData(path, &data, &length);
+   //The specified URI cannot be found?
+   if(error)
+      return error;
+#endif
+
+   //Acquire exclusive access to the SSI template cache
+   osAcquireMutex(&context->ssiCacheMutex);
+
+   //Loop through the SSI template cache
+   for(i = 0; i < HTTP_SERVER_SSI_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      p = &context->ssiCache[i];
+
+      //Check whether the template is already in the cache
+      if(p->path[0] != '\0' && !osStrcmp(p->path, path))
+      {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+         //Make sure the file has not been modified
+         if(p->length == length &&
+            !compareDateTime(&p->modified, &fileStat.modified))
+#else
+         //Make sure the resource has not been modified
+         if(p->data == (const char_t *) data && p->length == length)
+#endif
+         {
+            //The cached template is up-to-date
+            *entry = p;
+         }
+         else if(p->refCount == 0)
+         {
+            //Discard the outdated template
+            ssiFreeCacheEntry(p);
+            //The entry can be reused
+            newEntry = p;
+         }
+         else
+         {
+            //The outdated template is still being used by another connection
+         }
+
+         //We are done
+         break;
+      }
+   }
+
+   //Template not found in the cache?
+   if(*entry == NULL && i >= HTTP_SERVER_SSI_CACHE_SIZE)
+   {
+      //Loop through the SSI template cache
+      for(i = 0; i < HTTP_SERVER_SSI_CACHE_SIZE; i++)
+      {
+         //Point to the current entry
+         p = &context->ssiCache[i];
+
+         //Check whether the current entry is free
+         if(p->path[0] == '\0')
+         {
+            //Select the current entry
+            newEntry = p;
+            break;
+         }
+         else if(p->refCount == 0)
+         {
+            //Keep track of the least recently used entry
+            if(newEntry == NULL ||
+               timeCompare(p->timestamp, newEntry->timestamp) < 0)
+            {
+               newEntry = p;
+            }
+         }
+         else
+         {
+            //The current entry is in use
+         }
+      }
+
+      //Evict the least recently used template, if necessary
+      if(newEntry != NULL && newEntry->path[0] != '\0')
+      {
+         ssiFreeCacheEntry(newEntry);
+      }
+   }
+
+   //Any entry available to hold the template?
+   if(newEntry != NULL)
+   {
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+      //Save the modification time of the file
+      newEntry->modified = fileStat.modified;
+      //Parse the template
+      error = ssiLoadCacheEntry(newEntry, path, NULL, length);
+#else
+      //Parse the template
+      error = ssiLoadCacheEntry(newEntry, path, (const char_t *) data, length);
+#endif
+
+      //Check status code
+      if(!error)
+      {
+         *entry = newEntry;
+      }
+   }
+
+   //Valid cache entry?
+   if(*entry != NULL)
+   {
+      //The entry cannot be evicted while the template is being executed
+      (*entry)->refCount++;
+      //Save current time
+      (*entry)->timestamp = osGetSystemTime();
+
+      //Successful processing
+      error = NO_ERROR;
+   }
+   else if(!error)
+   {
+      //The SSI template cache runs out of space
+      error = ERROR_OUT_OF_RESOURCES;
+   }
+   else
+   {
+      //The template cannot be cached
+   }
+
+   //Release exclusive access to the SSI template cache
+   osReleaseMutex(&context->ssiCacheMutex);
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Release a precompiled SSI template
+ * @param[in] context Pointer to the HTTP server context
+ * @param[in] entry Pointer to the SSI template cache entry
+ **/
+
+void ssiReleaseCacheEntry(HttpServerContext *context, HttpSsiCacheEntry *entry)
+{
+   //Acquire exclusive access to the SSI template cache
+   osAcquireMutex(&context->ssiCacheMutex);
+
+   //Decrement reference count
+   if(entry->refCount > 0)
+   {
+      entry->refCount--;
+   }
+
+   //Release exclusive access to the SSI template cache
+   osReleaseMutex(&context->ssiCacheMutex);
+}
+
+
+/**
+ * @brief Load and parse an SSI template
+ * @param[in] entry Pointer to the SSI template cache entry
+ * @param[in] path Full pathname of the template
+ * @param[in] data Contents of the template (resource manager only)
+ * @param[in] length Length of the template
+ * @return Error code
+ **/
+
+error_t ssiLoadCacheEntry(HttpSsiCacheEntry *entry, const char_t *path,
+   const char_t *data, size_t length)
+{
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   error_t error;
+   size_t n;
+   size_t pos;
+   FsFile *file;
+
+   //Open the file for reading
+   file = fsOpenFile(path, FS_FILE_MODE_READ);
+   //Failed to open the file?
+   if(file == NULL)
+      return ERROR_NOT_FOUND;
+
+   //Allocate a memory buffer to hold the contents of the file
+   entry->buffer = osAllocMem(length + 1);
+
+   //Successful memory allocation?
+   if(entry->buffer != NULL)
+   {
+      //Initialize status code
+      error = NO_ERROR;
+
+      //Read the whole file
+      for(pos = 0; pos < length && !error; pos += n)
+      {
+         error = fsReadFile(file, entry->buffer + pos, length - pos, &n);
+      }
+   }
+   else
+   {
+      //Failed to allocate memory
+      error = ERROR_OUT_OF_MEMORY;
+   }
+
+   //Close the file
+   fsCloseFile(file);
+
+   //Any error to report?
+   if(error)
+   {
+      ssiFreeCacheEntry(entry);
+      return error;
+   }
+
+   //Point to the contents of the template
+   entry->data = entry->buffer;
+#else
+   //Resources are stored in memory and can be referenced directly
+   entry->data = data;
+#endif
+
+   //Save the length of the template
+   entry->length = length;
+
+   //Determine the number of nodes
+   entry->numNodes = ssiParseTemplate(entry->data, length, NULL);
+
+   //Any node?
+   if(entry->numNodes > 0)
+   {
+      //Allocate the node list
+      entry->nodes = osAllocMem(entry->numNodes * sizeof(HttpSsiNode));
+
+      //Failed to allocate memory?
+      if(entry->nodes == NULL)
+      {
+         ssiFreeCacheEntry(entry);
+         return ERROR_OUT_OF_MEMORY;
+      }
+
+      //Split the template into literal spans and SSI directives
+      ssiParseTemplate(entry->data, length, entry->nodes);
+   }
+
+   //Save the pathname of the template
+   osStrcpy(entry->path, path);
+   //The entry is not used yet
+   entry->refCount = 0;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Release the resources associated with a cache entry
+ * @param[in] entry Pointer to the SSI template cache entry
+ **/
+
+void ssiFreeCacheEntry(HttpSsiCacheEntry *entry)
+{
+#if (HTTP_SERVER_FS_SUPPORT == ENABLED)
+   //Release the copy of the file contents
+   if(entry->buffer != NULL)
+   {
+      osFreeMem(entry->buffer);
+      entry->buffer = NULL;
+   }
+#endif
+
+   //Release the node list
+   if(entry->nodes != NULL)
+   {
+      osFreeMem(entry->nodes);
+      entry->nodes = NULL;
+   }
+
+   //Mark the entry as free
+   entry->path[0] = '\0';
+   entry->data = NULL;
+   entry->length = 0;
+   entry->numNodes = 0;
+}
+
+
+/**
+ * @brief Split an SSI template into literal spans and SSI directives
+ * @param[in] data Contents of the template
+ * @param[in] length Length of the template
+ * @param[out] nodes Resulting node list (may be NULL)
+ * @return Number of nodes
+ **/
+
+uint_t ssiParseTemplate(const char_t *data, size_t length, HttpSsiNode *nodes)
+{
+   error_t error;
+   uint_t i;
+   uint_t j;
+   uint_t n;
+   size_t pos;
+
+   //Number of nodes
+   n = 0;
+
+   //Parse the specified template
+   for(pos = 0; pos < length; )
+   {
+      //Search for any SSI tags
+      error = ssiSearchTag(data + pos, length - pos, "<!--#", 5, &i);
+
+      //Opening identifier found?
+      if(!error)
+      {
+         //Search for the comment terminator
+         error = ssiSearchTag(data + pos + i + 5, length - pos - i - 5,
+            "-->", 3, &j);
+      }
+
+      //Check whether a valid SSI tag has been found?
+      if(!error)
+      {
+         //Any text preceding the tag?
+         if(i > 0)
+         {
+            //Add a literal span
+            if(nodes != NULL)
+            {
+               nodes[n].offset = pos;
+               nodes[n].length = i;
+               nodes[n].directive = FALSE;
+            }
+
+            //Increment node count
+            n++;
+         }
+
+         //Add an SSI directive
+         if(nodes != NULL)
+         {
+            nodes[n].offset = pos + i + 5;
+            nodes[n].length = j;
+            nodes[n].directive = TRUE;
+         }
+
+         //Increment node count
+         n++;
+
+         //Advance data pointer over the SSI tag
+         pos += i + 5 + j + 3;
+      }
+      else
+      {
+         //The rest of the template is literal text
+         if(nodes != NULL)
+         {
+            nodes[n].offset = pos;
+            nodes[n].length = length - pos;
+            nodes[n].directive = FALSE;
+         }
+
+         //Increment node count
+         n++;
+
+         //We are done
+         pos = length;
+      }
+   }
+
+   //Return the number of nodes
+   return n;
+}
+
+#endif
+
+
 /**
  * @brief Search a string for a given tag
  * @param[in] s String to search
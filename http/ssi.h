@@ -51,6 +51,20 @@ error_t ssiProcessIncludeCommand(HttpConnection *connection,
 error_t ssiProcessEchoCommand(HttpConnection *connection, const char_t *tag, size_t length);
 error_t ssiProcessExecCommand(HttpConnection *connection, const char_t *tag, size_t length);
 
+error_t ssiExecuteCachedScript(HttpConnection *connection,
+   const HttpSsiCacheEntry *entry, const char_t *uri, uint_t level);
+
+error_t ssiGetCacheEntry(HttpServerContext *context, const char_t *path,
+   HttpSsiCacheEntry **entry);
+
+void ssiReleaseCacheEntry(HttpServerContext *context, HttpSsiCacheEntry *entry);
+
+error_t ssiLoadCacheEntry(HttpSsiCacheEntry *entry, const char_t *path,
+   const char_t *data, size_t length);
+
+void ssiFreeCacheEntry(HttpSsiCacheEntry *entry);
+uint_t ssiParseTemplate(const char_t *data, size_t length, HttpSsiNode *nodes);
+
 error_t ssiSearchTag(const char_t *s, size_t sLen, const char_t *tag, size_t tagLen, uint_t *pos);
 
 //C++ guard
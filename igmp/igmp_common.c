@@ -47,7 +47,11 @@
    IGMP_ROUTER_SUPPORT == ENABLED || IGMP_SNOOPING_SUPPORT == ENABLED))
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t igmpTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t igmpTickCounter;
+#endif
 
 
 /**
@@ -176,7 +176,12 @@ typedef __start_packed struct
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t igmpTickCounters[NET_MAX_INSTANCES];
+#define igmpTickCounter (igmpTickCounters[netContext.instance])
+#else
 extern systime_t igmpTickCounter;
+#endif
 
 //IGMP related functions
 error_t igmpInit(NetInterface *interface);
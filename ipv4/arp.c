@@ -48,7 +48,11 @@
 #if (IPV4_SUPPORT == ENABLED && ETH_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t arpTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t arpTickCounter;
+#endif
 
 
 /**
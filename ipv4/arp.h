@@ -195,7 +195,12 @@ typedef struct
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t arpTickCounters[NET_MAX_INSTANCES];
+#define arpTickCounter (arpTickCounters[netContext.instance])
+#else
 extern systime_t arpTickCounter;
+#endif
 
 //ARP related functions
 error_t arpInit(NetInterface *interface);
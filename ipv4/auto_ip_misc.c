@@ -44,7 +44,11 @@
 #if (IPV4_SUPPORT == ENABLED && AUTO_IP_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t autoIpTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t autoIpTickCounter;
+#endif
 
 
 /**
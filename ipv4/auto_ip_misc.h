@@ -41,7 +41,12 @@ extern "C" {
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t autoIpTickCounters[NET_MAX_INSTANCES];
+#define autoIpTickCounter (autoIpTickCounters[netContext.instance])
+#else
 extern systime_t autoIpTickCounter;
+#endif
 
 //Auto-IP related functions
 void autoIpTick(AutoIpContext *context);
@@ -55,6 +55,7 @@
 #include "igmp/igmp_host.h"
 #include "dhcp/dhcp_client_misc.h"
 #include "mdns/mdns_responder.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/ip_mib_module.h"
 #include "debug.h"
@@ -102,6 +103,7 @@ error_t ipv4Init(NetInterface *interface)
 #if (IPV4_FRAG_SUPPORT == ENABLED)
    //Initialize the reassembly queue
    osMemset(context->fragQueue, 0, sizeof(context->fragQueue));
+   osMemset(context->fragHashTable, 0, sizeof(context->fragHashTable));
 #endif
 
    //Successful initialization
@@ -586,6 +588,9 @@ void ipv4ProcessPacket(NetInterface *interface, Ipv4Header *packet,
    IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsInOctets, length);
    IP_MIB_INC_COUNTER64(ipv4IfStatsTable[interface->index].ipIfStatsHCInOctets, length);
 
+   //Update statistics
+   NET_STATS_RX(NET_STATS_LAYER_IPV4, length);
+
    //Start of exception handling block
    do
    {
@@ -720,6 +725,14 @@ void ipv4ProcessPacket(NetInterface *interface, Ipv4Header *packet,
          break;
       }
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+      //The header checksum may already have been verified by the NIC
+      if((ancillary->checksumFlags & NET_CHECKSUM_IPV4) != 0)
+      {
+         //Skip software verification
+      }
+      else
+#endif
       //The host must verify the IP header checksum on every received datagram
       //and silently discard every datagram that has a bad checksum (refer to
       //RFC 1122, section 3.2.1.2)
@@ -742,6 +755,11 @@ void ipv4ProcessPacket(NetInterface *interface, Ipv4Header *packet,
       //A fragmented packet was received?
       if((ntohs(packet->fragmentOffset) & (IPV4_FLAG_MF | IPV4_OFFSET_MASK)) != 0)
       {
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+         //The NIC cannot verify the upper-layer checksum of a fragment
+         ancillary->checksumFlags &= ~(NET_CHECKSUM_TCP | NET_CHECKSUM_UDP);
+#endif
+
 #if (IPV4_FRAG_SUPPORT == ENABLED)
          //Reassemble the original datagram
          ipv4ReassembleDatagram(interface, packet, length, ancillary);
@@ -958,6 +976,9 @@ error_t ipv4SendDatagram(NetInterface *interface, Ipv4PseudoHeader *pseudoHeader
    //Retrieve the length of payload
    length = netBufferGetLength(buffer) - offset;
 
+   //Update statistics
+   NET_STATS_TX(NET_STATS_LAYER_IPV4, length);
+
    //Identification field is primarily used to identify fragments of an
    //original IP datagram
    id = interface->ipv4Context.identification++;
@@ -974,6 +995,12 @@ error_t ipv4SendDatagram(NetInterface *interface, Ipv4PseudoHeader *pseudoHeader
    //must fragment the data
    else
    {
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+      //The NIC cannot compute the upper-layer checksum of a fragmented
+      //datagram
+      ipCompleteUpperLayerChecksum(buffer, offset, ancillary);
+#endif
+
 #if (IPV4_FRAG_SUPPORT == ENABLED)
       //Fragment IP datagram into smaller packets
       error = ipv4FragmentDatagram(interface, pseudoHeader, id, buffer, offset,
@@ -1012,6 +1039,9 @@ error_t ipv4SendPacket(NetInterface *interface, Ipv4PseudoHeader *pseudoHeader,
 #if (ETH_SUPPORT == ENABLED)
    NetInterface *physicalInterface;
 #endif
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   uint8_t txChecksumOffload;
+#endif
 
    //Check whether an IP Router Alert option should be added
    if(ancillary->routerAlert)
@@ -1068,9 +1098,31 @@ error_t ipv4SendPacket(NetInterface *interface, Ipv4PseudoHeader *pseudoHeader,
    packet->typeOfService = (ancillary->dscp << 2) & 0xFC;
 #endif
 
-   //Calculate IP header checksum
-   packet->headerChecksum = ipCalcChecksumEx(buffer, offset,
-      packet->headerLength * 4);
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //Retrieve the checksums the underlying NIC is able to compute
+   txChecksumOffload = ipv4GetTxChecksumOffload(interface,
+      pseudoHeader->destAddr);
+
+   //Complete the upper-layer checksum in software if necessary
+   if((ancillary->checksumFlags & ~txChecksumOffload) != 0)
+   {
+      ipCompleteUpperLayerChecksum(buffer, offset + packet->headerLength * 4,
+         ancillary);
+   }
+
+   //Check whether the NIC can compute the IP header checksum
+   if((txChecksumOffload & NET_CHECKSUM_IPV4) != 0)
+   {
+      //The header checksum field is filled in by the NIC
+      ancillary->checksumFlags |= NET_CHECKSUM_IPV4;
+   }
+   else
+#endif
+   {
+      //Calculate IP header checksum
+      packet->headerChecksum = ipCalcChecksumEx(buffer, offset,
+         packet->headerLength * 4);
+   }
 
    //Ensure the source address is valid
    error = ipv4CheckSourceAddr(interface, pseudoHeader->srcAddr);
@@ -1181,6 +1233,7 @@ error_t ipv4SendPacket(NetInterface *interface, Ipv4PseudoHeader *pseudoHeader,
                //to transmit them to their destination
                MIB2_IP_INC_COUNTER32(ipOutNoRoutes, 1);
                IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsOutNoRoutes, 1);
+               NET_STATS_TX_DROP(NET_STATS_LAYER_IPV4, ERROR_NO_ROUTE);
             }
          }
 
@@ -346,6 +346,7 @@ typedef struct
    Ipv4FilterEntry multicastFilter[IPV4_MULTICAST_FILTER_SIZE]; ///<Multicast filter table
 #if (IPV4_FRAG_SUPPORT == ENABLED)
    Ipv4FragDesc fragQueue[IPV4_MAX_FRAG_DATAGRAMS];             ///<IPv4 fragment reassembly queue
+   Ipv4FragDesc *fragHashTable[IPV4_FRAG_HASH_TABLE_SIZE];      ///<Hash table used to locate datagrams being reassembled
 #endif
 } Ipv4Context;
 
@@ -54,7 +54,11 @@
 #if (IPV4_SUPPORT == ENABLED && IPV4_FRAG_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t ipv4FragTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t ipv4FragTickCounter;
+#endif
 
 
 /**
@@ -174,6 +178,11 @@ error_t ipv4FragmentDatagram(NetInterface *interface,
 
 /**
  * @brief IPv4 datagram reassembly algorithm
+ *
+ * The data of each fragment is stored in its own memory chunk. The chunks
+ * are kept sorted by offset, so that the reassembled datagram is obtained
+ * by chaining them without any further copy
+ *
  * @param[in] interface Underlying network interface
  * @param[in] packet Pointer to the IPv4 fragmented packet
  * @param[in] length Packet length including header and payload
@@ -185,12 +194,12 @@ void ipv4ReassembleDatagram(NetInterface *interface, const Ipv4Header *packet,
    size_t length, NetRxAncillary *ancillary)
 {
    error_t error;
+   size_t n;
+   size_t quota;
    uint16_t offset;
    uint16_t dataFirst;
    uint16_t dataLast;
    Ipv4FragDesc *frag;
-   Ipv4HoleDesc *hole;
-   Ipv4HoleDesc *prevHole;
 
    //Number of IP fragments received which needed to be reassembled
    MIB2_IP_INC_COUNTER32(ipReasmReqds, 1);
@@ -234,212 +243,142 @@ void ipv4ReassembleDatagram(NetInterface *interface, const Ipv4Header *packet,
       return;
    }
 
-   //The very first fragment requires special handling
-   if(!(offset & IPV4_OFFSET_MASK))
+   //Start of exception handling block
+   do
    {
-      //Calculate the length of the IP header including options
-      frag->headerLength = packet->headerLength * 4;
+      //The very first fragment requires special handling
+      if(!(offset & IPV4_OFFSET_MASK))
+      {
+         //Check whether the data of the first fragment is still missing
+         if(frag->buffer.chunk[0].length == frag->headerLength)
+         {
+            //Calculate the length of the IP header including options
+            frag->headerLength = packet->headerLength * 4;
+
+            //Make sure the IP header entirely fits in the first chunk
+            if(frag->headerLength > frag->buffer.chunk[0].size)
+            {
+               //Report an error
+               error = ERROR_INVALID_LENGTH;
+               break;
+            }
+
+            //Always take the IP header from the first fragment
+            osMemcpy(frag->buffer.chunk[0].address, packet, frag->headerLength);
+            //Fix the length of the first chunk
+            frag->buffer.chunk[0].length = (uint16_t) frag->headerLength;
+
+            //The data of the first fragment immediately follows the IP header
+            n = MIN(length, frag->buffer.chunk[0].size - frag->headerLength);
+
+            //Do not overlap the data that has already been received
+            if(frag->buffer.chunkCount > 1)
+            {
+               n = MIN(n, frag->chunkOffset[1]);
+            }
+
+            //Copy the data to the first chunk
+            osMemcpy((uint8_t *) frag->buffer.chunk[0].address +
+               frag->headerLength, IPV4_DATA(packet), n);
+
+            //Adjust the length of the first chunk
+            frag->buffer.chunk[0].length += (uint16_t) n;
+            frag->rcvdDataLen += n;
+         }
+      }
 
       //Enforce the size of the reconstructed datagram
-      if((frag->headerLength + frag->dataLen) > IPV4_MAX_FRAG_DATAGRAM_SIZE)
+      if((frag->headerLength + (offset & IPV4_OFFSET_MASK) * 8 + length) >
+         IPV4_MAX_FRAG_DATAGRAM_SIZE)
       {
-         //Number of failures detected by the IP reassembly algorithm
-         MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
+         //Report an error
+         error = ERROR_INVALID_LENGTH;
+         break;
       }
 
-      //Make sure the IP header entirely fits in the first chunk
-      if(frag->headerLength > frag->buffer.chunk[0].size)
+      //The fragment must not extend beyond the end of the datagram
+      if(frag->lastFragRcvd && dataLast > frag->dataLen)
       {
-         //Number of failures detected by the IP reassembly algorithm
-         MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
+         //Report an error
+         error = ERROR_INCONSISTENT_VALUE;
+         break;
       }
 
-      //Fix the length of the first chunk
-      frag->buffer.chunk[0].length = (uint16_t) frag->headerLength;
-      //Always take the IP header from the first fragment
-      netBufferWrite((NetBuffer *) &frag->buffer, 0, packet, frag->headerLength);
-   }
-
-   //It may be necessary to increase the size of the buffer...
-   if(dataLast > frag->dataLen)
-   {
-      //Enforce the size of the reconstructed datagram
-      if((frag->headerLength + dataLast) > IPV4_MAX_FRAG_DATAGRAM_SIZE)
+      //No data can follow the last fragment
+      if(!(offset & IPV4_FLAG_MF) && dataLast < frag->dataLen)
       {
-         //Number of failures detected by the IP reassembly algorithm
-         MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
+         //Report an error
+         error = ERROR_INCONSISTENT_VALUE;
+         break;
       }
 
-      //Adjust the size of the reconstructed datagram
-      error = netBufferSetLength((NetBuffer *) &frag->buffer,
-         frag->headerLength + dataLast + sizeof(Ipv4HoleDesc));
+      //Retrieve the amount of reassembly memory the source host can still use
+      n = ipv4FragGetSourceUsage(interface, packet);
+      quota = (n < IPV4_FRAG_MAX_SOURCE_SIZE) ? IPV4_FRAG_MAX_SOURCE_SIZE - n : 0;
 
+      //Store the data that is not already present in the reassembly buffer
+      error = ipv4FragInsertData(frag, dataFirst, dataLast, IPV4_DATA(packet),
+         quota);
       //Any error to report?
       if(error)
-      {
-         //Number of failures detected by the IP reassembly algorithm
-         MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
-      }
+         break;
 
       //Actual length of the payload
-      frag->dataLen = dataLast;
-   }
-
-   //Select the first hole descriptor from the list
-   hole = ipv4FindHole(frag, frag->firstHole);
-   //Keep track of the previous hole in the list
-   prevHole = NULL;
-
-   //Iterate through the hole descriptors
-   while(hole != NULL)
-   {
-      //Save lower and upper boundaries for later use
-      uint16_t holeFirst = hole->first;
-      uint16_t holeLast = hole->last;
+      frag->dataLen = MAX(frag->dataLen, dataLast);
 
-      //Check whether the newly arrived fragment interacts with this hole in
-      //some way
-      if(dataFirst < holeLast && dataLast > holeFirst)
+      //Check whether the last fragment has been received
+      if(!(offset & IPV4_FLAG_MF))
       {
-         //The current descriptor is no longer valid. We will destroy it, and
-         //in the next two steps, we will determine whether or not it is
-         //necessary to create any new hole descriptors
-         if(prevHole != NULL)
-            prevHole->next = hole->next;
-         else
-            frag->firstHole = hole->next;
-
-         //Is there still a hole at the beginning of the segment?
-         if(dataFirst > holeFirst)
-         {
-            //Create a new entry that describes this hole
-            hole = ipv4FindHole(frag, holeFirst);
-            hole->first = holeFirst;
-            hole->last = dataFirst;
-
-            //Insert the newly created entry into the hole descriptor list
-            if(prevHole != NULL)
-            {
-               hole->next = prevHole->next;
-               prevHole->next = hole->first;
-            }
-            else
-            {
-               hole->next = frag->firstHole;
-               frag->firstHole = hole->first;
-            }
-
-            //Always keep track of the previous hole
-            prevHole = hole;
-         }
-
-         //Is there still a hole at the end of the segment?
-         if(dataLast < holeLast && (offset & IPV4_FLAG_MF))
-         {
-            //Create a new entry that describes this hole
-            hole = ipv4FindHole(frag, dataLast);
-            hole->first = dataLast;
-            hole->last = holeLast;
+         frag->lastFragRcvd = TRUE;
+      }
 
-            //Insert the newly created entry into the hole descriptor list
-            if(prevHole != NULL)
-            {
-               hole->next = prevHole->next;
-               prevHole->next = hole->first;
-            }
-            else
-            {
-               hole->next = frag->firstHole;
-               frag->firstHole = hole->first;
-            }
+      //End of exception handling block
+   } while(0);
 
-            //Always keep track of the previous hole
-            prevHole = hole;
-         }
-      }
-      else
-      {
-         //The newly arrived fragment does not interact with the current hole
-         prevHole = hole;
-      }
+   //Any error to report?
+   if(error)
+   {
+      //Number of failures detected by the IP reassembly algorithm
+      MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
+      IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
+      IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
 
-      //Select the next hole descriptor from the list
-      hole = ipv4FindHole(frag, prevHole ? prevHole->next : frag->firstHole);
+      //Drop the reconstructed datagram
+      ipv4DeleteFragDesc(interface, frag);
+      //Exit immediately
+      return;
    }
 
-   //Copy data from the fragment to the reassembly buffer
-   netBufferWrite((NetBuffer *) &frag->buffer,
-      frag->headerLength + dataFirst, IPV4_DATA(packet), length);
+   //Dump the list of fragments
+   ipv4DumpFragList(frag);
 
-   //Dump hole descriptor list
-   ipv4DumpHoleList(frag);
-
-   //If the hole descriptor list is empty, the reassembly process is now
-   //complete
-   if(!ipv4FindHole(frag, frag->firstHole))
+   //The reassembly process is complete when the last fragment has been
+   //received and no data is missing
+   if(frag->lastFragRcvd && frag->rcvdDataLen == frag->dataLen)
    {
-      //Discard the extra hole descriptor that follows the reconstructed
-      //datagram
-      error = netBufferSetLength((NetBuffer *) &frag->buffer,
-         frag->headerLength + frag->dataLen);
+      Ipv4Header *datagram;
 
-      //Check status code
-      if(error)
-      {
-         //Number of failures detected by the IP reassembly algorithm
-         MIB2_IP_INC_COUNTER32(ipReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-      }
-      else
-      {
-         //Point to the IP header
-         Ipv4Header *datagram = netBufferAt((NetBuffer *) &frag->buffer, 0);
+      //Make the beginning of the datagram contiguous in memory
+      ipv4FragPullUp(frag);
 
-         //Fix IP header
-         datagram->totalLength = htons(frag->headerLength + frag->dataLen);
-         datagram->fragmentOffset = 0;
-         datagram->headerChecksum = 0;
+      //Point to the IP header
+      datagram = frag->buffer.chunk[0].address;
 
-         //Number of IP datagrams successfully reassembled
-         MIB2_IP_INC_COUNTER32(ipReasmOKs, 1);
-         IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmOKs, 1);
-         IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmOKs, 1);
+      //Fix IP header
+      datagram->totalLength = htons(frag->headerLength + frag->dataLen);
+      datagram->fragmentOffset = 0;
+      datagram->headerChecksum = 0;
 
-         //Pass the original IPv4 datagram to the higher protocol layer
-         ipv4ProcessDatagram(interface, (NetBuffer *) &frag->buffer, ancillary);
-      }
+      //Number of IP datagrams successfully reassembled
+      MIB2_IP_INC_COUNTER32(ipReasmOKs, 1);
+      IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmOKs, 1);
+      IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmOKs, 1);
+
+      //Pass the original IPv4 datagram to the higher protocol layer
+      ipv4ProcessDatagram(interface, (NetBuffer *) &frag->buffer, ancillary);
 
       //Release previously allocated memory
-      netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+      ipv4DeleteFragDesc(interface, frag);
    }
 }
 
@@ -458,7 +397,6 @@ void ipv4FragTick(NetInterface *interface)
    error_t error;
    uint_t i;
    systime_t time;
-   Ipv4HoleDesc *hole;
 
    //Get current time
    time = osGetSystemTime();
@@ -486,16 +424,13 @@ void ipv4FragTick(NetInterface *interface)
             IP_MIB_INC_COUNTER32(ipv4SystemStats.ipSystemStatsReasmFails, 1);
             IP_MIB_INC_COUNTER32(ipv4IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
 
-            //Point to the first hole descriptor
-            hole = ipv4FindHole(frag, frag->firstHole);
-
             //Make sure the fragment zero has been received before sending an
             //ICMP message
-            if(hole != NULL && hole->first > 0)
+            if(frag->buffer.chunk[0].length > frag->headerLength)
             {
-               //Fix the size of the reconstructed datagram
+               //Only keep the IP header and the data of the first fragment
                error = netBufferSetLength((NetBuffer *) &frag->buffer,
-                  frag->headerLength + hole->first);
+                  frag->buffer.chunk[0].length);
 
                //Check status code
                if(!error)
@@ -507,7 +442,7 @@ void ipv4FragTick(NetInterface *interface)
             }
 
             //Drop the partially reconstructed datagram
-            netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+            ipv4DeleteFragDesc(interface, frag);
          }
       }
    }
@@ -526,44 +461,48 @@ Ipv4FragDesc *ipv4SearchFragQueue(NetInterface *interface,
 {
    error_t error;
    uint_t i;
+   uint_t j;
    Ipv4Header *datagram;
    Ipv4FragDesc *frag;
-   Ipv4HoleDesc *hole;
+
+   //Select the relevant hash bucket
+   i = ipv4FragCalcHash(packet);
 
    //Search for a matching IP datagram being reassembled
-   for(i = 0; i < IPV4_MAX_FRAG_DATAGRAMS; i++)
+   for(frag = interface->ipv4Context.fragHashTable[i]; frag != NULL;
+      frag = frag->next)
    {
-      //Point to the current entry in the reassembly queue
-      frag = &interface->ipv4Context.fragQueue[i];
+      //Point to the corresponding datagram
+      datagram = frag->buffer.chunk[0].address;
+
+      //Check source and destination addresses
+      if(datagram->srcAddr != packet->srcAddr)
+         continue;
+      if(datagram->destAddr != packet->destAddr)
+         continue;
+      //Compare identification and protocol fields
+      if(datagram->identification != packet->identification)
+         continue;
+      if(datagram->protocol != packet->protocol)
+         continue;
+
+      //A matching entry has been found in the reassembly queue
+      return frag;
+   }
 
-      //Check whether the current entry is used?
-      if(frag->buffer.chunkCount > 0)
-      {
-         //Point to the corresponding datagram
-         datagram = netBufferAt((NetBuffer *) &frag->buffer, 0);
-
-         //Check source and destination addresses
-         if(datagram->srcAddr != packet->srcAddr)
-            continue;
-         if(datagram->destAddr != packet->destAddr)
-            continue;
-         //Compare identification and protocol fields
-         if(datagram->identification != packet->identification)
-            continue;
-         if(datagram->protocol != packet->protocol)
-            continue;
-
-         //A matching entry has been found in the reassembly queue
-         return frag;
-      }
+   //Make sure the source host has not exhausted its memory quota
+   if((ipv4FragGetSourceUsage(interface, packet) +
+      NET_MEM_POOL_BUFFER_SIZE) > IPV4_FRAG_MAX_SOURCE_SIZE)
+   {
+      return NULL;
    }
 
    //If the current packet does not match an existing entry in the reassembly
    //queue, then create a new entry
-   for(i = 0; i < IPV4_MAX_FRAG_DATAGRAMS; i++)
+   for(j = 0; j < IPV4_MAX_FRAG_DATAGRAMS; j++)
    {
       //Point to the current entry in the reassembly queue
-      frag = &interface->ipv4Context.fragQueue[i];
+      frag = &interface->ipv4Context.fragQueue[j];
 
       //The current entry is free?
       if(!frag->buffer.chunkCount)
@@ -571,10 +510,10 @@ Ipv4FragDesc *ipv4SearchFragQueue(NetInterface *interface,
          //Number of chunks that comprise the reassembly buffer
          frag->buffer.maxChunkCount = arraysize(frag->buffer.chunk);
 
-         //Allocate sufficient memory to hold the IPv4 header and
-         //the first hole descriptor
+         //Allocate sufficient memory to hold the IPv4 header and the data
+         //of the first fragment
          error = netBufferSetLength((NetBuffer *) &frag->buffer,
-            NET_MEM_POOL_BUFFER_SIZE + sizeof(Ipv4HoleDesc));
+            NET_MEM_POOL_BUFFER_SIZE);
 
          //Failed to allocate memory?
          if(error)
@@ -588,26 +527,23 @@ Ipv4FragDesc *ipv4SearchFragQueue(NetInterface *interface,
          //Initial length of the reconstructed datagram
          frag->headerLength = packet->headerLength * 4;
          frag->dataLen = 0;
+         frag->rcvdDataLen = 0;
+         frag->lastFragRcvd = FALSE;
+
+         //Amount of memory held by the datagram
+         frag->memSize = frag->buffer.chunk[0].size;
 
          //Fix the length of the first chunk
          frag->buffer.chunk[0].length = (uint16_t) frag->headerLength;
          //Copy IPv4 header from the incoming fragment
-         netBufferWrite((NetBuffer *) &frag->buffer, 0, packet, frag->headerLength);
+         osMemcpy(frag->buffer.chunk[0].address, packet, frag->headerLength);
 
          //Save current time
          frag->timestamp = osGetSystemTime();
-         //Create a new entry in the hole descriptor list
-         frag->firstHole = 0;
-
-         //Point to first hole descriptor
-         hole = ipv4FindHole(frag, frag->firstHole);
-         //The entry describes the datagram as being completely missing
-         hole->first = 0;
-         hole->last = IPV4_INFINITY;
-         hole->next = IPV4_INFINITY;
 
-         //Dump hole descriptor list
-         ipv4DumpHoleList(frag);
+         //Insert the newly created entry in the hash bucket
+         frag->next = interface->ipv4Context.fragHashTable[i];
+         interface->ipv4Context.fragHashTable[i] = frag;
 
          //Return the matching fragment descriptor
          return frag;
@@ -632,49 +568,410 @@ void ipv4FlushFragQueue(NetInterface *interface)
    for(i = 0; i < IPV4_MAX_FRAG_DATAGRAMS; i++)
    {
       //Drop any partially reconstructed datagram
-      netBufferSetLength((NetBuffer *) &interface->ipv4Context.fragQueue[i].buffer, 0);
+      ipv4DeleteFragDesc(interface, &interface->ipv4Context.fragQueue[i]);
    }
 }
 
 
 /**
- * @brief Retrieve hole descriptor
+ * @brief Remove an entry from the reassembly queue
+ * @param[in] interface Underlying network interface
  * @param[in] frag IPv4 fragment descriptor
- * @param[in] offset Offset of the hole
- * @return A pointer to the hole descriptor is returned if the specified
- *   offset is valid. Otherwise NULL is returned
  **/
 
-Ipv4HoleDesc *ipv4FindHole(Ipv4FragDesc *frag, uint16_t offset)
+void ipv4DeleteFragDesc(NetInterface *interface, Ipv4FragDesc *frag)
 {
-   //Return a pointer to the hole descriptor
-   return netBufferAt((NetBuffer *) &frag->buffer, frag->headerLength + offset);
+   Ipv4FragDesc **p;
+
+   //Make sure the entry is currently in use
+   if(frag->buffer.chunkCount > 0)
+   {
+      //Point to the hash bucket the entry belongs to
+      p = &interface->ipv4Context.fragHashTable[ipv4FragCalcHash(
+         frag->buffer.chunk[0].address)];
+
+      //Remove the entry from the hash bucket
+      while(*p != NULL)
+      {
+         //Matching entry?
+         if(*p == frag)
+         {
+            *p = frag->next;
+            break;
+         }
+
+         //Jump to the next entry
+         p = &(*p)->next;
+      }
+   }
+
+   //Release previously allocated memory
+   netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+   //The entry is now free
+   frag->next = NULL;
 }
 
 
 /**
- * @brief Dump hole descriptor list
+ * @brief Calculate the hash of a fragmented datagram
+ * @param[in] packet IPv4 header of the datagram
+ * @return Index of the hash bucket
+ **/
+
+uint_t ipv4FragCalcHash(const Ipv4Header *packet)
+{
+   uint32_t h;
+
+   //Fragments of the same datagram share the same source and destination
+   //addresses, identification and protocol fields
+   h = packet->srcAddr ^ packet->destAddr;
+   h ^= ((uint32_t) packet->identification << 8) ^ packet->protocol;
+
+   //Fold the resulting value
+   h ^= h >> 16;
+   h ^= h >> 8;
+
+   //Return the index of the hash bucket
+   return h % IPV4_FRAG_HASH_TABLE_SIZE;
+}
+
+
+/**
+ * @brief Get the amount of reassembly memory held by a given source host
+ * @param[in] interface Underlying network interface
+ * @param[in] packet Incoming IPv4 packet
+ * @return Amount of memory, in bytes
+ **/
+
+size_t ipv4FragGetSourceUsage(NetInterface *interface,
+   const Ipv4Header *packet)
+{
+   uint_t i;
+   size_t n;
+   Ipv4Header *datagram;
+   Ipv4FragDesc *frag;
+
+   //Total amount of memory
+   n = 0;
+
+   //Loop through the reassembly queue
+   for(i = 0; i < IPV4_MAX_FRAG_DATAGRAMS; i++)
+   {
+      //Point to the current entry in the reassembly queue
+      frag = &interface->ipv4Context.fragQueue[i];
+
+      //Make sure the entry is currently in use
+      if(frag->buffer.chunkCount > 0)
+      {
+         //Point to the corresponding datagram
+         datagram = frag->buffer.chunk[0].address;
+
+         //Matching source address?
+         if(datagram->srcAddr == packet->srcAddr)
+         {
+            n += frag->memSize;
+         }
+      }
+   }
+
+   //Return the amount of memory held by the source host
+   return n;
+}
+
+
+/**
+ * @brief Search for the first data chunk that ends after a given offset
+ * @param[in] frag IPv4 fragment descriptor
+ * @param[in] offset Offset within the payload
+ * @return Index of the chunk. The number of chunks is returned if no chunk
+ *   ends after the specified offset
+ **/
+
+uint_t ipv4FragFindChunk(Ipv4FragDesc *frag, uint16_t offset)
+{
+   uint_t left;
+   uint_t right;
+   uint_t mid;
+
+   //Data chunks are sorted by offset and never overlap (the first chunk
+   //holds the IPv4 header)
+   left = 1;
+   right = frag->buffer.chunkCount;
+
+   //Binary search
+   while(left < right)
+   {
+      //Select the chunk in the middle of the interval
+      mid = (left + right) / 2;
+
+      //Compare the end of the chunk with the specified offset
+      if((frag->chunkOffset[mid] + frag->buffer.chunk[mid].length) > offset)
+      {
+         right = mid;
+      }
+      else
+      {
+         left = mid + 1;
+      }
+   }
+
+   //Return the index of the chunk
+   return left;
+}
+
+
+/**
+ * @brief Store the data of a fragment in the reassembly buffer
+ *
+ * Only the data that is not already present in the reassembly buffer is
+ * stored. The gaps covered by the fragment are filled by appending data to
+ * the preceding chunk when it has room left, or by inserting new chunks
+ *
+ * @param[in] frag IPv4 fragment descriptor
+ * @param[in] first Index of the first byte of the fragment
+ * @param[in] last Index immediately following the last byte of the fragment
+ * @param[in] data Pointer to the data of the fragment
+ * @param[in] quota Amount of memory the source host can still use
+ * @return Error code
+ **/
+
+error_t ipv4FragInsertData(Ipv4FragDesc *frag, uint16_t first, uint16_t last,
+   const uint8_t *data, size_t quota)
+{
+   uint_t i;
+   size_t n;
+   size_t size;
+   uint16_t pos;
+   uint16_t end;
+   void *p;
+   ChunkDesc *chunk;
+   Ipv4ReassemblyBuffer *buffer;
+
+   //Point to the reassembly buffer
+   buffer = &frag->buffer;
+
+   //Skip the data that is already held by the first chunk
+   pos = MAX(first, buffer->chunk[0].length - frag->headerLength);
+
+   //Fill the gaps covered by the fragment
+   while(pos < last)
+   {
+      //Search for the first chunk that ends after the current position
+      i = ipv4FragFindChunk(frag, pos);
+
+      //The data at the current position has already been received?
+      if(i < buffer->chunkCount && frag->chunkOffset[i] <= pos)
+      {
+         //Skip the overlapping data
+         pos = frag->chunkOffset[i] + buffer->chunk[i].length;
+      }
+      else
+      {
+         //Determine the end of the gap
+         if(i < buffer->chunkCount)
+         {
+            end = MIN(last, frag->chunkOffset[i]);
+         }
+         else
+         {
+            end = last;
+         }
+
+         //Fill the gap with as many chunks as necessary
+         while(pos < end)
+         {
+            //Point to the chunk that precedes the gap
+            chunk = &buffer->chunk[i - 1];
+
+            //Retrieve the index immediately following the last byte of
+            //the preceding chunk
+            if(i == 1)
+            {
+               n = chunk->length - frag->headerLength;
+            }
+            else
+            {
+               n = frag->chunkOffset[i - 1] + chunk->length;
+            }
+
+            //Check whether the data can be appended to the preceding chunk
+            if(n == pos && chunk->length < chunk->size)
+            {
+               //Number of bytes to append
+               n = MIN(end - pos, chunk->size - chunk->length);
+
+               //Copy the data from the fragment
+               osMemcpy((uint8_t *) chunk->address + chunk->length,
+                  data + pos - first, n);
+
+               //Adjust the length of the preceding chunk
+               chunk->length += (uint16_t) n;
+               frag->rcvdDataLen += n;
+
+               //Prepare to fill the rest of the gap
+               pos += (uint16_t) n;
+               continue;
+            }
+
+            //Make sure a chunk descriptor is available
+            if(buffer->chunkCount >= buffer->maxChunkCount)
+               return ERROR_OUT_OF_RESOURCES;
+
+            //Number of bytes to store in the current chunk
+            n = MIN(end - pos, NET_MEM_POOL_BUFFER_SIZE);
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+            //Fixed-size blocks are allocated from the memory pool
+            size = NET_MEM_POOL_BUFFER_SIZE;
+#else
+            //Allocate exactly the amount of memory that is needed
+            size = n;
+#endif
+            //Enforce the memory quota of the source host
+            if(size > quota)
+               return ERROR_OUT_OF_MEMORY;
+
+            //Allocate a memory block to hold the data
+            p = memPoolAlloc(size);
+            //Failed to allocate memory?
+            if(p == NULL)
+               return ERROR_OUT_OF_MEMORY;
+
+            //Copy the data from the fragment
+            osMemcpy(p, data + pos - first, n);
+
+            //Make room for the new chunk
+            osMemmove(&buffer->chunk[i + 1], &buffer->chunk[i],
+               (buffer->chunkCount - i) * sizeof(ChunkDesc));
+            osMemmove(&frag->chunkOffset[i + 1], &frag->chunkOffset[i],
+               (buffer->chunkCount - i) * sizeof(uint16_t));
+
+            //Insert the new chunk
+            buffer->chunk[i].address = p;
+            buffer->chunk[i].length = (uint16_t) n;
+            buffer->chunk[i].size = (uint16_t) size;
+            frag->chunkOffset[i] = pos;
+            buffer->chunkCount++;
+
+            //Update the accounting of the datagram
+            frag->rcvdDataLen += n;
+            frag->memSize += size;
+            quota -= size;
+
+            //Prepare to fill the next chunk
+            pos += (uint16_t) n;
+            i++;
+         }
+      }
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Move the beginning of the payload to the first chunk
+ *
+ * Upper layers may parse a whole message through a single pointer, so the
+ * first chunk is filled with as much contiguous data as it can hold. In
+ * the common case, the gap-filling logic has already done so and no copy
+ * is needed
+ *
  * @param[in] frag IPv4 fragment descriptor
  **/
 
-void ipv4DumpHoleList(Ipv4FragDesc *frag)
+void ipv4FragPullUp(Ipv4FragDesc *frag)
+{
+   size_t n;
+   size_t length;
+   ChunkDesc *chunk;
+   Ipv4ReassemblyBuffer *buffer;
+
+   //Point to the reassembly buffer
+   buffer = &frag->buffer;
+
+   //The first chunk must hold as much data as possible
+   length = frag->headerLength + MIN(frag->dataLen,
+      buffer->chunk[0].size - frag->headerLength);
+
+   //Move data to the first chunk until the requirement is met
+   while(buffer->chunk[0].length < length && buffer->chunkCount > 1)
+   {
+      //Point to the chunk that follows the first chunk
+      chunk = &buffer->chunk[1];
+
+      //Number of bytes that can be appended to the first chunk
+      n = MIN(chunk->length, buffer->chunk[0].size - buffer->chunk[0].length);
+
+      //The first chunk is full?
+      if(n == 0)
+         break;
+
+      //Append the data to the first chunk
+      osMemcpy((uint8_t *) buffer->chunk[0].address + buffer->chunk[0].length,
+         chunk->address, n);
+
+      //Adjust the length of the first chunk
+      buffer->chunk[0].length += (uint16_t) n;
+
+      //The whole chunk has been consumed?
+      if(n == chunk->length)
+      {
+         //Release the corresponding memory block
+         memPoolFree(chunk->address);
+
+         //Remove the chunk from the list
+         osMemmove(&buffer->chunk[1], &buffer->chunk[2],
+            (buffer->chunkCount - 2) * sizeof(ChunkDesc));
+         osMemmove(&frag->chunkOffset[1], &frag->chunkOffset[2],
+            (buffer->chunkCount - 2) * sizeof(uint16_t));
+
+         //Update the number of chunks
+         buffer->chunkCount--;
+      }
+      else
+      {
+         //Keep the remaining data at the beginning of the memory block
+         osMemmove(chunk->address, (uint8_t *) chunk->address + n,
+            chunk->length - n);
+
+         //Adjust the length and the offset of the chunk
+         chunk->length -= (uint16_t) n;
+         frag->chunkOffset[1] += (uint16_t) n;
+      }
+   }
+}
+
+
+/**
+ * @brief Dump the list of fragments
+ * @param[in] frag IPv4 fragment descriptor
+ **/
+
+void ipv4DumpFragList(Ipv4FragDesc *frag)
 {
 //Check debugging level
 #if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
-   Ipv4HoleDesc *hole;
+   uint_t i;
 
    //Debug message
-   TRACE_DEBUG("Hole descriptor list:\r\n");
-   //Select the first hole descriptor from the list
-   hole = ipv4FindHole(frag, frag->firstHole);
+   TRACE_DEBUG("Fragment list:\r\n");
+
+   //The data of the first fragment follows the IPv4 header
+   if(frag->buffer.chunk[0].length > frag->headerLength)
+   {
+      //Display the data held by the first chunk
+      TRACE_DEBUG("  0 - %" PRIuSIZE "\r\n",
+         frag->buffer.chunk[0].length - frag->headerLength);
+   }
 
-   //Loop through the hole descriptor list
-   while(hole != NULL)
+   //Loop through the data chunks
+   for(i = 1; i < frag->buffer.chunkCount; i++)
    {
-      //Display current hole
-      TRACE_DEBUG("  %" PRIu16 " - %" PRIu16 "\r\n", hole->first, hole->last);
-      //Select the next hole descriptor from the list
-      hole = ipv4FindHole(frag, hole->next);
+      //Display current chunk
+      TRACE_DEBUG("  %" PRIu16 " - %" PRIu16 "\r\n", frag->chunkOffset[i],
+         (uint16_t) (frag->chunkOffset[i] + frag->buffer.chunk[i].length));
    }
 #endif
 }
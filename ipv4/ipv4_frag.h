@@ -71,36 +71,30 @@
    #error IPV4_FRAG_TIME_TO_LIVE parameter is not valid
 #endif
 
-//Infinity is implemented by a very large integer
-#define IPV4_INFINITY 0xFFFF
-
-//C++ guard
-#ifdef __cplusplus
-extern "C" {
+//Maximum number of memory chunks held by a datagram being reassembled
+#ifndef IPV4_MAX_FRAG_CHUNKS
+   #define IPV4_MAX_FRAG_CHUNKS 16
+#elif (IPV4_MAX_FRAG_CHUNKS < 2)
+   #error IPV4_MAX_FRAG_CHUNKS parameter is not valid
 #endif
 
-
-//CodeWarrior or Win32 compiler?
-#if defined(__CWCC__) || defined(_WIN32)
-   #pragma pack(push, 1)
+//Size of the hash table used to locate datagrams being reassembled
+#ifndef IPV4_FRAG_HASH_TABLE_SIZE
+   #define IPV4_FRAG_HASH_TABLE_SIZE 8
+#elif (IPV4_FRAG_HASH_TABLE_SIZE < 1)
+   #error IPV4_FRAG_HASH_TABLE_SIZE parameter is not valid
 #endif
 
+//Maximum amount of reassembly memory a single source host can hold
+#ifndef IPV4_FRAG_MAX_SOURCE_SIZE
+   #define IPV4_FRAG_MAX_SOURCE_SIZE 32768
+#elif (IPV4_FRAG_MAX_SOURCE_SIZE < IPV4_MAX_FRAG_DATAGRAM_SIZE)
+   #error IPV4_FRAG_MAX_SOURCE_SIZE parameter is not valid
+#endif
 
-/**
- * @brief Hole descriptor
- **/
-
-typedef __start_packed struct
-{
-   uint16_t first;
-   uint16_t last;
-   uint16_t next;
-} __end_packed Ipv4HoleDesc;
-
-
-//CodeWarrior or Win32 compiler?
-#if defined(__CWCC__) || defined(_WIN32)
-   #pragma pack(pop)
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
 #endif
 
 
@@ -112,26 +106,40 @@ typedef struct
 {
    uint_t chunkCount;
    uint_t maxChunkCount;
-   ChunkDesc chunk[N(IPV4_MAX_FRAG_DATAGRAM_SIZE) + 1];
+   ChunkDesc chunk[IPV4_MAX_FRAG_CHUNKS];
 } Ipv4ReassemblyBuffer;
 
 
 /**
  * @brief Fragmented packet descriptor
+ *
+ * The first chunk of the reassembly buffer holds the IPv4 header followed
+ * by the data of the first fragment. The remaining chunks hold the data
+ * of the other fragments and are kept sorted by offset, so that the buffer
+ * can be passed as is to the upper layer once the datagram is complete
  **/
 
-typedef struct
+typedef struct _Ipv4FragDesc
 {
-   systime_t timestamp;         ///<Time at which the first fragment was received
-   size_t headerLength;         ///<Length of the header
-   size_t dataLen;              ///<Length of the payload
-   uint16_t firstHole;          ///<Index of the first hole
-   Ipv4ReassemblyBuffer buffer; ///<Buffer containing the reassembled datagram
+   struct _Ipv4FragDesc *next;                 ///<Next entry in the same hash bucket
+   systime_t timestamp;                        ///<Time at which the first fragment was received
+   size_t headerLength;                        ///<Length of the header
+   size_t dataLen;                             ///<Length of the payload
+   size_t rcvdDataLen;                         ///<Number of payload bytes received so far
+   size_t memSize;                             ///<Amount of memory held by the datagram
+   bool_t lastFragRcvd;                        ///<The last fragment has been received
+   uint16_t chunkOffset[IPV4_MAX_FRAG_CHUNKS]; ///<Offset of each data chunk within the payload
+   Ipv4ReassemblyBuffer buffer;                ///<Buffer containing the reassembled datagram
 } Ipv4FragDesc;
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t ipv4FragTickCounters[NET_MAX_INSTANCES];
+#define ipv4FragTickCounter (ipv4FragTickCounters[netContext.instance])
+#else
 extern systime_t ipv4FragTickCounter;
+#endif
 
 //IPv4 datagram fragmentation and reassembly
 error_t ipv4FragmentDatagram(NetInterface *interface,
@@ -147,9 +155,19 @@ Ipv4FragDesc *ipv4SearchFragQueue(NetInterface *interface,
    const Ipv4Header *packet);
 
 void ipv4FlushFragQueue(NetInterface *interface);
+void ipv4DeleteFragDesc(NetInterface *interface, Ipv4FragDesc *frag);
+
+uint_t ipv4FragCalcHash(const Ipv4Header *packet);
+size_t ipv4FragGetSourceUsage(NetInterface *interface,
+   const Ipv4Header *packet);
+
+uint_t ipv4FragFindChunk(Ipv4FragDesc *frag, uint16_t offset);
+
+error_t ipv4FragInsertData(Ipv4FragDesc *frag, uint16_t first, uint16_t last,
+   const uint8_t *data, size_t quota);
 
-Ipv4HoleDesc *ipv4FindHole(Ipv4FragDesc *frag, uint16_t offset);
-void ipv4DumpHoleList(Ipv4FragDesc *frag);
+void ipv4FragPullUp(Ipv4FragDesc *frag);
+void ipv4DumpFragList(Ipv4FragDesc *frag);
 
 //C++ guard
 #ifdef __cplusplus
@@ -37,6 +37,7 @@
 #include "core/net.h"
 #include "ipv4/ipv4.h"
 #include "ipv4/ipv4_misc.h"
+#include "core/net_stats.h"
 #include "mibs/mib2_module.h"
 #include "mibs/ip_mib_module.h"
 #include "debug.h"
@@ -773,6 +774,42 @@ bool_t ipv4TrapIgmpPacket(Ipv4Header *header)
 }
 
 
+/**
+ * @brief Get the checksums the NIC can compute on outgoing IPv4 packets
+ * @param[in] interface Underlying network interface
+ * @param[in] destAddr Destination IPv4 address
+ * @return Checksum offload capabilities (see #NetChecksumFlags)
+ **/
+
+uint8_t ipv4GetTxChecksumOffload(NetInterface *interface, Ipv4Addr destAddr)
+{
+   uint8_t flags;
+   NetInterface *physicalInterface;
+
+   //Point to the physical interface
+   physicalInterface = nicGetPhysicalInterface(interface);
+
+   //Packets sent to the loopback address never reach the NIC
+   if(ipv4IsLocalHostAddr(destAddr))
+   {
+      flags = NET_CHECKSUM_NONE;
+   }
+   else if(physicalInterface->nicDriver != NULL)
+   {
+      //Retrieve the capabilities advertised by the NIC driver
+      flags = physicalInterface->nicDriver->txChecksumOffload;
+   }
+   else
+   {
+      //No NIC driver is attached to the interface
+      flags = NET_CHECKSUM_NONE;
+   }
+
+   //Return checksum offload capabilities
+   return flags;
+}
+
+
 /**
  * @brief Update IPv4 input statistics
  * @param[in] interface Underlying network interface
@@ -867,6 +904,9 @@ void ipv4UpdateOutStats(NetInterface *interface, Ipv4Addr destIpAddr,
 
 void ipv4UpdateErrorStats(NetInterface *interface, error_t error)
 {
+   //Update stack-wide statistics
+   NET_STATS_RX_DROP(NET_STATS_LAYER_IPV4, error);
+
    //Check error code
    switch(error)
    {
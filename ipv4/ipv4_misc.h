@@ -66,6 +66,8 @@ error_t ipv4MapMulticastAddrToMac(Ipv4Addr ipAddr, MacAddr *macAddr);
 
 bool_t ipv4TrapIgmpPacket(Ipv4Header *header);
 
+uint8_t ipv4GetTxChecksumOffload(NetInterface *interface, Ipv4Addr destAddr);
+
 void ipv4UpdateInStats(NetInterface *interface, Ipv4Addr destIpAddr,
    size_t length);
 
@@ -57,6 +57,7 @@
 #include "ipv6/ndp_router_adv_misc.h"
 #include "ipv6/slaac_misc.h"
 #include "dhcpv6/dhcpv6_client_misc.h"
+#include "core/net_stats.h"
 #include "mibs/ip_mib_module.h"
 #include "debug.h"
 
@@ -132,6 +133,7 @@ error_t ipv6Init(NetInterface *interface)
    context->identification = 0;
    //Initialize the reassembly queue
    osMemset(context->fragQueue, 0, sizeof(context->fragQueue));
+   osMemset(context->fragHashTable, 0, sizeof(context->fragHashTable));
 #endif
 
    //Successful initialization
@@ -963,6 +965,9 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
    IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInOctets, length);
    IP_MIB_INC_COUNTER64(ipv6IfStatsTable[interface->index].ipIfStatsHCInOctets, length);
 
+   //Update statistics
+   NET_STATS_RX(NET_STATS_LAYER_IPV6, length);
+
    //Ensure the packet length is greater than 40 bytes
    if(length < sizeof(Ipv6Header))
    {
@@ -970,6 +975,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
       //didn't carry enough data
       IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInTruncatedPkts, 1);
       IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInTruncatedPkts, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_LENGTH);
 
       //Discard the received packet
       return;
@@ -992,6 +998,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
       //Number of input datagrams discarded due to errors in their IP headers
       IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInHdrErrors, 1);
       IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInHdrErrors, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_HEADER);
 
       //Discard the received packet
       return;
@@ -1004,6 +1011,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
       //didn't carry enough data
       IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInTruncatedPkts, 1);
       IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInTruncatedPkts, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_LENGTH);
 
       //Discard the received packet
       return;
@@ -1015,6 +1023,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
       //Number of input datagrams discarded due to errors in their IP headers
       IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInHdrErrors, 1);
       IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInHdrErrors, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_HEADER);
 
       //Discard the received packet
       return;
@@ -1034,6 +1043,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
       //was not a valid address
       IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInAddrErrors, 1);
       IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInAddrErrors, 1);
+      NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_ADDRESS);
 #endif
       //We are done
       return;
@@ -1168,6 +1178,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
             //was not a valid address
             IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInAddrErrors, 1);
             IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInAddrErrors, 1);
+            NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_ADDRESS);
          }
 
          //Exit immediately
@@ -1200,6 +1211,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
             //was not a valid address
             IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInAddrErrors, 1);
             IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInAddrErrors, 1);
+            NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_ADDRESS);
          }
 
          //Exit immediately
@@ -1233,6 +1245,7 @@ void ipv6ProcessPacket(NetInterface *interface, NetBuffer *ipPacket,
             //was not a valid address
             IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsInAddrErrors, 1);
             IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsInAddrErrors, 1);
+            NET_STATS_RX_DROP(NET_STATS_LAYER_IPV6, ERROR_INVALID_ADDRESS);
          }
 
          //Discard incoming packet
@@ -1651,6 +1664,14 @@ error_t ipv6SendDatagram(NetInterface *interface, Ipv6PseudoHeader *pseudoHeader
    //Retrieve the length of payload
    length = netBufferGetLength(buffer) - offset;
 
+   //Update statistics
+   NET_STATS_TX(NET_STATS_LAYER_IPV6, length);
+
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //Upper-layer checksums are not offloaded over IPv6
+   ipCompleteUpperLayerChecksum(buffer, offset, ancillary);
+#endif
+
 #if (IPV6_PMTU_SUPPORT == ENABLED)
    //Retrieve the PMTU for the specified destination address
    pathMtu = ipv6GetPathMtu(interface, &pseudoHeader->destAddr);
@@ -1887,6 +1908,7 @@ error_t ipv6SendPacket(NetInterface *interface, Ipv6PseudoHeader *pseudoHeader,
                //Number of IP datagrams discarded because no route could be found
                //to transmit them to their destination
                IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsOutNoRoutes, 1);
+               NET_STATS_TX_DROP(NET_STATS_LAYER_IPV6, ERROR_NO_ROUTE);
             }
          }
 
@@ -470,6 +470,7 @@ typedef struct
 #if (IPV6_FRAG_SUPPORT == ENABLED)
    uint32_t identification;                                     ///<IPv6 fragment identification field
    Ipv6FragDesc fragQueue[IPV6_MAX_FRAG_DATAGRAMS];             ///<IPv6 fragment reassembly queue
+   Ipv6FragDesc *fragHashTable[IPV6_FRAG_HASH_TABLE_SIZE];      ///<Hash table used to locate datagrams being reassembled
 #endif
 } Ipv6Context;
 
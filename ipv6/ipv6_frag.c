@@ -44,7 +44,11 @@
 #if (IPV6_SUPPORT == ENABLED && IPV6_FRAG_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t ipv6FragTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t ipv6FragTickCounter;
+#endif
 
 
 /**
@@ -167,6 +171,11 @@ error_t ipv6FragmentDatagram(NetInterface *interface,
 
 /**
  * @brief Parse Fragment header and reassemble original datagram
+ *
+ * The data of each fragment is stored in its own memory chunk. The chunks
+ * are kept sorted by offset, so that the reassembled datagram is obtained
+ * by chaining them without any further copy
+ *
  * @param[in] interface Underlying network interface
  * @param[in] ipPacket Multi-part buffer containing the incoming IPv6 packet
  * @param[in] ipPacketOffset Offset to the first byte of the IPv6 packet
@@ -182,13 +191,12 @@ void ipv6ParseFragmentHeader(NetInterface *interface, const NetBuffer *ipPacket,
 {
    error_t error;
    size_t n;
+   size_t quota;
    size_t length;
    uint16_t offset;
    uint16_t dataFirst;
    uint16_t dataLast;
    Ipv6FragDesc *frag;
-   Ipv6HoleDesc *hole;
-   Ipv6HoleDesc *prevHole;
    Ipv6Header *ipHeader;
    Ipv6FragmentHeader *fragHeader;
 
@@ -196,6 +204,11 @@ void ipv6ParseFragmentHeader(NetInterface *interface, const NetBuffer *ipPacket,
    IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmReqds, 1);
    IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmReqds, 1);
 
+#if (NET_CHECKSUM_OFFLOAD_SUPPORT == ENABLED)
+   //The NIC cannot verify the upper-layer checksum of a fragment
+   ancillary->checksumFlags &= ~(NET_CHECKSUM_TCP | NET_CHECKSUM_UDP);
+#endif
+
    //Remaining bytes to process in the payload
    length = netBufferGetLength(ipPacket) - fragHeaderOffset;
 
@@ -266,80 +279,87 @@ void ipv6ParseFragmentHeader(NetInterface *interface, const NetBuffer *ipPacket,
       return;
    }
 
-   //The very first fragment requires special handling
-   if(!(offset & IPV6_OFFSET_MASK))
+   //Start of exception handling block
+   do
    {
-      uint8_t *p;
-
-      //Calculate the length of the unfragmentable part
-      frag->unfragPartLength = fragHeaderOffset - ipPacketOffset;
+#if (IPV6_OVERLAPPING_FRAG_SUPPORT == DISABLED)
+      //Retrieve the number of bytes of the fragment that have already been
+      //received
+      n = ipv6FragCalcCoverage(frag, dataFirst, dataLast);
+
+      //When reassembling an IPv6 datagram, if one or more its constituent
+      //fragments is determined to be an overlapping fragment, the entire
+      //datagram must be silently discarded (refer to RFC 5722, section 4)
+      if(n > 0 && n < length)
+      {
+         //Report an error
+         error = ERROR_INVALID_PACKET;
+         break;
+      }
+#endif
 
-      //The size of the reconstructed datagram exceeds the maximum value?
-      if((frag->unfragPartLength + frag->fragPartLength) > IPV6_MAX_FRAG_DATAGRAM_SIZE)
+      //The very first fragment requires special handling
+      if(!(offset & IPV6_OFFSET_MASK))
       {
-         //Number of failures detected by the IP reassembly algorithm
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
+         //Check whether the data of the first fragment is still missing
+         if(frag->buffer.chunk[0].length == frag->unfragPartLength)
+         {
+            uint8_t *p;
 
-         //Retrieve the offset of the Fragment header within the packet
-         n = fragHeaderOffset - ipPacketOffset;
-         //Compute the exact offset of the Fragment Offset field
-         n += (uint8_t *) &fragHeader->fragmentOffset - (uint8_t *) fragHeader;
+            //Calculate the length of the unfragmentable part
+            frag->unfragPartLength = fragHeaderOffset - ipPacketOffset;
 
-         //The fragment must be discarded and an ICMP Parameter Problem
-         //message should be sent to the source of the fragment, pointing
-         //to the Fragment Offset field of the fragment packet
-         icmpv6SendErrorMessage(interface, ICMPV6_TYPE_PARAM_PROBLEM,
-            ICMPV6_CODE_INVALID_HEADER_FIELD, n, ipPacket, ipPacketOffset);
+            //Make sure the unfragmentable part entirely fits in the first chunk
+            if(frag->unfragPartLength > frag->buffer.chunk[0].size)
+            {
+               //Report an error
+               error = ERROR_INVALID_LENGTH;
+               break;
+            }
 
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
-      }
+            //The unfragmentable part of the reassembled packet consists
+            //of all headers up to, but not including, the Fragment header
+            //of the first fragment packet
+            netBufferRead(frag->buffer.chunk[0].address, ipPacket,
+               ipPacketOffset, frag->unfragPartLength);
 
-      //Make sure the unfragmentable part entirely fits in the first chunk
-      if(frag->unfragPartLength > frag->buffer.chunk[0].size)
-      {
-         //Number of failures detected by the IP reassembly algorithm
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
-      }
+            //Fix the length of the first chunk
+            frag->buffer.chunk[0].length = (uint16_t) frag->unfragPartLength;
 
-      //Fix the length of the first chunk
-      frag->buffer.chunk[0].length = (uint16_t) frag->unfragPartLength;
+            //Point to the Next Header field of the last header
+            p = (uint8_t *) frag->buffer.chunk[0].address +
+               nextHeaderOffset - ipPacketOffset;
 
-      //The unfragmentable part of the reassembled packet consists
-      //of all headers up to, but not including, the Fragment header
-      //of the first fragment packet
-      netBufferCopy((NetBuffer *) &frag->buffer, 0, ipPacket,
-         ipPacketOffset, frag->unfragPartLength);
+            //The Next Header field of the last header of the unfragmentable
+            //part is obtained from the Next Header field of the first
+            //fragment's Fragment header
+            *p = fragHeader->nextHeader;
 
-      //Point to the Next Header field of the last header
-      p = netBufferAt((NetBuffer *) &frag->buffer,
-         nextHeaderOffset - ipPacketOffset);
+            //The data of the first fragment immediately follows the
+            //unfragmentable part
+            n = MIN(length, frag->buffer.chunk[0].size - frag->unfragPartLength);
 
-      //The Next Header field of the last header of the unfragmentable
-      //part is obtained from the Next Header field of the first
-      //fragment's Fragment header
-      *p = fragHeader->nextHeader;
-   }
+            //Do not overlap the data that has already been received
+            if(frag->buffer.chunkCount > 1)
+            {
+               n = MIN(n, frag->chunkOffset[1]);
+            }
+
+            //Copy the data to the first chunk
+            netBufferRead((uint8_t *) frag->buffer.chunk[0].address +
+               frag->unfragPartLength, ipPacket,
+               fragHeaderOffset + sizeof(Ipv6FragmentHeader), n);
+
+            //Adjust the length of the first chunk
+            frag->buffer.chunk[0].length += (uint16_t) n;
+            frag->rcvdDataLen += n;
+         }
+      }
 
-   //It may be necessary to increase the size of the buffer...
-   if(dataLast > frag->fragPartLength)
-   {
       //The size of the reconstructed datagram exceeds the maximum value?
-      if((frag->unfragPartLength + dataLast) > IPV6_MAX_FRAG_DATAGRAM_SIZE)
+      if((frag->unfragPartLength + (offset & IPV6_OFFSET_MASK) + length) >
+         IPV6_MAX_FRAG_DATAGRAM_SIZE)
       {
-         //Number of failures detected by the IP reassembly algorithm
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
          //Retrieve the offset of the Fragment header within the packet
          n = fragHeaderOffset - ipPacketOffset;
          //Compute the exact offset of the Fragment Offset field
@@ -351,171 +371,91 @@ void ipv6ParseFragmentHeader(NetInterface *interface, const NetBuffer *ipPacket,
          icmpv6SendErrorMessage(interface, ICMPV6_TYPE_PARAM_PROBLEM,
             ICMPV6_CODE_INVALID_HEADER_FIELD, n, ipPacket, ipPacketOffset);
 
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
+         //Report an error
+         error = ERROR_INVALID_LENGTH;
+         break;
       }
 
-      //Adjust the size of the reconstructed datagram
-      error = netBufferSetLength((NetBuffer *) &frag->buffer,
-         frag->unfragPartLength + dataLast + sizeof(Ipv6HoleDesc));
-
-      //Any error to report?
-      if(error)
+      //The fragment must not extend beyond the end of the datagram
+      if(frag->lastFragRcvd && dataLast > frag->fragPartLength)
       {
-         //Number of failures detected by the IP reassembly algorithm
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-         //Drop the reconstructed datagram
-         netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-         //Exit immediately
-         return;
+         //Report an error
+         error = ERROR_INCONSISTENT_VALUE;
+         break;
       }
 
-      //Actual length of the fragmentable part
-      frag->fragPartLength = dataLast;
-   }
-
-   //Select the first hole descriptor from the list
-   hole = ipv6FindHole(frag, frag->firstHole);
-   //Keep track of the previous hole in the list
-   prevHole = NULL;
-
-   //Iterate through the hole descriptors
-   while(hole != NULL)
-   {
-      //Save lower and upper boundaries for later use
-      uint16_t holeFirst = hole->first;
-      uint16_t holeLast = hole->last;
-
-      //Check whether the newly arrived fragment interacts with this hole
-      //in some way
-      if(dataFirst < holeLast && dataLast > holeFirst)
+      //No data can follow the last fragment
+      if(!(offset & IPV6_FLAG_M) && dataLast < frag->fragPartLength)
       {
-#if (IPV6_OVERLAPPING_FRAG_SUPPORT == DISABLED)
-         //When reassembling an IPv6 datagram, if one or more its constituent
-         //fragments is determined to be an overlapping fragment, the entire
-         //datagram must be silently discarded (refer to RFC 5722, section 4)
-         if(dataFirst < holeFirst || dataLast > holeLast)
-         {
-            //Number of failures detected by the IP reassembly algorithm
-            IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-            IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-
-            //Drop the reconstructed datagram
-            netBufferSetLength((NetBuffer *) &frag->buffer, 0);
-            //Exit immediately
-            return;
-         }
-#endif
-         //The current descriptor is no longer valid. We will destroy it,
-         //and in the next two steps, we will determine whether or not it
-         //is necessary to create any new hole descriptors
-         if(prevHole != NULL)
-            prevHole->next = hole->next;
-         else
-            frag->firstHole = hole->next;
-
-         //Is there still a hole at the beginning of the segment?
-         if(dataFirst > holeFirst)
-         {
-            //Create a new entry that describes this hole
-            hole = ipv6FindHole(frag, holeFirst);
-            hole->first = holeFirst;
-            hole->last = dataFirst;
-
-            //Insert the newly created entry into the hole descriptor list
-            if(prevHole != NULL)
-            {
-               hole->next = prevHole->next;
-               prevHole->next = hole->first;
-            }
-            else
-            {
-               hole->next = frag->firstHole;
-               frag->firstHole = hole->first;
-            }
+         //Report an error
+         error = ERROR_INCONSISTENT_VALUE;
+         break;
+      }
 
-            //Always keep track of the previous hole
-            prevHole = hole;
-         }
+      //Retrieve the amount of reassembly memory the source host can still use
+      n = ipv6FragGetSourceUsage(interface, ipHeader);
+      quota = (n < IPV6_FRAG_MAX_SOURCE_SIZE) ? IPV6_FRAG_MAX_SOURCE_SIZE - n : 0;
 
-         //Is there still a hole at the end of the segment?
-         if(dataLast < holeLast && (offset & IPV6_FLAG_M))
-         {
-            //Create a new entry that describes this hole
-            hole = ipv6FindHole(frag, dataLast);
-            hole->first = dataLast;
-            hole->last = holeLast;
+      //Store the data that is not already present in the reassembly buffer
+      error = ipv6FragInsertData(frag, dataFirst, dataLast, ipPacket,
+         fragHeaderOffset + sizeof(Ipv6FragmentHeader), quota);
+      //Any error to report?
+      if(error)
+         break;
 
-            //Insert the newly created entry into the hole descriptor list
-            if(prevHole != NULL)
-            {
-               hole->next = prevHole->next;
-               prevHole->next = hole->first;
-            }
-            else
-            {
-               hole->next = frag->firstHole;
-               frag->firstHole = hole->first;
-            }
+      //Actual length of the fragmentable part
+      frag->fragPartLength = MAX(frag->fragPartLength, dataLast);
 
-            //Always keep track of the previous hole
-            prevHole = hole;
-         }
-      }
-      else
+      //Check whether the last fragment has been received
+      if(!(offset & IPV6_FLAG_M))
       {
-         //The newly arrived fragment does not interact with the current hole
-         prevHole = hole;
+         frag->lastFragRcvd = TRUE;
       }
 
-      //Select the next hole descriptor from the list
-      hole = ipv6FindHole(frag, prevHole ? prevHole->next : frag->firstHole);
-   }
+      //End of exception handling block
+   } while(0);
 
-   //Copy data from the fragment to the reassembly buffer
-   netBufferCopy((NetBuffer *) &frag->buffer, frag->unfragPartLength + dataFirst,
-      ipPacket, fragHeaderOffset + sizeof(Ipv6FragmentHeader), length);
+   //Any error to report?
+   if(error)
+   {
+      //Number of failures detected by the IP reassembly algorithm
+      IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
+      IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
 
-   //Dump hole descriptor list
-   ipv6DumpHoleList(frag);
+      //Drop the reconstructed datagram
+      ipv6DeleteFragDesc(interface, frag);
+      //Exit immediately
+      return;
+   }
 
-   //If the hole descriptor list is empty, the reassembly process is now complete
-   if(!ipv6FindHole(frag, frag->firstHole))
+   //Dump the list of fragments
+   ipv6DumpFragList(frag);
+
+   //The reassembly process is complete when the last fragment has been
+   //received and no data is missing
+   if(frag->lastFragRcvd && frag->rcvdDataLen == frag->fragPartLength)
    {
-      //Discard the extra hole descriptor that follows the reconstructed datagram
-      error = netBufferSetLength((NetBuffer *) &frag->buffer,
-         frag->unfragPartLength + frag->fragPartLength);
+      Ipv6Header *datagram;
 
-      //Check status code
-      if(error)
-      {
-         //Number of failures detected by the IP reassembly algorithm
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
-      }
-      else
-      {
-         //Point to the IPv6 header
-         Ipv6Header *datagram = netBufferAt((NetBuffer *) &frag->buffer, 0);
+      //Make the beginning of the datagram contiguous in memory
+      ipv6FragPullUp(frag);
 
-         //Fix the Payload Length field
-         datagram->payloadLen = htons(frag->unfragPartLength +
-            frag->fragPartLength - sizeof(Ipv6Header));
+      //Point to the IPv6 header
+      datagram = frag->buffer.chunk[0].address;
 
-         //Number of IP datagrams successfully reassembled
-         IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmOKs, 1);
-         IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmOKs, 1);
+      //Fix the Payload Length field
+      datagram->payloadLen = htons(frag->unfragPartLength +
+         frag->fragPartLength - sizeof(Ipv6Header));
 
-         //Pass the original IPv6 datagram to the higher protocol layer
-         ipv6ProcessPacket(interface, (NetBuffer *) &frag->buffer, 0, ancillary);
-      }
+      //Number of IP datagrams successfully reassembled
+      IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmOKs, 1);
+      IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmOKs, 1);
+
+      //Pass the original IPv6 datagram to the higher protocol layer
+      ipv6ProcessPacket(interface, (NetBuffer *) &frag->buffer, 0, ancillary);
 
       //Release previously allocated memory
-      netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+      ipv6DeleteFragDesc(interface, frag);
    }
 }
 
@@ -534,7 +474,6 @@ void ipv6FragTick(NetInterface *interface)
    error_t error;
    uint_t i;
    systime_t time;
-   Ipv6HoleDesc *hole;
 
    //Get current time
    time = osGetSystemTime();
@@ -561,16 +500,14 @@ void ipv6FragTick(NetInterface *interface)
             IP_MIB_INC_COUNTER32(ipv6SystemStats.ipSystemStatsReasmFails, 1);
             IP_MIB_INC_COUNTER32(ipv6IfStatsTable[interface->index].ipIfStatsReasmFails, 1);
 
-            //Point to the first hole descriptor
-            hole = ipv6FindHole(frag, frag->firstHole);
-
             //Make sure the fragment zero has been received
             //before sending an ICMPv6 message
-            if(hole != NULL && hole->first > 0)
+            if(frag->buffer.chunk[0].length > frag->unfragPartLength)
             {
-               //Fix the size of the reconstructed datagram
+               //Only keep the unfragmentable part and the data of the
+               //first fragment
                error = netBufferSetLength((NetBuffer *) &frag->buffer,
-                  frag->unfragPartLength + hole->first);
+                  frag->buffer.chunk[0].length);
 
                //Check status code
                if(!error)
@@ -582,7 +519,7 @@ void ipv6FragTick(NetInterface *interface)
             }
 
             //Drop the partially reconstructed datagram
-            netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+            ipv6DeleteFragDesc(interface, frag);
          }
       }
    }
@@ -602,42 +539,46 @@ Ipv6FragDesc *ipv6SearchFragQueue(NetInterface *interface,
 {
    error_t error;
    uint_t i;
+   uint_t j;
    Ipv6Header *datagram;
    Ipv6FragDesc *frag;
-   Ipv6HoleDesc *hole;
+
+   //Select the relevant hash bucket
+   i = ipv6FragCalcHash(packet, header->identification);
 
    //Search for a matching IP datagram being reassembled
-   for(i = 0; i < IPV6_MAX_FRAG_DATAGRAMS; i++)
+   for(frag = interface->ipv6Context.fragHashTable[i]; frag != NULL;
+      frag = frag->next)
    {
-      //Point to the current entry in the reassembly queue
-      frag = &interface->ipv6Context.fragQueue[i];
+      //Point to the corresponding datagram
+      datagram = frag->buffer.chunk[0].address;
+
+      //Check source and destination addresses
+      if(!ipv6CompAddr(&datagram->srcAddr, &packet->srcAddr))
+         continue;
+      if(!ipv6CompAddr(&datagram->destAddr, &packet->destAddr))
+         continue;
+      //Compare fragment identification fields
+      if(frag->identification != header->identification)
+         continue;
+
+      //A matching entry has been found in the reassembly queue
+      return frag;
+   }
 
-      //Check whether the current entry is used?
-      if(frag->buffer.chunkCount > 0)
-      {
-         //Point to the corresponding datagram
-         datagram = netBufferAt((NetBuffer *) &frag->buffer, 0);
-
-         //Check source and destination addresses
-         if(!ipv6CompAddr(&datagram->srcAddr, &packet->srcAddr))
-            continue;
-         if(!ipv6CompAddr(&datagram->destAddr, &packet->destAddr))
-            continue;
-         //Compare fragment identification fields
-         if(frag->identification != header->identification)
-            continue;
-
-         //A matching entry has been found in the reassembly queue
-         return frag;
-      }
+   //Make sure the source host has not exhausted its memory quota
+   if((ipv6FragGetSourceUsage(interface, packet) +
+      NET_MEM_POOL_BUFFER_SIZE) > IPV6_FRAG_MAX_SOURCE_SIZE)
+   {
+      return NULL;
    }
 
    //If the current packet does not match an existing entry
    //in the reassembly queue, then create a new entry
-   for(i = 0; i < IPV6_MAX_FRAG_DATAGRAMS; i++)
+   for(j = 0; j < IPV6_MAX_FRAG_DATAGRAMS; j++)
    {
       //Point to the current entry in the reassembly queue
-      frag = &interface->ipv6Context.fragQueue[i];
+      frag = &interface->ipv6Context.fragQueue[j];
 
       //The current entry is free?
       if(!frag->buffer.chunkCount)
@@ -645,10 +586,10 @@ Ipv6FragDesc *ipv6SearchFragQueue(NetInterface *interface,
          //Number of chunks that comprise the reassembly buffer
          frag->buffer.maxChunkCount = arraysize(frag->buffer.chunk);
 
-         //Allocate sufficient memory to hold the IPv6 header and
-         //the first hole descriptor
+         //Allocate sufficient memory to hold the unfragmentable part and
+         //the data of the first fragment
          error = netBufferSetLength((NetBuffer *) &frag->buffer,
-            NET_MEM_POOL_BUFFER_SIZE + sizeof(Ipv6HoleDesc));
+            NET_MEM_POOL_BUFFER_SIZE);
 
          //Failed to allocate memory?
          if(error)
@@ -662,28 +603,25 @@ Ipv6FragDesc *ipv6SearchFragQueue(NetInterface *interface,
          //Initial length of the reconstructed datagram
          frag->unfragPartLength = sizeof(Ipv6Header);
          frag->fragPartLength = 0;
+         frag->rcvdDataLen = 0;
+         frag->lastFragRcvd = FALSE;
+
+         //Amount of memory held by the datagram
+         frag->memSize = frag->buffer.chunk[0].size;
 
          //Fix the length of the first chunk
          frag->buffer.chunk[0].length = (uint16_t) frag->unfragPartLength;
          //Copy IPv6 header from the incoming fragment
-         netBufferWrite((NetBuffer *) &frag->buffer, 0, packet, frag->unfragPartLength);
+         osMemcpy(frag->buffer.chunk[0].address, packet, frag->unfragPartLength);
 
          //Save current time
          frag->timestamp = osGetSystemTime();
          //Record fragment identification field
          frag->identification = header->identification;
-         //Create a new entry in the hole descriptor list
-         frag->firstHole = 0;
-
-         //Point to first hole descriptor
-         hole = ipv6FindHole(frag, frag->firstHole);
-         //The entry describes the datagram as being completely missing
-         hole->first = 0;
-         hole->last = IPV6_INFINITY;
-         hole->next = IPV6_INFINITY;
 
-         //Dump hole descriptor list
-         ipv6DumpHoleList(frag);
+         //Insert the newly created entry in the hash bucket
+         frag->next = interface->ipv6Context.fragHashTable[i];
+         interface->ipv6Context.fragHashTable[i] = frag;
 
          //Return the matching fragment descriptor
          return frag;
@@ -708,49 +646,453 @@ void ipv6FlushFragQueue(NetInterface *interface)
    for(i = 0; i < IPV6_MAX_FRAG_DATAGRAMS; i++)
    {
       //Drop any partially reconstructed datagram
-      netBufferSetLength((NetBuffer *) &interface->ipv6Context.fragQueue[i].buffer, 0);
+      ipv6DeleteFragDesc(interface, &interface->ipv6Context.fragQueue[i]);
    }
 }
 
 
 /**
- * @brief Retrieve hole descriptor
+ * @brief Remove an entry from the reassembly queue
+ * @param[in] interface Underlying network interface
  * @param[in] frag IPv6 fragment descriptor
- * @param[in] offset Offset of the hole
- * @return A pointer to the hole descriptor is returned if the
- *   specified offset is valid. Otherwise NULL is returned
  **/
 
-Ipv6HoleDesc *ipv6FindHole(Ipv6FragDesc *frag, uint16_t offset)
+void ipv6DeleteFragDesc(NetInterface *interface, Ipv6FragDesc *frag)
+{
+   Ipv6FragDesc **p;
+
+   //Make sure the entry is currently in use
+   if(frag->buffer.chunkCount > 0)
+   {
+      //Point to the hash bucket the entry belongs to
+      p = &interface->ipv6Context.fragHashTable[ipv6FragCalcHash(
+         frag->buffer.chunk[0].address, frag->identification)];
+
+      //Remove the entry from the hash bucket
+      while(*p != NULL)
+      {
+         //Matching entry?
+         if(*p == frag)
+         {
+            *p = frag->next;
+            break;
+         }
+
+         //Jump to the next entry
+         p = &(*p)->next;
+      }
+   }
+
+   //Release previously allocated memory
+   netBufferSetLength((NetBuffer *) &frag->buffer, 0);
+   //The entry is now free
+   frag->next = NULL;
+}
+
+
+/**
+ * @brief Calculate the hash of a fragmented datagram
+ * @param[in] packet IPv6 header of the datagram
+ * @param[in] identification Fragment identification field
+ * @return Index of the hash bucket
+ **/
+
+uint_t ipv6FragCalcHash(const Ipv6Header *packet, uint32_t identification)
 {
-   //Return a pointer to the hole descriptor
-   return netBufferAt((NetBuffer *) &frag->buffer, frag->unfragPartLength + offset);
+   uint_t i;
+   uint32_t h;
+
+   //Fragments of the same datagram share the same source and destination
+   //addresses and identification field
+   h = identification;
+
+   //Mix the source and destination addresses
+   for(i = 0; i < 4; i++)
+   {
+      h ^= packet->srcAddr.w[i] ^ packet->destAddr.w[i];
+   }
+
+   //Fold the resulting value
+   h ^= h >> 16;
+   h ^= h >> 8;
+
+   //Return the index of the hash bucket
+   return h % IPV6_FRAG_HASH_TABLE_SIZE;
 }
 
 
 /**
- * @brief Dump hole descriptor list
+ * @brief Get the amount of reassembly memory held by a given source host
+ * @param[in] interface Underlying network interface
+ * @param[in] packet Incoming IPv6 packet
+ * @return Amount of memory, in bytes
+ **/
+
+size_t ipv6FragGetSourceUsage(NetInterface *interface,
+   const Ipv6Header *packet)
+{
+   uint_t i;
+   size_t n;
+   Ipv6Header *datagram;
+   Ipv6FragDesc *frag;
+
+   //Total amount of memory
+   n = 0;
+
+   //Loop through the reassembly queue
+   for(i = 0; i < IPV6_MAX_FRAG_DATAGRAMS; i++)
+   {
+      //Point to the current entry in the reassembly queue
+      frag = &interface->ipv6Context.fragQueue[i];
+
+      //Make sure the entry is currently in use
+      if(frag->buffer.chunkCount > 0)
+      {
+         //Point to the corresponding datagram
+         datagram = frag->buffer.chunk[0].address;
+
+         //Matching source address?
+         if(ipv6CompAddr(&datagram->srcAddr, &packet->srcAddr))
+         {
+            n += frag->memSize;
+         }
+      }
+   }
+
+   //Return the amount of memory held by the source host
+   return n;
+}
+
+
+/**
+ * @brief Search for the first data chunk that ends after a given offset
  * @param[in] frag IPv6 fragment descriptor
+ * @param[in] offset Offset within the fragmentable part
+ * @return Index of the chunk. The number of chunks is returned if no chunk
+ *   ends after the specified offset
  **/
 
-void ipv6DumpHoleList(Ipv6FragDesc *frag)
+uint_t ipv6FragFindChunk(Ipv6FragDesc *frag, uint16_t offset)
+{
+   uint_t left;
+   uint_t right;
+   uint_t mid;
+
+   //Data chunks are sorted by offset and never overlap (the first chunk
+   //holds the unfragmentable part)
+   left = 1;
+   right = frag->buffer.chunkCount;
+
+   //Binary search
+   while(left < right)
+   {
+      //Select the chunk in the middle of the interval
+      mid = (left + right) / 2;
+
+      //Compare the end of the chunk with the specified offset
+      if((frag->chunkOffset[mid] + frag->buffer.chunk[mid].length) > offset)
+      {
+         right = mid;
+      }
+      else
+      {
+         left = mid + 1;
+      }
+   }
+
+   //Return the index of the chunk
+   return left;
+}
+
+
+/**
+ * @brief Get the number of bytes of a fragment that have already been received
+ * @param[in] frag IPv6 fragment descriptor
+ * @param[in] first Index of the first byte of the fragment
+ * @param[in] last Index immediately following the last byte of the fragment
+ * @return Number of bytes
+ **/
+
+size_t ipv6FragCalcCoverage(Ipv6FragDesc *frag, uint16_t first, uint16_t last)
+{
+   uint_t i;
+   size_t n;
+   size_t end;
+
+   //Index immediately following the last byte held by the first chunk
+   end = frag->buffer.chunk[0].length - frag->unfragPartLength;
+
+   //Data held by the first chunk
+   n = (first < end) ? MIN(last, end) - first : 0;
+
+   //Loop through the data chunks that overlap the fragment
+   for(i = ipv6FragFindChunk(frag, first); i < frag->buffer.chunkCount &&
+      frag->chunkOffset[i] < last; i++)
+   {
+      //Index immediately following the last byte of the current chunk
+      end = frag->chunkOffset[i] + frag->buffer.chunk[i].length;
+      //Count the overlapping bytes
+      n += MIN(last, end) - MAX(first, frag->chunkOffset[i]);
+   }
+
+   //Return the number of bytes
+   return n;
+}
+
+
+/**
+ * @brief Store the data of a fragment in the reassembly buffer
+ *
+ * Only the data that is not already present in the reassembly buffer is
+ * stored. The gaps covered by the fragment are filled by appending data to
+ * the preceding chunk when it has room left, or by inserting new chunks
+ *
+ * @param[in] frag IPv6 fragment descriptor
+ * @param[in] first Index of the first byte of the fragment
+ * @param[in] last Index immediately following the last byte of the fragment
+ * @param[in] ipPacket Multi-part buffer containing the incoming IPv6 packet
+ * @param[in] dataOffset Offset to the first data byte of the fragment
+ * @param[in] quota Amount of memory the source host can still use
+ * @return Error code
+ **/
+
+error_t ipv6FragInsertData(Ipv6FragDesc *frag, uint16_t first, uint16_t last,
+   const NetBuffer *ipPacket, size_t dataOffset, size_t quota)
+{
+   uint_t i;
+   size_t n;
+   size_t size;
+   uint16_t pos;
+   uint16_t end;
+   void *p;
+   ChunkDesc *chunk;
+   Ipv6ReassemblyBuffer *buffer;
+
+   //Point to the reassembly buffer
+   buffer = &frag->buffer;
+
+   //Skip the data that is already held by the first chunk
+   pos = MAX(first, buffer->chunk[0].length - frag->unfragPartLength);
+
+   //Fill the gaps covered by the fragment
+   while(pos < last)
+   {
+      //Search for the first chunk that ends after the current position
+      i = ipv6FragFindChunk(frag, pos);
+
+      //The data at the current position has already been received?
+      if(i < buffer->chunkCount && frag->chunkOffset[i] <= pos)
+      {
+         //Skip the overlapping data
+         pos = frag->chunkOffset[i] + buffer->chunk[i].length;
+      }
+      else
+      {
+         //Determine the end of the gap
+         if(i < buffer->chunkCount)
+         {
+            end = MIN(last, frag->chunkOffset[i]);
+         }
+         else
+         {
+            end = last;
+         }
+
+         //Fill the gap with as many chunks as necessary
+         while(pos < end)
+         {
+            //Point to the chunk that precedes the gap
+            chunk = &buffer->chunk[i - 1];
+
+            //Retrieve the index immediately following the last byte of
+            //the preceding chunk
+            if(i == 1)
+            {
+               n = chunk->length - frag->unfragPartLength;
+            }
+            else
+            {
+               n = frag->chunkOffset[i - 1] + chunk->length;
+            }
+
+            //Check whether the data can be appended to the preceding chunk
+            if(n == pos && chunk->length < chunk->size)
+            {
+               //Number of bytes to append
+               n = MIN(end - pos, chunk->size - chunk->length);
+
+               //Copy the data from the fragment
+               netBufferRead((uint8_t *) chunk->address + chunk->length,
+                  ipPacket, dataOffset + pos - first, n);
+
+               //Adjust the length of the preceding chunk
+               chunk->length += (uint16_t) n;
+               frag->rcvdDataLen += n;
+
+               //Prepare to fill the rest of the gap
+               pos += (uint16_t) n;
+               continue;
+            }
+
+            //Make sure a chunk descriptor is available
+            if(buffer->chunkCount >= buffer->maxChunkCount)
+               return ERROR_OUT_OF_RESOURCES;
+
+            //Number of bytes to store in the current chunk
+            n = MIN(end - pos, NET_MEM_POOL_BUFFER_SIZE);
+
+#if (NET_MEM_POOL_SUPPORT == ENABLED)
+            //Fixed-size blocks are allocated from the memory pool
+            size = NET_MEM_POOL_BUFFER_SIZE;
+#else
+            //Allocate exactly the amount of memory that is needed
+            size = n;
+#endif
+            //Enforce the memory quota of the source host
+            if(size > quota)
+               return ERROR_OUT_OF_MEMORY;
+
+            //Allocate a memory block to hold the data
+            p = memPoolAlloc(size);
+            //Failed to allocate memory?
+            if(p == NULL)
+               return ERROR_OUT_OF_MEMORY;
+
+            //Copy the data from the fragment
+            netBufferRead(p, ipPacket, dataOffset + pos - first, n);
+
+            //Make room for the new chunk
+            osMemmove(&buffer->chunk[i + 1], &buffer->chunk[i],
+               (buffer->chunkCount - i) * sizeof(ChunkDesc));
+            osMemmove(&frag->chunkOffset[i + 1], &frag->chunkOffset[i],
+               (buffer->chunkCount - i) * sizeof(uint16_t));
+
+            //Insert the new chunk
+            buffer->chunk[i].address = p;
+            buffer->chunk[i].length = (uint16_t) n;
+            buffer->chunk[i].size = (uint16_t) size;
+            frag->chunkOffset[i] = pos;
+            buffer->chunkCount++;
+
+            //Update the accounting of the datagram
+            frag->rcvdDataLen += n;
+            frag->memSize += size;
+            quota -= size;
+
+            //Prepare to fill the next chunk
+            pos += (uint16_t) n;
+            i++;
+         }
+      }
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Move the beginning of the fragmentable part to the first chunk
+ *
+ * Upper layers may parse a whole message through a single pointer, so the
+ * first chunk is filled with as much contiguous data as it can hold. In
+ * the common case, the gap-filling logic has already done so and no copy
+ * is needed
+ *
+ * @param[in] frag IPv6 fragment descriptor
+ **/
+
+void ipv6FragPullUp(Ipv6FragDesc *frag)
+{
+   size_t n;
+   size_t length;
+   ChunkDesc *chunk;
+   Ipv6ReassemblyBuffer *buffer;
+
+   //Point to the reassembly buffer
+   buffer = &frag->buffer;
+
+   //The first chunk must hold as much data as possible
+   length = frag->unfragPartLength + MIN(frag->fragPartLength,
+      buffer->chunk[0].size - frag->unfragPartLength);
+
+   //Move data to the first chunk until the requirement is met
+   while(buffer->chunk[0].length < length && buffer->chunkCount > 1)
+   {
+      //Point to the chunk that follows the first chunk
+      chunk = &buffer->chunk[1];
+
+      //Number of bytes that can be appended to the first chunk
+      n = MIN(chunk->length, buffer->chunk[0].size - buffer->chunk[0].length);
+
+      //The first chunk is full?
+      if(n == 0)
+         break;
+
+      //Append the data to the first chunk
+      osMemcpy((uint8_t *) buffer->chunk[0].address + buffer->chunk[0].length,
+         chunk->address, n);
+
+      //Adjust the length of the first chunk
+      buffer->chunk[0].length += (uint16_t) n;
+
+      //The whole chunk has been consumed?
+      if(n == chunk->length)
+      {
+         //Release the corresponding memory block
+         memPoolFree(chunk->address);
+
+         //Remove the chunk from the list
+         osMemmove(&buffer->chunk[1], &buffer->chunk[2],
+            (buffer->chunkCount - 2) * sizeof(ChunkDesc));
+         osMemmove(&frag->chunkOffset[1], &frag->chunkOffset[2],
+            (buffer->chunkCount - 2) * sizeof(uint16_t));
+
+         //Update the number of chunks
+         buffer->chunkCount--;
+      }
+      else
+      {
+         //Keep the remaining data at the beginning of the memory block
+         osMemmove(chunk->address, (uint8_t *) chunk->address + n,
+            chunk->length - n);
+
+         //Adjust the length and the offset of the chunk
+         chunk->length -= (uint16_t) n;
+         frag->chunkOffset[1] += (uint16_t) n;
+      }
+   }
+}
+
+
+/**
+ * @brief Dump the list of fragments
+ * @param[in] frag IPv6 fragment descriptor
+ **/
+
+void ipv6DumpFragList(Ipv6FragDesc *frag)
 {
 //Check debugging level
 #if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
-   Ipv6HoleDesc *hole;
+   uint_t i;
 
    //Debug message
-   TRACE_DEBUG("Hole descriptor list:\r\n");
-   //Select the first hole descriptor from the list
-   hole = ipv6FindHole(frag, frag->firstHole);
+   TRACE_DEBUG("Fragment list:\r\n");
+
+   //The data of the first fragment follows the unfragmentable part
+   if(frag->buffer.chunk[0].length > frag->unfragPartLength)
+   {
+      //Display the data held by the first chunk
+      TRACE_DEBUG("  0 - %" PRIuSIZE "\r\n",
+         frag->buffer.chunk[0].length - frag->unfragPartLength);
+   }
 
-   //Loop through the hole descriptor list
-   while(hole != NULL)
+   //Loop through the data chunks
+   for(i = 1; i < frag->buffer.chunkCount; i++)
    {
-      //Display current hole
-      TRACE_DEBUG("  %" PRIu16 " - %" PRIu16 "\r\n", hole->first, hole->last);
-      //Select the next hole descriptor from the list
-      hole = ipv6FindHole(frag, hole->next);
+      //Display current chunk
+      TRACE_DEBUG("  %" PRIu16 " - %" PRIu16 "\r\n", frag->chunkOffset[i],
+         (uint16_t) (frag->chunkOffset[i] + frag->buffer.chunk[i].length));
    }
 #endif
 }
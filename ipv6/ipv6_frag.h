@@ -78,36 +78,30 @@
    #error IPV6_FRAG_TIME_TO_LIVE parameter is not valid
 #endif
 
-//Infinity is implemented by a very large integer
-#define IPV6_INFINITY 0xFFFF
-
-//C++ guard
-#ifdef __cplusplus
-extern "C" {
+//Maximum number of memory chunks held by a datagram being reassembled
+#ifndef IPV6_MAX_FRAG_CHUNKS
+   #define IPV6_MAX_FRAG_CHUNKS 16
+#elif (IPV6_MAX_FRAG_CHUNKS < 2)
+   #error IPV6_MAX_FRAG_CHUNKS parameter is not valid
 #endif
 
-
-//CodeWarrior or Win32 compiler?
-#if defined(__CWCC__) || defined(_WIN32)
-   #pragma pack(push, 1)
+//Size of the hash table used to locate datagrams being reassembled
+#ifndef IPV6_FRAG_HASH_TABLE_SIZE
+   #define IPV6_FRAG_HASH_TABLE_SIZE 8
+#elif (IPV6_FRAG_HASH_TABLE_SIZE < 1)
+   #error IPV6_FRAG_HASH_TABLE_SIZE parameter is not valid
 #endif
 
+//Maximum amount of reassembly memory a single source host can hold
+#ifndef IPV6_FRAG_MAX_SOURCE_SIZE
+   #define IPV6_FRAG_MAX_SOURCE_SIZE 32768
+#elif (IPV6_FRAG_MAX_SOURCE_SIZE < IPV6_MAX_FRAG_DATAGRAM_SIZE)
+   #error IPV6_FRAG_MAX_SOURCE_SIZE parameter is not valid
+#endif
 
-/**
- * @brief Hole descriptor
- **/
-
-typedef __start_packed struct
-{
-   uint16_t first;
-   uint16_t last;
-   uint16_t next;
-} __end_packed Ipv6HoleDesc;
-
-
-//CodeWarrior or Win32 compiler?
-#if defined(__CWCC__) || defined(_WIN32)
-   #pragma pack(pop)
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
 #endif
 
 
@@ -119,27 +113,42 @@ typedef struct
 {
    uint_t chunkCount;
    uint_t maxChunkCount;
-   ChunkDesc chunk[N(IPV6_MAX_FRAG_DATAGRAM_SIZE) + 1];
+   ChunkDesc chunk[IPV6_MAX_FRAG_CHUNKS];
 } Ipv6ReassemblyBuffer;
 
 
 /**
  * @brief Fragmented packet descriptor
+ *
+ * The first chunk of the reassembly buffer holds the unfragmentable part
+ * followed by the data of the first fragment. The remaining chunks hold
+ * the data of the other fragments and are kept sorted by offset, so that
+ * the buffer can be passed as is to the upper layer once the datagram is
+ * complete
  **/
 
-typedef struct
+typedef struct _Ipv6FragDesc
 {
-   systime_t timestamp;         ///<Time at which the first fragment was received
-   uint32_t identification;     ///<Fragment identification field
-   size_t unfragPartLength;     ///<Length of the unfragmentable part
-   size_t fragPartLength;       ///<Length of the fragmentable part
-   uint16_t firstHole;          ///<Index of the first hole
-   Ipv6ReassemblyBuffer buffer; ///<Buffer containing the reassembled datagram
+   struct _Ipv6FragDesc *next;                 ///<Next entry in the same hash bucket
+   systime_t timestamp;                        ///<Time at which the first fragment was received
+   uint32_t identification;                    ///<Fragment identification field
+   size_t unfragPartLength;                    ///<Length of the unfragmentable part
+   size_t fragPartLength;                      ///<Length of the fragmentable part
+   size_t rcvdDataLen;                         ///<Number of bytes of the fragmentable part received so far
+   size_t memSize;                             ///<Amount of memory held by the datagram
+   bool_t lastFragRcvd;                        ///<The last fragment has been received
+   uint16_t chunkOffset[IPV6_MAX_FRAG_CHUNKS]; ///<Offset of each data chunk within the fragmentable part
+   Ipv6ReassemblyBuffer buffer;                ///<Buffer containing the reassembled datagram
 } Ipv6FragDesc;
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t ipv6FragTickCounters[NET_MAX_INSTANCES];
+#define ipv6FragTickCounter (ipv6FragTickCounters[netContext.instance])
+#else
 extern systime_t ipv6FragTickCounter;
+#endif
 
 //IPv6 datagram fragmentation and reassembly
 error_t ipv6FragmentDatagram(NetInterface *interface,
@@ -156,9 +165,21 @@ Ipv6FragDesc *ipv6SearchFragQueue(NetInterface *interface,
    Ipv6Header *packet, Ipv6FragmentHeader *header);
 
 void ipv6FlushFragQueue(NetInterface *interface);
+void ipv6DeleteFragDesc(NetInterface *interface, Ipv6FragDesc *frag);
+
+uint_t ipv6FragCalcHash(const Ipv6Header *packet, uint32_t identification);
+
+size_t ipv6FragGetSourceUsage(NetInterface *interface,
+   const Ipv6Header *packet);
+
+uint_t ipv6FragFindChunk(Ipv6FragDesc *frag, uint16_t offset);
+size_t ipv6FragCalcCoverage(Ipv6FragDesc *frag, uint16_t first, uint16_t last);
+
+error_t ipv6FragInsertData(Ipv6FragDesc *frag, uint16_t first, uint16_t last,
+   const NetBuffer *ipPacket, size_t dataOffset, size_t quota);
 
-Ipv6HoleDesc *ipv6FindHole(Ipv6FragDesc *frag, uint16_t offset);
-void ipv6DumpHoleList(Ipv6FragDesc *frag);
+void ipv6FragPullUp(Ipv6FragDesc *frag);
+void ipv6DumpFragList(Ipv6FragDesc *frag);
 
 //C++ guard
 #ifdef __cplusplus
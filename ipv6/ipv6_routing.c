@@ -46,7 +46,12 @@
 #if (IPV6_SUPPORT == ENABLED && IPV6_ROUTING_SUPPORT == ENABLED)
 
 //IPv6 routing table
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+static Ipv6RoutingTableEntry ipv6RoutingTables[NET_MAX_INSTANCES][IPV6_ROUTING_TABLE_SIZE];
+#define ipv6RoutingTable (ipv6RoutingTables[netContext.instance])
+#else
 static Ipv6RoutingTableEntry ipv6RoutingTable[IPV6_ROUTING_TABLE_SIZE];
+#endif
 
 
 /**
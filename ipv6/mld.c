@@ -53,7 +53,11 @@
 #if (IPV6_SUPPORT == ENABLED && MLD_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t mldTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t mldTickCounter;
+#endif
 
 
 /**
@@ -103,7 +103,12 @@ typedef __start_packed struct
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t mldTickCounters[NET_MAX_INSTANCES];
+#define mldTickCounter (mldTickCounters[netContext.instance])
+#else
 extern systime_t mldTickCounter;
+#endif
 
 //MLD related functions
 error_t mldInit(NetInterface *interface);
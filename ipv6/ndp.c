@@ -57,7 +57,11 @@
 #if (IPV6_SUPPORT == ENABLED && NDP_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t ndpTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t ndpTickCounter;
+#endif
 
 
 /**
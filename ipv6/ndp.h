@@ -591,7 +591,12 @@ typedef struct
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t ndpTickCounters[NET_MAX_INSTANCES];
+#define ndpTickCounter (ndpTickCounters[netContext.instance])
+#else
 extern systime_t ndpTickCounter;
+#endif
 
 //NDP related functions
 error_t ndpInit(NetInterface *interface);
@@ -48,7 +48,11 @@
 #if (IPV6_SUPPORT == ENABLED && NDP_ROUTER_ADV_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t ndpRouterAdvTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t ndpRouterAdvTickCounter;
+#endif
 
 
 /**
@@ -41,7 +41,12 @@ extern "C" {
 #endif
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t ndpRouterAdvTickCounters[NET_MAX_INSTANCES];
+#define ndpRouterAdvTickCounter (ndpRouterAdvTickCounters[netContext.instance])
+#else
 extern systime_t ndpRouterAdvTickCounter;
+#endif
 
 //RA service related functions
 void ndpRouterAdvTick(NdpRouterAdvContext *context);
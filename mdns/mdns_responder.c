@@ -46,7 +46,11 @@
 #if (MDNS_RESPONDER_SUPPORT == ENABLED)
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+systime_t mdnsResponderTickCounters[NET_MAX_INSTANCES];
+#else
 systime_t mdnsResponderTickCounter;
+#endif
 
 
 /**
@@ -186,7 +186,12 @@ struct _MdnsResponderContext
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t mdnsResponderTickCounters[NET_MAX_INSTANCES];
+#define mdnsResponderTickCounter (mdnsResponderTickCounters[netContext.instance])
+#else
 extern systime_t mdnsResponderTickCounter;
+#endif
 
 //mDNS related functions
 void mdnsResponderGetDefaultSettings(MdnsResponderSettings *settings);
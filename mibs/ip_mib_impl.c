@@ -87,6 +87,15 @@ error_t ipMibInit(void)
    ipMibBase.ipv6RouterAdvertSpinLock = netGetRandRange(1, INT32_MAX);
 #endif
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Initialize the snapshots of the ipAddressTable and ipNetToPhysicalTable
+   mibInitTableSnapshot(&ipMibBase.ipAddressSnapshot,
+      ipMibBase.ipAddressRows, IP_MIB_ADDRESS_TABLE_SIZE);
+
+   mibInitTableSnapshot(&ipMibBase.ipNetToPhysicalSnapshot,
+      ipMibBase.ipNetToPhysicalRows, IP_MIB_NET_TO_PHYSICAL_TABLE_SIZE);
+#endif
+
    //Successful processing
    return NO_ERROR;
 }
@@ -2130,6 +2139,22 @@ error_t ipMibGetNextIpAddressEntry(const MibObject *object, const uint8_t *oid,
    //Initialize variable
    ipAddr = IP_ADDR_UNSPECIFIED;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the ipAddressTable if necessary
+   if(!mibIsTableSnapshotValid(&ipMibBase.ipAddressSnapshot))
+   {
+      ipMibTakeIpAddressSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(ipMibBase.ipAddressSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&ipMibBase.ipAddressSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -2541,6 +2566,22 @@ error_t ipMibGetNextIpNetToPhysicalEntry(const MibObject *object, const uint8_t
    index = 0;
    ipAddr = IP_ADDR_UNSPECIFIED;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the ipNetToPhysicalTable if necessary
+   if(!mibIsTableSnapshotValid(&ipMibBase.ipNetToPhysicalSnapshot))
+   {
+      ipMibTakeIpNetToPhysicalSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(ipMibBase.ipNetToPhysicalSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&ipMibBase.ipNetToPhysicalSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -3940,4 +3981,206 @@ error_t ipMibGetNextIcmpMsgStatsEntry(const MibObject *object, const uint8_t *oi
    return ERROR_OBJECT_NOT_FOUND;
 }
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+
+/**
+ * @brief Take a snapshot of the ipAddressTable
+ **/
+
+void ipMibTakeIpAddressSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint_t index;
+   IpAddr ipAddr;
+   NetInterface *interface;
+   uint8_t buffer[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&ipMibBase.ipAddressSnapshot);
+
+   //Loop through network interfaces
+   for(index = 1; index <= NET_INTERFACE_COUNT && !error; index++)
+   {
+      //Point to the current interface
+      interface = &netInterface[index - 1];
+
+      //Avoid warnings from the compiler
+      (void) i;
+      (void) n;
+      (void) ipAddr;
+      (void) interface;
+
+#if (IPV4_SUPPORT == ENABLED)
+      //Loop through the list of IPv4 addresses assigned to the interface
+      for(i = 0; i < IPV4_ADDR_LIST_SIZE && !error; i++)
+      {
+         //Valid IPv4 address?
+         if(interface->ipv4Context.addrList[i].state == IPV4_ADDR_STATE_VALID)
+         {
+            //Get current address
+            ipAddr.length = sizeof(Ipv4Addr);
+            ipAddr.ipv4Addr = interface->ipv4Context.addrList[i].addr;
+
+            //ipAddressAddrType and ipAddressAddr are used as instance
+            //identifiers
+            n = 0;
+            error = mibEncodeIpAddr(buffer, sizeof(buffer), &n, &ipAddr);
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&ipMibBase.ipAddressSnapshot,
+                  buffer, n);
+            }
+         }
+      }
+#endif
+
+#if (IPV6_SUPPORT == ENABLED)
+      //Loop through the list of IPv6 addresses assigned to the interface
+      for(i = 0; i < IPV6_ADDR_LIST_SIZE && !error; i++)
+      {
+         //Valid IPv6 address?
+         if(interface->ipv6Context.addrList[i].state != IPV6_ADDR_STATE_INVALID)
+         {
+            //Get current address
+            ipAddr.length = sizeof(Ipv6Addr);
+            ipAddr.ipv6Addr = interface->ipv6Context.addrList[i].addr;
+
+            //ipAddressAddrType and ipAddressAddr are used as instance
+            //identifiers
+            n = 0;
+            error = mibEncodeIpAddr(buffer, sizeof(buffer), &n, &ipAddr);
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&ipMibBase.ipAddressSnapshot,
+                  buffer, n);
+            }
+         }
+      }
+#endif
+   }
+
+   //Any error to report?
+   if(error)
+   {
+      //The snapshot cannot be used
+      ipMibBase.ipAddressSnapshot.valid = FALSE;
+   }
+}
+
+
+/**
+ * @brief Take a snapshot of the ipNetToPhysicalTable
+ **/
+
+void ipMibTakeIpNetToPhysicalSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint_t index;
+   IpAddr ipAddr;
+   NetInterface *interface;
+   uint8_t buffer[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&ipMibBase.ipNetToPhysicalSnapshot);
+
+   //Loop through network interfaces
+   for(index = 1; index <= NET_INTERFACE_COUNT && !error; index++)
+   {
+      //Point to the current interface
+      interface = &netInterface[index - 1];
+
+      //Avoid warnings from the compiler
+      (void) i;
+      (void) n;
+      (void) ipAddr;
+      (void) interface;
+
+#if (IPV4_SUPPORT == ENABLED && ETH_SUPPORT == ENABLED)
+      //Loop through ARP cache entries
+      for(i = 0; i < ARP_CACHE_SIZE && !error; i++)
+      {
+         //Valid entry?
+         if(interface->arpCache[i].state != ARP_STATE_NONE)
+         {
+            //Get current IP address
+            ipAddr.length = sizeof(Ipv4Addr);
+            ipAddr.ipv4Addr = interface->arpCache[i].ipAddr;
+
+            //ipNetToPhysicalIfIndex is used as 1st instance identifier
+            n = 0;
+            error = mibEncodeIndex(buffer, sizeof(buffer), &n, index);
+
+            //ipNetToPhysicalNetAddressType and ipNetToPhysicalNetAddress are
+            //used as 2nd and 3rd instance identifiers
+            if(!error)
+            {
+               error = mibEncodeIpAddr(buffer, sizeof(buffer), &n, &ipAddr);
+            }
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&ipMibBase.ipNetToPhysicalSnapshot,
+                  buffer, n);
+            }
+         }
+      }
+#endif
+
+#if (IPV6_SUPPORT == ENABLED)
+      //Loop through Neighbor cache entries
+      for(i = 0; i < NDP_NEIGHBOR_CACHE_SIZE && !error; i++)
+      {
+         //Valid entry?
+         if(interface->ndpContext.neighborCache[i].state != NDP_STATE_NONE)
+         {
+            //Get current IP address
+            ipAddr.length = sizeof(Ipv6Addr);
+            ipAddr.ipv6Addr = interface->ndpContext.neighborCache[i].ipAddr;
+
+            //ipNetToPhysicalIfIndex is used as 1st instance identifier
+            n = 0;
+            error = mibEncodeIndex(buffer, sizeof(buffer), &n, index);
+
+            //ipNetToPhysicalNetAddressType and ipNetToPhysicalNetAddress are
+            //used as 2nd and 3rd instance identifiers
+            if(!error)
+            {
+               error = mibEncodeIpAddr(buffer, sizeof(buffer), &n, &ipAddr);
+            }
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&ipMibBase.ipNetToPhysicalSnapshot,
+                  buffer, n);
+            }
+         }
+      }
+#endif
+   }
+
+   //Any error to report?
+   if(error)
+   {
+      //The snapshot cannot be used
+      ipMibBase.ipNetToPhysicalSnapshot.valid = FALSE;
+   }
+}
+
+#endif
 #endif
@@ -141,6 +141,9 @@ error_t ipMibGetIcmpMsgStatsEntry(const MibObject *object, const uint8_t *oid,
 error_t ipMibGetNextIcmpMsgStatsEntry(const MibObject *object, const uint8_t *oid,
    size_t oidLen, uint8_t *nextOid, size_t *nextOidLen);
 
+void ipMibTakeIpAddressSnapshot(void);
+void ipMibTakeIpNetToPhysicalSnapshot(void);
+
 //C++ guard
 #ifdef __cplusplus
 }
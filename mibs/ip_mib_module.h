@@ -50,6 +50,14 @@
    #define IP_MIB_INC_COUNTER64(name, value)
 #endif
 
+//Maximum number of rows in the ipAddressTable
+#define IP_MIB_ADDRESS_TABLE_SIZE (NET_INTERFACE_COUNT * \
+   (IPV4_ADDR_LIST_SIZE + IPV6_ADDR_LIST_SIZE))
+
+//Maximum number of rows in the ipNetToPhysicalTable
+#define IP_MIB_NET_TO_PHYSICAL_TABLE_SIZE (NET_INTERFACE_COUNT * \
+   (ARP_CACHE_SIZE + NDP_NEIGHBOR_CACHE_SIZE))
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -334,6 +342,12 @@ typedef struct
    IpMibIcmpStatsEntry icmpv6Stats;
    IpMibIcmpMsgStatsEntry icmpv6MsgStatsTable;
 #endif
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   MibTableRow ipAddressRows[IP_MIB_ADDRESS_TABLE_SIZE];
+   MibTableSnapshot ipAddressSnapshot;
+   MibTableRow ipNetToPhysicalRows[IP_MIB_NET_TO_PHYSICAL_TABLE_SIZE];
+   MibTableSnapshot ipNetToPhysicalSnapshot;
+#endif
 } IpMibBase;
 
 
@@ -183,6 +183,12 @@ void mib2InitTcpGroup(Mib2TcpGroup *tcpGroup)
    tcpGroup->tcpRtoMax = TCP_MAX_RTO;
    //tcpMaxConn object
    tcpGroup->tcpMaxConn = SOCKET_MAX_COUNT;
+
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Initialize the snapshot of the tcpConnTable
+   mibInitTableSnapshot(&tcpGroup->tcpConnSnapshot, tcpGroup->tcpConnRows,
+      SOCKET_MAX_COUNT);
+#endif
 }
 
 
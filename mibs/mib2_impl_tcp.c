@@ -312,6 +312,22 @@ error_t mib2GetNextTcpConnEntry(const MibObject *object, const uint8_t *oid,
    remoteIpAddr = IPV4_UNSPECIFIED_ADDR;
    remotePort = 0;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the tcpConnTable if necessary
+   if(!mibIsTableSnapshotValid(&mib2Base.tcpGroup.tcpConnSnapshot))
+   {
+      mib2TakeTcpConnSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(mib2Base.tcpGroup.tcpConnSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&mib2Base.tcpGroup.tcpConnSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -453,4 +469,80 @@ error_t mib2GetNextTcpConnEntry(const MibObject *object, const uint8_t *oid,
    return NO_ERROR;
 }
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+
+/**
+ * @brief Take a snapshot of the tcpConnTable
+ **/
+
+void mib2TakeTcpConnSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint8_t index[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+   Socket *socket;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&mib2Base.tcpGroup.tcpConnSnapshot);
+
+   //Loop through socket descriptors
+   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   {
+      //Point to current socket
+      socket = &socketTable[i];
+
+      //TCP socket?
+      if(socket->type == SOCKET_TYPE_STREAM)
+      {
+         //Filter out IPv6 connections
+         if(socket->localIpAddr.length != sizeof(Ipv6Addr) &&
+            socket->remoteIpAddr.length != sizeof(Ipv6Addr))
+         {
+            //Format the instance identifier
+            n = 0;
+
+            //tcpConnLocalAddress is used as 1st instance identifier
+            error = mibEncodeIpv4Addr(index, sizeof(index), &n,
+               socket->localIpAddr.ipv4Addr);
+
+            //tcpConnLocalPort is used as 2nd instance identifier
+            if(!error)
+            {
+               error = mibEncodePort(index, sizeof(index), &n, socket->localPort);
+            }
+
+            //tcpConnRemAddress is used as 3rd instance identifier
+            if(!error)
+            {
+               error = mibEncodeIpv4Addr(index, sizeof(index), &n,
+                  socket->remoteIpAddr.ipv4Addr);
+            }
+
+            //tcpConnRemPort is used as 4th instance identifier
+            if(!error)
+            {
+               error = mibEncodePort(index, sizeof(index), &n, socket->remotePort);
+            }
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&mib2Base.tcpGroup.tcpConnSnapshot,
+                  index, n);
+            }
+
+            //Any error to report?
+            if(error)
+            {
+               //The snapshot cannot be used
+               mib2Base.tcpGroup.tcpConnSnapshot.valid = FALSE;
+               break;
+            }
+         }
+      }
+   }
+}
+
+#endif
 #endif
@@ -53,6 +53,8 @@ error_t mib2GetTcpConnEntry(const MibObject *object, const uint8_t *oid,
 error_t mib2GetNextTcpConnEntry(const MibObject *object, const uint8_t *oid,
    size_t oidLen, uint8_t *nextOid, size_t *nextOidLen);
 
+void mib2TakeTcpConnSnapshot(void);
+
 //C++ guard
 #ifdef __cplusplus
 }
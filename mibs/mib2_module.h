@@ -481,6 +481,10 @@ typedef struct
    uint32_t tcpRetransSegs;
    uint32_t tcpInErrs;
    uint32_t tcpOutRsts;
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   MibTableRow tcpConnRows[SOCKET_MAX_COUNT];
+   MibTableSnapshot tcpConnSnapshot;
+#endif
 } Mib2TcpGroup;
 
 
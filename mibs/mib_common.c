@@ -1038,3 +1038,288 @@ error_t mibTestAndIncSpinLock(int32_t *spinLock, int32_t value, bool_t commit)
    //Return status code
    return error;
 }
+
+
+/**
+ * @brief Initialize a table snapshot
+ * @param[in] snapshot Pointer to the table snapshot
+ * @param[in] rows Array where to store the rows
+ * @param[in] maxRows Maximum number of rows
+ **/
+
+void mibInitTableSnapshot(MibTableSnapshot *snapshot, MibTableRow *rows,
+   uint_t maxRows)
+{
+   //Attach the row storage
+   snapshot->rows = rows;
+   snapshot->maxRows = maxRows;
+
+   //The snapshot must be taken before use
+   snapshot->numRows = 0;
+   snapshot->cursor = 0;
+   snapshot->valid = FALSE;
+   snapshot->timestamp = 0;
+}
+
+
+/**
+ * @brief Check whether a table snapshot can be used
+ * @param[in] snapshot Pointer to the table snapshot
+ * @return TRUE if the snapshot is complete and has not expired, else FALSE
+ **/
+
+bool_t mibIsTableSnapshotValid(MibTableSnapshot *snapshot)
+{
+   bool_t valid;
+
+   //Check whether the snapshot holds all the rows of the table
+   if(snapshot->valid)
+   {
+      //Table walks (GetNext or GetBulk) that complete within the lifetime of
+      //the snapshot are served from it
+      if(timeCompare(osGetSystemTime(), snapshot->timestamp +
+         MIB_TABLE_SNAPSHOT_LIFETIME) < 0)
+      {
+         valid = TRUE;
+      }
+      else
+      {
+         valid = FALSE;
+      }
+   }
+   else
+   {
+      valid = FALSE;
+   }
+
+   //Return TRUE if the snapshot can be used
+   return valid;
+}
+
+
+/**
+ * @brief Start a new table snapshot
+ * @param[in] snapshot Pointer to the table snapshot
+ **/
+
+void mibClearTableSnapshot(MibTableSnapshot *snapshot)
+{
+   //Discard the previous rows
+   snapshot->numRows = 0;
+   snapshot->cursor = 0;
+
+   //Save the time at which the snapshot is taken
+   snapshot->valid = TRUE;
+   snapshot->timestamp = osGetSystemTime();
+}
+
+
+/**
+ * @brief Add a row to a table snapshot
+ * @param[in] snapshot Pointer to the table snapshot
+ * @param[in] index Instance identifier of the row
+ * @param[in] indexLen Length of the instance identifier
+ * @return Error code
+ **/
+
+error_t mibAddTableSnapshotRow(MibTableSnapshot *snapshot,
+   const uint8_t *index, size_t indexLen)
+{
+   uint_t left;
+   uint_t right;
+   uint_t mid;
+   int_t res;
+
+   //Make sure the snapshot can hold the row
+   if(snapshot->numRows >= snapshot->maxRows ||
+      indexLen > MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE)
+   {
+      //The snapshot is incomplete and cannot be used
+      snapshot->valid = FALSE;
+      //Report an error
+      return ERROR_BUFFER_OVERFLOW;
+   }
+
+   //Index of the first item
+   left = 0;
+   //Index past the last item
+   right = snapshot->numRows;
+
+   //Search for the position of the row (binary search algorithm)
+   while(left < right)
+   {
+      //Calculate the index of the middle item
+      mid = left + (right - left) / 2;
+
+      //Perform lexicographic comparison
+      res = oidComp(snapshot->rows[mid].index, snapshot->rows[mid].indexLen,
+         index, indexLen);
+
+      //Check the result of the comparison
+      if(res < 0)
+      {
+         left = mid + 1;
+      }
+      else if(res > 0)
+      {
+         right = mid;
+      }
+      else
+      {
+         //Duplicate rows are reported only once
+         return NO_ERROR;
+      }
+   }
+
+   //Make room for the new row
+   osMemmove(&snapshot->rows[left + 1], &snapshot->rows[left],
+      (snapshot->numRows - left) * sizeof(MibTableRow));
+
+   //Save the instance identifier
+   osMemcpy(snapshot->rows[left].index, index, indexLen);
+   snapshot->rows[left].indexLen = indexLen;
+
+   //Update the number of rows
+   snapshot->numRows++;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Get the next object instance from a table snapshot
+ *
+ * Rows that have disappeared since the snapshot was taken are skipped, so
+ * that a table walk never returns an instance that no longer exists
+ *
+ * @param[in] snapshot Pointer to the table snapshot
+ * @param[in] object Pointer to the MIB object descriptor
+ * @param[in] oid Object identifier
+ * @param[in] oidLen Length of the OID, in bytes
+ * @param[out] nextOid OID of the next object in the MIB
+ * @param[out] nextOidLen Length of the next object identifier, in bytes
+ * @return Error code
+ **/
+
+error_t mibGetNextTableSnapshotRow(MibTableSnapshot *snapshot,
+   const MibObject *object, const uint8_t *oid, size_t oidLen,
+   uint8_t *nextOid, size_t *nextOidLen)
+{
+   uint_t i;
+   uint_t left;
+   uint_t right;
+   uint_t mid;
+   error_t error;
+   size_t n;
+   const uint8_t *index;
+   size_t indexLen;
+   MibTableRow *row;
+   uint32_t value[8];
+
+   //Make sure the buffer is large enough to hold the OID prefix
+   if(*nextOidLen < object->oidLen)
+      return ERROR_BUFFER_OVERFLOW;
+
+   //Copy OID prefix
+   osMemcpy(nextOid, object->oid, object->oidLen);
+
+   //Check whether the OID designates an instance of the object
+   if(oidLen > object->oidLen &&
+      oidComp(oid, object->oidLen, object->oid, object->oidLen) == 0)
+   {
+      //Point to the instance identifier
+      index = oid + object->oidLen;
+      indexLen = oidLen - object->oidLen;
+
+      //Table walks typically request the row that follows the one returned
+      //last, whatever the column
+      if(snapshot->cursor < snapshot->numRows &&
+         oidComp(snapshot->rows[snapshot->cursor].index,
+         snapshot->rows[snapshot->cursor].indexLen, index, indexLen) == 0)
+      {
+         //No need to search the snapshot
+         i = snapshot->cursor + 1;
+      }
+      else
+      {
+         //Index of the first item
+         left = 0;
+         //Index past the last item
+         right = snapshot->numRows;
+
+         //Search for the first row that follows the instance identifier
+         while(left < right)
+         {
+            //Calculate the index of the middle item
+            mid = left + (right - left) / 2;
+
+            //Perform lexicographic comparison
+            if(oidComp(snapshot->rows[mid].index, snapshot->rows[mid].indexLen,
+               index, indexLen) <= 0)
+            {
+               left = mid + 1;
+            }
+            else
+            {
+               right = mid;
+            }
+         }
+
+         //Position of the next row
+         i = left;
+      }
+   }
+   else if(oidComp(oid, oidLen, object->oid, object->oidLen) <= 0)
+   {
+      //The OID precedes all the instances of the object
+      i = 0;
+   }
+   else
+   {
+      //The OID follows all the instances of the object
+      i = snapshot->numRows;
+   }
+
+   //Loop through the remaining rows
+   for(; i < snapshot->numRows; i++)
+   {
+      //Point to the current row
+      row = &snapshot->rows[i];
+
+      //Make sure the buffer is large enough to hold the entire OID
+      if((object->oidLen + row->indexLen) > *nextOidLen)
+         return ERROR_BUFFER_OVERFLOW;
+
+      //Append the instance identifier to the OID prefix
+      osMemcpy(nextOid + object->oidLen, row->index, row->indexLen);
+
+      //Check whether the row still exists
+      if(object->getValue != NULL)
+      {
+         //A value that does not fit in the buffer still denotes an
+         //existing instance
+         n = sizeof(value);
+
+         //Retrieve the value of the object instance
+         error = object->getValue(object, nextOid, object->oidLen +
+            row->indexLen, (MibVariant *) value, &n);
+
+         //The row has been deleted since the snapshot was taken?
+         if(error == ERROR_INSTANCE_NOT_FOUND)
+            continue;
+      }
+
+      //Save the length of the resulting object identifier
+      *nextOidLen = object->oidLen + row->indexLen;
+      //Save the position of the row
+      snapshot->cursor = i;
+
+      //Next object found
+      return NO_ERROR;
+   }
+
+   //The specified OID does not lexicographically precede the name
+   //of some object
+   return ERROR_OBJECT_NOT_FOUND;
+}
@@ -41,6 +41,27 @@
    #error MIB_MAX_OID_SIZE parameter is not valid
 #endif
 
+//Snapshot of tabular objects
+#ifndef MIB_TABLE_SNAPSHOT_SUPPORT
+   #define MIB_TABLE_SNAPSHOT_SUPPORT DISABLED
+#elif (MIB_TABLE_SNAPSHOT_SUPPORT != ENABLED && MIB_TABLE_SNAPSHOT_SUPPORT != DISABLED)
+   #error MIB_TABLE_SNAPSHOT_SUPPORT parameter is not valid
+#endif
+
+//Lifetime of table snapshots, in milliseconds
+#ifndef MIB_TABLE_SNAPSHOT_LIFETIME
+   #define MIB_TABLE_SNAPSHOT_LIFETIME 1000
+#elif (MIB_TABLE_SNAPSHOT_LIFETIME < 0)
+   #error MIB_TABLE_SNAPSHOT_LIFETIME parameter is not valid
+#endif
+
+//Maximum size of the instance identifier of a row
+#ifndef MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE
+   #define MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE 48
+#elif (MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE < 1)
+   #error MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE parameter is not valid
+#endif
+
 //Forward declaration of MibObject structure
 struct _MibObject;
 #define MibObject struct _MibObject
@@ -200,6 +221,32 @@ typedef __start_packed struct
 #endif
 
 
+/**
+ * @brief Row of a table snapshot
+ **/
+
+typedef struct
+{
+   uint8_t index[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE]; ///<Instance identifier
+   size_t indexLen;                                  ///<Length of the instance identifier
+} MibTableRow;
+
+
+/**
+ * @brief Table snapshot
+ **/
+
+typedef struct
+{
+   MibTableRow *rows;   ///<Rows, sorted by instance identifier
+   uint_t maxRows;      ///<Maximum number of rows
+   uint_t numRows;      ///<Number of rows
+   uint_t cursor;       ///<Position of the row returned last
+   bool_t valid;        ///<The snapshot holds all the rows of the table
+   systime_t timestamp; ///<Time at which the snapshot was taken
+} MibTableSnapshot;
+
+
 /**
  * @brief Set object value
  **/
@@ -371,6 +418,19 @@ int_t mibCompIpAddr(const IpAddr *ipAddr1, const IpAddr *ipAddr2);
 
 error_t mibTestAndIncSpinLock(int32_t *spinLock, int32_t value, bool_t commit);
 
+void mibInitTableSnapshot(MibTableSnapshot *snapshot, MibTableRow *rows,
+   uint_t maxRows);
+
+bool_t mibIsTableSnapshotValid(MibTableSnapshot *snapshot);
+void mibClearTableSnapshot(MibTableSnapshot *snapshot);
+
+error_t mibAddTableSnapshotRow(MibTableSnapshot *snapshot,
+   const uint8_t *index, size_t indexLen);
+
+error_t mibGetNextTableSnapshotRow(MibTableSnapshot *snapshot,
+   const MibObject *object, const uint8_t *oid, size_t oidLen,
+   uint8_t *nextOid, size_t *nextOidLen);
+
 //C++ guard
 #ifdef __cplusplus
 }
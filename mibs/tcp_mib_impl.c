@@ -67,6 +67,15 @@ error_t tcpMibInit(void)
    //tcpMaxConn object
    tcpMibBase.tcpMaxConn = SOCKET_MAX_COUNT;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Initialize the snapshots of the tcpConnectionTable and tcpListenerTable
+   mibInitTableSnapshot(&tcpMibBase.tcpConnectionSnapshot,
+      tcpMibBase.tcpConnectionRows, SOCKET_MAX_COUNT);
+
+   mibInitTableSnapshot(&tcpMibBase.tcpListenerSnapshot,
+      tcpMibBase.tcpListenerRows, SOCKET_MAX_COUNT);
+#endif
+
    //Successful processing
    return NO_ERROR;
 }
@@ -316,6 +325,22 @@ error_t tcpMibGetNextTcpConnectionEntry(const MibObject *object, const uint8_t *
    remoteIpAddr = IP_ADDR_ANY;
    remotePort = 0;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the tcpConnectionTable if necessary
+   if(!mibIsTableSnapshotValid(&tcpMibBase.tcpConnectionSnapshot))
+   {
+      tcpMibTakeTcpConnectionSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(tcpMibBase.tcpConnectionSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&tcpMibBase.tcpConnectionSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -572,6 +597,22 @@ error_t tcpMibGetNextTcpListenerEntry(const MibObject *object, const uint8_t *oi
    localIpAddr = IP_ADDR_ANY;
    localPort = 0;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the tcpListenerTable if necessary
+   if(!mibIsTableSnapshotValid(&tcpMibBase.tcpListenerSnapshot))
+   {
+      tcpMibTakeTcpListenerSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(tcpMibBase.tcpListenerSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&tcpMibBase.tcpListenerSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -672,4 +713,140 @@ error_t tcpMibGetNextTcpListenerEntry(const MibObject *object, const uint8_t *oi
    return NO_ERROR;
 }
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+
+/**
+ * @brief Take a snapshot of the tcpConnectionTable
+ **/
+
+void tcpMibTakeTcpConnectionSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint8_t index[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+   Socket *socket;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&tcpMibBase.tcpConnectionSnapshot);
+
+   //Loop through socket descriptors
+   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   {
+      //Point to current socket
+      socket = &socketTable[i];
+
+      //TCP socket?
+      if(socket->type == SOCKET_TYPE_STREAM)
+      {
+         //Check current state
+         if(socket->state != TCP_STATE_LISTEN)
+         {
+            //Format the instance identifier
+            n = 0;
+
+            //tcpConnectionLocalAddressType and tcpConnectionLocalAddress are used
+            //as 1st and 2nd instance identifiers
+            error = mibEncodeIpAddr(index, sizeof(index), &n, &socket->localIpAddr);
+
+            //tcpConnectionLocalPort is used as 3rd instance identifier
+            if(!error)
+            {
+               error = mibEncodePort(index, sizeof(index), &n, socket->localPort);
+            }
+
+            //tcpConnectionRemAddressType and tcpConnectionRemAddress are used
+            //as 4th and 5th instance identifiers
+            if(!error)
+            {
+               error = mibEncodeIpAddr(index, sizeof(index), &n,
+                  &socket->remoteIpAddr);
+            }
+
+            //tcpConnectionRemPort is used as 6th instance identifier
+            if(!error)
+            {
+               error = mibEncodePort(index, sizeof(index), &n, socket->remotePort);
+            }
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&tcpMibBase.tcpConnectionSnapshot,
+                  index, n);
+            }
+
+            //Any error to report?
+            if(error)
+            {
+               //The snapshot cannot be used
+               tcpMibBase.tcpConnectionSnapshot.valid = FALSE;
+               break;
+            }
+         }
+      }
+   }
+}
+
+
+/**
+ * @brief Take a snapshot of the tcpListenerTable
+ **/
+
+void tcpMibTakeTcpListenerSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint8_t index[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+   Socket *socket;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&tcpMibBase.tcpListenerSnapshot);
+
+   //Loop through socket descriptors
+   for(i = 0; i < SOCKET_MAX_COUNT; i++)
+   {
+      //Point to current socket
+      socket = &socketTable[i];
+
+      //TCP socket?
+      if(socket->type == SOCKET_TYPE_STREAM)
+      {
+         //Check current state
+         if(socket->state == TCP_STATE_LISTEN)
+         {
+            //Format the instance identifier
+            n = 0;
+
+            //tcpListenerLocalAddressType and tcpListenerLocalAddress are used
+            //as 1st and 2nd instance identifiers
+            error = mibEncodeIpAddr(index, sizeof(index), &n, &socket->localIpAddr);
+
+            //tcpListenerLocalPort is used as 3rd instance identifier
+            if(!error)
+            {
+               error = mibEncodePort(index, sizeof(index), &n, socket->localPort);
+            }
+
+            //Add the row to the snapshot
+            if(!error)
+            {
+               error = mibAddTableSnapshotRow(&tcpMibBase.tcpListenerSnapshot,
+                  index, n);
+            }
+
+            //Any error to report?
+            if(error)
+            {
+               //The snapshot cannot be used
+               tcpMibBase.tcpListenerSnapshot.valid = FALSE;
+               break;
+            }
+         }
+      }
+   }
+}
+
+#endif
 #endif
@@ -60,6 +60,9 @@ error_t tcpMibGetTcpListenerEntry(const MibObject *object, const uint8_t *oid,
 error_t tcpMibGetNextTcpListenerEntry(const MibObject *object, const uint8_t *oid,
    size_t oidLen, uint8_t *nextOid, size_t *nextOidLen);
 
+void tcpMibTakeTcpConnectionSnapshot(void);
+void tcpMibTakeTcpListenerSnapshot(void);
+
 //C++ guard
 #ifdef __cplusplus
 }
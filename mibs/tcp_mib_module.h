@@ -32,6 +32,7 @@
 #define _TCP_MIB_MODULE_H
 
 //Dependencies
+#include "core/socket.h"
 #include "mibs/mib_common.h"
 
 //TCP MIB module support
@@ -111,6 +112,12 @@ typedef struct
    uint32_t tcpOutRsts;
    uint64_t tcpHCInSegs;
    uint64_t tcpHCOutSegs;
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   MibTableRow tcpConnectionRows[SOCKET_MAX_COUNT];
+   MibTableSnapshot tcpConnectionSnapshot;
+   MibTableRow tcpListenerRows[SOCKET_MAX_COUNT];
+   MibTableSnapshot tcpListenerSnapshot;
+#endif
 } TcpMibBase;
 
 
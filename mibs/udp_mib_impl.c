@@ -58,6 +58,12 @@ error_t udpMibInit(void)
    //Clear UDP MIB base
    osMemset(&udpMibBase, 0, sizeof(udpMibBase));
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Initialize the snapshot of the udpEndpointTable
+   mibInitTableSnapshot(&udpMibBase.udpEndpointSnapshot,
+      udpMibBase.udpEndpointRows, arraysize(udpMibBase.udpEndpointRows));
+#endif
+
    //Successful processing
    return NO_ERROR;
 }
@@ -222,6 +228,22 @@ error_t udpMibGetNextUdpEndpointEntry(const MibObject *object, const uint8_t *oi
    remotePort = 0;
    instance = 1;
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   //Take a new snapshot of the udpEndpointTable if necessary
+   if(!mibIsTableSnapshotValid(&udpMibBase.udpEndpointSnapshot))
+   {
+      udpMibTakeUdpEndpointSnapshot();
+   }
+
+   //Check whether the snapshot holds all the rows of the table
+   if(udpMibBase.udpEndpointSnapshot.valid)
+   {
+      //Successive calls walk the sorted rows of the snapshot
+      return mibGetNextTableSnapshotRow(&udpMibBase.udpEndpointSnapshot, object, oid, oidLen,
+         nextOid, nextOidLen);
+   }
+#endif
+
    //Make sure the buffer is large enough to hold the OID prefix
    if(*nextOidLen < object->oidLen)
       return ERROR_BUFFER_OVERFLOW;
@@ -473,4 +495,133 @@ error_t udpMibGetNextUdpEndpointEntry(const MibObject *object, const uint8_t *oi
    return NO_ERROR;
 }
 
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+
+/**
+ * @brief Take a snapshot of the udpEndpointTable
+ **/
+
+void udpMibTakeUdpEndpointSnapshot(void)
+{
+   error_t error;
+   uint_t i;
+   size_t n;
+   uint8_t index[MIB_TABLE_SNAPSHOT_MAX_INDEX_SIZE];
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Discard the previous snapshot
+   mibClearTableSnapshot(&udpMibBase.udpEndpointSnapshot);
+
+   //Loop through socket descriptors
+   for(i = 0; i < SOCKET_MAX_COUNT && !error; i++)
+   {
+      //Point to current socket
+      Socket *socket = &socketTable[i];
+
+      //UDP socket?
+      if(socket->type == SOCKET_TYPE_DGRAM)
+      {
+         //Format the instance identifier
+         n = 0;
+
+         //udpEndpointLocalAddressType and udpEndpointLocalAddress are used
+         //as 1st and 2nd instance identifiers
+         error = mibEncodeIpAddr(index, sizeof(index), &n, &socket->localIpAddr);
+
+         //udpEndpointLocalPort is used as 3rd instance identifier
+         if(!error)
+         {
+            error = mibEncodePort(index, sizeof(index), &n, socket->localPort);
+         }
+
+         //udpEndpointRemoteAddressType and udpEndpointRemoteAddress are used
+         //as 4th and 5th instance identifiers
+         if(!error)
+         {
+            error = mibEncodeIpAddr(index, sizeof(index), &n,
+               &socket->remoteIpAddr);
+         }
+
+         //udpEndpointRemotePort is used as 6th instance identifier
+         if(!error)
+         {
+            error = mibEncodePort(index, sizeof(index), &n, socket->remotePort);
+         }
+
+         //udpEndpointInstance is used as 7th instance identifier
+         if(!error)
+         {
+            error = mibEncodeUnsigned32(index, sizeof(index), &n, 1);
+         }
+
+         //Add the row to the snapshot
+         if(!error)
+         {
+            error = mibAddTableSnapshotRow(&udpMibBase.udpEndpointSnapshot,
+               index, n);
+         }
+      }
+   }
+
+   //Loop through the UDP callback table
+   for(i = 0; i < UDP_CALLBACK_TABLE_SIZE && !error; i++)
+   {
+      //Point to the current entry
+      UdpRxCallbackEntry *entry = &udpCallbackTable[i];
+
+      //Check whether the entry is currently in use
+      if(entry->callback != NULL)
+      {
+         //Format the instance identifier
+         n = 0;
+
+         //udpEndpointLocalAddressType and udpEndpointLocalAddress are used
+         //as 1st and 2nd instance identifiers
+         error = mibEncodeIpAddr(index, sizeof(index), &n, &IP_ADDR_ANY);
+
+         //udpEndpointLocalPort is used as 3rd instance identifier
+         if(!error)
+         {
+            error = mibEncodePort(index, sizeof(index), &n, entry->port);
+         }
+
+         //udpEndpointRemoteAddressType and udpEndpointRemoteAddress are used
+         //as 4th and 5th instance identifiers
+         if(!error)
+         {
+            error = mibEncodeIpAddr(index, sizeof(index), &n, &IP_ADDR_ANY);
+         }
+
+         //udpEndpointRemotePort is used as 6th instance identifier
+         if(!error)
+         {
+            error = mibEncodePort(index, sizeof(index), &n, 0);
+         }
+
+         //udpEndpointInstance is used as 7th instance identifier
+         if(!error)
+         {
+            error = mibEncodeUnsigned32(index, sizeof(index), &n, 1);
+         }
+
+         //Add the row to the snapshot
+         if(!error)
+         {
+            error = mibAddTableSnapshotRow(&udpMibBase.udpEndpointSnapshot,
+               index, n);
+         }
+      }
+   }
+
+   //Any error to report?
+   if(error)
+   {
+      //The snapshot cannot be used
+      udpMibBase.udpEndpointSnapshot.valid = FALSE;
+   }
+}
+
+#endif
 #endif
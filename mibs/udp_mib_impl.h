@@ -48,6 +48,8 @@ error_t udpMibGetUdpEndpointEntry(const MibObject *object, const uint8_t *oid,
 error_t udpMibGetNextUdpEndpointEntry(const MibObject *object, const uint8_t *oid,
    size_t oidLen, uint8_t *nextOid, size_t *nextOidLen);
 
+void udpMibTakeUdpEndpointSnapshot(void);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -32,6 +32,8 @@
 #define _UDP_MIB_MODULE_H
 
 //Dependencies
+#include "core/socket.h"
+#include "core/udp.h"
 #include "mibs/mib_common.h"
 
 //UDP MIB module support
@@ -68,6 +70,10 @@ typedef struct
    uint32_t udpOutDatagrams;
    uint64_t udpHCInDatagrams;
    uint64_t udpHCOutDatagrams;
+#if (MIB_TABLE_SNAPSHOT_SUPPORT == ENABLED)
+   MibTableRow udpEndpointRows[SOCKET_MAX_COUNT + UDP_CALLBACK_TABLE_SIZE];
+   MibTableSnapshot udpEndpointSnapshot;
+#endif
 } UdpMibBase;
 
 
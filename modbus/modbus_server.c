@@ -303,7 +303,6 @@ void modbusServerTask(ModbusServerContext *context)
    uint_t i;
    systime_t timeout;
    ModbusClientConnection *connection;
-   SocketEventDesc eventDesc[MODBUS_SERVER_MAX_CONNECTIONS + 1];
 
 #if (NET_RTOS_SUPPORT == ENABLED)
    //Task prologue
@@ -317,7 +316,7 @@ void modbusServerTask(ModbusServerContext *context)
       timeout = MODBUS_SERVER_TICK_INTERVAL;
 
       //Clear event descriptor set
-      osMemset(eventDesc, 0, sizeof(eventDesc));
+      osMemset(context->eventDesc, 0, sizeof(context->eventDesc));
 
       //Specify the events the application is interested in
       for(i = 0; i < MODBUS_SERVER_MAX_CONNECTIONS; i++)
@@ -329,10 +328,11 @@ void modbusServerTask(ModbusServerContext *context)
          if(connection->state != MODBUS_CONNECTION_STATE_CLOSED)
          {
             //Register connection events
-            modbusServerRegisterConnectionEvents(connection, &eventDesc[i]);
+            modbusServerRegisterConnectionEvents(connection,
+               &context->eventDesc[i]);
 
             //Check whether the socket is ready for I/O operation
-            if(eventDesc[i].eventFlags != 0)
+            if(context->eventDesc[i].eventFlags != 0)
             {
                //No need to poll the underlying socket for incoming traffic
                timeout = 0;
@@ -341,11 +341,11 @@ void modbusServerTask(ModbusServerContext *context)
       }
 
       //The Modbus/TCP server listens for connection requests on port 502
-      eventDesc[i].socket = context->socket;
-      eventDesc[i].eventMask = SOCKET_EVENT_RX_READY;
+      context->eventDesc[i].socket = context->socket;
+      context->eventDesc[i].eventMask = SOCKET_EVENT_RX_READY;
 
       //Wait for one of the set of sockets to become ready to perform I/O
-      error = socketPoll(eventDesc, MODBUS_SERVER_MAX_CONNECTIONS + 1,
+      error = socketPoll(context->eventDesc, MODBUS_SERVER_MAX_CONNECTIONS + 1,
          &context->event, timeout);
 
       //Check status code
@@ -372,7 +372,7 @@ void modbusServerTask(ModbusServerContext *context)
             if(connection->state != MODBUS_CONNECTION_STATE_CLOSED)
             {
                //Check whether the socket is ready to perform I/O
-               if(eventDesc[i].eventFlags != 0)
+               if(context->eventDesc[i].eventFlags != 0)
                {
                   //Connection event handler
                   modbusServerProcessConnectionEvents(connection);
@@ -381,7 +381,7 @@ void modbusServerTask(ModbusServerContext *context)
          }
 
          //Any connection request received on port 502?
-         if(eventDesc[i].eventFlags != 0)
+         if(context->eventDesc[i].eventFlags != 0)
          {
             //Accept connection request
             modbusServerAcceptConnection(context);
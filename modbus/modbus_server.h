@@ -42,6 +42,20 @@
    #error MODBUS_SERVER_SUPPORT parameter is not valid
 #endif
 
+//Pipelined transaction processing
+#ifndef MODBUS_SERVER_PIPELINING_SUPPORT
+   #define MODBUS_SERVER_PIPELINING_SUPPORT DISABLED
+#elif (MODBUS_SERVER_PIPELINING_SUPPORT != ENABLED && MODBUS_SERVER_PIPELINING_SUPPORT != DISABLED)
+   #error MODBUS_SERVER_PIPELINING_SUPPORT parameter is not valid
+#endif
+
+//Reuse of idle connections when the connection table is full
+#ifndef MODBUS_SERVER_CONNECTION_REUSE_SUPPORT
+   #define MODBUS_SERVER_CONNECTION_REUSE_SUPPORT DISABLED
+#elif (MODBUS_SERVER_CONNECTION_REUSE_SUPPORT != ENABLED && MODBUS_SERVER_CONNECTION_REUSE_SUPPORT != DISABLED)
+   #error MODBUS_SERVER_CONNECTION_REUSE_SUPPORT parameter is not valid
+#endif
+
 //Modbus/TCP security
 #ifndef MODBUS_SERVER_TLS_SUPPORT
    #define MODBUS_SERVER_TLS_SUPPORT DISABLED
@@ -82,6 +96,20 @@
    #error MODBUS_SERVER_TICK_INTERVAL parameter is not valid
 #endif
 
+//Size of the per-connection receive buffer (pipelining)
+#ifndef MODBUS_SERVER_RX_BUFFER_SIZE
+   #define MODBUS_SERVER_RX_BUFFER_SIZE 1024
+#elif (MODBUS_SERVER_RX_BUFFER_SIZE < 260)
+   #error MODBUS_SERVER_RX_BUFFER_SIZE parameter is not valid
+#endif
+
+//Size of the per-connection transmit buffer (pipelining)
+#ifndef MODBUS_SERVER_TX_BUFFER_SIZE
+   #define MODBUS_SERVER_TX_BUFFER_SIZE 1024
+#elif (MODBUS_SERVER_TX_BUFFER_SIZE < 260)
+   #error MODBUS_SERVER_TX_BUFFER_SIZE parameter is not valid
+#endif
+
 //TX buffer size for TLS connections
 #ifndef MODBUS_SERVER_TLS_TX_BUFFER_SIZE
    #define MODBUS_SERVER_TLS_TX_BUFFER_SIZE 2048
@@ -246,21 +274,28 @@ typedef struct
 
 struct _ModbusClientConnection
 {
-   ModbusConnectionState state;                 ///<Connection state
-   ModbusServerContext *context;                ///<Modbus/TCP server context
-   Socket *socket;                              ///<Underlying socket
+   ModbusConnectionState state;                    ///<Connection state
+   ModbusServerContext *context;                   ///<Modbus/TCP server context
+   Socket *socket;                                 ///<Underlying socket
 #if (MODBUS_SERVER_TLS_SUPPORT == ENABLED)
-   TlsContext *tlsContext;                      ///<TLS context
+   TlsContext *tlsContext;                         ///<TLS context
+#endif
+   char_t role[MODBUS_SERVER_MAX_ROLE_LEN + 1];    ///<Client role OID
+   systime_t timestamp;                            ///<Time stamp
+   uint8_t requestAdu[MODBUS_MAX_ADU_SIZE];        ///<Request ADU
+   size_t requestAduLen;                           ///<Length of the request ADU, in bytes
+   size_t requestAduPos;                           ///<Current position in the request ADU
+   uint8_t requestUnitId;                          ///<Unit identifier
+   uint8_t responseAdu[MODBUS_MAX_ADU_SIZE];       ///<Response ADU
+   size_t responseAduLen;                          ///<Length of the response ADU, in bytes
+   size_t responseAduPos;                          ///<Current position in the response ADU
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED)
+   uint8_t rxBuffer[MODBUS_SERVER_RX_BUFFER_SIZE]; ///<Receive buffer
+   size_t rxBufferLen;                             ///<Number of bytes available in the receive buffer
+   uint8_t txBuffer[MODBUS_SERVER_TX_BUFFER_SIZE]; ///<Transmit buffer
+   size_t txBufferLen;                             ///<Number of bytes available in the transmit buffer
+   size_t txBufferPos;                             ///<Current position in the transmit buffer
 #endif
-   char_t role[MODBUS_SERVER_MAX_ROLE_LEN + 1]; ///<Client role OID
-   systime_t timestamp;                         ///<Time stamp
-   uint8_t requestAdu[MODBUS_MAX_ADU_SIZE];     ///<Request ADU
-   size_t requestAduLen;                        ///<Length of the request ADU, in bytes
-   size_t requestAduPos;                        ///<Current position in the request ADU
-   uint8_t requestUnitId;                       ///<Unit identifier
-   uint8_t responseAdu[MODBUS_MAX_ADU_SIZE];    ///<Response ADU
-   size_t responseAduLen;                       ///<Length of the response ADU, in bytes
-   size_t responseAduPos;                       ///<Current position in the response ADU
 };
 
 
@@ -281,6 +316,7 @@ struct _ModbusServerContext
 #endif
    Socket *socket;                                                   ///<Listening socket
    ModbusClientConnection connection[MODBUS_SERVER_MAX_CONNECTIONS]; ///<Client connections
+   SocketEventDesc eventDesc[MODBUS_SERVER_MAX_CONNECTIONS + 1];     ///<The events the application is interested in
 #if (MODBUS_SERVER_TLS_SUPPORT == ENABLED && TLS_TICKET_SUPPORT == ENABLED)
    TlsTicketContext tlsTicketContext;                                ///<TLS ticket encryption context
 #endif
@@ -36,6 +36,7 @@
 #include "modbus/modbus_server_pdu.h"
 #include "modbus/modbus_server_security.h"
 #include "modbus/modbus_server_transport.h"
+#include "modbus/modbus_server_pipeline.h"
 #include "modbus/modbus_server_misc.h"
 #include "debug.h"
 
@@ -166,14 +167,19 @@ void modbusServerRegisterConnectionEvents(ModbusClientConnection *connection,
 void modbusServerProcessConnectionEvents(ModbusClientConnection *connection)
 {
    error_t error;
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == DISABLED)
    size_t n;
    ModbusServerContext *context;
+#endif
 
    //Initialize status code
    error = NO_ERROR;
 
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == DISABLED)
    //Point to the Modbus/TCP server context
    context = connection->context;
+#endif
+
    //Update time stamp
    connection->timestamp = osGetSystemTime();
 
@@ -197,6 +203,10 @@ void modbusServerProcessConnectionEvents(ModbusClientConnection *connection)
    }
    else if(connection->state == MODBUS_CONNECTION_STATE_RECEIVE)
    {
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED)
+      //Receive and process pipelined Modbus requests
+      error = modbusServerReceivePipelinedRequests(connection);
+#else
       //Receive Modbus request
       if(connection->requestAduPos < sizeof(ModbusHeader))
       {
@@ -260,9 +270,14 @@ void modbusServerProcessConnectionEvents(ModbusClientConnection *connection)
          //Just for sanity
          error = ERROR_WRONG_STATE;
       }
+#endif
    }
    else if(connection->state == MODBUS_CONNECTION_STATE_SEND)
    {
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED)
+      //Send pipelined Modbus responses
+      error = modbusServerSendPipelinedResponses(connection);
+#else
       //Send Modbus response
       if(connection->responseAduPos < connection->responseAduLen)
       {
@@ -295,6 +310,7 @@ void modbusServerProcessConnectionEvents(ModbusClientConnection *connection)
          //Just for sanity
          error = ERROR_WRONG_STATE;
       }
+#endif
    }
    else if(connection->state == MODBUS_CONNECTION_STATE_SHUTDOWN_TLS ||
       connection->state == MODBUS_CONNECTION_STATE_SHUTDOWN_TX)
@@ -0,0 +1,261 @@
+/**
+ * @file modbus_server_pipeline.c
+ * @brief Modbus/TCP server pipelined transaction processing
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+//Switch to the appropriate trace level
+#define TRACE_LEVEL MODBUS_TRACE_LEVEL
+
+//Dependencies
+#include "modbus/modbus_server.h"
+#include "modbus/modbus_server_pdu.h"
+#include "modbus/modbus_server_transport.h"
+#include "modbus/modbus_server_pipeline.h"
+#include "modbus/modbus_server_misc.h"
+#include "debug.h"
+
+//Check TCP/IP stack configuration
+#if (MODBUS_SERVER_SUPPORT == ENABLED && MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED)
+
+
+/**
+ * @brief Receive pipelined Modbus requests
+ *
+ * As many bytes as possible are read from the socket in a single call, so
+ * that several request ADUs sent back-to-back by the client can be handled
+ * without polling the socket again
+ *
+ * @param[in] connection Pointer to the client connection
+ * @return Error code
+ **/
+
+error_t modbusServerReceivePipelinedRequests(ModbusClientConnection *connection)
+{
+   error_t error;
+   size_t n;
+
+   //Any room left in the receive buffer?
+   if(connection->rxBufferLen < MODBUS_SERVER_RX_BUFFER_SIZE)
+   {
+      //Receive more data
+      error = modbusServerReceiveData(connection,
+         connection->rxBuffer + connection->rxBufferLen,
+         MODBUS_SERVER_RX_BUFFER_SIZE - connection->rxBufferLen, &n, 0);
+
+      //Check status code
+      if(error == NO_ERROR)
+      {
+         //Update the length of the receive buffer
+         connection->rxBufferLen += n;
+      }
+      else if(error == ERROR_END_OF_STREAM)
+      {
+         //Initiate a graceful connection shutdown
+         return modbusServerShutdownConnection(connection);
+      }
+      else
+      {
+         //Exit immediately
+         return error;
+      }
+   }
+
+   //Process the request ADUs that have been completely received
+   return modbusServerProcessPipelinedRequests(connection);
+}
+
+
+/**
+ * @brief Process pipelined Modbus requests
+ *
+ * Request ADUs are processed in the order they were received. The resulting
+ * response ADUs are appended to the transmit buffer and sent in a single
+ * write once no further request can be processed
+ *
+ * @param[in] connection Pointer to the client connection
+ * @return Error code
+ **/
+
+error_t modbusServerProcessPipelinedRequests(ModbusClientConnection *connection)
+{
+   error_t error;
+   size_t pos;
+   ModbusServerContext *context;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Point to the Modbus/TCP server context
+   context = connection->context;
+
+   //Process as many request ADUs as possible
+   for(pos = 0; !error; pos += connection->requestAduLen)
+   {
+      //Make sure the transmit buffer can hold the largest response ADU
+      if((connection->txBufferLen + MODBUS_MAX_ADU_SIZE) >
+         MODBUS_SERVER_TX_BUFFER_SIZE)
+      {
+         break;
+      }
+
+      //Incomplete MBAP header?
+      if((connection->rxBufferLen - pos) < sizeof(ModbusHeader))
+         break;
+
+      //Copy the MBAP header
+      osMemcpy(connection->requestAdu, connection->rxBuffer + pos,
+         sizeof(ModbusHeader));
+
+      //Parse MBAP header
+      connection->requestAduPos = sizeof(ModbusHeader);
+      error = modbusServerParseMbapHeader(connection);
+      //Any error to report?
+      if(error)
+         break;
+
+      //Incomplete request ADU?
+      if((connection->rxBufferLen - pos) < connection->requestAduLen)
+         break;
+
+      //Copy the request ADU
+      osMemcpy(connection->requestAdu, connection->rxBuffer + pos,
+         connection->requestAduLen);
+
+      //The request ADU is now complete
+      connection->requestAduPos = connection->requestAduLen;
+
+      //Check unit identifier
+      if(context->settings.unitId == 0 ||
+         context->settings.unitId == 255 ||
+         context->settings.unitId == connection->requestUnitId)
+      {
+         //Process Modbus request
+         error = modbusServerProcessRequest(connection);
+
+         //Check whether a response ADU has been formatted
+         if(!error && connection->state == MODBUS_CONNECTION_STATE_SEND)
+         {
+            //Append the response ADU to the transmit buffer
+            osMemcpy(connection->txBuffer + connection->txBufferLen,
+               connection->responseAdu, connection->responseAduLen);
+
+            //Update the length of the transmit buffer
+            connection->txBufferLen += connection->responseAduLen;
+         }
+      }
+      else
+      {
+         //Debug message
+         TRACE_INFO("Modbus Server: Request discarded (unit ID %" PRIu8 ")...\r\n",
+            connection->requestUnitId);
+      }
+
+      //The response ADU is sent from the transmit buffer
+      connection->state = MODBUS_CONNECTION_STATE_RECEIVE;
+   }
+
+   //Discard the request ADUs that have been processed
+   if(pos > 0)
+   {
+      //Move the remaining data to the beginning of the receive buffer
+      osMemmove(connection->rxBuffer, connection->rxBuffer + pos,
+         connection->rxBufferLen - pos);
+
+      //Update the length of the receive buffer
+      connection->rxBufferLen -= pos;
+   }
+
+   //Flush request ADU
+   connection->requestAduLen = 0;
+   connection->requestAduPos = 0;
+
+   //Check status code
+   if(!error)
+   {
+      //Any response ADU to send?
+      if(connection->txBufferLen > 0)
+      {
+         //Rewind to the beginning of the transmit buffer
+         connection->txBufferPos = 0;
+         //Send the response ADUs to the client
+         connection->state = MODBUS_CONNECTION_STATE_SEND;
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Send pipelined Modbus responses
+ * @param[in] connection Pointer to the client connection
+ * @return Error code
+ **/
+
+error_t modbusServerSendPipelinedResponses(ModbusClientConnection *connection)
+{
+   error_t error;
+   size_t n;
+
+   //Sanity check
+   if(connection->txBufferPos >= connection->txBufferLen)
+      return ERROR_WRONG_STATE;
+
+   //Send more data
+   error = modbusServerSendData(connection,
+      connection->txBuffer + connection->txBufferPos,
+      connection->txBufferLen - connection->txBufferPos, &n,
+      SOCKET_FLAG_NO_DELAY);
+
+   //Check status code
+   if(error == NO_ERROR || error == ERROR_TIMEOUT)
+   {
+      //Advance data pointer
+      connection->txBufferPos += n;
+
+      //Response ADUs successfully sent?
+      if(connection->txBufferPos >= connection->txBufferLen)
+      {
+         //Flush transmit buffer
+         connection->txBufferLen = 0;
+         connection->txBufferPos = 0;
+
+         //Wait for the next Modbus request
+         connection->state = MODBUS_CONNECTION_STATE_RECEIVE;
+
+         //Process the request ADUs that are already buffered, if any
+         error = modbusServerProcessPipelinedRequests(connection);
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * @file modbus_server_pipeline.h
+ * @brief Modbus/TCP server pipelined transaction processing
+ *
+ * @section License
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ *
+ * Copyright (C) 2010-2022 Oryx Embedded SARL. All rights reserved.
+ *
+ * This file is part of CycloneTCP Open.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @author Oryx Embedded SARL (www.oryx-embedded.com)
+ * @version 2.1.4
+ **/
+
+#ifndef _MODBUS_SERVER_PIPELINE_H
+#define _MODBUS_SERVER_PIPELINE_H
+
+//Dependencies
+#include "core/net.h"
+#include "modbus/modbus_server.h"
+
+//C++ guard
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//Modbus/TCP server related functions
+error_t modbusServerReceivePipelinedRequests(ModbusClientConnection *connection);
+error_t modbusServerProcessPipelinedRequests(ModbusClientConnection *connection);
+error_t modbusServerSendPipelinedResponses(ModbusClientConnection *connection);
+
+//C++ guard
+#ifdef __cplusplus
+}
+#endif
+
+#endif
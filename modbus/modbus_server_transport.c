@@ -79,6 +79,25 @@ void modbusServerAcceptConnection(ModbusServerContext *context)
          }
       }
 
+#if (MODBUS_SERVER_CONNECTION_REUSE_SUPPORT == ENABLED)
+      //The connection table runs out of space?
+      if(connection == NULL)
+      {
+         //Reuse the least recently used idle connection, if any
+         connection = modbusServerGetIdleConnection(context);
+
+         //Any idle connection found?
+         if(connection != NULL)
+         {
+            //Debug message
+            TRACE_INFO("Modbus Server: Connection table full, reusing idle connection...\r\n");
+
+            //Close the idle connection to make room for the new client
+            modbusServerCloseConnection(connection);
+         }
+      }
+#endif
+
       //If the connection table runs out of space, then the client's connection
       //request is rejected
       if(connection != NULL)
@@ -138,6 +157,51 @@ void modbusServerAcceptConnection(ModbusServerContext *context)
 }
 
 
+/**
+ * @brief Find the least recently used idle connection
+ * @param[in] context Pointer to the Modbus/TCP server context
+ * @return Pointer to the idle connection, if any
+ **/
+
+ModbusClientConnection *modbusServerGetIdleConnection(ModbusServerContext *context)
+{
+   uint_t i;
+   ModbusClientConnection *connection;
+   ModbusClientConnection *oldestConnection;
+
+   //Initialize pointer
+   oldestConnection = NULL;
+
+   //Loop through the connection table
+   for(i = 0; i < MODBUS_SERVER_MAX_CONNECTIONS; i++)
+   {
+      //Point to the current connection
+      connection = &context->connection[i];
+
+      //A connection is idle when it waits for a new request and no partial
+      //request has been received
+      if(connection->state == MODBUS_CONNECTION_STATE_RECEIVE &&
+         connection->requestAduPos == 0)
+      {
+#if (MODBUS_SERVER_PIPELINING_SUPPORT == ENABLED)
+         //Any buffered request data?
+         if(connection->rxBufferLen > 0)
+            continue;
+#endif
+         //Keep track of the least recently used connection
+         if(oldestConnection == NULL ||
+            timeCompare(connection->timestamp, oldestConnection->timestamp) < 0)
+         {
+            oldestConnection = connection;
+         }
+      }
+   }
+
+   //Return a pointer to the idle connection, if any
+   return oldestConnection;
+}
+
+
 /**
  * @brief Shutdown network connection
  * @param[in] connection Pointer to the client connection
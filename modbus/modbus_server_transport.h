@@ -43,6 +43,8 @@ extern "C" {
 //Modbus/TCP server related functions
 void modbusServerAcceptConnection(ModbusServerContext *context);
 
+ModbusClientConnection *modbusServerGetIdleConnection(ModbusServerContext *context);
+
 error_t modbusServerShutdownConnection(ModbusClientConnection *connection);
 void modbusServerCloseConnection(ModbusClientConnection *connection);
 
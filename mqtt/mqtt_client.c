@@ -436,6 +436,37 @@ error_t mqttClientSetWillMessage(MqttClientContext *context, const char_t *topic
 }
 
 
+/**
+ * @brief Enable or disable the coalescing of QoS 0 messages
+ *
+ * When batching is enabled, small QoS 0 PUBLISH packets are accumulated and
+ * sent with a single transport write by mqttClientFlush, mqttClientTask or
+ * before any other control packet
+ *
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] enable Enable or disable batching
+ * @return Error code
+ **/
+
+error_t mqttClientEnableBatching(MqttClientContext *context, bool_t enable)
+{
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   //Make sure the MQTT client context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Save setting
+   context->batching = enable;
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Bind the MQTT client to a particular network interface
  * @param[in] context Pointer to the MQTT client context
@@ -497,6 +528,11 @@ error_t mqttClientConnect(MqttClientContext *context,
             TRACE_INFO("MQTT: Connecting to server %s port %" PRIu16 "...\r\n",
                ipAddrToString(serverIpAddr, NULL), serverPort);
 
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+            //Discard the messages coalesced on a previous connection
+            context->batchPos = 0;
+            context->batchLen = 0;
+#endif
             //The network connection is open
             mqttClientChangeState(context, MQTT_CLIENT_STATE_CONNECTING);
             //Save current time
@@ -561,6 +597,12 @@ error_t mqttClientConnect(MqttClientContext *context,
          context->packetType = MQTT_PACKET_TYPE_INVALID;
          //A CONNACK packet has been received
          mqttClientChangeState(context, MQTT_CLIENT_STATE_IDLE);
+
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+         //Retransmit the messages that have not been acknowledged, or discard
+         //them if a new session is started
+         error = mqttClientResumeInflightMsgs(context, cleanSession);
+#endif
       }
       else if(context->state == MQTT_CLIENT_STATE_IDLE)
       {
@@ -635,6 +677,18 @@ error_t mqttClientPublish(MqttClientContext *context,
             error = mqttClientFormatPublish(context, topic, message,
                length, qos, retain);
 
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+            //Small QoS 0 messages may be coalesced
+            if(!error && qos == MQTT_QOS_LEVEL_0 &&
+               mqttClientCanBatchPacket(context))
+            {
+               //Append the PUBLISH packet to the batch buffer
+               error = mqttClientBatchPacket(context);
+               //The packet will be sent later
+               break;
+            }
+#endif
+
             //Check status code
             if(!error)
             {
@@ -725,6 +779,202 @@ error_t mqttClientPublish(MqttClientContext *context,
 }
 
 
+/**
+ * @brief Publish message without waiting for the acknowledgment
+ *
+ * QoS 1 and QoS 2 messages are kept in a bounded window until the
+ * PUBACK/PUBCOMP packet is processed by mqttClientTask. The completion
+ * callback is then invoked with the user-defined parameter. When the window
+ * is full, the function processes incoming packets until a slot is released
+ *
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] topic Topic name
+ * @param[in] message Message payload
+ * @param[in] length Length of the message payload
+ * @param[in] qos QoS level to be used when publishing the message
+ * @param[in] retain This flag specifies if the message is to be retained
+ * @param[in] param User-defined parameter passed to the completion callback
+ * @param[out] packetId Packet identifier used to send the PUBLISH packet
+ * @return Error code
+ **/
+
+error_t mqttClientPublishAsync(MqttClientContext *context,
+   const char_t *topic, const void *message, size_t length,
+   MqttQosLevel qos, bool_t retain, void *param, uint16_t *packetId)
+{
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   error_t error;
+   bool_t waiting;
+   MqttClientInflightMsg *msg;
+
+   //Check parameters
+   if(context == NULL || topic == NULL)
+      return ERROR_INVALID_PARAMETER;
+   if(message == NULL && length != 0)
+      return ERROR_INVALID_PARAMETER;
+
+   //Initialize status code
+   error = NO_ERROR;
+   //The window is not full yet
+   waiting = FALSE;
+
+   //Send PUBLISH packet
+   while(!error)
+   {
+      //Check current state
+      if(context->state == MQTT_CLIENT_STATE_IDLE)
+      {
+         //Check for transmission completion
+         if(context->packetType == MQTT_PACKET_TYPE_INVALID)
+         {
+            //QoS 0 messages are not acknowledged
+            if(qos != MQTT_QOS_LEVEL_0)
+            {
+               //Allocate a slot in the in-flight window
+               msg = mqttClientAllocInflightMsg(context);
+
+               //The window is full?
+               if(msg == NULL)
+               {
+                  //Save the time at which the client started waiting
+                  if(!waiting)
+                  {
+                     context->startTime = osGetSystemTime();
+                     waiting = TRUE;
+                  }
+
+                  //Process incoming acknowledgments
+                  error = mqttClientProcessEvents(context,
+                     context->settings.timeout);
+
+                  //Try again
+                  continue;
+               }
+            }
+            else
+            {
+               //No slot is required
+               msg = NULL;
+            }
+
+            //Format PUBLISH packet
+            error = mqttClientFormatPublish(context, topic, message,
+               length, qos, retain);
+
+            //Check status code
+            if(!error && msg != NULL)
+            {
+               //The packet must be kept until it is acknowledged
+               if(context->payloadLen == 0 &&
+                  context->packetLen <= MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE)
+               {
+                  //Save a copy of the PUBLISH packet
+                  osMemcpy(msg->packet, context->packet, context->packetLen);
+                  msg->packetLen = context->packetLen;
+                  msg->packetId = context->packetId;
+                  msg->param = param;
+
+                  //Wait for PUBACK or PUBREC packet
+                  if(qos == MQTT_QOS_LEVEL_1)
+                     msg->state = MQTT_CLIENT_MSG_STATE_WAIT_PUBACK;
+                  else
+                     msg->state = MQTT_CLIENT_MSG_STATE_WAIT_PUBREC;
+               }
+               else
+               {
+                  //Report an error
+                  error = ERROR_INVALID_LENGTH;
+               }
+            }
+
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+            //Small QoS 0 messages may be coalesced
+            if(!error && qos == MQTT_QOS_LEVEL_0 &&
+               mqttClientCanBatchPacket(context))
+            {
+               //Append the PUBLISH packet to the batch buffer
+               error = mqttClientBatchPacket(context);
+               //The packet will be sent later
+               break;
+            }
+#endif
+
+            //Check status code
+            if(!error)
+            {
+               //Save the packet identifier used to send the PUBLISH packet
+               if(packetId != NULL)
+                  *packetId = context->packetId;
+
+               //Debug message
+               TRACE_INFO("MQTT: Sending PUBLISH packet (%" PRIuSIZE " bytes)...\r\n",
+                  context->packetLen);
+
+               //Dump the contents of the PUBLISH packet
+               TRACE_DEBUG_ARRAY("  ", context->packet, context->packetLen);
+
+               //Save the type of the MQTT packet to be sent
+               context->packetType = MQTT_PACKET_TYPE_PUBLISH;
+               //Point to the beginning of the packet
+               context->packetPos = 0;
+
+               //Send PUBLISH packet
+               mqttClientChangeState(context, MQTT_CLIENT_STATE_SENDING_PACKET);
+               //Save the time at which the packet was sent
+               context->startTime = osGetSystemTime();
+            }
+         }
+         else
+         {
+            //Reset packet type
+            context->packetType = MQTT_PACKET_TYPE_INVALID;
+            //We are done
+            break;
+         }
+      }
+      else if(context->state == MQTT_CLIENT_STATE_SENDING_PACKET)
+      {
+         //Send more data
+         error = mqttClientProcessEvents(context, context->settings.timeout);
+      }
+      else if(context->state == MQTT_CLIENT_STATE_PACKET_SENT)
+      {
+         //The acknowledgment will be processed by mqttClientTask
+         mqttClientChangeState(context, MQTT_CLIENT_STATE_IDLE);
+      }
+      else if(context->state == MQTT_CLIENT_STATE_RECEIVING_PACKET)
+      {
+         //Receive more data
+         error = mqttClientProcessEvents(context, context->settings.timeout);
+      }
+      else if(context->state == MQTT_CLIENT_STATE_PACKET_RECEIVED)
+      {
+         //A packet has been received
+         mqttClientChangeState(context, MQTT_CLIENT_STATE_IDLE);
+      }
+      else
+      {
+         //Invalid state
+         error = ERROR_NOT_CONNECTED;
+      }
+   }
+
+   //Check status code
+   if(error == ERROR_WOULD_BLOCK || error == ERROR_TIMEOUT)
+   {
+      //Check whether the timeout has elapsed
+      error = mqttClientCheckTimeout(context);
+   }
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Subscribe to topic
  * @param[in] context Pointer to the MQTT client context
@@ -1067,6 +1317,52 @@ error_t mqttClientPing(MqttClientContext *context, systime_t *rtt)
 }
 
 
+/**
+ * @brief Send the QoS 0 messages that have been coalesced
+ * @param[in] context Pointer to the MQTT client context
+ * @return Error code
+ **/
+
+error_t mqttClientFlush(MqttClientContext *context)
+{
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   error_t error;
+
+   //Make sure the MQTT client context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //The batch cannot be interleaved with a partially sent packet
+   if(context->state == MQTT_CLIENT_STATE_SENDING_PACKET)
+      return ERROR_WRONG_STATE;
+
+   //Save the time at which the flush operation started
+   if(context->batchPos == 0)
+      context->startTime = osGetSystemTime();
+
+   //Send the pending data
+   error = mqttClientFlushBatch(context);
+
+   //Check status code
+   if(error == ERROR_WOULD_BLOCK || error == ERROR_TIMEOUT)
+   {
+      //Check whether the timeout has elapsed
+      error = mqttClientCheckTimeout(context);
+   }
+
+   //Return status code
+   return error;
+#else
+   //Make sure the MQTT client context is valid
+   if(context == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+   //Messages are never coalesced
+   return NO_ERROR;
+#endif
+}
+
+
 /**
  * @brief Process MQTT client events
  * @param[in] context Pointer to the MQTT client context
@@ -1082,6 +1378,19 @@ error_t mqttClientTask(MqttClientContext *context, systime_t timeout)
    if(context == NULL)
       return ERROR_INVALID_PARAMETER;
 
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   //Coalesced messages are sent at the latest when the task runs
+   if(context->state == MQTT_CLIENT_STATE_IDLE ||
+      context->state == MQTT_CLIENT_STATE_PACKET_SENT)
+   {
+      //Send the pending data
+      error = mqttClientFlushBatch(context);
+      //Any error to report?
+      if(error)
+         return error;
+   }
+#endif
+
    //Process MQTT client events
    error = mqttClientProcessEvents(context, timeout);
 
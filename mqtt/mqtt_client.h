@@ -56,6 +56,20 @@
    #error MQTT_CLIENT_WS_SUPPORT parameter is not valid
 #endif
 
+//Asynchronous publishing support
+#ifndef MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT
+   #define MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT DISABLED
+#elif (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT != ENABLED && MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT != DISABLED)
+   #error MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT parameter is not valid
+#endif
+
+//Coalescing of QoS 0 messages
+#ifndef MQTT_CLIENT_BATCH_SUPPORT
+   #define MQTT_CLIENT_BATCH_SUPPORT DISABLED
+#elif (MQTT_CLIENT_BATCH_SUPPORT != ENABLED && MQTT_CLIENT_BATCH_SUPPORT != DISABLED)
+   #error MQTT_CLIENT_BATCH_SUPPORT parameter is not valid
+#endif
+
 //Default keep-alive time interval, in seconds
 #ifndef MQTT_CLIENT_DEFAULT_KEEP_ALIVE
    #define MQTT_CLIENT_DEFAULT_KEEP_ALIVE 0
@@ -126,6 +140,27 @@
    #error MQTT_CLIENT_BUFFER_SIZE parameter is not valid
 #endif
 
+//Maximum number of QoS 1 and QoS 2 messages in flight
+#ifndef MQTT_CLIENT_MAX_INFLIGHT_MSGS
+   #define MQTT_CLIENT_MAX_INFLIGHT_MSGS 8
+#elif (MQTT_CLIENT_MAX_INFLIGHT_MSGS < 1 || MQTT_CLIENT_MAX_INFLIGHT_MSGS > 256)
+   #error MQTT_CLIENT_MAX_INFLIGHT_MSGS parameter is not valid
+#endif
+
+//Maximum size of a PUBLISH packet that can be kept for retransmission
+#ifndef MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE
+   #define MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE 256
+#elif (MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE < 8)
+   #error MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE parameter is not valid
+#endif
+
+//Size of the buffer used to coalesce QoS 0 messages
+#ifndef MQTT_CLIENT_BATCH_BUFFER_SIZE
+   #define MQTT_CLIENT_BATCH_BUFFER_SIZE 1460
+#elif (MQTT_CLIENT_BATCH_BUFFER_SIZE < 64)
+   #error MQTT_CLIENT_BATCH_BUFFER_SIZE parameter is not valid
+#endif
+
 //TLS supported?
 #if (MQTT_CLIENT_TLS_SUPPORT == ENABLED)
    #include "core/crypto.h"
@@ -238,6 +273,14 @@ typedef void (*MqttClientUnsubAckCallback)(MqttClientContext *context,
 typedef void (*MqttClientPingRespCallback)(MqttClientContext *context);
 
 
+/**
+ * @brief Asynchronous publication complete callback
+ **/
+
+typedef void (*MqttClientPublishCompleteCallback)(MqttClientContext *context,
+   uint16_t packetId, error_t status, void *param);
+
+
 //TLS supported?
 #if (MQTT_CLIENT_TLS_SUPPORT == ENABLED)
 
@@ -265,6 +308,33 @@ typedef struct
 } MqttClientWillMessage;
 
 
+/**
+ * @brief State of an in-flight message
+ **/
+
+typedef enum
+{
+   MQTT_CLIENT_MSG_STATE_UNUSED       = 0,
+   MQTT_CLIENT_MSG_STATE_WAIT_PUBACK  = 1,
+   MQTT_CLIENT_MSG_STATE_WAIT_PUBREC  = 2,
+   MQTT_CLIENT_MSG_STATE_WAIT_PUBCOMP = 3
+} MqttClientMsgState;
+
+
+/**
+ * @brief In-flight message
+ **/
+
+typedef struct
+{
+   MqttClientMsgState state;                          ///<State of the message
+   uint16_t packetId;                                 ///<Packet identifier
+   uint8_t packet[MQTT_CLIENT_MAX_INFLIGHT_MSG_SIZE]; ///<Copy of the PUBLISH packet
+   size_t packetLen;                                  ///<Length of the PUBLISH packet
+   void *param;                                       ///<User-defined parameter
+} MqttClientInflightMsg;
+
+
 /**
  * @brief MQTT client callback functions
  **/
@@ -280,6 +350,9 @@ typedef struct
    MqttClientPubAckCallback subAckCallback;     ///<SUBACK message received callback
    MqttClientPubAckCallback unsubAckCallback;   ///<UNSUBACK message received callback
    MqttClientPingRespCallback pingRespCallback; ///<PINGRESP message received callback
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   MqttClientPublishCompleteCallback publishCompleteCallback; ///<Asynchronous publication complete callback
+#endif
 #if (MQTT_CLIENT_TLS_SUPPORT == ENABLED)
    MqttClientTlsInitCallback tlsInitCallback;   ///<TLS initialization callback
 #endif
@@ -334,6 +407,18 @@ struct _MqttClientContext
    MqttPacketType packetType;               ///<Control packet type
    uint16_t packetId;                       ///<Packet identifier
    size_t remainingLen;                     ///<Length of the variable header and payload
+   const uint8_t *payload;                  ///<Payload sent directly from the application buffer
+   size_t payloadPos;                       ///<Current position in the payload
+   size_t payloadLen;                       ///<Length of the payload that does not fit in the buffer
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   bool_t batching;                         ///<Coalescing of QoS 0 messages
+   uint8_t batchBuffer[MQTT_CLIENT_BATCH_BUFFER_SIZE]; ///<Coalesced QoS 0 messages
+   size_t batchPos;                         ///<Current position in the batch buffer
+   size_t batchLen;                         ///<Number of bytes in the batch buffer
+#endif
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   MqttClientInflightMsg inflightMsgs[MQTT_CLIENT_MAX_INFLIGHT_MSGS]; ///<QoS 1 and QoS 2 messages waiting for acknowledgment
+#endif
 };
 
 
@@ -374,6 +459,8 @@ error_t mqttClientSetAuthInfo(MqttClientContext *context,
 error_t mqttClientSetWillMessage(MqttClientContext *context, const char_t *topic,
    const void *message, size_t length, MqttQosLevel qos, bool_t retain);
 
+error_t mqttClientEnableBatching(MqttClientContext *context, bool_t enable);
+
 error_t mqttClientBindToInterface(MqttClientContext *context,
    NetInterface *interface);
 
@@ -384,6 +471,10 @@ error_t mqttClientPublish(MqttClientContext *context,
    const char_t *topic, const void *message, size_t length,
    MqttQosLevel qos, bool_t retain, uint16_t *packetId);
 
+error_t mqttClientPublishAsync(MqttClientContext *context,
+   const char_t *topic, const void *message, size_t length,
+   MqttQosLevel qos, bool_t retain, void *param, uint16_t *packetId);
+
 error_t mqttClientSubscribe(MqttClientContext *context,
    const char_t *topic, MqttQosLevel qos, uint16_t *packetId);
 
@@ -392,6 +483,7 @@ error_t mqttClientUnsubscribe(MqttClientContext *context,
 
 error_t mqttClientPing(MqttClientContext *context, systime_t *rtt);
 
+error_t mqttClientFlush(MqttClientContext *context);
 error_t mqttClientTask(MqttClientContext *context, systime_t timeout);
 
 error_t mqttClientDisconnect(MqttClientContext *context);
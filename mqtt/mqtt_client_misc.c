@@ -68,6 +68,7 @@ error_t mqttClientProcessEvents(MqttClientContext *context, systime_t timeout)
 {
    error_t error;
    size_t n;
+   uint_t flags;
 
    //It is the responsibility of the client to ensure that the interval
    //between control packets being sent does not exceed the keep-alive value
@@ -119,18 +120,49 @@ error_t mqttClientProcessEvents(MqttClientContext *context, systime_t timeout)
       }
       else if(context->state == MQTT_CLIENT_STATE_SENDING_PACKET)
       {
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+         //Coalesced messages must be sent first to preserve ordering
+         if(context->batchPos < context->batchLen)
+         {
+            //Send the pending data
+            error = mqttClientFlushBatch(context);
+         }
+         else
+#endif
          //Any remaining data to be sent?
          if(context->packetPos < context->packetLen)
          {
+            //The header is held back so that it can be coalesced with the
+            //payload that immediately follows
+            if(context->payloadLen > 0)
+               flags = SOCKET_FLAG_DELAY;
+            else
+               flags = 0;
+
             //Send more data
             error = mqttClientSendData(context, context->packet + context->packetPos,
-               context->packetLen - context->packetPos, &n, 0);
+               context->packetLen - context->packetPos, &n, flags);
 
             //Advance data pointer
             context->packetPos += n;
          }
+         //Any payload data to be sent from the application buffer?
+         else if(context->payloadPos < context->payloadLen)
+         {
+            //Send more data
+            error = mqttClientSendData(context, context->payload + context->payloadPos,
+               context->payloadLen - context->payloadPos, &n, 0);
+
+            //Advance data pointer
+            context->payloadPos += n;
+         }
          else
          {
+            //The application buffer is no longer referenced
+            context->payload = NULL;
+            context->payloadPos = 0;
+            context->payloadLen = 0;
+
             //Save the time at which the message was sent
             context->keepAliveTimestamp = osGetSystemTime();
 
@@ -635,4 +667,308 @@ error_t mqttClientCheckTimeout(MqttClientContext *context)
 #endif
 }
 
+
+/**
+ * @brief Allocate a slot in the in-flight window
+ * @param[in] context Pointer to the MQTT client context
+ * @return Pointer to the free slot, if any
+ **/
+
+MqttClientInflightMsg *mqttClientAllocInflightMsg(MqttClientContext *context)
+{
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   uint_t i;
+
+   //Loop through the in-flight window
+   for(i = 0; i < MQTT_CLIENT_MAX_INFLIGHT_MSGS; i++)
+   {
+      //Check whether the current slot is free
+      if(context->inflightMsgs[i].state == MQTT_CLIENT_MSG_STATE_UNUSED)
+         return &context->inflightMsgs[i];
+   }
+#endif
+
+   //The window is full
+   return NULL;
+}
+
+
+/**
+ * @brief Search the in-flight window for a given packet identifier
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] packetId Packet identifier
+ * @return Pointer to the matching in-flight message, if any
+ **/
+
+MqttClientInflightMsg *mqttClientFindInflightMsg(MqttClientContext *context,
+   uint16_t packetId)
+{
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   uint_t i;
+   MqttClientInflightMsg *msg;
+
+   //Loop through the in-flight window
+   for(i = 0; i < MQTT_CLIENT_MAX_INFLIGHT_MSGS; i++)
+   {
+      //Point to the current slot
+      msg = &context->inflightMsgs[i];
+
+      //Matching packet identifier?
+      if(msg->state != MQTT_CLIENT_MSG_STATE_UNUSED && msg->packetId == packetId)
+         return msg;
+   }
+#endif
+
+   //No matching message
+   return NULL;
+}
+
+
+/**
+ * @brief Release an in-flight message and notify the application
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] msg Pointer to the in-flight message
+ * @param[in] status Completion status
+ **/
+
+void mqttClientCompleteInflightMsg(MqttClientContext *context,
+   MqttClientInflightMsg *msg, error_t status)
+{
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   //Release the slot before invoking the callback, so that the application
+   //can publish another message from within the callback
+   msg->state = MQTT_CLIENT_MSG_STATE_UNUSED;
+
+   //Any registered callback?
+   if(context->callbacks.publishCompleteCallback != NULL)
+   {
+      //Invoke user callback function
+      context->callbacks.publishCompleteCallback(context, msg->packetId,
+         status, msg->param);
+   }
+#endif
+}
+
+
+/**
+ * @brief Resume in-flight messages after a connection has been established
+ *
+ * When the session is resumed, unacknowledged PUBLISH packets are sent again
+ * with the DUP flag set, and PUBREL packets are sent for QoS 2 messages whose
+ * PUBREC has already been received. When a new session is started, pending
+ * messages are discarded and reported to the application
+ *
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] cleanSession If this flag is set, then the client and server
+ *   must discard any previous session and start a new one
+ * @return Error code
+ **/
+
+error_t mqttClientResumeInflightMsgs(MqttClientContext *context,
+   bool_t cleanSession)
+{
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   error_t error;
+   uint_t i;
+   MqttClientInflightMsg *msg;
+   MqttPacketHeader *header;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Loop through the in-flight window
+   for(i = 0; i < MQTT_CLIENT_MAX_INFLIGHT_MSGS && !error; i++)
+   {
+      //Point to the current slot
+      msg = &context->inflightMsgs[i];
+
+      //Unused slot?
+      if(msg->state == MQTT_CLIENT_MSG_STATE_UNUSED)
+         continue;
+
+      //New session?
+      if(cleanSession)
+      {
+         //The server has discarded the state of the previous session
+         mqttClientCompleteInflightMsg(context, msg, ERROR_CONNECTION_RESET);
+      }
+      else if(msg->state == MQTT_CLIENT_MSG_STATE_WAIT_PUBCOMP)
+      {
+         //Format PUBREL packet
+         error = mqttClientFormatPubRel(context, msg->packetId);
+
+         //Check status code
+         if(!error)
+         {
+            //Debug message
+            TRACE_INFO("MQTT: Resending PUBREL packet (%" PRIuSIZE " bytes)...\r\n",
+               context->packetLen);
+
+            //Send PUBREL packet
+            error = mqttClientSendPacket(context, context->packet,
+               context->packetLen);
+         }
+      }
+      else
+      {
+         //Point to the fixed header of the PUBLISH packet
+         header = (MqttPacketHeader *) msg->packet;
+         //The DUP flag indicates that this is a re-delivery
+         header->dup = TRUE;
+
+         //Debug message
+         TRACE_INFO("MQTT: Resending PUBLISH packet (%" PRIuSIZE " bytes)...\r\n",
+            msg->packetLen);
+
+         //Send PUBLISH packet
+         error = mqttClientSendPacket(context, msg->packet, msg->packetLen);
+      }
+   }
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return NO_ERROR;
+#endif
+}
+
+
+/**
+ * @brief Send a complete MQTT packet
+ * @param[in] context Pointer to the MQTT client context
+ * @param[in] packet Pointer to the packet
+ * @param[in] length Length of the packet
+ * @return Error code
+ **/
+
+error_t mqttClientSendPacket(MqttClientContext *context, const uint8_t *packet,
+   size_t length)
+{
+   error_t error;
+   size_t n;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send the entire packet
+   while(length > 0 && !error)
+   {
+      //Send more data
+      error = mqttClientSendData(context, packet, length, &n, 0);
+
+      //Advance data pointer
+      packet += n;
+      length -= n;
+   }
+
+   //Save the time at which the packet was sent
+   context->keepAliveTimestamp = osGetSystemTime();
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Check whether the current PUBLISH packet can be coalesced
+ * @param[in] context Pointer to the MQTT client context
+ * @return TRUE if the packet can be appended to the batch buffer
+ **/
+
+bool_t mqttClientCanBatchPacket(MqttClientContext *context)
+{
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   //Only fully serialized packets that fit in the batch buffer are coalesced
+   return context->batching && context->payloadLen == 0 &&
+      context->packetLen <= MQTT_CLIENT_BATCH_BUFFER_SIZE;
+#else
+   //Batching is not supported
+   return FALSE;
+#endif
+}
+
+
+/**
+ * @brief Append the current packet to the batch buffer
+ * @param[in] context Pointer to the MQTT client context
+ * @return Error code
+ **/
+
+error_t mqttClientBatchPacket(MqttClientContext *context)
+{
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   error_t error;
+
+   //Not enough room in the batch buffer?
+   if((context->batchLen + context->packetLen) > MQTT_CLIENT_BATCH_BUFFER_SIZE)
+   {
+      //Send the pending data
+      error = mqttClientFlushBatch(context);
+      //Any error to report?
+      if(error)
+         return error;
+   }
+
+   //Append the packet to the batch buffer
+   osMemcpy(context->batchBuffer + context->batchLen, context->packet,
+      context->packetLen);
+
+   //Update the length of the batch
+   context->batchLen += context->packetLen;
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Not implemented
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+ * @brief Send the contents of the batch buffer
+ * @param[in] context Pointer to the MQTT client context
+ * @return Error code
+ **/
+
+error_t mqttClientFlushBatch(MqttClientContext *context)
+{
+#if (MQTT_CLIENT_BATCH_SUPPORT == ENABLED)
+   error_t error;
+   size_t n;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //Send the coalesced messages with as few transport writes as possible
+   while(context->batchPos < context->batchLen && !error)
+   {
+      //Send more data
+      error = mqttClientSendData(context, context->batchBuffer + context->batchPos,
+         context->batchLen - context->batchPos, &n, 0);
+
+      //Advance data pointer
+      context->batchPos += n;
+   }
+
+   //Check whether the batch has been entirely sent
+   if(context->batchPos >= context->batchLen)
+   {
+      //Flush the batch buffer
+      context->batchPos = 0;
+      context->batchLen = 0;
+
+      //Save the time at which the messages were sent
+      context->keepAliveTimestamp = osGetSystemTime();
+   }
+
+   //Return status code
+   return error;
+#else
+   //Not implemented
+   return NO_ERROR;
+#endif
+}
+
 #endif
@@ -76,6 +76,24 @@ error_t mqttDeserializeString(uint8_t *buffer, size_t bufferLen,
 
 error_t mqttClientCheckTimeout(MqttClientContext *context);
 
+MqttClientInflightMsg *mqttClientAllocInflightMsg(MqttClientContext *context);
+
+MqttClientInflightMsg *mqttClientFindInflightMsg(MqttClientContext *context,
+   uint16_t packetId);
+
+void mqttClientCompleteInflightMsg(MqttClientContext *context,
+   MqttClientInflightMsg *msg, error_t status);
+
+error_t mqttClientResumeInflightMsgs(MqttClientContext *context,
+   bool_t cleanSession);
+
+error_t mqttClientSendPacket(MqttClientContext *context, const uint8_t *packet,
+   size_t length);
+
+bool_t mqttClientCanBatchPacket(MqttClientContext *context);
+error_t mqttClientBatchPacket(MqttClientContext *context);
+error_t mqttClientFlushBatch(MqttClientContext *context);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -437,6 +437,9 @@ error_t mqttClientProcessPubAck(MqttClientContext *context,
 {
    error_t error;
    uint16_t packetId;
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   MqttClientInflightMsg *msg;
+#endif
 
    //If invalid flags are received, the receiver must close the network connection
    if(dup != FALSE && qos != MQTT_QOS_LEVEL_0 && retain != FALSE)
@@ -458,6 +461,18 @@ error_t mqttClientProcessPubAck(MqttClientContext *context,
       context->callbacks.pubAckCallback(context, packetId);
    }
 
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   //Search the in-flight window for the acknowledged message
+   msg = mqttClientFindInflightMsg(context, packetId);
+
+   //QoS 1 message published asynchronously?
+   if(msg != NULL && msg->state == MQTT_CLIENT_MSG_STATE_WAIT_PUBACK)
+   {
+      //The delivery of the message is complete
+      mqttClientCompleteInflightMsg(context, msg, NO_ERROR);
+   }
+#endif
+
    //Notify the application that a PUBACK packet has been received
    if(context->packetType == MQTT_PACKET_TYPE_PUBLISH && context->packetId == packetId)
       mqttClientChangeState(context, MQTT_CLIENT_STATE_PACKET_RECEIVED);
@@ -481,6 +496,9 @@ error_t mqttClientProcessPubRec(MqttClientContext *context,
 {
    error_t error;
    uint16_t packetId;
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   MqttClientInflightMsg *msg;
+#endif
 
    //If invalid flags are received, the receiver must close the network connection
    if(dup != FALSE && qos != MQTT_QOS_LEVEL_0 && retain != FALSE)
@@ -502,6 +520,18 @@ error_t mqttClientProcessPubRec(MqttClientContext *context,
       context->callbacks.pubRecCallback(context, packetId);
    }
 
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   //Search the in-flight window for the acknowledged message
+   msg = mqttClientFindInflightMsg(context, packetId);
+
+   //QoS 2 message published asynchronously?
+   if(msg != NULL && msg->state == MQTT_CLIENT_MSG_STATE_WAIT_PUBREC)
+   {
+      //The PUBLISH packet must not be sent again. Wait for PUBCOMP packet
+      msg->state = MQTT_CLIENT_MSG_STATE_WAIT_PUBCOMP;
+   }
+#endif
+
    //A PUBREL packet is the response to a PUBREC packet. It is the third
    //packet of the QoS 2 protocol exchange
    error = mqttClientFormatPubRel(context, packetId);
@@ -597,6 +627,9 @@ error_t mqttClientProcessPubComp(MqttClientContext *context,
 {
    error_t error;
    uint16_t packetId;
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   MqttClientInflightMsg *msg;
+#endif
 
    //If invalid flags are received, the receiver must close the network connection
    if(dup != FALSE && qos != MQTT_QOS_LEVEL_0 && retain != FALSE)
@@ -618,6 +651,18 @@ error_t mqttClientProcessPubComp(MqttClientContext *context,
       context->callbacks.pubCompCallback(context, packetId);
    }
 
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+   //Search the in-flight window for the acknowledged message
+   msg = mqttClientFindInflightMsg(context, packetId);
+
+   //QoS 2 message published asynchronously?
+   if(msg != NULL && msg->state == MQTT_CLIENT_MSG_STATE_WAIT_PUBCOMP)
+   {
+      //The delivery of the message is complete
+      mqttClientCompleteInflightMsg(context, msg, NO_ERROR);
+   }
+#endif
+
    //Notify the application that a PUBCOMP packet has been received
    if(context->packetType == MQTT_PACKET_TYPE_PUBLISH && context->packetId == packetId)
       mqttClientChangeState(context, MQTT_CLIENT_STATE_PACKET_RECEIVED);
@@ -977,6 +1022,15 @@ error_t mqttClientFormatPublish(MqttClientContext *context, const char_t *topic,
       //a currently unused packet identifier
       context->packetId++;
 
+#if (MQTT_CLIENT_ASYNC_PUBLISH_SUPPORT == ENABLED)
+      //Skip the identifiers of the messages that are still in flight
+      while(context->packetId == 0 ||
+         mqttClientFindInflightMsg(context, context->packetId) != NULL)
+      {
+         context->packetId++;
+      }
+#endif
+
       //The Packet Identifier field is only present in PUBLISH packets
       //where the QoS level is 1 or 2
       error = mqttSerializeShort(context->buffer, MQTT_CLIENT_BUFFER_SIZE,
@@ -987,15 +1041,33 @@ error_t mqttClientFormatPublish(MqttClientContext *context, const char_t *topic,
          return error;
    }
 
-   //The payload contains the Application Message that is being published
-   error = mqttSerializeData(context->buffer, MQTT_CLIENT_BUFFER_SIZE,
-      &n, message, length);
+   //Check whether the payload fits in the buffer
+   if((n + length) <= MQTT_CLIENT_BUFFER_SIZE)
+   {
+      //The payload contains the Application Message that is being published
+      error = mqttSerializeData(context->buffer, MQTT_CLIENT_BUFFER_SIZE,
+         &n, message, length);
 
-   //Failed to serialize Application Message?
-   if(error)
-      return error;
+      //Failed to serialize Application Message?
+      if(error)
+         return error;
 
-   //Calculate the length of the variable header and the payload
+      //The whole packet is contained in the buffer
+      context->payload = NULL;
+      context->payloadLen = 0;
+   }
+   else
+   {
+      //The payload is too large to be copied. It will be sent directly from
+      //the application buffer, right after the variable header
+      context->payload = (const uint8_t *) message;
+      context->payloadLen = length;
+   }
+
+   //Rewind to the beginning of the payload
+   context->payloadPos = 0;
+
+   //Calculate the length of the variable header
    context->packetLen = n - MQTT_MAX_HEADER_SIZE;
 
    //The fixed header will be encoded in reverse order
@@ -1003,7 +1075,7 @@ error_t mqttClientFormatPublish(MqttClientContext *context, const char_t *topic,
 
    //Prepend the variable header and the payload with the fixed header
    error = mqttSerializeHeader(context->buffer, &n, MQTT_PACKET_TYPE_PUBLISH,
-      FALSE, qos, retain, context->packetLen);
+      FALSE, qos, retain, context->packetLen + context->payloadLen);
 
    //Failed to serialize fixed header?
    if(error)
@@ -1011,7 +1083,7 @@ error_t mqttClientFormatPublish(MqttClientContext *context, const char_t *topic,
 
    //Point to the first byte of the MQTT packet
    context->packet = context->buffer + n;
-   //Calculate the length of the MQTT packet
+   //Calculate the length of the part of the packet held in the buffer
    context->packetLen += MQTT_MAX_HEADER_SIZE - n;
 
    //Successful processing
@@ -119,6 +119,13 @@ struct _PppContext;
    #error PPP_MAX_FAILURE parameter is not valid
 #endif
 
+//Slicing-by-4 FCS calculation
+#ifndef PPP_FAST_FCS_SUPPORT
+   #define PPP_FAST_FCS_SUPPORT ENABLED
+#elif (PPP_FAST_FCS_SUPPORT != ENABLED && PPP_FAST_FCS_SUPPORT != DISABLED)
+   #error PPP_FAST_FCS_SUPPORT parameter is not valid
+#endif
+
 //PPP special characters
 #define PPP_MASK_CHAR 0x20
 #define PPP_ESC_CHAR  0x7D
@@ -488,7 +495,12 @@ struct _PppContext
 
 
 //Tick counter to handle periodic operations
+#if (NET_MULTI_INSTANCE_SUPPORT == ENABLED)
+extern systime_t pppTickCounters[NET_MAX_INSTANCES];
+#define pppTickCounter (pppTickCounters[netContext.instance])
+#else
 extern systime_t pppTickCounter;
+#endif
 
 //PPP related functions
 void pppGetDefaultSettings(PppSettings *settings);
@@ -519,6 +531,7 @@ size_t pppParseFrameHeader(const uint8_t *frame, size_t length, uint16_t *protoc
 
 uint16_t pppCalcFcs(const uint8_t *data, size_t length);
 uint16_t pppCalcFcsEx(const NetBuffer *buffer, size_t offset, size_t length);
+uint16_t pppUpdateFcs(uint16_t fcs, const uint8_t *data, size_t length);
 
 NetBuffer *pppAllocBuffer(size_t length, size_t *offset);
 
@@ -63,7 +63,11 @@ const NicDriver pppHdlcDriver =
    FALSE,
    FALSE,
    FALSE,
-   FALSE
+   FALSE,
+   NULL,
+   NULL,
+   0,
+   0
 };
 
 
@@ -186,8 +190,9 @@ error_t pppHdlcDriverSendPacket(NetInterface *interface,
    const NetBuffer *buffer, size_t offset, NetTxAncillary *ancillary)
 {
    uint_t i;
-   size_t j;
    size_t n;
+   size_t length;
+   uint8_t c;
    uint8_t *p;
    uint16_t protocol;
    uint32_t accm;
@@ -215,7 +220,9 @@ error_t pppHdlcDriverSendPacket(NetInterface *interface,
    }
 
    //Send flag
-   pppHdlcDriverWriteTxQueue(context, PPP_FLAG_CHAR);
+   c = PPP_FLAG_CHAR;
+   pppHdlcDriverCopyToTxQueue(context, &c, sizeof(uint8_t));
+   length = sizeof(uint8_t);
 
    //Loop through data chunks
    for(i = 0; i < buffer->chunkCount; i++)
@@ -228,34 +235,8 @@ error_t pppHdlcDriverSendPacket(NetInterface *interface,
          //Compute the number of bytes to copy at a time
          n = buffer->chunk[i].length - offset;
 
-         //Copy data to TX queue
-         for(j = 0; j < n; j++)
-         {
-            if(p[j] < PPP_MASK_CHAR)
-            {
-               //Check whether the character is flagged
-               if(accm & (1 << p[j]))
-               {
-                  pppHdlcDriverWriteTxQueue(context, PPP_ESC_CHAR);
-                  pppHdlcDriverWriteTxQueue(context, p[j] ^ PPP_MASK_CHAR);
-               }
-               else
-               {
-                  //Enqueue current character
-                  pppHdlcDriverWriteTxQueue(context, p[j]);
-               }
-            }
-            else if(p[j] == PPP_ESC_CHAR || p[j] == PPP_FLAG_CHAR)
-            {
-               pppHdlcDriverWriteTxQueue(context, PPP_ESC_CHAR);
-               pppHdlcDriverWriteTxQueue(context, p[j] ^ PPP_MASK_CHAR);
-            }
-            else
-            {
-               //Enqueue current character
-               pppHdlcDriverWriteTxQueue(context, p[j]);
-            }
-         }
+         //Perform octet stuffing and copy data to TX queue
+         length += pppHdlcDriverEscapeBlock(context, p, n, accm);
 
          //Process the next block from the start
          offset = 0;
@@ -268,7 +249,16 @@ error_t pppHdlcDriverSendPacket(NetInterface *interface,
    }
 
    //Send flag
-   pppHdlcDriverWriteTxQueue(context, PPP_FLAG_CHAR);
+   c = PPP_FLAG_CHAR;
+   pppHdlcDriverCopyToTxQueue(context, &c, sizeof(uint8_t));
+   length += sizeof(uint8_t);
+
+   //Enter critical section
+   __disable_irq();
+   //The whole frame is made available to the UART at once
+   context->txBufferLen += length;
+   //Exit critical section
+   __enable_irq();
 
    //Start transferring data
    interface->uartDriver->startTx();
@@ -293,9 +283,16 @@ error_t pppHdlcDriverSendPacket(NetInterface *interface,
 
 error_t pppHdlcDriverReceivePacket(NetInterface *interface)
 {
+   size_t i;
+   size_t j;
+   size_t k;
+   size_t m;
    size_t n;
+   size_t length;
    uint8_t c;
+   uint8_t *p;
    bool_t escFlag;
+   bool_t flagFound;
    uint32_t accm;
    PppContext *context;
 
@@ -306,51 +303,113 @@ error_t pppHdlcDriverReceivePacket(NetInterface *interface)
 
    //Length of the original PPP frame
    n = 0;
+   //Number of characters consumed from the RX queue
+   length = 0;
+   //Current read position in the RX queue
+   k = context->rxReadIndex;
+
    //This flag tells whether the next character is escaped
    escFlag = FALSE;
+   //This flag is set when the closing flag is found
+   flagFound = FALSE;
 
    //The receiver must reverse the octet stuffing procedure
-   while(n < PPP_MAX_FRAME_SIZE && context->rxBufferLen > 0)
+   while(!flagFound && n < PPP_MAX_FRAME_SIZE && length < context->rxBufferLen)
    {
-      //Read a single character
-      c = pppHdlcDriverReadRxQueue(context);
+      //Point to the contiguous block of data that can be read
+      p = context->rxBuffer + k;
+      //Compute the length of the block
+      m = MIN(context->rxBufferLen - length, PPP_RX_BUFFER_SIZE - k);
 
-      if(c < PPP_MASK_CHAR)
+      //Process the block
+      for(i = 0; !flagFound && i < m && n < PPP_MAX_FRAME_SIZE; )
       {
-         //Check whether the character is flagged
-         if(accm & (1 << c))
+         //Ordinary characters can be copied as a whole
+         if(!escFlag)
          {
-            //The extra characters must be removed from the incoming data stream
+            //Search for the next character that requires special processing
+            for(j = i; j < m && (n + j - i) < PPP_MAX_FRAME_SIZE; j++)
+            {
+               //Control, escape and flag characters are handled one by one
+               if(p[j] < PPP_MASK_CHAR || p[j] == PPP_ESC_CHAR ||
+                  p[j] == PPP_FLAG_CHAR)
+               {
+                  break;
+               }
+            }
+
+            //Copy the run of ordinary characters
+            osMemcpy(context->frame + n, p + i, j - i);
+
+            //Advance data pointers
+            n += j - i;
+            i = j;
          }
-         else
+
+         //Any character that requires special processing?
+         if(i < m && n < PPP_MAX_FRAME_SIZE)
          {
-            //Copy current character
-            context->frame[n++] = c;
+            //Read a single character
+            c = p[i++];
+
+            if(c < PPP_MASK_CHAR)
+            {
+               //Check whether the character is flagged
+               if(accm & (1 << c))
+               {
+                  //The extra characters must be removed from the incoming data stream
+               }
+               else
+               {
+                  //Copy current character
+                  context->frame[n++] = c;
+               }
+            }
+            else if(c == PPP_ESC_CHAR)
+            {
+               //All occurrences of 0x7D indicate that the next character is escaped
+               escFlag = TRUE;
+            }
+            else if(c == PPP_FLAG_CHAR)
+            {
+               //0x7E flag found
+               flagFound = TRUE;
+            }
+            else if(escFlag)
+            {
+               //The character is XOR'ed with 0x20
+               context->frame[n++] = c ^ PPP_MASK_CHAR;
+               escFlag = FALSE;
+            }
+            else
+            {
+               //Copy current character
+               context->frame[n++] = c;
+            }
          }
       }
-      else if(c == PPP_ESC_CHAR)
-      {
-         //All occurrences of 0x7D indicate that the next character is escaped
-         escFlag = TRUE;
-      }
-      else if(c == PPP_FLAG_CHAR)
-      {
-         //0x7E flag found
-         break;
-      }
-      else if(escFlag)
-      {
-         //The character is XOR'ed with 0x20
-         context->frame[n++] = c ^ PPP_MASK_CHAR;
-         escFlag = FALSE;
-      }
-      else
+
+      //Update the number of characters consumed
+      length += i;
+
+      //Increment index and wrap around if necessary
+      k += i;
+      if(k >= PPP_RX_BUFFER_SIZE)
       {
-         //Copy current character
-         context->frame[n++] = c;
+         k = 0;
       }
    }
 
+   //Advance read index
+   context->rxReadIndex = k;
+
+   //Enter critical section
+   __disable_irq();
+   //Update the length of the RX queue
+   context->rxBufferLen -= length;
+   //Exit critical section
+   __enable_irq();
+
    //Check whether a valid PPP frame has been received
    if(n > 0)
    {
@@ -591,6 +650,110 @@ void pppHdlcDriverWriteTxQueue(PppContext *context, uint8_t c)
 }
 
 
+/**
+ * @brief Copy a block of data to the TX queue
+ *
+ * The length of the TX queue is not updated, so that the caller can make a
+ * complete frame available to the UART at once
+ *
+ * @param[in] context Pointer to the PPP context
+ * @param[in] data Pointer to the data to be written
+ * @param[in] length Number of bytes to write
+ **/
+
+void pppHdlcDriverCopyToTxQueue(PppContext *context, const uint8_t *data,
+   size_t length)
+{
+   size_t n;
+
+   //Number of bytes that can be written before wrapping around
+   n = MIN(length, PPP_TX_BUFFER_SIZE - context->txWriteIndex);
+
+   //Copy the first part of the data
+   osMemcpy(context->txBuffer + context->txWriteIndex, data, n);
+
+   //Wrap around if necessary
+   if(n < length)
+   {
+      //Copy the remaining data to the beginning of the queue
+      osMemcpy(context->txBuffer, data + n, length - n);
+   }
+
+   //Advance write index and wrap around if necessary
+   context->txWriteIndex += length;
+
+   if(context->txWriteIndex >= PPP_TX_BUFFER_SIZE)
+      context->txWriteIndex -= PPP_TX_BUFFER_SIZE;
+}
+
+
+/**
+ * @brief Perform octet stuffing on a block of data
+ *
+ * Runs of characters that do not need to be escaped are copied to the TX
+ * queue as a whole. The length of the TX queue is not updated
+ *
+ * @param[in] context Pointer to the PPP context
+ * @param[in] data Pointer to the data to be sent
+ * @param[in] length Number of bytes to process
+ * @param[in] accm Async control character map
+ * @return Number of bytes written to the TX queue
+ **/
+
+size_t pppHdlcDriverEscapeBlock(PppContext *context, const uint8_t *data,
+   size_t length, uint32_t accm)
+{
+   size_t i;
+   size_t j;
+   size_t n;
+   uint8_t c[2];
+
+   //Number of bytes written to the TX queue
+   n = 0;
+
+   //Process the data
+   for(i = 0; i < length; i = j + 1)
+   {
+      //Search for the next character that must be escaped
+      for(j = i; j < length; j++)
+      {
+         if(data[j] < PPP_MASK_CHAR)
+         {
+            //Check whether the character is flagged
+            if(accm & (1 << data[j]))
+               break;
+         }
+         else if(data[j] == PPP_ESC_CHAR || data[j] == PPP_FLAG_CHAR)
+         {
+            break;
+         }
+      }
+
+      //Copy the run of characters that need no escaping
+      if(j > i)
+      {
+         pppHdlcDriverCopyToTxQueue(context, data + i, j - i);
+         n += j - i;
+      }
+
+      //Character to be escaped?
+      if(j < length)
+      {
+         //The character is XOR'ed with 0x20 and preceded by 0x7D
+         c[0] = PPP_ESC_CHAR;
+         c[1] = data[j] ^ PPP_MASK_CHAR;
+
+         //Copy the escape sequence
+         pppHdlcDriverCopyToTxQueue(context, c, sizeof(c));
+         n += sizeof(c);
+      }
+   }
+
+   //Return the number of bytes written
+   return n;
+}
+
+
 /**
  * @brief Read RX queue
  * @param[in] context Pointer to the PPP context
@@ -67,6 +67,13 @@ error_t pppHdlcDriverPurgeTxBuffer(PppContext *context);
 error_t pppHdlcDriverPurgeRxBuffer(PppContext *context);
 
 void pppHdlcDriverWriteTxQueue(PppContext *context, uint8_t c);
+
+void pppHdlcDriverCopyToTxQueue(PppContext *context, const uint8_t *data,
+   size_t length);
+
+size_t pppHdlcDriverEscapeBlock(PppContext *context, const uint8_t *data,
+   size_t length, uint32_t accm);
+
 uint8_t pppHdlcDriverReadRxQueue(PppContext *context);
 
 bool_t pppHdlcDriverReadTxQueue(NetInterface *interface, int_t *c);
@@ -53,6 +53,7 @@
 #include "snmp/snmp_agent_dispatch.h"
 #include "snmp/snmp_agent_pdu.h"
 #include "snmp/snmp_agent_misc.h"
+#include "snmp/snmp_agent_object.h"
 #include "snmp/snmp_agent_trap.h"
 #include "snmp/snmp_agent_inform.h"
 #include "mibs/mib2_module.h"
@@ -395,6 +396,11 @@ error_t snmpAgentLoadMib(SnmpAgentContext *context, const MibModule *module)
          {
             //Add the MIB to the list
             context->mibTable[i] = module;
+
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+            //Rebuild the index of MIB objects
+            snmpBuildObjectIndex(context);
+#endif
          }
       }
       else
@@ -452,6 +458,11 @@ error_t snmpAgentUnloadMib(SnmpAgentContext *context, const MibModule *module)
       //Remove the MIB from the list
       context->mibTable[i] = NULL;
 
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+      //Rebuild the index of MIB objects
+      snmpBuildObjectIndex(context);
+#endif
+
       //Successful processing
       error = NO_ERROR;
    }
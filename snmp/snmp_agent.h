@@ -71,6 +71,20 @@ struct _SnmpAgentContext;
    #error SNMP_AGENT_MAX_MIBS parameter is not valid
 #endif
 
+//Sorted index of the objects of all loaded MIBs
+#ifndef SNMP_AGENT_OBJECT_INDEX_SUPPORT
+   #define SNMP_AGENT_OBJECT_INDEX_SUPPORT DISABLED
+#elif (SNMP_AGENT_OBJECT_INDEX_SUPPORT != ENABLED && SNMP_AGENT_OBJECT_INDEX_SUPPORT != DISABLED)
+   #error SNMP_AGENT_OBJECT_INDEX_SUPPORT parameter is not valid
+#endif
+
+//Maximum number of objects in the index
+#ifndef SNMP_AGENT_OBJECT_INDEX_SIZE
+   #define SNMP_AGENT_OBJECT_INDEX_SIZE 256
+#elif (SNMP_AGENT_OBJECT_INDEX_SIZE < 1)
+   #error SNMP_AGENT_OBJECT_INDEX_SIZE parameter is not valid
+#endif
+
 //Maximum number of community strings
 #ifndef SNMP_AGENT_MAX_COMMUNITIES
    #define SNMP_AGENT_MAX_COMMUNITIES 3
@@ -153,6 +167,12 @@ struct _SnmpAgentContext
    uint8_t enterpriseOid[SNMP_MAX_OID_SIZE];                  ///<Enterprise OID
    size_t enterpriseOidLen;                                   ///<Length of the enterprise OID
    const MibModule *mibTable[SNMP_AGENT_MAX_MIBS];            ///<MIB modules
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+   const MibObject *objectIndex[SNMP_AGENT_OBJECT_INDEX_SIZE]; ///<Objects of all loaded MIBs, in lexicographical order
+   uint_t objectIndexLen;                                     ///<Number of objects in the index
+   bool_t objectIndexValid;                                   ///<The index covers all loaded MIBs
+   uint_t objectIndexHint;                                    ///<Position of the object returned by the last GetNext
+#endif
 #if (SNMP_V1_SUPPORT == ENABLED || SNMP_V2C_SUPPORT == ENABLED)
    SnmpUserEntry communityTable[SNMP_AGENT_MAX_COMMUNITIES];  ///<Community strings
 #endif
@@ -183,6 +203,9 @@ struct _SnmpAgentContext
    int32_t msgId;                                             ///<Message identifier
    uint64_t salt;                                             ///<Integer initialized to a random value at boot time
    uint8_t privParameters[8];                                 ///<Privacy parameters
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+   SnmpKeyCacheEntry keyCache[SNMP_KEY_CACHE_SIZE];           ///<HMAC states and cipher key schedules
+#endif
 #endif
 #if (SNMP_AGENT_INFORM_SUPPORT == ENABLED)
    SnmpAgentState informState;                                ///<State of the inform sending process
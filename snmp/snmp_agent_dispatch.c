@@ -383,7 +383,8 @@ error_t snmpv3ProcessMessage(SnmpAgentContext *context)
       if((context->request.msgFlags & SNMP_MSG_FLAG_AUTH) != 0)
       {
          //Authenticate incoming SNMP message
-         error = snmpAuthIncomingMessage(&context->user, &context->request);
+         error = snmpAuthIncomingMessage(context, &context->user,
+            &context->request);
          //Data authentication failed?
          if(error)
             break;
@@ -399,7 +400,8 @@ error_t snmpv3ProcessMessage(SnmpAgentContext *context)
       if((context->request.msgFlags & SNMP_MSG_FLAG_PRIV) != 0)
       {
          //Decrypt data
-         error = snmpDecryptData(&context->user, &context->request);
+         error = snmpDecryptData(context, &context->user,
+            &context->request);
          //Data decryption failed?
          if(error)
             break;
@@ -462,7 +464,7 @@ error_t snmpv3ProcessMessage(SnmpAgentContext *context)
       if((context->response.msgFlags & SNMP_MSG_FLAG_PRIV) != 0)
       {
          //Encrypt data
-         error = snmpEncryptData(&context->user, &context->response,
+         error = snmpEncryptData(context, &context->user, &context->response,
             &context->salt);
          //Any error to report?
          if(error)
@@ -479,7 +481,8 @@ error_t snmpv3ProcessMessage(SnmpAgentContext *context)
       if((context->response.msgFlags & SNMP_MSG_FLAG_AUTH) != 0)
       {
          //Authenticate outgoing SNMP message
-         error = snmpAuthOutgoingMessage(&context->user, &context->response);
+         error = snmpAuthOutgoingMessage(context, &context->user,
+            &context->response);
          //Any error to report?
          if(error)
             return error;
@@ -459,141 +459,112 @@ error_t snmpGetNextObject(SnmpAgentContext *context,
    nextOid = context->response.varBindList + context->response.varBindListLen;
    nextOidLen = 0;
 
-   //Loop through MIBs
-   for(i = 0; i < SNMP_AGENT_MAX_MIBS; i++)
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+   //Check whether the index covers all the loaded MIBs
+   if(context->objectIndexValid)
    {
-      //Valid MIB?
-      if(context->mibTable[i] != NULL &&
-         context->mibTable[i]->numObjects > 0)
+      //Sanity check
+      if(var->oidLen <= bufferLen)
       {
-         //Get the total number of objects
-         numObjects = context->mibTable[i]->numObjects;
-
-         //Point to the last object of the MIB
-         object = &context->mibTable[i]->objects[numObjects - 1];
+         //Copy the OID from the specified variable binding
+         curOid = nextOid;
+         curOidLen = var->oidLen;
+         osMemcpy(curOid, var->oid, var->oidLen);
+
+         //Search the index for the first object that does not precede the
+         //specified OID
+         i = snmpFindIndexedObject(context, var->oid, var->oidLen);
+
+         //Loop through the remaining objects, in lexicographical order
+         for(error = ERROR_OBJECT_NOT_FOUND; i < context->objectIndexLen &&
+            error == ERROR_OBJECT_NOT_FOUND; i++)
+         {
+            //Point to the current object
+            object = context->objectIndex[i];
 
-         //Discard instance sub-identifier
-         n = MIN(var->oidLen, object->oidLen);
+            //Search the object for the next instance
+            error = snmpGetNextInstance(context, message, object, curOid,
+               &curOidLen, bufferLen, &tempOidLen);
 
-         //Perform lexicographical comparison
-         if(oidComp(var->oid, n, object->oid, object->oidLen) <= 0)
-         {
-            //Sanity check
-            if((nextOidLen + var->oidLen) > bufferLen)
+            //Check status code
+            if(!error)
             {
-               //Report an error
-               error = ERROR_BUFFER_OVERFLOW;
-               //Exit immediately
-               break;
+               //The objects are sorted, so the first match is the closest
+               //object identifier that follows the specified OID
+               nextObject = object;
+               nextOidLen = tempOidLen;
+               osMemmove(nextOid, curOid + curOidLen, tempOidLen);
+
+               //Save the position of the object, so that a subsequent walk
+               //can resume from here without searching the index
+               context->objectIndexHint = i;
             }
+         }
 
-            //Copy the OID from the specified variable binding
-            curOid = nextOid + nextOidLen;
-            curOidLen = var->oidLen;
-            osMemcpy(curOid, var->oid, var->oidLen);
+         //Catch exception
+         if(error == ERROR_OBJECT_NOT_FOUND)
+         {
+            error = NO_ERROR;
+         }
+      }
+      else
+      {
+         //Report an error
+         error = ERROR_BUFFER_OVERFLOW;
+      }
+   }
+   else
+#endif
+   {
+      //Loop through MIBs
+      for(i = 0; i < SNMP_AGENT_MAX_MIBS; i++)
+      {
+         //Valid MIB?
+         if(context->mibTable[i] != NULL &&
+            context->mibTable[i]->numObjects > 0)
+         {
+            //Get the total number of objects
+            numObjects = context->mibTable[i]->numObjects;
 
-            //Loop through objects
-            for(j = 0; j < numObjects; )
-            {
-               //Point to the current object
-               object = &context->mibTable[i]->objects[j];
+            //Point to the last object of the MIB
+            object = &context->mibTable[i]->objects[numObjects - 1];
 
-               //Buffer where to store the OID of the next object
-               tempOid = curOid + curOidLen;
+            //Discard instance sub-identifier
+            n = MIN(var->oidLen, object->oidLen);
 
-               //Make sure the current object is accessible
-               if(object->access == MIB_ACCESS_READ_ONLY ||
-                  object->access == MIB_ACCESS_READ_WRITE ||
-                  object->access == MIB_ACCESS_READ_CREATE)
+            //Perform lexicographical comparison
+            if(oidComp(var->oid, n, object->oid, object->oidLen) <= 0)
+            {
+               //Sanity check
+               if((nextOidLen + var->oidLen) > bufferLen)
                {
-                  //Scalar or tabular object?
-                  if(object->getNext == NULL)
-                  {
-                     //Perform lexicographical comparison
-                     if(oidComp(curOid, curOidLen, object->oid, object->oidLen) <= 0)
-                     {
-                        //Take in account the instance sub-identifier to determine
-                        //the length of the OID
-                        tempOidLen = object->oidLen + 1;
-
-                        //Make sure the buffer is large enough to hold the entire OID
-                        if((nextOidLen + curOidLen + tempOidLen) <= bufferLen)
-                        {
-                           //Copy object identifier
-                           osMemcpy(tempOid, object->oid, object->oidLen);
-                           //Append instance sub-identifier
-                           tempOid[tempOidLen - 1] = 0;
-
-                           //Successful processing
-                           error = NO_ERROR;
-                        }
-                        else
-                        {
-                           //Report an error
-                           error = ERROR_BUFFER_OVERFLOW;
-                        }
-                     }
-                     else
-                     {
-                        //The specified OID does not lexicographically precede
-                        //the name of the current object
-                        error = ERROR_OBJECT_NOT_FOUND;
-                     }
-                  }
-                  else
-                  {
-                     //Discard instance sub-identifier
-                     n = MIN(curOidLen, object->oidLen);
+                  //Report an error
+                  error = ERROR_BUFFER_OVERFLOW;
+                  //Exit immediately
+                  break;
+               }
 
-                     //Perform lexicographical comparison
-                     if(oidComp(curOid, n, object->oid, object->oidLen) <= 0)
-                     {
-                        //Maximum acceptable size of the OID
-                        tempOidLen = bufferLen - nextOidLen - curOidLen;
+               //Copy the OID from the specified variable binding
+               curOid = nextOid + nextOidLen;
+               curOidLen = var->oidLen;
+               osMemcpy(curOid, var->oid, var->oidLen);
 
-                        //Search the MIB for the next object
-                        error = object->getNext(object, curOid, curOidLen,
-                           tempOid, &tempOidLen);
-                     }
-                     else
-                     {
-                        //The specified OID does not lexicographically precede
-                        //the name of the current object
-                        error = ERROR_OBJECT_NOT_FOUND;
-                     }
-                  }
+               //Loop through objects
+               for(j = 0; j < numObjects; j++)
+               {
+                  //Point to the current object
+                  object = &context->mibTable[i]->objects[j];
+
+                  //Search the object for the next instance
+                  error = snmpGetNextInstance(context, message, object, curOid,
+                     &curOidLen, bufferLen - nextOidLen, &tempOidLen);
 
-#if (SNMP_V1_SUPPORT == ENABLED)
-                  //Check status code
-                  if(error == NO_ERROR)
-                  {
-                     //On receipt of an SNMPv1 GetNextRequest-PDU, any object
-                     //instance which contains a syntax of Counter64 shall be
-                     //skipped (refer to RFC 3584, section 4.2.2.1)
-                     if(message->version == SNMP_VERSION_1)
-                     {
-                        //Counter64 type?
-                        if(object->objClass == ASN1_CLASS_APPLICATION &&
-                           object->objType == MIB_TYPE_COUNTER64)
-                        {
-                           //Skip current object
-                           error = ERROR_OBJECT_NOT_FOUND;
-                        }
-                     }
-                  }
-#endif
-#if (SNMP_AGENT_VACM_SUPPORT == ENABLED)
-                  //Check status code
-                  if(error == NO_ERROR)
-                  {
-                     //Access control verification
-                     error = snmpIsAccessAllowed(context, message, tempOid,
-                        tempOidLen);
-                  }
-#endif
                   //Check status code
                   if(error == NO_ERROR)
                   {
+                     //The resulting OID immediately follows the current OID
+                     tempOid = curOid + curOidLen;
+
                      //Save the closest object identifier that follows the
                      //specified OID
                      if(nextObject == NULL)
@@ -616,19 +587,6 @@ error_t snmpGetNextObject(SnmpAgentContext *context,
                   {
                      //Catch exception
                      error = NO_ERROR;
-
-                     //Jump to the next object in the MIB
-                     j++;
-                  }
-                  else if(error == ERROR_UNKNOWN_CONTEXT ||
-                     error == ERROR_AUTHORIZATION_FAILED)
-                  {
-                     //Catch exception
-                     error = NO_ERROR;
-
-                     //Check the next instance of the same object
-                     curOidLen = tempOidLen;
-                     osMemmove(curOid, tempOid, tempOidLen);
                   }
                   else
                   {
@@ -636,18 +594,13 @@ error_t snmpGetNextObject(SnmpAgentContext *context,
                      break;
                   }
                }
-               else
-               {
-                  //The current object is not accessible
-                  j++;
-               }
             }
          }
-      }
 
-      //Any error to report?
-      if(error)
-         break;
+         //Any error to report?
+         if(error)
+            break;
+      }
    }
 
    //Check status code
@@ -676,6 +629,160 @@ error_t snmpGetNextObject(SnmpAgentContext *context,
 }
 
 
+/**
+ * @brief Search an object for the instance that follows the specified OID
+ *
+ * The resulting OID is written immediately after the current OID. Instances
+ * to which access is denied are skipped, in which case the current OID is
+ * updated accordingly
+ *
+ * @param[in] context Pointer to the SNMP agent context
+ * @param[in] message Pointer to the received SNMP message
+ * @param[in] object Pointer to the MIB object descriptor
+ * @param[in,out] curOid Current OID
+ * @param[in,out] curOidLen Length of the current OID
+ * @param[in] maxLen Size of the buffer that holds the current OID
+ * @param[out] nextOidLen Length of the resulting OID
+ * @return Error code
+ **/
+
+error_t snmpGetNextInstance(SnmpAgentContext *context,
+   const SnmpMessage *message, const MibObject *object, uint8_t *curOid,
+   size_t *curOidLen, size_t maxLen, size_t *nextOidLen)
+{
+   error_t error;
+   size_t n;
+   uint8_t *tempOid;
+   size_t tempOidLen;
+
+   //Make sure the current object is accessible
+   if(object->access != MIB_ACCESS_READ_ONLY &&
+      object->access != MIB_ACCESS_READ_WRITE &&
+      object->access != MIB_ACCESS_READ_CREATE)
+   {
+      //The current object is not accessible
+      return ERROR_OBJECT_NOT_FOUND;
+   }
+
+   //Loop through the instances of the object
+   while(1)
+   {
+      //Buffer where to store the OID of the next object
+      tempOid = curOid + *curOidLen;
+
+      //Scalar or tabular object?
+      if(object->getNext == NULL)
+      {
+         //Perform lexicographical comparison
+         if(oidComp(curOid, *curOidLen, object->oid, object->oidLen) <= 0)
+         {
+            //Take in account the instance sub-identifier to determine
+            //the length of the OID
+            tempOidLen = object->oidLen + 1;
+
+            //Make sure the buffer is large enough to hold the entire OID
+            if((*curOidLen + tempOidLen) <= maxLen)
+            {
+               //Copy object identifier
+               osMemcpy(tempOid, object->oid, object->oidLen);
+               //Append instance sub-identifier
+               tempOid[tempOidLen - 1] = 0;
+
+               //Successful processing
+               error = NO_ERROR;
+            }
+            else
+            {
+               //Report an error
+               error = ERROR_BUFFER_OVERFLOW;
+            }
+         }
+         else
+         {
+            //The specified OID does not lexicographically precede
+            //the name of the current object
+            error = ERROR_OBJECT_NOT_FOUND;
+         }
+      }
+      else
+      {
+         //Discard instance sub-identifier
+         n = MIN(*curOidLen, object->oidLen);
+
+         //Perform lexicographical comparison
+         if(oidComp(curOid, n, object->oid, object->oidLen) <= 0)
+         {
+            //Maximum acceptable size of the OID
+            tempOidLen = maxLen - *curOidLen;
+
+            //Search the MIB for the next object
+            error = object->getNext(object, curOid, *curOidLen,
+               tempOid, &tempOidLen);
+         }
+         else
+         {
+            //The specified OID does not lexicographically precede
+            //the name of the current object
+            error = ERROR_OBJECT_NOT_FOUND;
+         }
+      }
+
+#if (SNMP_V1_SUPPORT == ENABLED)
+      //Check status code
+      if(error == NO_ERROR)
+      {
+         //On receipt of an SNMPv1 GetNextRequest-PDU, any object
+         //instance which contains a syntax of Counter64 shall be
+         //skipped (refer to RFC 3584, section 4.2.2.1)
+         if(message->version == SNMP_VERSION_1)
+         {
+            //Counter64 type?
+            if(object->objClass == ASN1_CLASS_APPLICATION &&
+               object->objType == MIB_TYPE_COUNTER64)
+            {
+               //Skip current object
+               error = ERROR_OBJECT_NOT_FOUND;
+            }
+         }
+      }
+#endif
+#if (SNMP_AGENT_VACM_SUPPORT == ENABLED)
+      //Check status code
+      if(error == NO_ERROR)
+      {
+         //Access control verification
+         error = snmpIsAccessAllowed(context, message, tempOid,
+            tempOidLen);
+      }
+#endif
+
+      //Access denied?
+      if(error == ERROR_UNKNOWN_CONTEXT ||
+         error == ERROR_AUTHORIZATION_FAILED)
+      {
+         //Check the next instance of the same object
+         *curOidLen = tempOidLen;
+         osMemmove(curOid, tempOid, tempOidLen);
+      }
+      else
+      {
+         //We are done
+         break;
+      }
+   }
+
+   //Check status code
+   if(!error)
+   {
+      //Return the length of the resulting OID
+      *nextOidLen = tempOidLen;
+   }
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Search MIBs for the given object
  * @param[in] context Pointer to the SNMP agent context
@@ -696,71 +803,104 @@ error_t snmpFindMibObject(SnmpAgentContext *context,
    uint_t i;
    size_t n;
    const MibObject *objects;
+   const MibObject *match;
 
    //Initialize variables
    res = -1;
    mid = 0;
    objects = NULL;
+   match = NULL;
 
-   //Loop through MIBs
-   for(i = 0; i < SNMP_AGENT_MAX_MIBS && res != 0; i++)
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+   //Check whether the index covers all the loaded MIBs
+   if(context->objectIndexValid)
    {
-      //Valid MIB?
-      if(context->mibTable[i] != NULL &&
-         context->mibTable[i]->numObjects > 0)
-      {
-         //Point to the list of objects
-         objects = context->mibTable[i]->objects;
+      //Search the index for the first object that does not precede the
+      //specified OID
+      i = snmpFindIndexedObject(context, oid, oidLen);
 
-         //Index of the first item
-         left = 0;
-         //Index of the last item
-         right = context->mibTable[i]->numObjects - 1;
+      //Any candidate?
+      if(i < context->objectIndexLen)
+      {
+         //Point to the current object
+         match = context->objectIndex[i];
 
          //Discard instance sub-identifier
-         n = MIN(oidLen, objects[right].oidLen);
+         n = MIN(oidLen, match->oidLen);
 
-         //Check object identifier
-         if(oidComp(oid, oidLen, objects[left].oid, objects[left].oidLen) >= 0 &&
-            oidComp(oid, n, objects[right].oid, objects[right].oidLen) <= 0)
+         //Perform lexicographic comparison
+         res = oidComp(oid, n, match->oid, match->oidLen);
+      }
+   }
+   else
+#endif
+   {
+      //Loop through MIBs
+      for(i = 0; i < SNMP_AGENT_MAX_MIBS && res != 0; i++)
+      {
+         //Valid MIB?
+         if(context->mibTable[i] != NULL &&
+            context->mibTable[i]->numObjects > 0)
          {
-            //Binary search algorithm
-            while(left <= right && res != 0)
-            {
-               //Calculate the index of the middle item
-               mid = left + (right - left) / 2;
+            //Point to the list of objects
+            objects = context->mibTable[i]->objects;
 
-               //Discard instance sub-identifier
-               n = MIN(oidLen, objects[mid].oidLen);
+            //Index of the first item
+            left = 0;
+            //Index of the last item
+            right = context->mibTable[i]->numObjects - 1;
 
-               //Perform lexicographic comparison
-               res = oidComp(oid, n, objects[mid].oid, objects[mid].oidLen);
+            //Discard instance sub-identifier
+            n = MIN(oidLen, objects[right].oidLen);
 
-               //Check the result of the comparison
-               if(res > 0)
-               {
-                  left = mid + 1;
-               }
-               else if(res < 0)
+            //Check object identifier
+            if(oidComp(oid, oidLen, objects[left].oid, objects[left].oidLen) >= 0 &&
+               oidComp(oid, n, objects[right].oid, objects[right].oidLen) <= 0)
+            {
+               //Binary search algorithm
+               while(left <= right && res != 0)
                {
-                  right = mid - 1;
+                  //Calculate the index of the middle item
+                  mid = left + (right - left) / 2;
+
+                  //Discard instance sub-identifier
+                  n = MIN(oidLen, objects[mid].oidLen);
+
+                  //Perform lexicographic comparison
+                  res = oidComp(oid, n, objects[mid].oid, objects[mid].oidLen);
+
+                  //Check the result of the comparison
+                  if(res > 0)
+                  {
+                     left = mid + 1;
+                  }
+                  else if(res < 0)
+                  {
+                     right = mid - 1;
+                  }
                }
             }
          }
       }
+
+      //Object identifier found?
+      if(res == 0)
+      {
+         match = &objects[mid];
+      }
    }
 
    //Object identifier found?
    if(res == 0)
    {
       //Scalar object?
-      if(objects[mid].getNext == NULL)
+      if(match->getNext == NULL)
       {
          //The instance sub-identifier shall be 0 for scalar objects
-         if(oidLen == (objects[mid].oidLen + 1) && oid[oidLen - 1] == 0)
+         if(oidLen == (match->oidLen + 1) && oid[oidLen - 1] == 0)
          {
             //Return a pointer to the matching object
-            *object = &objects[mid];
+            *object = match;
             //No error to report
             error = NO_ERROR;
          }
@@ -774,10 +914,10 @@ error_t snmpFindMibObject(SnmpAgentContext *context,
       else
       {
          //Check the length of the OID
-         if(oidLen > objects[mid].oidLen)
+         if(oidLen > match->oidLen)
          {
             //Return a pointer to the matching object
-            *object = &objects[mid];
+            *object = match;
             //No error to report
             error = NO_ERROR;
          }
@@ -798,4 +938,141 @@ error_t snmpFindMibObject(SnmpAgentContext *context,
    return error;
 }
 
+#if (SNMP_AGENT_OBJECT_INDEX_SUPPORT == ENABLED)
+
+/**
+ * @brief Build the sorted index of the objects of all loaded MIBs
+ * @param[in] context Pointer to the SNMP agent context
+ **/
+
+void snmpBuildObjectIndex(SnmpAgentContext *context)
+{
+   uint_t i;
+   uint_t j;
+   uint_t k;
+   uint_t numObjects;
+   const MibObject *object;
+
+   //Clear the index
+   context->objectIndexLen = 0;
+   context->objectIndexValid = TRUE;
+   context->objectIndexHint = 0;
+
+   //Loop through MIBs
+   for(i = 0; i < SNMP_AGENT_MAX_MIBS; i++)
+   {
+      //Valid MIB?
+      if(context->mibTable[i] != NULL)
+      {
+         //Get the total number of objects
+         numObjects = context->mibTable[i]->numObjects;
+
+         //Make sure the index is large enough to hold all the objects
+         if((context->objectIndexLen + numObjects) > SNMP_AGENT_OBJECT_INDEX_SIZE)
+         {
+            //Debug message
+            TRACE_WARNING("SNMP object index is too small (%u objects)!\r\n",
+               context->objectIndexLen + numObjects);
+
+            //Fall back to the per-MIB search
+            context->objectIndexLen = 0;
+            context->objectIndexValid = FALSE;
+            break;
+         }
+
+         //The objects of a given MIB are already sorted, so they can be
+         //merged into the index starting from the end
+         k = context->objectIndexLen + numObjects;
+         j = context->objectIndexLen;
+
+         //Merge the objects of the current MIB
+         while(numObjects > 0)
+         {
+            //Point to the last object that is not yet merged
+            object = &context->mibTable[i]->objects[numObjects - 1];
+
+            //Compare against the last indexed object
+            if(j > 0 && oidComp(context->objectIndex[j - 1]->oid,
+               context->objectIndex[j - 1]->oidLen, object->oid,
+               object->oidLen) > 0)
+            {
+               context->objectIndex[--k] = context->objectIndex[--j];
+            }
+            else
+            {
+               context->objectIndex[--k] = object;
+               numObjects--;
+            }
+         }
+
+         //Update the number of indexed objects
+         context->objectIndexLen += context->mibTable[i]->numObjects;
+      }
+   }
+}
+
+
+/**
+ * @brief Search the index for the first object that does not precede an OID
+ * @param[in] context Pointer to the SNMP agent context
+ * @param[in] oid Object identifier
+ * @param[in] oidLen Length of the OID
+ * @return Position of the object in the index
+ **/
+
+uint_t snmpFindIndexedObject(SnmpAgentContext *context, const uint8_t *oid,
+   size_t oidLen)
+{
+   uint_t left;
+   uint_t right;
+   uint_t mid;
+   const MibObject *object;
+
+   //Table walks (GetNext and GetBulk) typically request the next instance of
+   //the object that was returned last
+   if(context->objectIndexHint < context->objectIndexLen)
+   {
+      //Point to the object that was returned last
+      object = context->objectIndex[context->objectIndexHint];
+
+      //The OID designates an instance of this object?
+      if(oidLen >= object->oidLen &&
+         oidComp(oid, object->oidLen, object->oid, object->oidLen) == 0)
+      {
+         //All the preceding objects lexicographically precede the OID
+         return context->objectIndexHint;
+      }
+   }
+
+   //Index of the first item
+   left = 0;
+   //Index past the last item
+   right = context->objectIndexLen;
+
+   //Binary search algorithm
+   while(left < right)
+   {
+      //Calculate the index of the middle item
+      mid = left + (right - left) / 2;
+
+      //Point to the middle object
+      object = context->objectIndex[mid];
+
+      //Discard instance sub-identifier and perform lexicographic comparison
+      if(oidComp(oid, MIN(oidLen, object->oidLen), object->oid,
+         object->oidLen) > 0)
+      {
+         left = mid + 1;
+      }
+      else
+      {
+         right = mid;
+      }
+   }
+
+   //Return the position of the first object that does not precede the OID
+   return left;
+}
+
+#endif
 #endif
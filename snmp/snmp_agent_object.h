@@ -50,9 +50,18 @@ error_t snmpGetObjectValue(SnmpAgentContext *context,
 error_t snmpGetNextObject(SnmpAgentContext *context,
    const SnmpMessage *message, SnmpVarBind *var);
 
+error_t snmpGetNextInstance(SnmpAgentContext *context,
+   const SnmpMessage *message, const MibObject *object, uint8_t *curOid,
+   size_t *curOidLen, size_t maxLen, size_t *nextOidLen);
+
 error_t snmpFindMibObject(SnmpAgentContext *context,
    const uint8_t *oid, size_t oidLen, const MibObject **object);
 
+void snmpBuildObjectIndex(SnmpAgentContext *context);
+
+uint_t snmpFindIndexedObject(SnmpAgentContext *context, const uint8_t *oid,
+   size_t oidLen);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -133,7 +133,7 @@ error_t snmpFormatTrapMessage(SnmpAgentContext *context, SnmpVersion version,
       if((context->response.msgFlags & SNMP_MSG_FLAG_PRIV) != 0)
       {
          //Encrypt data
-         error = snmpEncryptData(&context->user, &context->response,
+         error = snmpEncryptData(context, &context->user, &context->response,
             &context->salt);
          //Any error to report?
          if(error)
@@ -150,7 +150,8 @@ error_t snmpFormatTrapMessage(SnmpAgentContext *context, SnmpVersion version,
       if((context->response.msgFlags & SNMP_MSG_FLAG_AUTH) != 0)
       {
          //Authenticate outgoing SNMP message
-         error = snmpAuthOutgoingMessage(&context->user, &context->response);
+         error = snmpAuthOutgoingMessage(context, &context->user,
+            &context->response);
          //Any error to report?
          if(error)
             return error;
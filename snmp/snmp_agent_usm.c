@@ -461,16 +461,18 @@ error_t snmpCheckEngineTime(SnmpAgentContext *context, SnmpMessage *message)
 
 /**
  * @brief Authenticate outgoing SNMP message
+ * @param[in] context Pointer to the SNMP agent context
  * @param[in] user Security profile of the user
  * @param[in,out] message Pointer to the outgoing SNMP message
  * @return Error code
  **/
 
-error_t snmpAuthOutgoingMessage(const SnmpUserEntry *user, SnmpMessage *message)
+error_t snmpAuthOutgoingMessage(SnmpAgentContext *context,
+   const SnmpUserEntry *user, SnmpMessage *message)
 {
    const HashAlgo *hashAlgo;
    size_t macLen;
-   HmacContext hmacContext;
+   uint8_t digest[SNMP_MAX_KEY_SIZE];
 
    //Get the hash algorithm to be used for HMAC computation
    hashAlgo = snmpGetHashAlgo(user->authProtocol);
@@ -487,12 +489,11 @@ error_t snmpAuthOutgoingMessage(const SnmpUserEntry *user, SnmpMessage *message)
       return ERROR_FAILURE;
 
    //The MAC is calculated over the whole message
-   hmacInit(&hmacContext, hashAlgo, user->localizedAuthKey.b, hashAlgo->digestSize);
-   hmacUpdate(&hmacContext, message->pos, message->length);
-   hmacFinal(&hmacContext, NULL);
+   snmpComputeMac(context, user, hashAlgo, message->pos, message->length,
+      digest);
 
    //Replace the msgAuthenticationParameters field with the calculated MAC
-   osMemcpy(message->msgAuthParameters, hmacContext.digest, macLen);
+   osMemcpy(message->msgAuthParameters, digest, macLen);
 
    //Successful message authentication
    return NO_ERROR;
@@ -501,17 +502,19 @@ error_t snmpAuthOutgoingMessage(const SnmpUserEntry *user, SnmpMessage *message)
 
 /**
  * @brief Authenticate incoming SNMP message
+ * @param[in] context Pointer to the SNMP agent context
  * @param[in] user Security profile of the user
  * @param[in] message Pointer to the incoming SNMP message
  * @return Error code
  **/
 
-error_t snmpAuthIncomingMessage(const SnmpUserEntry *user, SnmpMessage *message)
+error_t snmpAuthIncomingMessage(SnmpAgentContext *context,
+   const SnmpUserEntry *user, SnmpMessage *message)
 {
    const HashAlgo *hashAlgo;
    size_t macLen;
    uint8_t mac[SNMP_MAX_TRUNCATED_MAC_SIZE];
-   HmacContext hmacContext;
+   uint8_t digest[SNMP_MAX_KEY_SIZE];
 
    //Get the hash algorithm to be used for HMAC computation
    hashAlgo = snmpGetHashAlgo(user->authProtocol);
@@ -535,16 +538,15 @@ error_t snmpAuthIncomingMessage(const SnmpUserEntry *user, SnmpMessage *message)
    osMemset(message->msgAuthParameters, 0, macLen);
 
    //The MAC is calculated over the whole message
-   hmacInit(&hmacContext, hashAlgo, user->localizedAuthKey.b, hashAlgo->digestSize);
-   hmacUpdate(&hmacContext, message->buffer, message->bufferLen);
-   hmacFinal(&hmacContext, NULL);
+   snmpComputeMac(context, user, hashAlgo, message->buffer, message->bufferLen,
+      digest);
 
    //Restore the value of the msgAuthenticationParameters field
    osMemcpy(message->msgAuthParameters, mac, macLen);
 
    //The newly calculated MAC is compared with the MAC value that was
    //saved in the first step
-   if(osMemcmp(hmacContext.digest, mac, macLen))
+   if(osMemcmp(digest, mac, macLen))
       return ERROR_AUTHENTICATION_FAILED;
 
    //Successful message authentication
@@ -552,21 +554,76 @@ error_t snmpAuthIncomingMessage(const SnmpUserEntry *user, SnmpMessage *message)
 }
 
 
+/**
+ * @brief Compute the HMAC of a message using the localized authentication key
+ * @param[in] context Pointer to the SNMP agent context
+ * @param[in] user Security profile of the user
+ * @param[in] hashAlgo Hash algorithm to be used
+ * @param[in] data Pointer to the message
+ * @param[in] length Length of the message, in bytes
+ * @param[out] digest Resulting MAC (not truncated)
+ **/
+
+void snmpComputeMac(SnmpAgentContext *context, const SnmpUserEntry *user,
+   const HashAlgo *hashAlgo, const uint8_t *data, size_t length,
+   uint8_t *digest)
+{
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+   HashContext hashContext;
+   SnmpKeyCacheEntry *entry;
+
+   //Retrieve the precomputed HMAC states of the user
+   entry = snmpGetKeyCacheEntry(context, user);
+
+   //Cache hit?
+   if(entry != NULL)
+   {
+      //Resume the inner hash from the state reached after the inner padding
+      hashContext = entry->innerHashContext;
+      hashAlgo->update(&hashContext, data, length);
+      hashAlgo->final(&hashContext, digest);
+
+      //Resume the outer hash from the state reached after the outer padding
+      hashContext = entry->outerHashContext;
+      hashAlgo->update(&hashContext, digest, hashAlgo->digestSize);
+      hashAlgo->final(&hashContext, digest);
+   }
+   else
+#endif
+   {
+      HmacContext hmacContext;
+
+      //Compute HMAC from scratch
+      hmacInit(&hmacContext, hashAlgo, user->localizedAuthKey.b,
+         hashAlgo->digestSize);
+      hmacUpdate(&hmacContext, data, length);
+      hmacFinal(&hmacContext, digest);
+   }
+}
+
+
 /**
  * @brief Data encryption
+ * @param[in] context Pointer to the SNMP agent context
  * @param[in] user Security profile of the user
  * @param[in,out] message Pointer to the outgoing SNMP message
  * @param[in,out] salt Pointer to the salt integer
  * @return Error code
  **/
 
-error_t snmpEncryptData(const SnmpUserEntry *user, SnmpMessage *message,
-   uint64_t *salt)
+error_t snmpEncryptData(SnmpAgentContext *context, const SnmpUserEntry *user,
+   SnmpMessage *message, uint64_t *salt)
 {
    error_t error;
    uint_t i;
    size_t n;
    Asn1Tag tag;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+   SnmpKeyCacheEntry *entry;
+
+   //Retrieve the expanded cipher key of the user
+   entry = snmpGetKeyCacheEntry(context, user);
+#endif
 
    //Debug message
    TRACE_DEBUG("Scoped PDU (%" PRIuSIZE " bytes):\r\n", message->length);
@@ -602,11 +659,22 @@ error_t snmpEncryptData(const SnmpUserEntry *user, SnmpMessage *message,
       //The resulting salt is then put into the msgPrivacyParameters field
       message->msgPrivParametersLen = 8;
 
-      //Initialize DES context
-      error = desInit(&desContext, user->localizedPrivKey.b, 8);
-      //Initialization failed?
-      if(error)
-         return error;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+      //Cache hit?
+      if(entry != NULL)
+      {
+         //Reuse the DES key schedule
+         desContext = entry->desContext;
+      }
+      else
+#endif
+      {
+         //Initialize DES context
+         error = desInit(&desContext, user->localizedPrivKey.b, 8);
+         //Initialization failed?
+         if(error)
+            return error;
+      }
 
       //The last 8 octets of the 16-octet secret (private privacy key) are
       //used as pre-IV
@@ -647,11 +715,22 @@ error_t snmpEncryptData(const SnmpUserEntry *user, SnmpMessage *message,
       STORE64BE(*salt, message->msgPrivParameters);
       message->msgPrivParametersLen = 8;
 
-      //Initialize AES context
-      error = aesInit(&aesContext, user->localizedPrivKey.b, 16);
-      //Initialization failed?
-      if(error)
-         return error;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+      //Cache hit?
+      if(entry != NULL)
+      {
+         //Reuse the AES key schedule
+         aesContext = entry->aesContext;
+      }
+      else
+#endif
+      {
+         //Initialize AES context
+         error = aesInit(&aesContext, user->localizedPrivKey.b, 16);
+         //Initialization failed?
+         if(error)
+            return error;
+      }
 
       //Perform CFB-128 encryption
       error = cfbEncrypt(AES_CIPHER_ALGO, &aesContext, 128, iv, message->pos,
@@ -697,16 +776,24 @@ error_t snmpEncryptData(const SnmpUserEntry *user, SnmpMessage *message,
 
 /**
  * @brief Data decryption
+ * @param[in] context Pointer to the SNMP agent context
  * @param[in] user Security profile of the user
  * @param[in,out] message Pointer to the incoming SNMP message
  * @return Error code
  **/
 
-error_t snmpDecryptData(const SnmpUserEntry *user, SnmpMessage *message)
+error_t snmpDecryptData(SnmpAgentContext *context, const SnmpUserEntry *user,
+   SnmpMessage *message)
 {
    error_t error;
    uint_t i;
    Asn1Tag tag;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+   SnmpKeyCacheEntry *entry;
+
+   //Retrieve the expanded cipher key of the user
+   entry = snmpGetKeyCacheEntry(context, user);
+#endif
 
    //The encryptedPDU is encapsulated within an octet string
    error = asn1ReadTag(message->pos, message->length, &tag);
@@ -741,11 +828,22 @@ error_t snmpDecryptData(const SnmpUserEntry *user, SnmpMessage *message)
       if(message->msgPrivParametersLen != 8)
          return ERROR_DECRYPTION_FAILED;
 
-      //Initialize DES context
-      error = desInit(&desContext, user->localizedPrivKey.b, 8);
-      //Initialization failed?
-      if(error)
-         return error;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+      //Cache hit?
+      if(entry != NULL)
+      {
+         //Reuse the DES key schedule
+         desContext = entry->desContext;
+      }
+      else
+#endif
+      {
+         //Initialize DES context
+         error = desInit(&desContext, user->localizedPrivKey.b, 8);
+         //Initialization failed?
+         if(error)
+            return error;
+      }
 
       //The last 8 octets of the 16-octet secret (private privacy key) are
       //used as pre-IV
@@ -784,11 +882,22 @@ error_t snmpDecryptData(const SnmpUserEntry *user, SnmpMessage *message)
       //The 64-bit integer is then converted to the last 8 octets
       osMemcpy(iv + 8, message->msgPrivParameters, 8);
 
-      //Initialize AES context
-      error = aesInit(&aesContext, user->localizedPrivKey.b, 16);
-      //Initialization failed?
-      if(error)
-         return error;
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+      //Cache hit?
+      if(entry != NULL)
+      {
+         //Reuse the AES key schedule
+         aesContext = entry->aesContext;
+      }
+      else
+#endif
+      {
+         //Initialize AES context
+         error = aesInit(&aesContext, user->localizedPrivKey.b, 16);
+         //Initialization failed?
+         if(error)
+            return error;
+      }
 
       //Perform CFB-128 encryption
       error = cfbDecrypt(AES_CIPHER_ALGO, &aesContext, 128, iv, message->pos,
@@ -817,6 +926,159 @@ error_t snmpDecryptData(const SnmpUserEntry *user, SnmpMessage *message)
 }
 
 
+/**
+ * @brief Retrieve the precomputed key material of a user
+ *
+ * Entries are looked up by protocols and localized keys, so that any key
+ * change (snmpChangeKey, key localization or cloning) automatically causes
+ * the key material to be computed again
+ *
+ * @param[in] context Pointer to the SNMP agent context
+ * @param[in] user Security profile of the user
+ * @return Pointer to the matching entry, or NULL if the key material cannot
+ *   be computed
+ **/
+
+SnmpKeyCacheEntry *snmpGetKeyCacheEntry(SnmpAgentContext *context,
+   const SnmpUserEntry *user)
+{
+#if (SNMP_KEY_CACHE_SUPPORT == ENABLED)
+   error_t error;
+   uint_t i;
+   systime_t time;
+   const HashAlgo *hashAlgo;
+   SnmpKeyCacheEntry *entry;
+   SnmpKeyCacheEntry *oldestEntry;
+   uint8_t pad[MAX_HASH_BLOCK_SIZE];
+
+   //Get current time
+   time = osGetSystemTime();
+
+   //Keep track of the least recently used entry
+   oldestEntry = &context->keyCache[0];
+
+   //Loop through the key cache
+   for(i = 0; i < SNMP_KEY_CACHE_SIZE; i++)
+   {
+      //Point to the current entry
+      entry = &context->keyCache[i];
+
+      //Check whether the entry is currently in use
+      if(entry->valid)
+      {
+         //Compare protocols and localized keys
+         if(entry->authProtocol == user->authProtocol &&
+            entry->privProtocol == user->privProtocol &&
+            !osMemcmp(&entry->localizedAuthKey, &user->localizedAuthKey,
+            sizeof(SnmpKey)) &&
+            !osMemcmp(&entry->localizedPrivKey, &user->localizedPrivKey,
+            sizeof(SnmpKey)))
+         {
+            //Save the time of last use
+            entry->timestamp = time;
+            //The key material is already available
+            return entry;
+         }
+
+         //Keep track of the least recently used entry
+         if(oldestEntry->valid &&
+            timeCompare(entry->timestamp, oldestEntry->timestamp) < 0)
+         {
+            oldestEntry = entry;
+         }
+      }
+      else
+      {
+         //Free entries are used first
+         oldestEntry = entry;
+      }
+   }
+
+   //Get the hash algorithm to be used for HMAC computation
+   hashAlgo = snmpGetHashAlgo(user->authProtocol);
+
+   //Invalid authentication protocol?
+   if(hashAlgo == NULL)
+      return NULL;
+
+   //The localized key cannot be longer than the block size
+   if(hashAlgo->digestSize > hashAlgo->blockSize)
+      return NULL;
+
+   //Point to the entry to be reused
+   entry = oldestEntry;
+   entry->valid = FALSE;
+
+   //Save protocols and localized keys
+   entry->authProtocol = user->authProtocol;
+   entry->localizedAuthKey = user->localizedAuthKey;
+   entry->privProtocol = user->privProtocol;
+   entry->localizedPrivKey = user->localizedPrivKey;
+
+   //The key is padded with zeros to the block size of the hash function
+   osMemset(pad, 0, hashAlgo->blockSize);
+   osMemcpy(pad, user->localizedAuthKey.b, hashAlgo->digestSize);
+
+   //XOR the resulting key with ipad (refer to RFC 2104, section 2)
+   for(i = 0; i < hashAlgo->blockSize; i++)
+   {
+      pad[i] ^= 0x36;
+   }
+
+   //Save the hash state after the inner padding
+   hashAlgo->init(&entry->innerHashContext);
+   hashAlgo->update(&entry->innerHashContext, pad, hashAlgo->blockSize);
+
+   //XOR the original key with opad
+   for(i = 0; i < hashAlgo->blockSize; i++)
+   {
+      pad[i] ^= 0x36 ^ 0x5C;
+   }
+
+   //Save the hash state after the outer padding
+   hashAlgo->init(&entry->outerHashContext);
+   hashAlgo->update(&entry->outerHashContext, pad, hashAlgo->blockSize);
+
+   //Clear the padded key from the stack
+   osMemset(pad, 0, sizeof(pad));
+
+   //Initialize status code
+   error = NO_ERROR;
+
+#if (SNMP_DES_SUPPORT == ENABLED)
+   //DES-CBC privacy protocol?
+   if(user->privProtocol == SNMP_PRIV_PROTOCOL_DES)
+   {
+      //Expand the DES key
+      error = desInit(&entry->desContext, user->localizedPrivKey.b, 8);
+   }
+#endif
+#if (SNMP_AES_SUPPORT == ENABLED)
+   //AES-128-CFB privacy protocol?
+   if(user->privProtocol == SNMP_PRIV_PROTOCOL_AES)
+   {
+      //Expand the AES key
+      error = aesInit(&entry->aesContext, user->localizedPrivKey.b, 16);
+   }
+#endif
+
+   //Failed to expand the cipher key?
+   if(error)
+      return NULL;
+
+   //The entry is now valid
+   entry->valid = TRUE;
+   entry->timestamp = time;
+
+   //Return a pointer to the entry
+   return entry;
+#else
+   //Not implemented
+   return NULL;
+#endif
+}
+
+
 /**
  * @brief Get the hash algorithm to be used for a given authentication protocol
  * @param[in] authProtocol Authentication protocol (MD5, SHA-1, SHA-224,
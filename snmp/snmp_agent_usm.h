@@ -100,6 +100,20 @@
    #error SNMP_AES_SUPPORT parameter is not valid
 #endif
 
+//Caching of HMAC states and cipher key schedules
+#ifndef SNMP_KEY_CACHE_SUPPORT
+   #define SNMP_KEY_CACHE_SUPPORT DISABLED
+#elif (SNMP_KEY_CACHE_SUPPORT != ENABLED && SNMP_KEY_CACHE_SUPPORT != DISABLED)
+   #error SNMP_KEY_CACHE_SUPPORT parameter is not valid
+#endif
+
+//Number of entries in the key cache
+#ifndef SNMP_KEY_CACHE_SIZE
+   #define SNMP_KEY_CACHE_SIZE 4
+#elif (SNMP_KEY_CACHE_SIZE < 1)
+   #error SNMP_KEY_CACHE_SIZE parameter is not valid
+#endif
+
 //Support for MD5 authentication?
 #if (SNMP_MD5_SUPPORT == ENABLED)
    #include "hash/md5.h"
@@ -309,6 +323,29 @@ typedef struct
 } SnmpUserEntry;
 
 
+/**
+ * @brief Key cache entry
+ **/
+
+typedef struct
+{
+   bool_t valid;                    ///<Valid entry
+   SnmpAuthProtocol authProtocol;   ///<Authentication protocol
+   SnmpKey localizedAuthKey;        ///<Localized authentication key
+   SnmpPrivProtocol privProtocol;   ///<Privacy protocol
+   SnmpKey localizedPrivKey;        ///<Localized privacy key
+   HashContext innerHashContext;    ///<Hash state after the inner padding
+   HashContext outerHashContext;    ///<Hash state after the outer padding
+#if (SNMP_DES_SUPPORT == ENABLED)
+   DesContext desContext;           ///<DES key schedule
+#endif
+#if (SNMP_AES_SUPPORT == ENABLED)
+   AesContext aesContext;           ///<AES key schedule
+#endif
+   systime_t timestamp;             ///<Time of last use
+} SnmpKeyCacheEntry;
+
+
 //USM related constants
 extern const uint8_t usmStatsUnsupportedSecLevelsObject[10];
 extern const uint8_t usmStatsNotInTimeWindowsObject[10];
@@ -341,13 +378,24 @@ error_t snmpCheckSecurityParameters(const SnmpUserEntry *user,
 void snmpRefreshEngineTime(SnmpAgentContext *context);
 error_t snmpCheckEngineTime(SnmpAgentContext *context, SnmpMessage *message);
 
-error_t snmpAuthOutgoingMessage(const SnmpUserEntry *user, SnmpMessage *message);
-error_t snmpAuthIncomingMessage(const SnmpUserEntry *user, SnmpMessage *message);
+error_t snmpAuthOutgoingMessage(SnmpAgentContext *context,
+   const SnmpUserEntry *user, SnmpMessage *message);
+
+error_t snmpAuthIncomingMessage(SnmpAgentContext *context,
+   const SnmpUserEntry *user, SnmpMessage *message);
+
+void snmpComputeMac(SnmpAgentContext *context, const SnmpUserEntry *user,
+   const HashAlgo *hashAlgo, const uint8_t *data, size_t length,
+   uint8_t *digest);
+
+error_t snmpEncryptData(SnmpAgentContext *context, const SnmpUserEntry *user,
+   SnmpMessage *message, uint64_t *salt);
 
-error_t snmpEncryptData(const SnmpUserEntry *user, SnmpMessage *message,
-   uint64_t *salt);
+error_t snmpDecryptData(SnmpAgentContext *context, const SnmpUserEntry *user,
+   SnmpMessage *message);
 
-error_t snmpDecryptData(const SnmpUserEntry *user, SnmpMessage *message);
+SnmpKeyCacheEntry *snmpGetKeyCacheEntry(SnmpAgentContext *context,
+   const SnmpUserEntry *user);
 
 const HashAlgo *snmpGetHashAlgo(SnmpAuthProtocol authProtocol);
 size_t snmpGetMacLength(SnmpAuthProtocol authProtocol);
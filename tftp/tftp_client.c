@@ -33,6 +33,7 @@
  * - RFC 1782: TFTP Option Extension
  * - RFC 1783: TFTP Blocksize Option
  * - RFC 1784: TFTP Timeout Interval and Transfer Size Options
+ * - RFC 7440: TFTP Windowsize Option
  *
  * @author Oryx Embedded SARL (www.oryx-embedded.com)
  * @version 2.1.4
@@ -159,6 +160,9 @@ error_t tftpClientOpenFile(TftpClientContext *context,
             //Check status code
             if(!error)
             {
+               //Default parameters apply unless the server acknowledges options
+               tftpClientResetOptions(context);
+
                //Send WRQ packet
                if((mode & TFTP_FILE_MODE_NETASCII) != 0)
                {
@@ -212,6 +216,9 @@ error_t tftpClientOpenFile(TftpClientContext *context,
             //Check status code
             if(!error)
             {
+               //Default parameters apply unless the server acknowledges options
+               tftpClientResetOptions(context);
+
                //Send RRQ packet
                if((mode & TFTP_FILE_MODE_NETASCII) != 0)
                {
@@ -300,10 +307,10 @@ error_t tftpClientWriteFile(TftpClientContext *context,
       else if(context->state == TFTP_CLIENT_STATE_ACK)
       {
          //Send buffer available for writing?
-         if(context->outDataLen < TFTP_CLIENT_BLOCK_SIZE)
+         if(context->outDataLen < context->blockSize)
          {
             //Compute the number of bytes available
-            n = TFTP_CLIENT_BLOCK_SIZE - context->outDataLen;
+            n = context->blockSize - context->outDataLen;
             //Limit the number of bytes to copy at a time
             n = MIN(n, length - totalLength);
 
@@ -320,7 +327,7 @@ error_t tftpClientWriteFile(TftpClientContext *context,
          }
 
          //Check whether the send buffer is full
-         if(context->outDataLen >= TFTP_CLIENT_BLOCK_SIZE)
+         if(context->outDataLen >= context->blockSize)
          {
             //The block number increases by one for each new block of data
             context->block++;
@@ -464,24 +471,43 @@ error_t tftpClientReadFile(TftpClientContext *context,
          //Check whether the receive buffer is empty
          if(context->inDataPos >= context->inDataLen)
          {
-            //Acknowledge the DATA packet
-            tftpClientSendAckPacket(context);
-
-            //Increment block number
-            context->block++;
+            //Update the number of blocks received in the current window
+            context->windowCount++;
 
             //Check the length of the DATA packet
-            if(context->inDataLen < TFTP_CLIENT_BLOCK_SIZE)
+            if(context->inDataLen < context->blockSize)
             {
-               //A data packet of less than 512 bytes signals termination
+               //Acknowledge the last DATA packet
+               tftpClientSendAckPacket(context, context->block);
+
+               //A data packet of less than blksize bytes signals termination
                //of the transfer
                context->state = TFTP_CLIENT_STATE_COMPLETE;
             }
             else
             {
+               //The receiver acknowledges the last DATA packet of each window
+               if(context->windowCount >= context->windowSize)
+               {
+                  //Acknowledge the DATA packet
+                  tftpClientSendAckPacket(context, context->block);
+                  //Start a new window
+                  context->windowCount = 0;
+               }
+               else
+               {
+                  //Defer the acknowledgment until the window is complete
+                  context->timestamp = osGetSystemTime();
+                  //Reset retransmission counter
+                  context->retransmitCount = 0;
+               }
+
                //Wait for the next DATA packet to be received
                context->state = TFTP_CLIENT_STATE_ACK;
             }
+
+            //Increment block number
+            context->block++;
          }
       }
       else if(context->state == TFTP_CLIENT_STATE_ACK)
@@ -538,6 +564,36 @@ error_t tftpClientCloseFile(TftpClientContext *context)
 }
 
 
+/**
+ * @brief Retrieve the transfer size reported by the server
+ * @param[in] context Pointer to the TFTP client context
+ * @param[out] size Size of the file, in bytes
+ * @return Error code
+ **/
+
+error_t tftpClientGetTransferSize(TftpClientContext *context, size_t *size)
+{
+   //Check parameters
+   if(context == NULL || size == NULL)
+      return ERROR_INVALID_PARAMETER;
+
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   //The tsize option must have been acknowledged by the server
+   if((context->options & TFTP_OPTION_TSIZE) == 0)
+      return ERROR_NOT_FOUND;
+
+   //Return the size of the file
+   *size = context->tsize;
+
+   //Successful processing
+   return NO_ERROR;
+#else
+   //Option negotiation is not supported
+   return ERROR_NOT_IMPLEMENTED;
+#endif
+}
+
+
 /**
  * @brief Release TFTP client context
  * @param[in] context Pointer to the TFTP client context
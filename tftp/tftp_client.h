@@ -77,8 +77,33 @@
    #error TFTP_CLIENT_BLOCK_SIZE parameter is not valid
 #endif
 
+//TFTP option negotiation support (blksize, windowsize and tsize)
+#ifndef TFTP_CLIENT_OPTION_SUPPORT
+   #define TFTP_CLIENT_OPTION_SUPPORT DISABLED
+#elif (TFTP_CLIENT_OPTION_SUPPORT != ENABLED && TFTP_CLIENT_OPTION_SUPPORT != DISABLED)
+   #error TFTP_CLIENT_OPTION_SUPPORT parameter is not valid
+#endif
+
+//Block size requested by the client
+#ifndef TFTP_CLIENT_MAX_BLOCK_SIZE
+   #define TFTP_CLIENT_MAX_BLOCK_SIZE 1428
+#elif (TFTP_CLIENT_MAX_BLOCK_SIZE < TFTP_CLIENT_BLOCK_SIZE || TFTP_CLIENT_MAX_BLOCK_SIZE > 65464)
+   #error TFTP_CLIENT_MAX_BLOCK_SIZE parameter is not valid
+#endif
+
+//Window size requested by the client (read operations)
+#ifndef TFTP_CLIENT_WINDOW_SIZE
+   #define TFTP_CLIENT_WINDOW_SIZE 8
+#elif (TFTP_CLIENT_WINDOW_SIZE < 1 || TFTP_CLIENT_WINDOW_SIZE > 65535)
+   #error TFTP_CLIENT_WINDOW_SIZE parameter is not valid
+#endif
+
 //Maximum size of TFTP packets
-#define TFTP_CLIENT_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_CLIENT_BLOCK_SIZE)
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   #define TFTP_CLIENT_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_CLIENT_MAX_BLOCK_SIZE)
+#else
+   #define TFTP_CLIENT_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_CLIENT_BLOCK_SIZE)
+#endif
 
 //C++ guard
 #ifdef __cplusplus
@@ -129,6 +154,13 @@ typedef struct
    Socket *socket;                                 ///<Underlying UDP socket
    TftpClientState state;                          ///<TFTP client state
    uint16_t block;                                 ///<Block number
+   size_t blockSize;                               ///<Negotiated block size
+   uint16_t windowSize;                            ///<Negotiated window size
+   uint16_t windowCount;                           ///<Number of blocks received in the current window
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   uint_t options;                                 ///<Options acknowledged by the server
+   size_t tsize;                                   ///<Transfer size
+#endif
    systime_t timestamp;                            ///<Time stamp to manage retransmissions
    uint_t retransmitCount;                         ///<Retransmission counter
    uint8_t inPacket[TFTP_CLIENT_MAX_PACKET_SIZE];  ///<Incoming TFTP packet
@@ -163,6 +195,8 @@ error_t tftpClientReadFile(TftpClientContext *context,
 
 error_t tftpClientCloseFile(TftpClientContext *context);
 
+error_t tftpClientGetTransferSize(TftpClientContext *context, size_t *size);
+
 void tftpClientDeinit(TftpClientContext *context);
 
 //C++ guard
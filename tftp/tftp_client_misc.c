@@ -214,6 +214,15 @@ void tftpClientProcessPacket(TftpClientContext *context,
       tftpClientProcessAckPacket(context, srcPort,
          (TftpAckPacket *) context->inPacket, context->inPacketLen);
    }
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   //Option acknowledgment packet received?
+   else if(opcode == TFTP_OPCODE_OACK)
+   {
+      //Process OACK packet
+      tftpClientProcessOackPacket(context, srcPort,
+         (TftpOackPacket *) context->inPacket, context->inPacketLen);
+   }
+#endif
    //Error packet received?
    else if(opcode == TFTP_OPCODE_ERROR)
    {
@@ -288,11 +297,25 @@ void tftpClientProcessDataPacket(TftpClientContext *context,
             context->inDataLen = length;
             context->inDataPos = 0;
          }
-         else
+         else if(context->windowCount > 0)
+         {
+            //When a gap is detected, the receiver acknowledges the last DATA
+            //packet received in sequence (refer to RFC 7440, section 4)
+            tftpClientSendAckPacket(context, context->block - 1);
+
+            //Start a new window
+            context->windowCount = 0;
+         }
+         else if(context->windowSize == 1)
          {
             //Retransmit ACK packet
             tftpClientRetransmitPacket(context);
          }
+         else
+         {
+            //Discard out-of-sequence DATA packets until the server restarts
+            //the window
+         }
       }
    }
 }
@@ -384,6 +407,84 @@ void tftpClientProcessAckPacket(TftpClientContext *context,
 }
 
 
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+
+/**
+ * @brief Process incoming OACK packet
+ * @param[in] context Pointer to the TFTP client context
+ * @param[in] srcPort Source port number
+ * @param[in] oackPacket Pointer to the OACK packet
+ * @param[in] length Length of the packet, in bytes
+ **/
+
+void tftpClientProcessOackPacket(TftpClientContext *context,
+   uint16_t srcPort, const TftpOackPacket *oackPacket, size_t length)
+{
+   error_t error;
+
+   //Debug message
+   TRACE_DEBUG("TFTP Client: OACK packet received (%" PRIuSIZE " bytes)...\r\n",
+      length);
+
+   //Make sure the length of the OACK packet is acceptable
+   if(length <= sizeof(TftpOackPacket))
+      return;
+
+   //Compute the length of the option list
+   length -= sizeof(TftpOackPacket);
+
+   //Malformed OACK packet?
+   if(oackPacket->options[length - 1] != '\0')
+      return;
+
+   //Debug message
+   TRACE_DEBUG("  Opcode = %" PRIu16 "\r\n", ntohs(oackPacket->opcode));
+
+   //The OACK packet is only expected in response to a request
+   if(context->state != TFTP_CLIENT_STATE_RRQ &&
+      context->state != TFTP_CLIENT_STATE_WRQ)
+   {
+      return;
+   }
+
+   //Save the TID chosen by the server
+   context->serverTid = srcPort;
+
+   //Parse the options acknowledged by the server
+   error = tftpClientParseOptions(context, oackPacket->options, length);
+
+   //Any error to report?
+   if(error)
+   {
+      //The client terminates the transfer if it does not accept the
+      //acknowledged options (refer to RFC 2347)
+      tftpClientSendErrorPacket(context, TFTP_ERROR_OPTION_NEGOTIATION,
+         "Invalid option");
+
+      //Report an error
+      context->state = TFTP_CLIENT_STATE_ERROR;
+   }
+   else if(context->state == TFTP_CLIENT_STATE_RRQ)
+   {
+      //The client acknowledges the OACK packet with block number zero
+      tftpClientSendAckPacket(context, 0);
+
+      //Wait for the first DATA packet to be received
+      context->state = TFTP_CLIENT_STATE_ACK;
+   }
+   else
+   {
+      //The OACK packet replaces the acknowledgment with block number zero
+      context->state = TFTP_CLIENT_STATE_ACK;
+
+      //Flush the output data buffer
+      context->outDataLen = 0;
+   }
+}
+
+#endif
+
+
 /**
  * @brief Process incoming ERROR packet
  * @param[in] context Pointer to the TFTP client context
@@ -447,6 +548,10 @@ error_t tftpClientSendRrqPacket(TftpClientContext *context,
    if((m + n) > TFTP_CLIENT_BLOCK_SIZE)
       return ERROR_INVALID_PARAMETER;
 
+   //Make sure the filename and the transfer mode fit in the packet
+   if((sizeof(TftpRrqPacket) + m + n + 2) > TFTP_CLIENT_MAX_PACKET_SIZE)
+      return ERROR_INVALID_PARAMETER;
+
    //Point to the buffer where to format the packet
    rrqPacket = (TftpRrqPacket *) context->outPacket;
 
@@ -458,6 +563,18 @@ error_t tftpClientSendRrqPacket(TftpClientContext *context,
    //Compute the length of the RRQ packet
    context->outPacketLen = sizeof(TftpRrqPacket) + n + m + 2;
 
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   //Request a larger block size, a sliding window and the size of the file
+   error = tftpClientFormatOptions(context, rrqPacket->filename + m + n + 2,
+      TFTP_CLIENT_MAX_PACKET_SIZE - context->outPacketLen, FALSE, &n);
+   //The options do not fit in the packet?
+   if(error)
+      return ERROR_INVALID_PARAMETER;
+
+   //Adjust the length of the RRQ packet
+   context->outPacketLen += n;
+#endif
+
    //Debug message
    TRACE_DEBUG("TFTP Client: Sending RRQ packet (%" PRIuSIZE " bytes)...\r\n", context->outPacketLen);
    TRACE_DEBUG("  Opcode = %u\r\n", ntohs(rrqPacket->opcode));
@@ -503,6 +620,10 @@ error_t tftpClientSendWrqPacket(TftpClientContext *context,
    if((m + n) > TFTP_CLIENT_BLOCK_SIZE)
       return ERROR_INVALID_PARAMETER;
 
+   //Make sure the filename and the transfer mode fit in the packet
+   if((sizeof(TftpRrqPacket) + m + n + 2) > TFTP_CLIENT_MAX_PACKET_SIZE)
+      return ERROR_INVALID_PARAMETER;
+
    //Point to the buffer where to format the packet
    wrqPacket = (TftpWrqPacket *) context->outPacket;
 
@@ -514,6 +635,18 @@ error_t tftpClientSendWrqPacket(TftpClientContext *context,
    //Compute the length of the WRQ packet
    context->outPacketLen = sizeof(TftpRrqPacket) + n + m + 2;
 
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   //Request a larger block size
+   error = tftpClientFormatOptions(context, wrqPacket->filename + m + n + 2,
+      TFTP_CLIENT_MAX_PACKET_SIZE - context->outPacketLen, TRUE, &n);
+   //The options do not fit in the packet?
+   if(error)
+      return ERROR_INVALID_PARAMETER;
+
+   //Adjust the length of the WRQ packet
+   context->outPacketLen += n;
+#endif
+
    //Debug message
    TRACE_DEBUG("TFTP Client: Sending WRQ packet (%" PRIuSIZE " bytes)...\r\n", context->outPacketLen);
    TRACE_DEBUG("  Opcode = %u\r\n", ntohs(wrqPacket->opcode));
@@ -577,10 +710,11 @@ error_t tftpClientSendDataPacket(TftpClientContext *context)
 /**
  * @brief Send ACK packet
  * @param[in] context Pointer to the TFTP client context
+ * @param[in] block Block number
  * @return Error code
  **/
 
-error_t tftpClientSendAckPacket(TftpClientContext *context)
+error_t tftpClientSendAckPacket(TftpClientContext *context, uint16_t block)
 {
    error_t error;
    TftpAckPacket *ackPacket;
@@ -590,7 +724,7 @@ error_t tftpClientSendAckPacket(TftpClientContext *context)
 
    //Format ACK packet
    ackPacket->opcode = HTONS(TFTP_OPCODE_ACK);
-   ackPacket->block = htons(context->block);
+   ackPacket->block = htons(block);
 
    //Length of the ACK packet
    context->outPacketLen = sizeof(TftpAckPacket);
@@ -676,6 +810,21 @@ error_t tftpClientRetransmitPacket(TftpClientContext *context)
    error_t error;
    uint16_t destPort;
 
+   //Any DATA packet received in the current window that has not been
+   //acknowledged yet?
+   if(context->state == TFTP_CLIENT_STATE_ACK && context->windowCount > 0)
+   {
+      //On timeout, the receiver acknowledges the last DATA packet received
+      //in sequence (refer to RFC 7440, section 4)
+      error = tftpClientSendAckPacket(context, context->block - 1);
+
+      //Start a new window
+      context->windowCount = 0;
+
+      //Return status code
+      return error;
+   }
+
    //Select the relevant destination port
    if(context->state == TFTP_CLIENT_STATE_RRQ ||
       context->state == TFTP_CLIENT_STATE_WRQ)
@@ -701,4 +850,194 @@ error_t tftpClientRetransmitPacket(TftpClientContext *context)
    return error;
 }
 
+
+/**
+ * @brief Restore the default transfer parameters
+ * @param[in] context Pointer to the TFTP client context
+ **/
+
+void tftpClientResetOptions(TftpClientContext *context)
+{
+   //Use the default block size until another value is negotiated
+   context->blockSize = TFTP_CLIENT_BLOCK_SIZE;
+   //Lock-step transfers are used unless a larger window is negotiated
+   context->windowSize = 1;
+   context->windowCount = 0;
+
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+   //No option has been acknowledged yet
+   context->options = 0;
+   context->tsize = 0;
+#endif
+}
+
+
+#if (TFTP_CLIENT_OPTION_SUPPORT == ENABLED)
+
+/**
+ * @brief Format the options of a RRQ or WRQ packet
+ * @param[in] context Pointer to the TFTP client context
+ * @param[out] p Buffer where to format the option list
+ * @param[in] size Size of the buffer, in bytes
+ * @param[in] writeAccess Write request (TRUE) or read request (FALSE)
+ * @param[out] length Length of the option list, in bytes
+ * @return Error code
+ **/
+
+error_t tftpClientFormatOptions(TftpClientContext *context, char_t *p,
+   size_t size, bool_t writeAccess, size_t *length)
+{
+   error_t error;
+
+   //Length of the option list
+   *length = 0;
+
+   //Request the largest block size supported by the client
+   error = tftpClientAddOption(p, size, length, "blksize",
+      TFTP_CLIENT_MAX_BLOCK_SIZE);
+
+   //Read request?
+   if(!error && !writeAccess)
+   {
+#if (TFTP_CLIENT_WINDOW_SIZE > 1)
+      //The client buffers a single DATA packet, so a sliding window is only
+      //requested when the client is the receiving side
+      error = tftpClientAddOption(p, size, length, "windowsize",
+         TFTP_CLIENT_WINDOW_SIZE);
+#endif
+
+      //Check status code
+      if(!error)
+      {
+         //Ask the server to report the size of the file
+         error = tftpClientAddOption(p, size, length, "tsize", 0);
+      }
+   }
+
+   //Return status code
+   return error;
+}
+
+
+/**
+ * @brief Append an option to the option list
+ * @param[out] p Buffer where to format the option list
+ * @param[in] size Size of the buffer, in bytes
+ * @param[in,out] length Length of the option list, in bytes
+ * @param[in] name NULL-terminated string specifying the option name
+ * @param[in] value Option value
+ * @return Error code
+ **/
+
+error_t tftpClientAddOption(char_t *p, size_t size, size_t *length,
+   const char_t *name, uint_t value)
+{
+   size_t m;
+   size_t n;
+   char_t temp[12];
+
+   //Format the option value
+   osSprintf(temp, "%u", value);
+
+   //Retrieve the length of the option name and value
+   m = osStrlen(name) + 1;
+   n = osStrlen(temp) + 1;
+
+   //Make sure the buffer is large enough to hold the option
+   if((*length + m + n) > size)
+      return ERROR_BUFFER_OVERFLOW;
+
+   //Copy the option name and value, both terminated by a zero byte
+   osStrcpy(p + *length, name);
+   osStrcpy(p + *length + m, temp);
+
+   //Adjust the length of the option list
+   *length += m + n;
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+
+/**
+ * @brief Parse the options of an OACK packet
+ * @param[in] context Pointer to the TFTP client context
+ * @param[in] options Pointer to the option list
+ * @param[in] length Length of the option list, in bytes
+ * @return Error code
+ **/
+
+error_t tftpClientParseOptions(TftpClientContext *context,
+   const char_t *options, size_t length)
+{
+   size_t n;
+   unsigned long value;
+   const char_t *name;
+   const char_t *valueStr;
+
+   //Each option consists of a name and a value, both terminated by a zero byte
+   while(length > 0)
+   {
+      //Point to the option name
+      name = options;
+      n = osStrlen(name) + 1;
+
+      //Malformed option?
+      if(n >= length)
+         return ERROR_INVALID_SYNTAX;
+
+      //Point to the option value
+      valueStr = options + n;
+      n += osStrlen(valueStr) + 1;
+
+      //Debug message
+      TRACE_DEBUG("  Option %s = %s\r\n", name, valueStr);
+
+      //Option values are decimal numbers
+      value = osStrtoul(valueStr, NULL, 10);
+
+      //Option names are case-insensitive
+      if(!osStrcasecmp(name, "blksize"))
+      {
+         //The server must not acknowledge a larger block size than requested
+         if(value < TFTP_MIN_BLOCK_SIZE || value > TFTP_CLIENT_MAX_BLOCK_SIZE)
+            return ERROR_INVALID_VALUE;
+
+         //Save the negotiated block size
+         context->blockSize = value;
+         context->options |= TFTP_OPTION_BLKSIZE;
+      }
+      else if(!osStrcasecmp(name, "windowsize"))
+      {
+         //The server must not acknowledge a larger window size than requested
+         if(value < 1 || value > TFTP_CLIENT_WINDOW_SIZE)
+            return ERROR_INVALID_VALUE;
+
+         //Save the negotiated window size
+         context->windowSize = (uint16_t) value;
+         context->options |= TFTP_OPTION_WINDOWSIZE;
+      }
+      else if(!osStrcasecmp(name, "tsize"))
+      {
+         //Save the size of the file
+         context->tsize = value;
+         context->options |= TFTP_OPTION_TSIZE;
+      }
+      else
+      {
+         //The server must not acknowledge an option the client did not request
+         return ERROR_INVALID_OPTION;
+      }
+
+      //Jump to the next option
+      options += n;
+      length -= n;
+   }
+
+   //Successful processing
+   return NO_ERROR;
+}
+
+#endif
+
 #endif
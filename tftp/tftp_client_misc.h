@@ -55,6 +55,9 @@ void tftpClientProcessDataPacket(TftpClientContext *context,
 void tftpClientProcessAckPacket(TftpClientContext *context,
    uint16_t srcPort, const TftpAckPacket *ackPacket, size_t length);
 
+void tftpClientProcessOackPacket(TftpClientContext *context,
+   uint16_t srcPort, const TftpOackPacket *oackPacket, size_t length);
+
 void tftpClientProcessErrorPacket(TftpClientContext *context,
    uint16_t srcPort, const TftpErrorPacket *errorPacket, size_t length);
 
@@ -65,13 +68,24 @@ error_t tftpClientSendWrqPacket(TftpClientContext *context,
    const char_t *filename, const char_t *mode);
 
 error_t tftpClientSendDataPacket(TftpClientContext *context);
-error_t tftpClientSendAckPacket(TftpClientContext *context);
+error_t tftpClientSendAckPacket(TftpClientContext *context, uint16_t block);
 
 error_t tftpClientSendErrorPacket(TftpClientContext *context,
    uint16_t errorCode, const char_t *errorMsg);
 
 error_t tftpClientRetransmitPacket(TftpClientContext *context);
 
+void tftpClientResetOptions(TftpClientContext *context);
+
+error_t tftpClientFormatOptions(TftpClientContext *context, char_t *p,
+   size_t size, bool_t writeAccess, size_t *length);
+
+error_t tftpClientAddOption(char_t *p, size_t size, size_t *length,
+   const char_t *name, uint_t value);
+
+error_t tftpClientParseOptions(TftpClientContext *context,
+   const char_t *options, size_t length);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -37,6 +37,15 @@
 //TFTP port number
 #define TFTP_PORT 69
 
+//Default block size
+#define TFTP_DEFAULT_BLOCK_SIZE 512
+//Minimum block size (refer to RFC 2348)
+#define TFTP_MIN_BLOCK_SIZE 8
+//Maximum block size (refer to RFC 2348)
+#define TFTP_MAX_BLOCK_SIZE 65464
+//Maximum window size (refer to RFC 7440)
+#define TFTP_MAX_WINDOW_SIZE 65535
+
 //C++ guard
 #ifdef __cplusplus
 extern "C" {
@@ -71,10 +80,24 @@ typedef enum
    TFTP_ERROR_ILLEGAL_OPERATION   = 4,
    TFTP_ERROR_UNKNOWN_TID         = 5,
    TFTP_ERROR_FILE_ALREADY_EXISTS = 6,
-   TFTP_ERROR_NO_SUCH_USER        = 7
+   TFTP_ERROR_NO_SUCH_USER        = 7,
+   TFTP_ERROR_OPTION_NEGOTIATION  = 8
 } TftpErrorCode;
 
 
+/**
+ * @brief TFTP options
+ **/
+
+typedef enum
+{
+   TFTP_OPTION_NONE       = 0x00,
+   TFTP_OPTION_BLKSIZE    = 0x01, ///<Block size (RFC 2348)
+   TFTP_OPTION_TSIZE      = 0x02, ///<Transfer size (RFC 2349)
+   TFTP_OPTION_WINDOWSIZE = 0x04  ///<Window size (RFC 7440)
+} TftpOption;
+
+
 //CodeWarrior or Win32 compiler?
 #if defined(__CWCC__) || defined(_WIN32)
    #pragma pack(push, 1)
@@ -138,6 +161,17 @@ typedef __start_packed struct
 } __end_packed TftpErrorPacket;
 
 
+/**
+ * @brief Option acknowledgment packet (OACK)
+ **/
+
+typedef __start_packed struct
+{
+   uint16_t opcode;  //0-1
+   char_t options[]; //2
+} __end_packed TftpOackPacket;
+
+
 //CodeWarrior or Win32 compiler?
 #if defined(__CWCC__) || defined(_WIN32)
    #pragma pack(pop)
@@ -33,6 +33,7 @@
  * - RFC 1782: TFTP Option Extension
  * - RFC 1783: TFTP Blocksize Option
  * - RFC 1784: TFTP Timeout Interval and Transfer Size Options
+ * - RFC 7440: TFTP Windowsize Option
  *
  * @author Oryx Embedded SARL (www.oryx-embedded.com)
  * @version 2.1.4
@@ -71,6 +72,11 @@ void tftpServerGetDefaultSettings(TftpServerSettings *settings)
    settings->readFileCallback = NULL;
    //Close file callback function
    settings->closeFileCallback = NULL;
+
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   //Get file size callback function
+   settings->getFileSizeCallback = NULL;
+#endif
 }
 
 
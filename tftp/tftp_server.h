@@ -96,8 +96,33 @@
    #error TFTP_SERVER_BLOCK_SIZE parameter is not valid
 #endif
 
+//TFTP option negotiation support (blksize, windowsize and tsize)
+#ifndef TFTP_SERVER_OPTION_SUPPORT
+   #define TFTP_SERVER_OPTION_SUPPORT DISABLED
+#elif (TFTP_SERVER_OPTION_SUPPORT != ENABLED && TFTP_SERVER_OPTION_SUPPORT != DISABLED)
+   #error TFTP_SERVER_OPTION_SUPPORT parameter is not valid
+#endif
+
+//Maximum block size that can be negotiated
+#ifndef TFTP_SERVER_MAX_BLOCK_SIZE
+   #define TFTP_SERVER_MAX_BLOCK_SIZE 1428
+#elif (TFTP_SERVER_MAX_BLOCK_SIZE < TFTP_SERVER_BLOCK_SIZE || TFTP_SERVER_MAX_BLOCK_SIZE > 65464)
+   #error TFTP_SERVER_MAX_BLOCK_SIZE parameter is not valid
+#endif
+
+//Maximum window size that can be negotiated
+#ifndef TFTP_SERVER_MAX_WINDOW_SIZE
+   #define TFTP_SERVER_MAX_WINDOW_SIZE 16
+#elif (TFTP_SERVER_MAX_WINDOW_SIZE < 1 || TFTP_SERVER_MAX_WINDOW_SIZE > 65535)
+   #error TFTP_SERVER_MAX_WINDOW_SIZE parameter is not valid
+#endif
+
 //Maximum size of TFTP packets
-#define TFTP_SERVER_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_SERVER_BLOCK_SIZE)
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   #define TFTP_SERVER_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_SERVER_MAX_BLOCK_SIZE)
+#else
+   #define TFTP_SERVER_MAX_PACKET_SIZE (sizeof(TftpDataPacket) + TFTP_SERVER_BLOCK_SIZE)
+#endif
 
 //Forward declaration of TftpClientConnection structure
 struct _TftpClientConnection;
@@ -159,6 +184,13 @@ typedef error_t (*TftpServerReadFileCallback)(void *file,
 typedef void (*TftpServerCloseFileCallback)(void *file);
 
 
+/**
+ * @brief Get file size callback function
+ **/
+
+typedef error_t (*TftpServerGetFileSizeCallback)(void *file, size_t *size);
+
+
 /**
  * @brief TFTP server settings
  **/
@@ -171,6 +203,9 @@ typedef struct
    TftpServerWriteFileCallback writeFileCallback; ///<Write file callback function
    TftpServerReadFileCallback readFileCallback;   ///<Read file callback function
    TftpServerCloseFileCallback closeFileCallback; ///<Close file callback function
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   TftpServerGetFileSizeCallback getFileSizeCallback; ///<Get file size callback function
+#endif
 } TftpServerSettings;
 
 
@@ -185,6 +220,13 @@ struct _TftpClientConnection
    Socket *socket;                              ///<Underlying socket
    void *file;                                  ///<File pointer
    uint16_t block;                              ///<Block number
+   size_t blockSize;                            ///<Negotiated block size
+   uint16_t windowSize;                         ///<Negotiated window size
+   uint16_t windowCount;                        ///<Number of blocks sent or received in the current window
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   uint_t options;                              ///<Options acknowledged by the server
+   size_t tsize;                                ///<Transfer size
+#endif
    systime_t timestamp;                         ///<Time stamp to manage retransmissions
    uint_t retransmitCount;                      ///<Retransmission counter
    uint8_t packet[TFTP_SERVER_MAX_PACKET_SIZE]; ///<Outgoing TFTP packet
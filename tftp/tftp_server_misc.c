@@ -206,6 +206,11 @@ TftpClientConnection *tftpServerOpenConnection(TftpServerContext *context,
    //Update connection state
    connection->state = TFTP_STATE_OPEN;
 
+   //Use the default block size until another value is negotiated
+   connection->blockSize = TFTP_SERVER_BLOCK_SIZE;
+   //Lock-step transfers are used unless a larger window is negotiated
+   connection->windowSize = 1;
+
    //Pointer to the structure describing the connection
    return connection;
 }
@@ -420,6 +425,14 @@ void tftpServerProcessRrqPacket(TftpServerContext *context, const IpAddr *client
    if(connection == NULL)
       return;
 
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   //Compute the length of the option list
+   length -= osStrlen(mode) + 1;
+
+   //Parse the options that follow the mode string (refer to RFC 2347)
+   tftpServerParseOptions(connection, mode + osStrlen(mode) + 1, length);
+#endif
+
    //Open the specified file for reading
    if(context->settings.openFileCallback != NULL)
    {
@@ -438,11 +451,40 @@ void tftpServerProcessRrqPacket(TftpServerContext *context, const IpAddr *client
    {
       //The read operation is in progress...
       connection->state = TFTP_STATE_READING;
-      //Initialize block number
-      connection->block = 1;
 
-      //Send the first DATA packet
-      tftpServerSendDataPacket(connection);
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+      //Transfer size requested by the client?
+      if((connection->options & TFTP_OPTION_TSIZE) != 0)
+      {
+         //The server reports the size of the file in the OACK packet
+         if(context->settings.getFileSizeCallback == NULL ||
+            context->settings.getFileSizeCallback(connection->file,
+            &connection->tsize) != NO_ERROR)
+         {
+            //The transfer size cannot be determined
+            connection->options &= ~TFTP_OPTION_TSIZE;
+         }
+      }
+
+      //Any option acknowledged by the server?
+      if(connection->options != 0)
+      {
+         //The client acknowledges the OACK packet with block number zero
+         connection->block = 0;
+         connection->windowCount = 1;
+
+         //Send OACK packet
+         tftpServerSendOackPacket(connection);
+      }
+      else
+#endif
+      {
+         //Initialize block number
+         connection->block = 1;
+
+         //Send the first window of DATA packets
+         tftpServerSendDataWindow(connection);
+      }
    }
    else
    {
@@ -511,6 +553,14 @@ void tftpServerProcessWrqPacket(TftpServerContext *context, const IpAddr *client
    if(connection == NULL)
       return;
 
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+   //Compute the length of the option list
+   length -= osStrlen(mode) + 1;
+
+   //Parse the options that follow the mode string (refer to RFC 2347)
+   tftpServerParseOptions(connection, mode + osStrlen(mode) + 1, length);
+#endif
+
    //Open the specified file for writing
    if(context->settings.openFileCallback != NULL)
    {
@@ -532,9 +582,20 @@ void tftpServerProcessWrqPacket(TftpServerContext *context, const IpAddr *client
       //Initialize block number
       connection->block = 0;
 
-      //The positive response to a write request is an acknowledgment
-      //packet with block number zero
-      tftpServerSendAckPacket(connection);
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+      //Any option acknowledged by the server?
+      if(connection->options != 0)
+      {
+         //The OACK packet replaces the acknowledgment with block number zero
+         tftpServerSendOackPacket(connection);
+      }
+      else
+#endif
+      {
+         //The positive response to a write request is an acknowledgment
+         //packet with block number zero
+         tftpServerSendAckPacket(connection, 0);
+      }
 
       //Increment block number
       connection->block++;
@@ -589,7 +650,7 @@ void tftpServerProcessDataPacket(TftpClientConnection *connection,
          if(connection->settings->writeFileCallback != NULL)
          {
             //Calculate the offset relative to the beginning of the file
-            offset = (connection->block - 1) * TFTP_SERVER_BLOCK_SIZE;
+            offset = (size_t) (connection->block - 1) * connection->blockSize;
 
             //Invoke user callback function
             error = connection->settings->writeFileCallback(connection->file,
@@ -604,15 +665,16 @@ void tftpServerProcessDataPacket(TftpClientConnection *connection,
          //Check status code
          if(!error)
          {
-            //Acknowledge the DATA packet
-            tftpServerSendAckPacket(connection);
-
-            //Increment block number
-            connection->block++;
+            //Update the number of blocks received in the current window
+            connection->windowCount++;
 
-            //A data packet of less than 512 bytes signals termination of the transfer
-            if(length < TFTP_SERVER_BLOCK_SIZE)
+            //A data packet of less than blksize bytes signals termination
+            //of the transfer
+            if(length < connection->blockSize)
             {
+               //Acknowledge the last DATA packet
+               tftpServerSendAckPacket(connection, connection->block);
+
                //Properly close the file
                if(connection->settings->closeFileCallback != NULL)
                {
@@ -630,6 +692,24 @@ void tftpServerProcessDataPacket(TftpClientConnection *connection,
                //Save current time
                connection->timestamp = osGetSystemTime();
             }
+            else if(connection->windowCount >= connection->windowSize)
+            {
+               //The receiver acknowledges the last DATA packet of each window
+               tftpServerSendAckPacket(connection, connection->block);
+
+               //Start a new window
+               connection->windowCount = 0;
+            }
+            else
+            {
+               //Defer the acknowledgment until the window is complete
+               connection->timestamp = osGetSystemTime();
+               //Reset retransmission counter
+               connection->retransmitCount = 0;
+            }
+
+            //Increment block number
+            connection->block++;
          }
          else
          {
@@ -641,11 +721,25 @@ void tftpServerProcessDataPacket(TftpClientConnection *connection,
             tftpServerCloseConnection(connection);
          }
       }
-      else
+      else if(connection->windowCount > 0)
+      {
+         //When a gap is detected, the receiver acknowledges the last DATA
+         //packet received in sequence (refer to RFC 7440, section 4)
+         tftpServerSendAckPacket(connection, connection->block - 1);
+
+         //Start a new window
+         connection->windowCount = 0;
+      }
+      else if(connection->windowSize == 1)
       {
          //Retransmit ACK packet
          tftpServerRetransmitPacket(connection);
       }
+      else
+      {
+         //Discard out-of-sequence DATA packets until the sender restarts
+         //the window
+      }
    }
    else if(connection->state == TFTP_STATE_WRITE_COMPLETE)
    {
@@ -666,6 +760,8 @@ void tftpServerProcessDataPacket(TftpClientConnection *connection,
 void tftpServerProcessAckPacket(TftpClientConnection *connection,
    const TftpAckPacket *ackPacket, size_t length)
 {
+   uint16_t n;
+
    //Debug message
    TRACE_DEBUG("TFTP Server: ACK packet received (%" PRIuSIZE " bytes)...\r\n",
       length);
@@ -679,16 +775,39 @@ void tftpServerProcessAckPacket(TftpClientConnection *connection,
    TRACE_DEBUG("  Block = %" PRIu16 "\r\n", ntohs(ackPacket->block));
 
    //Check current state
-   if(connection->state == TFTP_STATE_READING)
+   if(connection->state == TFTP_STATE_READING ||
+      connection->state == TFTP_STATE_READ_COMPLETE)
    {
+      //Position of the acknowledged block within the current window
+      n = ntohs(ackPacket->block) - connection->block;
+
       //Make sure the ACK is not a duplicate
-      if(ntohs(ackPacket->block) == connection->block)
+      if(n < connection->windowCount)
       {
-         //The block number increases by one for each new block of data
-         connection->block++;
+         //Check whether the last DATA packet has been acknowledged
+         if(connection->state == TFTP_STATE_READ_COMPLETE &&
+            n == (connection->windowCount - 1))
+         {
+            //The host sending the last DATA must retransmit it until the packet
+            //is acknowledged or the sending host times out. If the response is
+            //an ACK, the transmission was completed successfully
+            tftpServerCloseConnection(connection);
+         }
+         else
+         {
+            //The next window starts with the block that follows the
+            //acknowledged one
+            connection->block = ntohs(ackPacket->block) + 1;
 
-         //Send DATA packet
-         tftpServerSendDataPacket(connection);
+            //Send the next window of DATA packets
+            tftpServerSendDataWindow(connection);
+         }
+      }
+      else if(connection->windowSize > 1 && n == UINT16_MAX)
+      {
+         //The receiver did not get the first DATA packet of the window and
+         //acknowledges the last block received in sequence (RFC 7440)
+         tftpServerSendDataWindow(connection);
       }
       else
       {
@@ -696,17 +815,6 @@ void tftpServerProcessAckPacket(TftpClientConnection *connection,
          //receipt of a duplicate ACK (refer to RFC 1123, section 4.2.3.1)
       }
    }
-   else if(connection->state == TFTP_STATE_READ_COMPLETE)
-   {
-      //Make sure the ACK is not a duplicate
-      if(ntohs(ackPacket->block) == connection->block)
-      {
-         //The host sending the last DATA must retransmit it until the packet is
-         //acknowledged or the sending host times out. If the response is an ACK,
-         //the transmission was completed successfully
-         tftpServerCloseConnection(connection);
-      }
-   }
 }
 
 
@@ -747,13 +855,60 @@ void tftpServerProcessErrorPacket(TftpClientConnection *connection,
 }
 
 
+/**
+ * @brief Send a window of DATA packets
+ * @param[in] connection Pointer to the client connection
+ * @return Error code
+ **/
+
+error_t tftpServerSendDataWindow(TftpClientConnection *connection)
+{
+   error_t error;
+
+   //Initialize status code
+   error = NO_ERROR;
+
+   //The read operation is in progress...
+   connection->state = TFTP_STATE_READING;
+   //The window starts with the first unacknowledged block
+   connection->windowCount = 0;
+
+   //The sender transmits up to windowsize DATA packets before waiting for
+   //an acknowledgment (refer to RFC 7440, section 4)
+   while(connection->windowCount < connection->windowSize &&
+      connection->state == TFTP_STATE_READING)
+   {
+      //Send DATA packet
+      error = tftpServerSendDataPacket(connection, connection->block +
+         connection->windowCount);
+
+      //Any error to report?
+      if(error)
+         break;
+
+      //Update the number of blocks sent in the current window
+      connection->windowCount++;
+   }
+
+   //Save the time at which the window was sent
+   connection->timestamp = osGetSystemTime();
+   //Reset retransmission counter
+   connection->retransmitCount = 0;
+
+   //Return status code
+   return error;
+}
+
+
 /**
  * @brief Send DATA packet
  * @param[in] connection Pointer to the client connection
+ * @param[in] block Block number
  * @return Error code
  **/
 
-error_t tftpServerSendDataPacket(TftpClientConnection *connection)
+error_t tftpServerSendDataPacket(TftpClientConnection *connection,
+   uint16_t block)
 {
    error_t error;
    size_t offset;
@@ -764,17 +919,17 @@ error_t tftpServerSendDataPacket(TftpClientConnection *connection)
 
    //Format DATA packet
    dataPacket->opcode = HTONS(TFTP_OPCODE_DATA);
-   dataPacket->block = htons(connection->block);
+   dataPacket->block = htons(block);
 
    //Read more data from the input file
    if(connection->settings->readFileCallback != NULL)
    {
       //Calculate the offset relative to the beginning of the file
-      offset = (connection->block - 1) * TFTP_SERVER_BLOCK_SIZE;
+      offset = (size_t) (block - 1) * connection->blockSize;
 
       //Invoke user callback function
       error = connection->settings->readFileCallback(connection->file, offset,
-         dataPacket->data, TFTP_SERVER_BLOCK_SIZE, &connection->packetLen);
+         dataPacket->data, connection->blockSize, &connection->packetLen);
    }
    else
    {
@@ -794,21 +949,13 @@ error_t tftpServerSendDataPacket(TftpClientConnection *connection)
    //Check status code
    if(!error)
    {
-      //A data packet of less than 512 bytes signals termination of the transfer
-      if(connection->packetLen < TFTP_SERVER_BLOCK_SIZE)
+      //A data packet of less than blksize bytes signals termination of
+      //the transfer
+      if(connection->packetLen < connection->blockSize)
       {
-         //Properly close the file
-         if(connection->settings->closeFileCallback != NULL)
-         {
-            //Invoke user callback function
-            connection->settings->closeFileCallback(connection->file);
-         }
-
-         //Mark the file as closed
-         connection->file = NULL;
-
          //The host sending the last DATA must retransmit it until the packet
-         //is acknowledged or the sending host times out
+         //is acknowledged or the sending host times out. The file is kept
+         //open since any block of the window may have to be read again
          connection->state = TFTP_STATE_READ_COMPLETE;
       }
 
@@ -823,11 +970,6 @@ error_t tftpServerSendDataPacket(TftpClientConnection *connection)
       //Send DATA packet
       error = socketSend(connection->socket, connection->packet,
          connection->packetLen, NULL, 0);
-
-      //Save the time at which the packet was sent
-      connection->timestamp = osGetSystemTime();
-      //Reset retransmission counter
-      connection->retransmitCount = 0;
    }
    else
    {
@@ -847,10 +989,12 @@ error_t tftpServerSendDataPacket(TftpClientConnection *connection)
 /**
  * @brief Send ACK packet
  * @param[in] connection Pointer to the client connection
+ * @param[in] block Block number
  * @return Error code
  **/
 
-error_t tftpServerSendAckPacket(TftpClientConnection *connection)
+error_t tftpServerSendAckPacket(TftpClientConnection *connection,
+   uint16_t block)
 {
    error_t error;
    TftpAckPacket *ackPacket;
@@ -860,7 +1004,7 @@ error_t tftpServerSendAckPacket(TftpClientConnection *connection)
 
    //Format ACK packet
    ackPacket->opcode = HTONS(TFTP_OPCODE_ACK);
-   ackPacket->block = htons(connection->block);
+   ackPacket->block = htons(block);
 
    //Length of the ACK packet
    connection->packetLen = sizeof(TftpAckPacket);
@@ -884,6 +1028,78 @@ error_t tftpServerSendAckPacket(TftpClientConnection *connection)
 }
 
 
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+
+/**
+ * @brief Send OACK packet
+ * @param[in] connection Pointer to the client connection
+ * @return Error code
+ **/
+
+error_t tftpServerSendOackPacket(TftpClientConnection *connection)
+{
+   error_t error;
+   size_t n;
+   TftpOackPacket *oackPacket;
+
+   //Point to the buffer where to format the packet
+   oackPacket = (TftpOackPacket *) connection->packet;
+
+   //Format OACK packet
+   oackPacket->opcode = HTONS(TFTP_OPCODE_OACK);
+
+   //Length of the option list
+   n = 0;
+
+   //Block size option acknowledged?
+   if((connection->options & TFTP_OPTION_BLKSIZE) != 0)
+   {
+      n += osSprintf(oackPacket->options + n, "blksize") + 1;
+      n += osSprintf(oackPacket->options + n, "%" PRIuSIZE,
+         connection->blockSize) + 1;
+   }
+
+   //Window size option acknowledged?
+   if((connection->options & TFTP_OPTION_WINDOWSIZE) != 0)
+   {
+      n += osSprintf(oackPacket->options + n, "windowsize") + 1;
+      n += osSprintf(oackPacket->options + n, "%" PRIu16,
+         connection->windowSize) + 1;
+   }
+
+   //Transfer size option acknowledged?
+   if((connection->options & TFTP_OPTION_TSIZE) != 0)
+   {
+      n += osSprintf(oackPacket->options + n, "tsize") + 1;
+      n += osSprintf(oackPacket->options + n, "%" PRIuSIZE,
+         connection->tsize) + 1;
+   }
+
+   //Length of the OACK packet
+   connection->packetLen = sizeof(TftpOackPacket) + n;
+
+   //Debug message
+   TRACE_DEBUG("TFTP Server: Sending OACK packet (%" PRIuSIZE " bytes)...\r\n", connection->packetLen);
+   TRACE_DEBUG("  Opcode = %" PRIu16 "\r\n", ntohs(oackPacket->opcode));
+   TRACE_DEBUG("  Block Size = %" PRIuSIZE "\r\n", connection->blockSize);
+   TRACE_DEBUG("  Window Size = %" PRIu16 "\r\n", connection->windowSize);
+
+   //Send OACK packet
+   error = socketSend(connection->socket, connection->packet,
+      connection->packetLen, NULL, 0);
+
+   //Save the time at which the packet was sent
+   connection->timestamp = osGetSystemTime();
+   //Reset retransmission counter
+   connection->retransmitCount = 0;
+
+   //Return status code
+   return error;
+}
+
+#endif
+
+
 /**
  * @brief Send ERROR packet
  * @param[in] connection Pointer to the client connection
@@ -944,17 +1160,189 @@ error_t tftpServerSendErrorPacket(TftpClientConnection *connection,
 error_t tftpServerRetransmitPacket(TftpClientConnection *connection)
 {
    error_t error;
+   uint_t i;
 
-   //Debug message
-   TRACE_DEBUG("TFTP Server: Retransmitting packet (%" PRIuSIZE " bytes)...\r\n",
-      connection->packetLen);
+   //Initialize status code
+   error = NO_ERROR;
 
-   //Retransmit the last packet
-   error = socketSend(connection->socket, connection->packet,
-      connection->packetLen, NULL, 0);
+   //Check current state
+   if((connection->state == TFTP_STATE_READING ||
+      connection->state == TFTP_STATE_READ_COMPLETE) &&
+      connection->windowCount > 1)
+   {
+      //Debug message
+      TRACE_DEBUG("TFTP Server: Retransmitting window (%" PRIu16 " blocks)...\r\n",
+         connection->windowCount);
+
+      //Only the last packet of the window is kept in memory. The whole window
+      //is read again from the file, starting with the first unacknowledged block
+      for(i = 0; i < connection->windowCount && !error; i++)
+      {
+         //Send DATA packet
+         error = tftpServerSendDataPacket(connection, connection->block + i);
+      }
+   }
+   else if(connection->state == TFTP_STATE_WRITING &&
+      connection->windowCount > 0)
+   {
+      //Acknowledge the DATA packets that have been received in sequence
+      error = tftpServerSendAckPacket(connection, connection->block - 1);
+
+      //Start a new window
+      connection->windowCount = 0;
+   }
+   else
+   {
+      //Debug message
+      TRACE_DEBUG("TFTP Server: Retransmitting packet (%" PRIuSIZE " bytes)...\r\n",
+         connection->packetLen);
+
+      //Retransmit the last packet
+      error = socketSend(connection->socket, connection->packet,
+         connection->packetLen, NULL, 0);
+   }
 
    //Return status code
    return error;
 }
 
+
+#if (TFTP_SERVER_OPTION_SUPPORT == ENABLED)
+
+/**
+ * @brief Parse the options of a RRQ or WRQ packet
+ * @param[in] connection Pointer to the client connection
+ * @param[in] options Pointer to the option list
+ * @param[in] length Length of the option list, in bytes
+ **/
+
+void tftpServerParseOptions(TftpClientConnection *connection,
+   const char_t *options, size_t length)
+{
+   size_t n;
+   unsigned long value;
+   const char_t *name;
+   const char_t *valueStr;
+
+   //Each option consists of a name and a value, both terminated by a zero byte
+   while(length > 0)
+   {
+      //Point to the option name
+      name = options;
+      n = osStrlen(name) + 1;
+
+      //Malformed option?
+      if(n >= length)
+         break;
+
+      //Point to the option value
+      valueStr = options + n;
+      n += osStrlen(valueStr) + 1;
+
+      //Debug message
+      TRACE_DEBUG("  Option %s = %s\r\n", name, valueStr);
+
+      //Option values are decimal numbers
+      value = osStrtoul(valueStr, NULL, 10);
+
+      //Option names are case-insensitive
+      if(!osStrcasecmp(name, "blksize"))
+      {
+         //Valid values range between 8 and 65464 octets (refer to RFC 2348)
+         if(value >= TFTP_MIN_BLOCK_SIZE && value <= TFTP_MAX_BLOCK_SIZE)
+         {
+            //The server may reply with a smaller block size
+            connection->blockSize = MIN(value,
+               tftpServerGetMaxBlockSize(connection));
+
+            //Acknowledge the option
+            connection->options |= TFTP_OPTION_BLKSIZE;
+         }
+      }
+      else if(!osStrcasecmp(name, "windowsize"))
+      {
+         //Valid values range between 1 and 65535 blocks (refer to RFC 7440)
+         if(value >= 1 && value <= TFTP_MAX_WINDOW_SIZE)
+         {
+            //The server may reply with a smaller window size
+            connection->windowSize = (uint16_t) MIN(value,
+               TFTP_SERVER_MAX_WINDOW_SIZE);
+
+            //Acknowledge the option
+            connection->options |= TFTP_OPTION_WINDOWSIZE;
+         }
+      }
+      else if(!osStrcasecmp(name, "tsize"))
+      {
+         //In a WRQ, the client specifies the size of the file. In a RRQ, the
+         //value is zero and the server reports the size (refer to RFC 2349)
+         connection->tsize = value;
+
+         //Acknowledge the option
+         connection->options |= TFTP_OPTION_TSIZE;
+      }
+      else
+      {
+         //Unrecognized options are silently ignored (refer to RFC 2347)
+      }
+
+      //Jump to the next option
+      options += n;
+      length -= n;
+   }
+}
+
+
+/**
+ * @brief Get the largest block size that avoids IP fragmentation
+ * @param[in] connection Pointer to the client connection
+ * @return Maximum block size, in bytes
+ **/
+
+size_t tftpServerGetMaxBlockSize(TftpClientConnection *connection)
+{
+   size_t n;
+   size_t mtu;
+   NetInterface *interface;
+
+   //Point to the underlying network interface
+   interface = connection->settings->interface;
+
+   //Default interface?
+   if(interface == NULL)
+      interface = netGetDefaultInterface();
+
+   //Maximum payload of a single IP datagram
+   mtu = 0;
+
+#if (IPV4_SUPPORT == ENABLED)
+   //IPv4 client?
+   if(connection->socket->remoteIpAddr.length == sizeof(Ipv4Addr))
+   {
+      mtu = interface->ipv4Context.linkMtu - sizeof(Ipv4Header);
+   }
+#endif
+#if (IPV6_SUPPORT == ENABLED)
+   //IPv6 client?
+   if(connection->socket->remoteIpAddr.length == sizeof(Ipv6Addr))
+   {
+      mtu = interface->ipv6Context.linkMtu - sizeof(Ipv6Header);
+   }
+#endif
+
+   //Maximum block size that can be negotiated
+   n = TFTP_SERVER_MAX_BLOCK_SIZE;
+
+   //Limit the block size so that DATA packets fit in a single IP datagram
+   if(mtu > (sizeof(UdpHeader) + sizeof(TftpDataPacket) + TFTP_DEFAULT_BLOCK_SIZE))
+   {
+      n = MIN(n, mtu - sizeof(UdpHeader) - sizeof(TftpDataPacket));
+   }
+
+   //Return the maximum block size
+   return n;
+}
+
+#endif
+
 #endif
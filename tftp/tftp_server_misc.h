@@ -68,14 +68,26 @@ void tftpServerProcessAckPacket(TftpClientConnection *connection,
 void tftpServerProcessErrorPacket(TftpClientConnection *connection,
    const TftpErrorPacket *errorPacket, size_t length);
 
-error_t tftpServerSendDataPacket(TftpClientConnection *connection);
-error_t tftpServerSendAckPacket(TftpClientConnection *connection);
+error_t tftpServerSendDataWindow(TftpClientConnection *connection);
+
+error_t tftpServerSendDataPacket(TftpClientConnection *connection,
+   uint16_t block);
+
+error_t tftpServerSendAckPacket(TftpClientConnection *connection,
+   uint16_t block);
+
+error_t tftpServerSendOackPacket(TftpClientConnection *connection);
 
 error_t tftpServerSendErrorPacket(TftpClientConnection *connection,
    uint16_t errorCode, const char_t *errorMsg);
 
 error_t tftpServerRetransmitPacket(TftpClientConnection *connection);
 
+void tftpServerParseOptions(TftpClientConnection *connection,
+   const char_t *options, size_t length);
+
+size_t tftpServerGetMaxBlockSize(TftpClientConnection *connection);
+
 //C++ guard
 #ifdef __cplusplus
 }
@@ -975,7 +975,6 @@ error_t webSocketSendEx(WebSocket *webSocket, const void *data, size_t length,
 {
    error_t error;
    size_t i;
-   size_t j;
    size_t k;
    size_t n;
    const uint8_t *p;
@@ -1026,10 +1025,17 @@ error_t webSocketSendEx(WebSocket *webSocket, const void *data, size_t length,
          //Any remaining data to be sent?
          if(txContext->bufferPos < txContext->bufferLen)
          {
+            //The frame header is held back so that it can be coalesced with
+            //the payload that immediately follows
+            if(txContext->payloadLen > 0)
+               k = SOCKET_FLAG_DELAY;
+            else
+               k = 0;
+
             //Send more data
             error = webSocketSendData(webSocket,
                txContext->buffer + txContext->bufferPos,
-               txContext->bufferLen - txContext->bufferPos, &n, 0);
+               txContext->bufferLen - txContext->bufferPos, &n, k);
 
             //Advance data pointer
             txContext->bufferPos += n;
@@ -1069,6 +1075,28 @@ error_t webSocketSendEx(WebSocket *webSocket, const void *data, size_t length,
             {
                //Calculate the number of bytes that are pending
                n = MIN(length - i, txContext->payloadLen - txContext->payloadPos);
+
+               //Frames sent from the server to the client are not masked
+               if(webSocket->endpoint == WS_ENDPOINT_SERVER)
+               {
+                  //The application data are sent directly from the caller's
+                  //buffer, without any intermediate copy
+                  error = webSocketSendData(webSocket, p + i, n, &n, 0);
+
+                  //Advance data pointer
+                  txContext->payloadPos += n;
+
+                  //Total number of data that have been written
+                  i += n;
+
+                  //Any error to report?
+                  if(error)
+                     break;
+
+                  //Process the next sub-state
+                  continue;
+               }
+
                //Limit the number of bytes to be copied at a time
                n = MIN(n, WEB_SOCKET_BUFFER_SIZE);
 
@@ -1078,14 +1106,9 @@ error_t webSocketSendEx(WebSocket *webSocket, const void *data, size_t length,
                //All frames sent from the client to the server are masked
                if(webSocket->endpoint == WS_ENDPOINT_CLIENT)
                {
-                  //Apply masking
-                  for(j = 0; j < n; j++)
-                  {
-                     //Index of the masking key to be applied
-                     k = (txContext->payloadPos + j) % 4;
-                     //Convert unmasked data into masked data
-                     txContext->buffer[j] ^= txContext->maskingKey[k];
-                  }
+                  //Convert unmasked data into masked data
+                  webSocketApplyMask(txContext->buffer, n,
+                     txContext->maskingKey, txContext->payloadPos);
                }
 
                //Rewind to the beginning of the buffer
@@ -1162,9 +1185,9 @@ error_t webSocketReceiveEx(WebSocket *webSocket, void *data, size_t size,
 {
    error_t error;
    size_t i;
-   size_t j;
    size_t k;
    size_t n;
+   uint8_t *p;
    WebSocketFrame *frame;
    WebSocketFrameContext *rxContext;
 
@@ -1301,23 +1324,31 @@ error_t webSocketReceiveEx(WebSocket *webSocket, void *data, size_t size,
          {
             //Limit the number of bytes to read at a time
             n = MIN(size - i, rxContext->payloadLen - rxContext->payloadPos);
-            //Limit the number of bytes to be copied at a time
-            n = MIN(n, WEB_SOCKET_BUFFER_SIZE);
+
+            //Sanity check
+            if(data != NULL)
+            {
+               //The payload is delivered in place, without any intermediate
+               //copy
+               p = (uint8_t *) data + i;
+            }
+            else
+            {
+               //The payload is discarded
+               p = rxContext->buffer;
+               //Limit the number of bytes to be read at a time
+               n = MIN(n, WEB_SOCKET_BUFFER_SIZE);
+            }
 
             //Read more data
-            error = webSocketReceiveData(webSocket, rxContext->buffer, n, &n, 0);
+            error = webSocketReceiveData(webSocket, p, n, &n, 0);
 
             //All frames sent from the client to the server are masked
             if(rxContext->mask)
             {
-               //Unmask the data
-               for(j = 0; j < n; j++)
-               {
-                  //Index of the masking key to be applied
-                  k = (rxContext->payloadPos + j) % 4;
-                  //Convert masked data into unmasked data
-                  rxContext->buffer[j] ^= rxContext->maskingKey[k];
-               }
+               //Convert masked data into unmasked data
+               webSocketApplyMask(p, n, rxContext->maskingKey,
+                  rxContext->payloadPos);
             }
 
             //Text frame?
@@ -1331,8 +1362,7 @@ error_t webSocketReceiveEx(WebSocket *webSocket, void *data, size_t size,
                   k = 0;
 
                //Invalid UTF-8 sequence?
-               if(!webSocketCheckUtf8Stream(&webSocket->utf8Context,
-                  rxContext->buffer, n, k))
+               if(!webSocketCheckUtf8Stream(&webSocket->utf8Context, p, n, k))
                {
                   //The received data is not consistent with the type of the message
                   webSocket->statusCode = WS_STATUS_CODE_INVALID_PAYLOAD_DATA;
@@ -1341,13 +1371,6 @@ error_t webSocketReceiveEx(WebSocket *webSocket, void *data, size_t size,
                }
             }
 
-            //Sanity check
-            if(data != NULL)
-            {
-               //Copy application data
-               osMemcpy((uint8_t *) data + i, rxContext->buffer, n);
-            }
-
             //Advance data pointer
             rxContext->payloadPos += n;
 
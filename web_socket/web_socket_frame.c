@@ -179,7 +179,6 @@ error_t webSocketFormatFrameHeader(WebSocket *webSocket,
 error_t webSocketParseFrameHeader(WebSocket *webSocket,
    const WebSocketFrame *frame, WebSocketFrameType *type)
 {
-   size_t j;
    size_t k;
    size_t n;
    uint16_t statusCode;
@@ -317,14 +316,9 @@ error_t webSocketParseFrameHeader(WebSocket *webSocket,
          //All frames sent from the client to the server are masked
          if(frame->mask)
          {
-            //Unmask the data
-            for(j = 0; j < rxContext->payloadLen; j++)
-            {
-               //Index of the masking key to be applied
-               k = j % 4;
-               //Convert masked data into unmasked data
-               *((uint8_t *) frame + n + j) ^= rxContext->maskingKey[k];
-            }
+            //Convert masked data into unmasked data
+            webSocketApplyMask((uint8_t *) frame + n, rxContext->payloadLen,
+               rxContext->maskingKey, 0);
          }
 
          //If there is a body, the first two bytes of the body must be
@@ -1253,6 +1253,14 @@ bool_t webSocketCheckUtf8Stream(WebSocketUtf8Context *context,
       //Leading or continuation byte?
       if(context->utf8CharIndex == 0)
       {
+         //Skip the run of 7-bit code points, if any. A single-byte sequence
+         //is always complete, so the termination check can be omitted
+         i += webSocketScanAsciiChars(data + i, length - i);
+
+         //End of the data chunk?
+         if(i >= length)
+            break;
+
          //7-bit code point?
          if((data[i] & 0x80) == 0x00)
          {
@@ -1359,4 +1367,110 @@ bool_t webSocketCheckUtf8Stream(WebSocketUtf8Context *context,
    return valid;
 }
 
+
+/**
+ * @brief Count the number of 7-bit characters at the beginning of a buffer
+ *
+ * The data are examined a word at a time once the pointer is suitably
+ * aligned, which speeds up the validation of text messages that consist
+ * mostly of ASCII characters
+ *
+ * @param[in] data Pointer to the data to be examined
+ * @param[in] length Number of bytes to examine
+ * @return Number of leading bytes whose most significant bit is cleared
+ **/
+
+size_t webSocketScanAsciiChars(const uint8_t *data, size_t length)
+{
+   size_t i;
+
+   //Process leading bytes until the pointer is aligned on a word boundary
+   for(i = 0; i < length && ((uintptr_t) (data + i) % sizeof(uint32_t)) != 0; i++)
+   {
+      //Non-ASCII character?
+      if((data[i] & 0x80) != 0)
+         return i;
+   }
+
+   //Process the data a word at a time
+   while((length - i) >= sizeof(uint32_t))
+   {
+      //Any of the bytes has its most significant bit set?
+      if((LOAD32LE(data + i) & 0x80808080U) != 0)
+         break;
+
+      //Next word
+      i += sizeof(uint32_t);
+   }
+
+   //Process the remaining bytes
+   while(i < length && (data[i] & 0x80) == 0)
+   {
+      i++;
+   }
+
+   //Return the number of 7-bit characters
+   return i;
+}
+
+
+/**
+ * @brief Apply the masking algorithm to a chunk of payload data
+ *
+ * Masking and unmasking are the same operation. The masking key is rotated
+ * once according to the position of the chunk within the payload, so that
+ * the data can then be processed a word at a time
+ *
+ * @param[in,out] data Pointer to the data to be masked or unmasked
+ * @param[in] length Number of bytes to process
+ * @param[in] maskingKey 32-bit masking key
+ * @param[in] offset Position of the chunk within the payload
+ **/
+
+void webSocketApplyMask(uint8_t *data, size_t length,
+   const uint8_t *maskingKey, size_t offset)
+{
+   size_t i;
+   uint_t k;
+   uint32_t mask;
+   uint8_t key[4];
+
+   //Index of the masking key to be applied to the first byte
+   k = offset % 4;
+
+   //Process leading bytes until the pointer is aligned on a word boundary
+   for(i = 0; i < length && ((uintptr_t) (data + i) % sizeof(uint32_t)) != 0; i++)
+   {
+      //Convert masked data into unmasked data (and vice versa)
+      data[i] ^= maskingKey[k];
+      //Next byte of the masking key
+      k = (k + 1) % 4;
+   }
+
+   //Rotate the masking key so that it lines up with the aligned words
+   key[0] = maskingKey[k];
+   key[1] = maskingKey[(k + 1) % 4];
+   key[2] = maskingKey[(k + 2) % 4];
+   key[3] = maskingKey[(k + 3) % 4];
+
+   //Loading the key and the data with the same byte order makes the XOR
+   //independent of the endianness of the CPU
+   mask = LOAD32LE(key);
+
+   //Process the data a word at a time
+   while((length - i) >= sizeof(uint32_t))
+   {
+      //Apply masking
+      STORE32LE(LOAD32LE(data + i) ^ mask, data + i);
+      //Next word
+      i += sizeof(uint32_t);
+   }
+
+   //Process the remaining bytes
+   for(k = 0; i < length; i++, k++)
+   {
+      data[i] ^= key[k];
+   }
+}
+
 #endif
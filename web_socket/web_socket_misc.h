@@ -85,6 +85,11 @@ error_t webSocketDecodePercentEncodedString(const char_t *input,
 bool_t webSocketCheckUtf8Stream(WebSocketUtf8Context *context,
    const uint8_t *data, size_t length, size_t remaining);
 
+size_t webSocketScanAsciiChars(const uint8_t *data, size_t length);
+
+void webSocketApplyMask(uint8_t *data, size_t length,
+   const uint8_t *maskingKey, size_t offset);
+
 //C++ guard
 #ifdef __cplusplus
 }